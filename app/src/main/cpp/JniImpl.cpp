@@ -26,38 +26,34 @@
 #include "engine/vulkan_wrapper/vulkan_wrapper.h"
 #include "jni.h"
 #include "samples/Sample.h"
+#include <android/hardware_buffer_jni.h>
 #include <android/native_window_jni.h>
+#include <cstdio>
 #include <stdexcept>
+#include <string>
 #include <vulkan/vulkan.h>
 
 #define JCMCPRV(rettype, name) \
     extern "C" JNIEXPORT rettype JNICALL Java_com_gain_vulkan_NativeVulkan_##name
 
-// TODO We do it by compute pipeline
-void removeFakeUVData(uint8_t *srcBuffer, jint width, jint height, jint stride, jint pixelStride,
-                      uint8_t *dstBuffer)
-{
-    int index = 0;
-    for (int row = 0; row < height; row++)
-    {
-        for (int col = 0; col < width; col++)
-        {
-            dstBuffer[index++] = srcBuffer[row * stride + col * pixelStride];
-        }
-    }
-}
-
 Sample *castToSample(jlong handle)
 {
     return reinterpret_cast<Sample *>(static_cast<uintptr_t>(handle));
 }
 
 JCMCPRV(jlong, nativeInit)
-(JNIEnv *env, jobject thiz, jobject asset_manager, jint type)
+(JNIEnv *env, jobject thiz, jobject asset_manager, jint type, jboolean headless, jstring cache_dir)
 {
-    auto *assetManager = AAssetManager_fromJava(env, asset_manager);
-    assert(assetManager != nullptr);
-    auto sample = Sample::create(assetManager, type);
+    auto assets = vks::AssetLoader::create(AAssetManager_fromJava(env, asset_manager));
+    assert(assets != nullptr);
+    std::string cacheDir;
+    if (cache_dir != nullptr)
+    {
+        const char *chars = env->GetStringUTFChars(cache_dir, nullptr);
+        cacheDir          = chars;
+        env->ReleaseStringUTFChars(cache_dir, chars);
+    }
+    auto sample = Sample::create(assets, type, headless, cacheDir);
     return static_cast<jlong>(reinterpret_cast<uintptr_t>(sample.release()));
 }
 
@@ -114,20 +110,60 @@ JCMCPRV(void, nativePrepareI420VkConversion)
     env->ReleaseByteArrayElements(img_data, reinterpret_cast<jbyte *>(buf), 0);
 }
 
+JCMCPRV(void, nativePrepareNV12VkConversion)
+(JNIEnv *env, jobject thiz, jlong handle, jbyteArray img_data, jint w, jint h, jboolean cr_cb)
+{
+    uint8_t *buf = reinterpret_cast<uint8_t *>(env->GetByteArrayElements(img_data, JNI_FALSE));
+    castToSample(handle)->prepareNV12VkConversion(env, buf, w, h, cr_cb);
+    env->ReleaseByteArrayElements(img_data, reinterpret_cast<jbyte *>(buf), 0);
+}
+
 JCMCPRV(void, nativePrepareCameraYUV)
 (JNIEnv *env, jobject thiz, jlong handle, jobject y_buffer, jobject u_buffer, jobject v_buffer,
  jint w, jint h, jint stride_y, jint stride_u, jint stride_v, jint uPixelStride, jint vPixelStride,
  jint orientation)
 {
     uint8_t *y = static_cast<uint8_t *>(env->GetDirectBufferAddress(y_buffer));
-    removeFakeUVData(y, w, h, stride_y, 1, y);
-    uint8_t *u    = static_cast<uint8_t *>(env->GetDirectBufferAddress(u_buffer));
-    uint8_t *dstU = static_cast<uint8_t *>(malloc(sizeof(uint8_t) * w * h / 4));
-    removeFakeUVData(u, w / 2, h / 2, stride_u, uPixelStride, dstU);
-    uint8_t *v    = static_cast<uint8_t *>(env->GetDirectBufferAddress(v_buffer));
-    uint8_t *dstV = static_cast<uint8_t *>(malloc(sizeof(uint8_t) * w * h / 4));
-    removeFakeUVData(v, w / 2, h / 2, stride_v, vPixelStride, dstV);
-    castToSample(handle)->prepareYUV(env, y, dstU, dstV, w, h, w, w / 2, w / 2, orientation);
+    uint8_t *u = static_cast<uint8_t *>(env->GetDirectBufferAddress(u_buffer));
+    uint8_t *v = static_cast<uint8_t *>(env->GetDirectBufferAddress(v_buffer));
+    castToSample(handle)->prepareYUV(env, y, u, v, w, h, stride_y, stride_u, stride_v,
+                                     uPixelStride, vPixelStride, orientation);
+}
+
+JCMCPRV(void, nativeSetHistogramChannel)
+(JNIEnv *env, jobject thiz, jlong handle, jint channel)
+{
+    castToSample(handle)->setHistogramChannel(channel);
+}
+
+JCMCPRV(jlong, nativeGetLatestHistogram)
+(JNIEnv *env, jobject thiz, jlong handle, jintArray bins)
+{
+    return static_cast<jlong>(castToSample(handle)->latestHistogram(env, bins));
+}
+
+JCMCPRV(void, nativeSetLUTChain)
+(JNIEnv *env, jobject thiz, jlong handle, jobjectArray lut_bitmaps)
+{
+    castToSample(handle)->setLUTChain(env, lut_bitmaps);
+}
+
+JCMCPRV(void, nativeSetLUTIntensity)
+(JNIEnv *env, jobject thiz, jlong handle, jint step, jfloat intensity)
+{
+    castToSample(handle)->setLUTIntensity(step, intensity);
+}
+
+JCMCPRV(jboolean, nativeApplyLUT)
+(JNIEnv *env, jobject thiz, jlong handle, jobject y_buffer, jobject u_buffer, jobject v_buffer,
+ jint w, jint h, jint stride_y, jint stride_u, jint stride_v, jint uPixelStride, jint vPixelStride,
+ jboolean tetrahedral, jobject dst)
+{
+    uint8_t *y = static_cast<uint8_t *>(env->GetDirectBufferAddress(y_buffer));
+    uint8_t *u = static_cast<uint8_t *>(env->GetDirectBufferAddress(u_buffer));
+    uint8_t *v = static_cast<uint8_t *>(env->GetDirectBufferAddress(v_buffer));
+    return castToSample(handle)->applyLUT(env, y, u, v, w, h, stride_y, stride_u, stride_v, uPixelStride,
+                                          vPixelStride, tetrahedral, dst);
 }
 
 JCMCPRV(void, nativePrepareHistogram)
@@ -143,9 +179,11 @@ JCMCPRV(void, nativePrepareHistogram)
 }
 
 JCMCPRV(void, nativePrepareCameraTexture)
-(JNIEnv *env, jobject thiz, jlong handle)
+(JNIEnv *env, jobject thiz, jlong handle, jobject hardware_buffer, jint orientation)
 {
-    castToSample(handle)->prepareCameraTexture(env);
+    // The sample takes its own reference, the Java HardwareBuffer only has to outlive the call
+    AHardwareBuffer *buffer = AHardwareBuffer_fromHardwareBuffer(env, hardware_buffer);
+    castToSample(handle)->prepareCameraTexture(env, buffer, orientation);
 }
 
 JCMCPRV(void, nativePrepareLUT)
@@ -155,9 +193,9 @@ JCMCPRV(void, nativePrepareLUT)
 }
 
 JCMCPRV(void, nativePrepareLUTs)
-(JNIEnv *env, jobject thiz, jlong handle, jobjectArray luts)
+(JNIEnv *env, jobject thiz, jlong handle, jobjectArray lut_paths)
 {
-    castToSample(handle)->prepareLUTs(env, luts);
+    castToSample(handle)->prepareLUTs(env, lut_paths);
 }
 
 JCMCPRV(void, nativeUpdateLUTs)
@@ -175,12 +213,20 @@ JCMCPRV(void, nativeUpdateSelectedIndex)
 
 JCMCPRV(void, nativePrepareLongExposure)
 (JNIEnv *env, jobject thiz, jlong handle, jobject y_buffer, jobject u_buffer, jobject v_buffer,
- jint w, jint h, jint stride_y, jint stride_u, jint stride_v)
+ jint w, jint h, jint stride_y, jint stride_u, jint stride_v, jint uPixelStride, jint vPixelStride,
+ jint orientation)
 {
     uint8_t *y = static_cast<uint8_t *>(env->GetDirectBufferAddress(y_buffer));
     uint8_t *u = static_cast<uint8_t *>(env->GetDirectBufferAddress(u_buffer));
     uint8_t *v = static_cast<uint8_t *>(env->GetDirectBufferAddress(v_buffer));
-    castToSample(handle)->prepareLongExposure(env, y, u, v, w, h, stride_y, stride_u, stride_v);
+    castToSample(handle)->prepareLongExposure(
+        env, y, u, v, w, h, stride_y, stride_u, stride_v, uPixelStride, vPixelStride, orientation);
+}
+
+JCMCPRV(void, nativeSetLongExposureMode)
+(JNIEnv *env, jobject thiz, jlong handle, jint mode, jfloat decay)
+{
+    castToSample(handle)->setLongExposureMode(mode, decay);
 }
 
 JCMCPRV(void, nativePrepare3dModel)
@@ -223,6 +269,52 @@ JCMCPRV(void, native_1setWindow)
     castToSample(handle)->setWindow(window, width, height);
 }
 
+JCMCPRV(void, nativeSetHeadlessTarget)
+(JNIEnv *env, jobject thiz, jlong handle, jint width, jint height)
+{
+    castToSample(handle)->setHeadlessTarget(width, height);
+}
+
+JCMCPRV(jboolean, nativeReadbackFrame)
+(JNIEnv *env, jobject thiz, jlong handle, jobject dst)
+{
+    void        *data = env->GetDirectBufferAddress(dst);
+    const jlong  size = env->GetDirectBufferCapacity(dst);
+    if (data == nullptr || size < 0)
+    {
+        LOGCATE("nativeReadbackFrame: dst is not a direct buffer");
+        return JNI_FALSE;
+    }
+    return castToSample(handle)->readbackFrame(data, static_cast<size_t>(size));
+}
+
+JCMCPRV(void, nativeSetFramesInFlight)
+(JNIEnv *env, jobject thiz, jlong handle, jint count)
+{
+    castToSample(handle)->setFramesInFlight(count);
+}
+
+JCMCPRV(jstring, nativeCompareFramesInFlight)
+(JNIEnv *env, jobject thiz, jlong handle, jint frame_count)
+{
+    std::string report;
+    char        line[128];
+    for (const auto &result : castToSample(handle)->compareFramesInFlight(frame_count))
+    {
+        snprintf(line, sizeof(line), "%u frames in flight: %.2f ms/frame, %.2f ms cpu\n",
+                 result.framesInFlight, result.frameMs, result.cpuMs);
+        report += line;
+    }
+    return env->NewStringUTF(report.c_str());
+}
+
+JCMCPRV(void, nativeRunBenchmarks)
+(JNIEnv *env, jobject thiz, jlong handle)
+{
+    castToSample(handle)->runBenchmarks();
+    castToSample(handle)->runEngineBenchmarks();
+}
+
 JCMCPRV(void, nativeOnTouchActionMove)
 (JNIEnv *env, jobject thiz, jlong handle, jfloat delta_x, jfloat delta_y)
 {
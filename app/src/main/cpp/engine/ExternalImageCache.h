@@ -0,0 +1,179 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_EXTERNALIMAGECACHE_H
+#define GAINVULKANSAMPLE_EXTERNALIMAGECACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+// This header does not depend on Vulkan or Android, the cache logic is built and tested on the
+// host (app/src/test/cpp/ExternalImageCacheTest.cpp).
+namespace vks
+{
+// What the cache needs to know about an external buffer to decide whether an import can be reused
+struct ExternalBufferDesc
+{
+    // Stable identity of the buffer as long as it is alive
+    uint64_t id     = 0;
+    uint32_t width  = 0;
+    uint32_t height = 0;
+    uint32_t format = 0;
+    uint64_t usage  = 0;
+
+    bool operator==(const ExternalBufferDesc &other) const
+    {
+        return id == other.id && width == other.width && height == other.height &&
+               format == other.format && usage == other.usage;
+    }
+    bool operator!=(const ExternalBufferDesc &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// Turns an external buffer into an image usable by the renderer
+template <typename T_Buffer, typename T_Image>
+class ExternalImageImporter
+{
+  public:
+    virtual ~ExternalImageImporter() = default;
+
+    virtual bool describe(T_Buffer *buffer, ExternalBufferDesc *desc) = 0;
+
+    // Returns nullptr if the buffer can not be imported
+    virtual std::shared_ptr<T_Image> import(T_Buffer *buffer, const ExternalBufferDesc &desc) = 0;
+};
+
+// Keeps the images imported from the last few external buffers, keyed by the buffer id. Camera
+// and decoder producers cycle through a small fixed set of buffers, so after the first round
+// every frame is a hit and no import happens.
+//
+// The cache holds a reference to the images only, users keep their own reference for as long as
+// the GPU may read the image: an evicted image is destroyed when the last reference goes away.
+template <typename T_Buffer, typename T_Image>
+class ExternalImageCache
+{
+  public:
+    struct Stats
+    {
+        uint64_t hits      = 0;
+        uint64_t imports   = 0;
+        uint64_t evictions = 0;
+        uint64_t failures  = 0;
+    };
+
+    ExternalImageCache(ExternalImageImporter<T_Buffer, T_Image> *importer, size_t capacity) :
+        mImporter(importer), mCapacity(capacity > 0 ? capacity : 1)
+    {}
+
+    // Image of the buffer, imported on the first use. Returns nullptr if the import failed.
+    std::shared_ptr<T_Image> acquire(T_Buffer *buffer)
+    {
+        ExternalBufferDesc desc;
+        if (buffer == nullptr || !mImporter->describe(buffer, &desc))
+        {
+            mStats.failures++;
+            return nullptr;
+        }
+
+        auto found = mIndex.find(desc.id);
+        if (found != mIndex.end())
+        {
+            auto entry = found->second;
+            if (entry->desc == desc)
+            {
+                // Most recently used entries are at the front
+                mEntries.splice(mEntries.begin(), mEntries, entry);
+                mStats.hits++;
+                return entry->image;
+            }
+            // The id was reused for a buffer with a different layout
+            mIndex.erase(found);
+            mEntries.erase(entry);
+            mStats.evictions++;
+        }
+
+        std::shared_ptr<T_Image> image = mImporter->import(buffer, desc);
+        if (image == nullptr)
+        {
+            mStats.failures++;
+            return nullptr;
+        }
+        mStats.imports++;
+
+        mEntries.push_front({desc, image});
+        mIndex[desc.id] = mEntries.begin();
+        while (mEntries.size() > mCapacity)
+        {
+            mIndex.erase(mEntries.back().desc.id);
+            mEntries.pop_back();
+            mStats.evictions++;
+        }
+        return image;
+    }
+
+    // Drop every cached image, e.g. when the producer is reconfigured
+    void clear()
+    {
+        mStats.evictions += mEntries.size();
+        mIndex.clear();
+        mEntries.clear();
+    }
+
+    size_t size() const
+    {
+        return mEntries.size();
+    }
+
+    size_t capacity() const
+    {
+        return mCapacity;
+    }
+
+    const Stats &stats() const
+    {
+        return mStats;
+    }
+
+  private:
+    struct Entry
+    {
+        ExternalBufferDesc       desc;
+        std::shared_ptr<T_Image> image;
+    };
+
+    ExternalImageImporter<T_Buffer, T_Image> *mImporter;
+    size_t                                    mCapacity;
+
+    std::list<Entry>                                                 mEntries;
+    std::unordered_map<uint64_t, typename std::list<Entry>::iterator> mIndex;
+
+    Stats mStats;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_EXTERNALIMAGECACHE_H
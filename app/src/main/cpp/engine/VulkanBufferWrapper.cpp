@@ -86,6 +86,19 @@ namespace vks {
         memcpy(mapped, data, size);
     }
 
+    /**
+	* Copies the content of the mapped buffer to the specified host memory
+	*
+	* @param data Pointer to the destination memory
+	* @param size Size of the data to copy in machine units
+	*
+	*/
+    void Buffer::copyTo(void* data, VkDeviceSize size) const
+    {
+        assert(mapped);
+        memcpy(data, mapped, size);
+    }
+
     /**
 	* Map a memory range of this buffer. If successful, mapped points to the specified buffer range.
 	*
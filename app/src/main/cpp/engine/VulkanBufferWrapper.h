@@ -57,6 +57,11 @@ namespace vks {
             return {mBuffer.handle(), 0, mSize};
         }
 
+        // Host address of the memory, nullptr if the buffer is not mapped
+        void* getMappedData() const {
+            return mapped;
+        }
+
         VkResult flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 
         VkResult map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
@@ -65,6 +70,8 @@ namespace vks {
 
         void copyFrom(const void* data, VkDeviceSize size);
 
+        void copyTo(void* data, VkDeviceSize size) const;
+
         VkResult invalidate(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 
     private:
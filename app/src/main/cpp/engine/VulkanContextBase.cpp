@@ -27,16 +27,27 @@
 #include "VulkanDebug.h"
 #include "VulkanInitializers.hpp"
 #include "includes/cube_data.h"
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <optional>
 #include <vulkan_wrapper.h>
 
-bool VulkanContextBase::create(bool enableDebug, AAssetManager *assetManager)
+bool VulkanContextBase::create(bool enableDebug, std::shared_ptr<vks::AssetLoader> assets, bool headless,
+                               const std::string &cacheDir)
 {
-    mAssetManager = assetManager;
+    mCreateTimestamp = std::chrono::steady_clock::now();
+    mAssets          = std::move(assets);
+    mHeadless        = headless;
+    mCacheDir        = cacheDir;
     getDeviceConfig();
     bool ret = createInstance(enableDebug) && pickPhysicalDeviceAndQueueFamily() && createDevice();
+    if (ret)
+    {
+        mPipelineCacheFile = PipelineCacheFile::create(cacheDir, mDeviceWrapper->properties);
+        mShaderLibrary     = ShaderLibrary::create(device(), mAssets);
+    }
 
     initRAIIObjects();
 
@@ -47,11 +58,17 @@ bool VulkanContextBase::create(bool enableDebug, AAssetManager *assetManager)
 
 void VulkanContextBase::getDeviceConfig()
 {
-    // Screen density
-    AConfiguration *config = AConfiguration_new();
-    AConfiguration_fromAssetManager(config, mAssetManager);
-    mScreenDensity = AConfiguration_getDensity(config);
-    AConfiguration_delete(config);
+    // Screen density, the medium density baseline without an Android configuration (host builds)
+    mScreenDensity = ACONFIGURATION_DENSITY_MEDIUM;
+#if defined(__ANDROID__)
+    if (mAssets && mAssets->assetManager() != nullptr)
+    {
+        AConfiguration *config = AConfiguration_new();
+        AConfiguration_fromAssetManager(config, mAssets->assetManager());
+        mScreenDensity = AConfiguration_getDensity(config);
+        AConfiguration_delete(config);
+    }
+#endif
 }
 
 void VulkanContextBase::initRAIIObjects()
@@ -61,31 +78,27 @@ void VulkanContextBase::initRAIIObjects()
     mDescriptorSetLayout     = VulkanDescriptorSetLayout(device());
     mPipelineLayout          = VulkanPipelineLayout(device());
     mPipeline                = VulkanPipeline(device());
-    presentCompleteSemaphore = VulkanSemaphore(device());
-    renderCompleteSemaphore  = VulkanSemaphore(device());
 }
 
 void VulkanContextBase::initUIOverlay()
 {
     UIOverlay.deviceWrapper = deviceWrapper();
     UIOverlay.screenDensity = mScreenDensity;
-    UIOverlay.assetManager  = mAssetManager;
+    UIOverlay.assets        = mAssets;
     UIOverlay.queue         = mGraphicsQueue;
     UIOverlay.init();
 }
 
 bool VulkanContextBase::createInstance(bool enableDebug)
 {
-#ifdef __ANDROID__
     // This place is the first place for samples to use Vulkan APIs.
-    // Here, we are going to open Vulkan.so on the device and retrieve function pointers using
-    // vulkan_wrapper helper.
+    // Here, we are going to open Vulkan.so on the device (the Vulkan loader on a host) and retrieve
+    // function pointers using vulkan_wrapper helper.
     if (!loadVulkanLibrary())
     {
         LOGCATE("Failied load Vulkan library!");
-        return VK_ERROR_INITIALIZATION_FAILED;
+        return false;
     }
-#endif
 
     // Required instance layers
     std::vector<const char *> instanceLayers;
@@ -96,12 +109,30 @@ bool VulkanContextBase::createInstance(bool enableDebug)
 
     // Required instance extensions
     std::vector<const char *> instanceExtensions = {
-        //            VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME,
-        //            VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
-        VK_KHR_SURFACE_EXTENSION_NAME,
-        VK_KHR_ANDROID_SURFACE_EXTENSION_NAME,
         VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
     };
+    // Needed by the AHardwareBuffer import, enabled only if available so that devices without it
+    // still run the samples that copy the camera images
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> supportedExtensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, supportedExtensions.data());
+    for (const auto &extension : supportedExtensions)
+    {
+        if (strcmp(extension.extensionName, VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME) == 0)
+        {
+            instanceExtensions.push_back(VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME);
+            mExternalMemoryCapabilities = true;
+        }
+    }
+    // Surface extensions are only needed when presenting to a window
+    if (!mHeadless)
+    {
+        instanceExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
+        instanceExtensions.push_back(VK_KHR_ANDROID_SURFACE_EXTENSION_NAME);
+#endif
+    }
     if (enableDebug)
     {
         instanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -132,10 +163,8 @@ bool VulkanContextBase::createInstance(bool enableDebug)
         vks::debug::setupDebugging(mInstance.handle());
     }
 
-#ifdef __ANDROID__
     loadVulkanFunctions(mInstance.handle());
     LOGCATI("Loaded Vulkan APIs.");
-#endif
 
     return true;
 }
@@ -175,18 +204,30 @@ bool VulkanContextBase::pickPhysicalDeviceAndQueueFamily(VkQueueFlags requestedQ
 bool VulkanContextBase::createDevice(VkQueueFlags requestedQueueTypes)
 {
     // Required device extensions
-    // These extensions are required to import an AHardwareBuffer to Vulkan.
     std::vector<const char *> deviceExtensions = {
-        /*
-	    VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME,
-	    VK_EXT_QUEUE_FAMILY_FOREIGN_EXTENSION_NAME,
-	    VK_ANDROID_EXTERNAL_MEMORY_ANDROID_HARDWARE_BUFFER_EXTENSION_NAME,*/
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
         VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME,
         VK_KHR_SAMPLER_YCBCR_CONVERSION_EXTENSION_NAME,
         VK_KHR_MAINTENANCE1_EXTENSION_NAME,
         VK_KHR_BIND_MEMORY_2_EXTENSION_NAME,
     };
+    if (!mHeadless)
+    {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
+    // These extensions are required to import an AHardwareBuffer to Vulkan. They are optional, the
+    // samples fall back to copying the camera images if they are missing. The external memory
+    // capabilities they depend on are enabled by createInstance.
+    if (mExternalMemoryCapabilities &&
+        mDeviceWrapper->extensionSupported(VK_ANDROID_EXTERNAL_MEMORY_ANDROID_HARDWARE_BUFFER_EXTENSION_NAME) &&
+        mDeviceWrapper->extensionSupported(VK_EXT_QUEUE_FAMILY_FOREIGN_EXTENSION_NAME))
+    {
+        deviceExtensions.push_back(VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_EXT_QUEUE_FAMILY_FOREIGN_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_ANDROID_EXTERNAL_MEMORY_ANDROID_HARDWARE_BUFFER_EXTENSION_NAME);
+    }
+#endif
 
     VkPhysicalDeviceFeatures enabledFeatures{};
 
@@ -204,10 +245,38 @@ bool VulkanContextBase::createDevice(VkQueueFlags requestedQueueTypes)
 
 void VulkanContextBase::createPipelineCache()
 {
+    // Start from the pipelines compiled by earlier launches, if any
+    std::vector<uint8_t> initialData;
+    if (mPipelineCacheFile)
+    {
+        initialData = mPipelineCacheFile->load();
+    }
+
     VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
     pipelineCacheCreateInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-    CALL_VK(vkCreatePipelineCache(
-        device(), &pipelineCacheCreateInfo, nullptr, mPipelineCache.pHandle()));
+    pipelineCacheCreateInfo.initialDataSize           = initialData.size();
+    pipelineCacheCreateInfo.pInitialData              = initialData.data();
+    VkResult result = vkCreatePipelineCache(device(), &pipelineCacheCreateInfo, nullptr, mPipelineCache.pHandle());
+    if (result != VK_SUCCESS && !initialData.empty())
+    {
+        LOGCATE("Failed to create the pipeline cache from %zu bytes, starting empty", initialData.size());
+        initialData.clear();
+        pipelineCacheCreateInfo.initialDataSize = 0;
+        pipelineCacheCreateInfo.pInitialData    = nullptr;
+        result = vkCreatePipelineCache(device(), &pipelineCacheCreateInfo, nullptr, mPipelineCache.pHandle());
+    }
+    CALL_VK(result);
+    mPipelineCacheLoadedSize = initialData.size();
+
+    mPipelineBuilder = PipelineBuilder::create(device(), mPipelineCache.handle());
+}
+
+void VulkanContextBase::savePipelineCache()
+{
+    if (mPipelineCacheFile && mPipelineCache.handle() != VK_NULL_HANDLE)
+    {
+        mPipelineCacheFile->save(device(), mPipelineCache.handle());
+    }
 }
 
 bool VulkanContextBase::createSemaphore(VkSemaphore *semaphore) const
@@ -240,6 +309,116 @@ void VulkanContextBase::setNativeWindow(ANativeWindow *window, uint32_t width, u
         45.0f, (float) mWindow.windowWidth / (float) mWindow.windowHeight, 0.1f, 256.0f);
 }
 
+void VulkanContextBase::setHeadlessTarget(uint32_t width, uint32_t height)
+{
+    assert(mHeadless);
+    setNativeWindow(nullptr, width, height);
+}
+
+bool VulkanContextBase::readbackFrame(void *dst, size_t size)
+{
+    const VkDeviceSize imageSize = static_cast<VkDeviceSize>(mWindow.windowWidth) * mWindow.windowHeight * 4;
+    if (!mHeadless || mLastRenderedImage == UINT32_MAX || dst == nullptr || size < imageSize)
+    {
+        return false;
+    }
+
+    // Make sure the frame has been rendered completely
+    CALL_VK(vkQueueWaitIdle(mGraphicsQueue));
+
+    auto stagingBuffer = vks::Buffer::create(
+        mDeviceWrapper,
+        static_cast<uint32_t>(imageSize),
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    // The render pass leaves the offscreen image in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+    VulkanCommandBuffer copyCmd(device(), commandPool());
+    mDeviceWrapper->beginSingleTimeCommand(copyCmd.pHandle());
+
+    VkBufferImageCopy copyRegion               = {};
+    copyRegion.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    copyRegion.imageSubresource.mipLevel       = 0;
+    copyRegion.imageSubresource.baseArrayLayer = 0;
+    copyRegion.imageSubresource.layerCount     = 1;
+    copyRegion.imageExtent                     = {static_cast<uint32_t>(mWindow.windowWidth),
+                              static_cast<uint32_t>(mWindow.windowHeight),
+                              1};
+    vkCmdCopyImageToBuffer(copyCmd.handle(),
+                           mSwapChain.images[mLastRenderedImage],
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           stagingBuffer->getBufferHandle(),
+                           1,
+                           &copyRegion);
+
+    mDeviceWrapper->endAndSubmitSingleTimeCommand(copyCmd.handle(), mGraphicsQueue, false);
+
+    CALL_VK(stagingBuffer->map());
+    stagingBuffer->copyTo(dst, imageSize);
+    stagingBuffer->unmap();
+    return true;
+}
+
+void VulkanContextBase::setFramesInFlight(uint32_t count)
+{
+    settings.framesInFlight = count;
+    // Before prepare() the setting is picked up by createSynchronizationPrimitives
+    if (mFrames.empty())
+        return;
+
+    // The fences and semaphores of the frames in flight are recreated, none of them may be pending
+    CALL_VK(vkDeviceWaitIdle(device()));
+    createSynchronizationPrimitives();
+}
+
+std::vector<VulkanContextBase::FramePacing> VulkanContextBase::compareFramesInFlight(uint32_t frameCount)
+{
+    std::vector<FramePacing> results;
+    if (mFrames.empty())
+    {
+        LOGCATE("compareFramesInFlight: The sample is not prepared yet");
+        return results;
+    }
+
+    const uint32_t framesInFlight = settings.framesInFlight;
+    for (uint32_t count = 1; count <= 3; count++)
+    {
+        setFramesInFlight(count);
+        // Fill the pipeline first, the first frames of each count wait for nothing
+        for (uint32_t i = 0; i < count + 1; i++)
+        {
+            draw();
+        }
+
+        double     cpuMs = 0.0;
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            const auto drawStart = std::chrono::high_resolution_clock::now();
+            draw();
+            cpuMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - drawStart)
+                         .count();
+        }
+        CALL_VK(vkDeviceWaitIdle(device()));
+        const double wallMs =
+            std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        results.push_back({static_cast<uint32_t>(mFrames.size()), wallMs / frameCount, cpuMs / frameCount});
+    }
+    setFramesInFlight(framesInFlight);
+
+    LOGCATI("Frames in flight over %u frames:", frameCount);
+    for (const FramePacing &result : results)
+    {
+        LOGCATI("  %u: %.2f ms/frame (%.1f fps), %.2f ms cpu in draw()",
+                result.framesInFlight,
+                result.frameMs,
+                1000.0 / result.frameMs,
+                result.cpuMs);
+    }
+    return results;
+}
+
 void VulkanContextBase::prepareVertices(bool useStagingBuffers, const void *data, size_t bufSize)
 {
     // A note on memory management in Vulkan in general:
@@ -257,22 +436,17 @@ void VulkanContextBase::prepareVertices(bool useStagingBuffers, const void *data
         // for optimal (and fastest) access by the GPU
         //
         // To achieve this we use so-called "staging buffers" :
-        // - Create a buffer that's visible to the host (and can be mapped)
-        // - Copy the data to this buffer
+        // - Copy the data to a buffer that's visible to the host (the shared staging ring)
         // - Create another buffer that's local on the device (VRAM) with the same size
         // - Copy the data from the host to the device using a command buffer
-        // - Delete the host visible (staging) buffer
         // - Use the device local buffers for rendering
 
-        auto stagingBuffers = vks::Buffer::create(
-            mDeviceWrapper,
-            vertexBufferSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        stagingBuffers->map();
-        stagingBuffers->copyFrom(data, vertexBufferSize);
-
-        vks::debug::setDeviceMemoryName(mDeviceWrapper->logicalDevice, stagingBuffers->getMemoryHandle(), "VulkanContextBase-prepareVertices-stagingBuffers");
+        vks::StagingRing::Allocation staging;
+        if (!mDeviceWrapper->getStagingRing()->upload(data, vertexBufferSize, &staging))
+        {
+            LOGCATE("VulkanContextBase::prepareVertices: Failed to allocate %u staging bytes", vertexBufferSize);
+            return;
+        }
 
         mVerticesBuffer =
                 vks::Buffer::create(mDeviceWrapper,
@@ -282,26 +456,12 @@ void VulkanContextBase::prepareVertices(bool useStagingBuffers, const void *data
 
         vks::debug::setDeviceMemoryName(mDeviceWrapper->logicalDevice, mVerticesBuffer->getMemoryHandle(), "VulkanContextBase-prepareVertices-mVerticesBuffer");
 
-        // Buffer copies have to be submitted to a queue, so we need a command buffer for them
-        // Note: Some devices offer a dedicated transfer queue (with only the transfer bit set) that
-        // may be faster when doing lots of copies
-        VulkanCommandBuffer copyCmd(device(), commandPool());
-        assert(mDeviceWrapper->beginSingleTimeCommand(copyCmd.pHandle()));
-
-        // Put buffer region copies into command buffer
+        // Buffer copies have to be submitted to a queue, the upload manager batches them and uses
+        // the dedicated transfer queue (with only the transfer bit set) if the device has one
         VkBufferCopy copyRegion = {};
-
-        // Vertex buffer
-        copyRegion.size = vertexBufferSize;
-        vkCmdCopyBuffer(copyCmd.handle(),
-                        stagingBuffers->getBufferHandle(),
-                        mVerticesBuffer->getBufferHandle(),
-                        1,
-                        &copyRegion);
-
-        // Flushing the command buffer will also submit it to the queue and uses a fence to ensure
-        // that all commands have been executed before returning
-        mDeviceWrapper->endAndSubmitSingleTimeCommand(copyCmd.handle(), mGraphicsQueue, false);
+        copyRegion.srcOffset    = staging.offset;
+        copyRegion.size         = vertexBufferSize;
+        mDeviceWrapper->getUploadManager()->copyBuffer(staging.buffer, mVerticesBuffer->getBufferHandle(), 1, &copyRegion);
     }
     else
     {
@@ -332,7 +492,7 @@ void VulkanContextBase::setupRenderPass()
     attachments[0].stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachments[0].initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[0].finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    attachments[0].finalLayout    = mSwapChain.presentLayout();
     // Depth attachment
     attachments[1].format         = depthFormat;
     attachments[1].samples        = VK_SAMPLE_COUNT_1_BIT;
@@ -407,25 +567,9 @@ void VulkanContextBase::setupRenderPass()
 VkPipelineShaderStageCreateInfo VulkanContextBase::loadShader(const char *          shaderFilePath,
                                                               VkShaderStageFlagBits stage)
 {
-    // Read shader file from asset.
-    AAsset *shaderFile = AAssetManager_open(mAssetManager, shaderFilePath, AASSET_MODE_BUFFER);
-    assert(shaderFile != nullptr);
-    const size_t      shaderSize = AAsset_getLength(shaderFile);
-    std::vector<char> shader(shaderSize);
-    int               status = AAsset_read(shaderFile, shader.data(), shaderSize);
-    AAsset_close(shaderFile);
-    assert(status >= 0);
-
-    // Create shader module.
-    const VkShaderModuleCreateInfo shaderDesc = {
-        .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-        .flags    = 0,
-        .codeSize = shaderSize,
-        .pCode    = reinterpret_cast<const uint32_t *>(shader.data()),
-    };
-    VkShaderModule shaderModule;
-    CALL_VK(
-        vkCreateShaderModule(mDeviceWrapper->logicalDevice, &shaderDesc, nullptr, &shaderModule));
+    // Read and created once per context, later loads of the same shader reuse the module
+    VkShaderModule shaderModule = mShaderLibrary->module(shaderFilePath);
+    assert(shaderModule != VK_NULL_HANDLE);
 
     VkPipelineShaderStageCreateInfo shaderStage = {};
     shaderStage.sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -449,6 +593,12 @@ void VulkanContextBase::buildCommandBuffers()
 
 void VulkanContextBase::initSwapchain()
 {
+    if (mHeadless)
+    {
+        mSwapChain.initHeadless(mGraphicsQueue, mDeviceWrapper->queueFamilyIndices.graphics);
+        return;
+    }
+
 #if defined(_WIN32)
     swapChain.initSurface(windowInstance, window);
 #elif defined(VK_USE_PLATFORM_ANDROID_KHR)
@@ -490,18 +640,34 @@ void VulkanContextBase::createCommandBuffers()
 
 void VulkanContextBase::createSynchronizationPrimitives()
 {
-    // Wait fences to sync command buffer access
+    // Frames in flight are decoupled from the swap chain image count, but there is no point in
+    // having more of them than images the presentation engine can hand out
+    uint32_t framesInFlight = std::max(1u, std::min(settings.framesInFlight, mSwapChain.imageCount));
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    // Wait fences to sync the reuse of a frame slot, created signaled so the first wait returns
     VkFenceCreateInfo fenceCreateInfo{};
     fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    for (int i = 0; i < drawCmdBuffers.size(); ++i)
-    {
-        waitFences.emplace_back(VulkanFence(device()));
-    }
-    for (auto &fence : waitFences)
+
+    mFrames.clear();
+    for (uint32_t i = 0; i < framesInFlight; ++i)
     {
-        CALL_VK(vkCreateFence(device(), &fenceCreateInfo, nullptr, fence.pHandle()));
+        FrameSync frame = {VulkanSemaphore(device()), VulkanSemaphore(device()), VulkanFence(device())};
+        CALL_VK(vkCreateSemaphore(
+            device(), &semaphoreCreateInfo, nullptr, frame.presentCompleteSemaphore.pHandle()));
+        CALL_VK(vkCreateSemaphore(
+            device(), &semaphoreCreateInfo, nullptr, frame.renderCompleteSemaphore.pHandle()));
+        CALL_VK(vkCreateFence(device(), &fenceCreateInfo, nullptr, frame.inFlightFence.pHandle()));
+        mFrames.push_back(std::move(frame));
     }
+
+    mImagesInFlight.assign(mSwapChain.imageCount, VK_NULL_HANDLE);
+    currentFrame = 0;
+
+    LOGCATI("Frames in flight: %u (swap chain images: %u)", framesInFlight, mSwapChain.imageCount);
 }
 
 void VulkanContextBase::setupDepthStencil()
@@ -606,25 +772,19 @@ void VulkanContextBase::prepare(JNIEnv *env)
         };
         UIOverlay.prepareResources();
         UIOverlay.preparePipeline(mPipelineCache.handle(), mRenderPass);
-
-        // Shader modules are no longer needed once the graphics pipeline has been created
-        vkDestroyShaderModule(device(), UIOverlay.shaders[0].module, nullptr);
-        vkDestroyShaderModule(device(), UIOverlay.shaders[1].module, nullptr);
     }
 }
 
-// 1. Acquire Image，设置完成信号presentCompleteSemaphore
+// 1. Wait for the frame slot，Acquire Image，设置完成信号presentCompleteSemaphore
 // 2. Queue Submit，等待完成信号presentCompleteSemaphore，并设置完成信号renderCompleteSemaphore
-// 3. Present，等待完成信号renderCompleteSemaphore
+// 3. Present，等待完成信号renderCompleteSemaphore，切换到下一个frame slot
 void VulkanContextBase::draw()
 {
     auto tStart = std::chrono::high_resolution_clock::now();
 
     prepareFrame();
 
-    // Use a fence to wait until the command buffer has finished execution before using it again
-    CALL_VK(vkWaitForFences(device(), 1, waitFences[currentBuffer].pHandle(), VK_TRUE, UINT64_MAX));
-    CALL_VK(vkResetFences(device(), 1, waitFences[currentBuffer].pHandle()));
+    FrameSync &frame = currentFrameSync();
 
     // Pipeline stage at which the queue submission will wait (via pWaitSemaphores)
     VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
@@ -634,11 +794,11 @@ void VulkanContextBase::draw()
     submitInfo.pWaitDstStageMask = &waitStageMask;        // Pointer to the list of pipeline stages that
                                                           // the semaphore waits will occur at
     submitInfo.pWaitSemaphores =
-        presentCompleteSemaphore.pHandle();        // Semaphore(s) to wait upon before the submitted
-                                                   // command buffer starts executing
-    submitInfo.waitSemaphoreCount = 1;             // One wait semaphore
+        frame.presentCompleteSemaphore.pHandle();        // Semaphore(s) to wait upon before the submitted
+                                                         // command buffer starts executing
+    submitInfo.waitSemaphoreCount = 1;                   // One wait semaphore
     submitInfo.pSignalSemaphores =
-        renderCompleteSemaphore
+        frame.renderCompleteSemaphore
             .pHandle();                         // Semaphore(s) to be signaled when command buffers have completed
     submitInfo.signalSemaphoreCount = 1;        // One signal semaphore
     submitInfo.pCommandBuffers =
@@ -646,8 +806,8 @@ void VulkanContextBase::draw()
             .pHandle();                       // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;        // One command buffer
 
-    // Submit to the graphics queue passing a wait fence
-    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, waitFences[currentBuffer].handle()));
+    // Submit to the graphics queue passing the fence of this frame slot
+    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, frame.inFlightFence.handle()));
 
     submitFrame();
 
@@ -655,14 +815,33 @@ void VulkanContextBase::draw()
     auto tEnd  = std::chrono::high_resolution_clock::now();
     auto tDiff = std::chrono::duration<double, std::milli>(tEnd - tStart).count();
     frameTimer = tDiff / 1000.0f;
+    frameTimeAccumulator += tDiff;
 
     float fpsTimer = std::chrono::duration<double, std::milli>(tEnd - lastTimestamp).count();
 
     if (fpsTimer > 1000.0f)
     {
-        lastFPS       = (float) frameCounter * (1000.0f / fpsTimer);
-        frameCounter  = 0;
-        lastTimestamp = tEnd;
+        lastFPS = (float) frameCounter * (1000.0f / fpsTimer);
+        // CPU time spent in draw() per frame, see compareFramesInFlight for how much of the GPU
+        // work is overlapped
+        LOGCATI("Frame time: %.2f ms cpu, %u fps (%zu frames in flight)",
+                frameTimeAccumulator / frameCounter,
+                lastFPS,
+                mFrames.size());
+        if (mDeviceWrapper->stagingRing)
+        {
+            // Texture streaming through the shared staging ring, the stalls should stay at 0 once
+            // the ring is large enough for the uploads of the frames in flight
+            const auto &stagingStats = mDeviceWrapper->stagingRing->stats();
+            LOGCATI("Staging ring: %.2f MB streamed in %llu uploads, %u stalls, %u grows",
+                    stagingStats.bytesStreamed / (1024.0 * 1024.0),
+                    static_cast<unsigned long long>(stagingStats.allocations),
+                    stagingStats.stalls,
+                    stagingStats.grows);
+        }
+        frameCounter         = 0;
+        frameTimeAccumulator = 0.0;
+        lastTimestamp        = tEnd;
     }
 
     if (settings.overlay)
@@ -713,6 +892,8 @@ void VulkanContextBase::updateOverlay()
 
     if (UIOverlay.update() || UIOverlay.updated)
     {
+        // The command buffers are re-recorded in place, none of them may still be pending
+        waitForFramesInFlight();
         buildCommandBuffers();
         UIOverlay.updated = false;
     }
@@ -724,6 +905,32 @@ void VulkanContextBase::updateOverlay()
 #endif
 }
 
+void VulkanContextBase::waitForFramesInFlight()
+{
+    std::vector<VkFence> fences;
+    fences.reserve(mFrames.size());
+    for (auto &frame : mFrames)
+    {
+        fences.push_back(frame.inFlightFence.handle());
+    }
+    if (!fences.empty())
+    {
+        CALL_VK(vkWaitForFences(device(), static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX));
+    }
+}
+
+void VulkanContextBase::updateUniformBuffer(vks::Buffer &buffer, const void *data, VkDeviceSize size)
+{
+    // Most calls come with every camera frame and write the same matrices again, these must not
+    // serialize the frames in flight
+    if (buffer.getMappedData() != nullptr && memcmp(buffer.getMappedData(), data, size) == 0)
+    {
+        return;
+    }
+    waitForFramesInFlight();
+    buffer.copyFrom(data, size);
+}
+
 void VulkanContextBase::drawUI(const VkCommandBuffer commandBuffer)
 {
     if (settings.overlay)
@@ -741,7 +948,31 @@ void VulkanContextBase::drawUI(const VkCommandBuffer commandBuffer)
 
 void VulkanContextBase::prepareFrame()
 {
-    CALL_VK(mSwapChain.acquireNextImage(presentCompleteSemaphore.handle(), &currentBuffer));
+    // Submit the uploads recorded since the last frame (camera images, textures, model data). They
+    // are ahead of this frame on the graphics queue, so the frame does not need to wait for them
+    if (mDeviceWrapper->uploadManager)
+    {
+        mDeviceWrapper->uploadManager->flush();
+    }
+
+    FrameSync &frame = currentFrameSync();
+
+    // Wait until the GPU has finished the frame that used this slot last time, only then its
+    // semaphores can be signaled again
+    CALL_VK(vkWaitForFences(device(), 1, frame.inFlightFence.pHandle(), VK_TRUE, UINT64_MAX));
+
+    CALL_VK(mSwapChain.acquireNextImage(frame.presentCompleteSemaphore.handle(), &currentBuffer));
+
+    // The acquired image may still be rendered by an older frame in flight, its command buffer
+    // can't be resubmitted before that frame has finished
+    if (mImagesInFlight[currentBuffer] != VK_NULL_HANDLE &&
+        mImagesInFlight[currentBuffer] != frame.inFlightFence.handle())
+    {
+        CALL_VK(vkWaitForFences(device(), 1, &mImagesInFlight[currentBuffer], VK_TRUE, UINT64_MAX));
+    }
+    mImagesInFlight[currentBuffer] = frame.inFlightFence.handle();
+
+    CALL_VK(vkResetFences(device(), 1, frame.inFlightFence.pHandle()));
 }
 
 void VulkanContextBase::submitFrame()
@@ -750,12 +981,29 @@ void VulkanContextBase::submitFrame()
     // Pass the semaphore signaled by the command buffer submission from the submit info as the wait
     // semaphore for swap chain presentation This ensures that the image is not presented to the
     // windowing system until all commands have been submitted
-    VkResult present =
-        mSwapChain.queuePresent(mGraphicsQueue, currentBuffer, renderCompleteSemaphore.handle());
+    VkResult present = mSwapChain.queuePresent(
+        mGraphicsQueue, currentBuffer, currentFrameSync().renderCompleteSemaphore.handle());
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR)))
     {
         CALL_VK(present);
     }
+    mLastRenderedImage = currentBuffer;
+
+    currentFrame = (currentFrame + 1) % mFrames.size();
+
+    // The pipelines of a sample are created before its first frame, more may follow (e.g. LUTs
+    // selected later), so the cache is saved after the first frame and then every few seconds
+    if (mSubmittedFrames == 0)
+    {
+        const auto startup = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mCreateTimestamp);
+        LOGCATI("Startup: first frame after %.1f ms, %s pipeline cache (%zu bytes)", startup.count(),
+                mPipelineCacheLoadedSize > 0 ? "warm" : "cold", mPipelineCacheLoadedSize);
+    }
+    if (mSubmittedFrames % PIPELINE_CACHE_SAVE_INTERVAL == 0)
+    {
+        savePipelineCache();
+    }
+    mSubmittedFrames++;
 }
 
 void VulkanContextBase::onTouchActionMove(float deltaX, float deltaY)
@@ -771,6 +1019,8 @@ VulkanContextBase::~VulkanContextBase()
 {
     vkDeviceWaitIdle(device());
 
+    savePipelineCache();
+
     mSwapChain.cleanup();
 
     vks::debug::freeDebugCallback(mInstance.handle());
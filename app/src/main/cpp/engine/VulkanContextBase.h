@@ -26,12 +26,13 @@
 #define GAINVULKANSAMPLE_VULKANCONTEXTBASE_H
 
 #include "VulkanDeviceWrapper.hpp"
+#include "VulkanPipelineBuilder.h"
+#include "VulkanPipelineCacheFile.h"
+#include "VulkanShaderLibrary.h"
 #include "VulkanSwapChain.h"
+#include "util/AssetUtil.h"
+#include "util/PlatformUtil.h"
 #include "util/VulkanRAIIUtil.h"
-#include <android/asset_manager_jni.h>
-#include <android/bitmap.h>
-#include <android/configuration.h>
-#include <android/hardware_buffer_jni.h>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -55,22 +56,31 @@ struct YUVSinglePassImage
 class VulkanContextBase
 {
   private:
+    // About 10s at 60fps
+    static constexpr uint64_t PIPELINE_CACHE_SAVE_INTERVAL = 600;
+
     void getDeviceConfig();
     void createPipelineCache();
     void createSynchronizationPrimitives();
     void initSwapchain();
     void setupSwapChain();
     void createCommandBuffers();
+    // Write the pipeline cache to disk if pipelines were added since the last save
+    void savePipelineCache();
 
   public:
-    bool create(bool enableDebug, AAssetManager *assetManager);
+    // The shaders, fonts and models are read from assets. headless renders into offscreen images
+    // instead of a window, see setHeadlessTarget.
+    // The pipeline cache is kept in cacheDir between launches, it is not persisted if empty.
+    bool create(bool enableDebug, std::shared_ptr<vks::AssetLoader> assets, bool headless = false,
+                const std::string &cacheDir = "");
     // Prefer VulkanContextBase::create
     VulkanContextBase() :
-        mDescriptorPool(VK_NULL_HANDLE), mPipelineCache(VK_NULL_HANDLE), mDescriptorSetLayout(VK_NULL_HANDLE), mPipelineLayout(VK_NULL_HANDLE), mPipeline(VK_NULL_HANDLE), presentCompleteSemaphore(VK_NULL_HANDLE), renderCompleteSemaphore(VK_NULL_HANDLE)
+        mDescriptorPool(VK_NULL_HANDLE), mPipelineCache(VK_NULL_HANDLE), mDescriptorSetLayout(VK_NULL_HANDLE), mPipelineLayout(VK_NULL_HANDLE), mPipeline(VK_NULL_HANDLE)
     {}
 
     VulkanContextBase(const char *vertPath, const char *fragPath) :
-        mDescriptorPool(VK_NULL_HANDLE), mPipelineCache(VK_NULL_HANDLE), mDescriptorSetLayout(VK_NULL_HANDLE), mPipelineLayout(VK_NULL_HANDLE), mPipeline(VK_NULL_HANDLE), presentCompleteSemaphore(VK_NULL_HANDLE), renderCompleteSemaphore(VK_NULL_HANDLE), vertFilePath(vertPath), fragFilePath(fragPath)
+        mDescriptorPool(VK_NULL_HANDLE), mPipelineCache(VK_NULL_HANDLE), mDescriptorSetLayout(VK_NULL_HANDLE), mPipelineLayout(VK_NULL_HANDLE), mPipeline(VK_NULL_HANDLE), vertFilePath(vertPath), fragFilePath(fragPath)
     {}
 
     virtual ~VulkanContextBase();
@@ -79,9 +89,11 @@ class VulkanContextBase
     {
         /** @brief Enable UI overlay */
         bool overlay = true;
+        /** @brief Number of frames the CPU may record ahead of the GPU (1 = fully serialized) */
+        uint32_t framesInFlight = 2;
     } settings;
 
-    AAssetManager *mAssetManager;
+    std::shared_ptr<vks::AssetLoader> mAssets;
 
     uint32_t mScreenDensity;
 
@@ -106,6 +118,11 @@ class VulkanContextBase
     {
         return mDescriptorPool.handle();
     }
+    // Compiles pipelines on worker threads with mPipelineCache, available after prepare
+    vks::PipelineBuilder *pipelineBuilder() const
+    {
+        return mPipelineBuilder.get();
+    }
 
     // Create a semaphore with the managed device.
     bool createSemaphore(VkSemaphore *semaphore) const;
@@ -114,6 +131,42 @@ class VulkanContextBase
 
     void setNativeWindow(ANativeWindow *window, uint32_t width, uint32_t height);
 
+    // Headless counterpart of setNativeWindow, sets the size of the offscreen render target
+    void setHeadlessTarget(uint32_t width, uint32_t height);
+
+    bool isHeadless() const
+    {
+        return mHeadless;
+    }
+
+    // Copy the most recently rendered frame (R8G8B8A8, tightly packed) to host memory.
+    // Only available in headless mode, dst must hold width * height * 4 bytes
+    bool readbackFrame(void *dst, size_t size);
+
+    // Change settings.framesInFlight while rendering, waits for the device to be idle and recreates
+    // the synchronization primitives of the frames in flight
+    void setFramesInFlight(uint32_t count);
+
+    // Frame times measured by compareFramesInFlight
+    struct FramePacing
+    {
+        // Frames in flight in use, settings.framesInFlight clamped to the swap chain image count
+        uint32_t framesInFlight;
+        // Wall time per frame, from the first draw() until the GPU finished the last frame
+        double frameMs;
+        // CPU time spent in draw() per frame
+        double cpuMs;
+    };
+
+    // Draw frameCount frames with 1, 2 and then 3 frames in flight and log the frame times side by
+    // side. Must be called on the render thread after prepare(), settings.framesInFlight is restored.
+    std::vector<FramePacing> compareFramesInFlight(uint32_t frameCount);
+
+    // Benchmarks of the sample, logged. Run on demand through Sample::runBenchmarks (NativeVulkan
+    // runBenchmarks, GainVulkanBench on the host), after prepare() and with the device idle.
+    virtual void runBenchmarks()
+    {}
+
     void setupRenderPass();
 
     void prepareVertices(bool useStagingBuffers, const void *data, size_t bufSize);
@@ -138,10 +191,25 @@ class VulkanContextBase
 
     virtual void unInit(JNIEnv *env);
 
+    // The module is shared through mShaderLibrary and owned by the context, don't destroy it
     VkPipelineShaderStageCreateInfo loadShader(const char *          shaderFilePath,
                                                VkShaderStageFlagBits stage);
 
   protected:
+    // Per-frame synchronization primitives
+    // Each frame in flight owns its own pair of semaphores and a fence, so the CPU can record and
+    // submit frame N+1 while the GPU is still executing frame N without reusing a semaphore that
+    // is still pending
+    struct FrameSync
+    {
+        // Signaled by the presentation engine once the acquired image is ready to be rendered to
+        VulkanSemaphore presentCompleteSemaphore;
+        // Signaled by the queue submission once all commands of the frame have completed
+        VulkanSemaphore renderCompleteSemaphore;
+        // Signaled once the GPU has finished the frame, guards the reuse of this slot
+        VulkanFence inFlightFence;
+    };
+
     // Initialization
     bool createInstance(bool enableDebug);
     bool pickPhysicalDeviceAndQueueFamily(VkQueueFlags requestedQueueTypes = VK_QUEUE_GRAPHICS_BIT |
@@ -158,8 +226,20 @@ class VulkanContextBase
     /** Prepare the next frame for workload submission by acquiring the next swap
 	 * chain image */
     void prepareFrame();
-    /** @brief Presents the current image to the swap chain */
+    /** @brief Presents the current image to the swap chain and advances to the next frame in flight */
     void submitFrame();
+    /** @brief Synchronization primitives of the frame currently being recorded */
+    FrameSync &currentFrameSync()
+    {
+        return mFrames[currentFrame];
+    }
+
+    // Wait until the GPU has finished every frame in flight, before the recorded command buffers or
+    // the resources they read are changed
+    void waitForFramesInFlight();
+    // Write a host-visible uniform buffer read by the recorded command buffers, unchanged contents
+    // are skipped, otherwise the frames in flight still reading it are waited for first
+    void updateUniformBuffer(vks::Buffer &buffer, const void *data, VkDeviceSize size);
 
     void updateOverlay();
 
@@ -168,6 +248,8 @@ class VulkanContextBase
     // Instance
     uint32_t       mInstanceVersion = 0;
     VulkanInstance mInstance;
+    // VK_KHR_external_memory_capabilities is enabled on the instance
+    bool mExternalMemoryCapabilities = false;
 
     // Device and queue
     std::shared_ptr<vks::VulkanDeviceWrapper> mDeviceWrapper;
@@ -193,7 +275,18 @@ class VulkanContextBase
 
     Camera mCamera;
 
+    // Files kept between launches (pipeline cache, parsed LUTs), empty if nothing is kept
+    std::string mCacheDir;
+
     VulkanPipelineCache mPipelineCache;
+    // On-disk copy of mPipelineCache, null if the cache is not persisted
+    std::unique_ptr<vks::PipelineCacheFile> mPipelineCacheFile;
+    // Size of the data mPipelineCache was created with, 0 on a cold start
+    size_t mPipelineCacheLoadedSize = 0;
+
+    std::unique_ptr<vks::ShaderLibrary> mShaderLibrary;
+
+    std::unique_ptr<vks::PipelineBuilder> mPipelineBuilder;
 
     struct
     {
@@ -204,6 +297,10 @@ class VulkanContextBase
 
     VulkanSwapChain mSwapChain;
 
+    bool mHeadless = false;
+    // Swap chain image the last submitted frame was rendered into
+    uint32_t mLastRenderedImage = UINT32_MAX;
+
     struct
     {
         VkImage        image;
@@ -228,16 +325,16 @@ class VulkanContextBase
     // Synchronization is an important concept of Vulkan that OpenGL mostly hid
     // away. Getting this right is crucial to using Vulkan.
 
-    // Semaphores
-    // Used to coordinate operations within the graphics queue and ensure correct
-    // command ordering
-    VulkanSemaphore presentCompleteSemaphore;
-    VulkanSemaphore renderCompleteSemaphore;
+    // One FrameSync per frame in flight
+    std::vector<FrameSync> mFrames;
 
-    // Fences
-    // Used to check the completion of queue operations (e.g. command buffer
-    // execution)
-    std::vector<VulkanFence> waitFences;
+    // Fence of the frame that last rendered into each swap chain image. The command buffers are
+    // recorded per swap chain image, so an image (and its command buffer) must not be reused until
+    // that frame has finished
+    std::vector<VkFence> mImagesInFlight;
+
+    // Active frame in flight index
+    uint32_t currentFrame = 0;
 
     // Active frame buffer index
     uint32_t currentBuffer = 0;
@@ -261,6 +358,13 @@ class VulkanContextBase
     uint32_t                                                    lastFPS      = 0;
     std::chrono::time_point<std::chrono::high_resolution_clock> lastTimestamp;
 
+    // Startup time is measured from create() to the first presented frame
+    std::chrono::time_point<std::chrono::steady_clock> mCreateTimestamp;
+    uint64_t                                           mSubmittedFrames = 0;
+    // Accumulated CPU frame time since the last fps update, used to log the average frame time
+    // for the current frames in flight setting
+    double frameTimeAccumulator = 0.0;
+
     bool mPrepared = false;
 };
 
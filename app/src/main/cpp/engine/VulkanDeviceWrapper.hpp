@@ -26,11 +26,15 @@
 #pragma once
 
 #include "VulkanDebug.h"
+#include "VulkanStagingRing.h"
+#include "VulkanUploadManager.h"
 #include <LogUtil.h>
 #include <algorithm>
 #include <assert.h>
 #include <cstring>
 #include <exception>
+#include <memory>
+#include <string>
 #include <vector>
 #include <vulkan_wrapper.h>
 
@@ -44,14 +48,24 @@ struct VulkanDeviceWrapper
     VkPhysicalDeviceFeatures             features;
     VkPhysicalDeviceFeatures             enabledFeatures;
     VkPhysicalDeviceMemoryProperties     memoryProperties;
+    // Zeroed on Vulkan 1.0 devices, which have no subgroup operations
+    VkPhysicalDeviceSubgroupProperties   subgroupProperties = {};
     std::vector<VkQueueFamilyProperties> queueFamilyProperties;
+    std::vector<std::string>             supportedExtensions;
+    std::vector<std::string>             enabledExtensions;
     VkCommandPool                        commandPool   = VK_NULL_HANDLE;
     uint32_t                             workGroupSize = 0;
+    // Initial size of the shared staging ring, it grows if a single upload does not fit
+    VkDeviceSize                         stagingRingSize = 16 * 1024 * 1024;
+    std::unique_ptr<StagingRing>         stagingRing;
+    std::unique_ptr<UploadManager>       uploadManager;
 
     struct
     {
         uint32_t graphics;
         uint32_t compute;
+        // Same as graphics if the device has no dedicated transfer queue family
+        uint32_t transfer;
     } queueFamilyIndices;
 
     operator VkDevice()
@@ -76,12 +90,33 @@ struct VulkanDeviceWrapper
         vkGetPhysicalDeviceFeatures(physicalDevice, &features);
         // Memory properties are used regularly for creating all kinds of buffers
         vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+        if (vkGetPhysicalDeviceProperties2 != nullptr && VK_VERSION_MINOR(properties.apiVersion) >= 1)
+        {
+            subgroupProperties.sType            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+            VkPhysicalDeviceProperties2 properties2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, &subgroupProperties};
+            vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+        }
         // Queue family properties, used for setting up requested queues upon device creation
         uint32_t queueFamilyCount;
         vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
         assert(queueFamilyCount > 0);
         queueFamilyProperties.resize(queueFamilyCount);
         vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilyProperties.data());
+
+        // Get list of supported extensions
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+        if (extensionCount > 0)
+        {
+            std::vector<VkExtensionProperties> extensions(extensionCount);
+            if (vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, &extensions.front()) == VK_SUCCESS)
+            {
+                for (const auto &extension : extensions)
+                {
+                    supportedExtensions.push_back(extension.extensionName);
+                }
+            }
+        }
     }
 
     /**
@@ -91,6 +126,9 @@ struct VulkanDeviceWrapper
 	 */
     ~VulkanDeviceWrapper()
     {
+        // Both wait for the uploads still in flight, the manager uses the ring
+        uploadManager.reset();
+        stagingRing.reset();
         if (commandPool)
         {
             vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
@@ -204,6 +242,48 @@ struct VulkanDeviceWrapper
         throw std::runtime_error("Could not find a matching queue family index");
     }
 
+    /**
+	 * Get the index of a queue family that only supports transfer operations (DMA engine)
+	 *
+	 * @return Index of the dedicated transfer queue family, or the graphics one if there is none
+	 */
+    uint32_t getDedicatedTransferQueueFamilyIndex() const
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(queueFamilyProperties.size()); i++)
+        {
+            const VkQueueFamilyProperties &family = queueFamilyProperties[i];
+            // Images are copied in one region, so the family must not restrict the copy granularity
+            const bool fineGranularity = family.minImageTransferGranularity.width == 1 &&
+                                         family.minImageTransferGranularity.height == 1 &&
+                                         family.minImageTransferGranularity.depth == 1;
+            if ((family.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+                (family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0 &&
+                fineGranularity)
+            {
+                return i;
+            }
+        }
+        return queueFamilyIndices.graphics;
+    }
+
+    /**
+	 * Check if an extension is supported by the (physical device)
+	 *
+	 * @param extension Name of the extension to check
+	 *
+	 * @return True if the extension is supported (present in the list read at device creation time)
+	 */
+    bool extensionSupported(const char *extension) const
+    {
+        return std::find(supportedExtensions.begin(), supportedExtensions.end(), extension) != supportedExtensions.end();
+    }
+
+    // Whether the extension was passed to createLogicalDevice
+    bool extensionEnabled(const char *extension) const
+    {
+        return std::find(enabledExtensions.begin(), enabledExtensions.end(), extension) != enabledExtensions.end();
+    }
+
     void getDepthFormat(VkFormat &depthFormat)
     {
         // Get depth format
@@ -294,9 +374,21 @@ struct VulkanDeviceWrapper
             queueFamilyIndices.compute = queueFamilyIndices.graphics;
         }
 
+        // Dedicated transfer queue, used by the upload manager
+        queueFamilyIndices.transfer = getDedicatedTransferQueueFamilyIndex();
+        if (queueFamilyIndices.transfer != queueFamilyIndices.graphics && queueFamilyIndices.transfer != queueFamilyIndices.compute)
+        {
+            VkDeviceQueueCreateInfo queueInfo{};
+            queueInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueInfo.queueFamilyIndex = queueFamilyIndices.transfer;
+            queueInfo.queueCount       = 1;
+            queueInfo.pQueuePriorities = &defaultQueuePriority;
+            queueCreateInfos.push_back(queueInfo);
+        }
+
         // Create the logical device representation
+        // VK_KHR_swapchain is left to the caller, a headless device does not need it
         std::vector<const char *> deviceExtensions(enabledExtensions);
-        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
         VkDeviceCreateInfo deviceCreateInfo   = {};
         deviceCreateInfo.sType                = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -335,6 +427,7 @@ struct VulkanDeviceWrapper
         if (result == VK_SUCCESS)
         {
             commandPool = createCommandPool(queueFamilyIndices.graphics);
+            this->enabledExtensions.assign(deviceExtensions.begin(), deviceExtensions.end());
         }
 
         this->enabledFeatures = enabledFeatures;
@@ -430,6 +523,37 @@ struct VulkanDeviceWrapper
         return true;
     }
 
+    /**
+	 * Get the staging ring shared by all the uploads of this device, created on first use
+	 *
+	 * @note Copies sourced from the ring are recorded through getUploadManager(), which closes the ring frames
+	 */
+    StagingRing *getStagingRing()
+    {
+        if (!stagingRing)
+        {
+            const VkDeviceSize alignment = std::max<VkDeviceSize>(16, properties.limits.optimalBufferCopyOffsetAlignment);
+            stagingRing                  = StagingRing::create(logicalDevice, memoryProperties, stagingRingSize, alignment);
+            assert(stagingRing);
+        }
+        return stagingRing.get();
+    }
+
+    /**
+	 * Get the upload manager batching the copies of this device, created on first use
+	 *
+	 * @note The returned manager submits to the graphics queue, it must be used from the thread that renders
+	 */
+    UploadManager *getUploadManager()
+    {
+        if (!uploadManager)
+        {
+            uploadManager = UploadManager::create(logicalDevice, getStagingRing(), queueFamilyIndices.graphics, queueFamilyIndices.transfer);
+            assert(uploadManager);
+        }
+        return uploadManager.get();
+    }
+
     // End the command buffer recording, submit it to the queue, and wait until it is finished.
     void endAndSubmitSingleTimeCommand(VkCommandBuffer commandBuffer, VkQueue queue, bool free = true) const
     {
@@ -0,0 +1,335 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanFrameAccumulator.h"
+
+#include <LogUtil.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "VulkanDebug.h"
+#include "VulkanInitializers.hpp"
+
+namespace vks
+{
+const char *FrameAccumulator::shaderPath(Precision precision)
+{
+    return precision == Precision::HALF ? "shaders/accumulate.comp.spv" : "shaders/accumulate_float.comp.spv";
+}
+
+std::unique_ptr<FrameAccumulator> FrameAccumulator::create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper,
+                                                           VkQueue queue, VkPipelineCache pipelineCache,
+                                                           const VkPipelineShaderStageCreateInfo &shaderStage,
+                                                           Precision precision, uint32_t width, uint32_t height)
+{
+    auto       accumulator = std::make_unique<FrameAccumulator>(deviceWrapper, queue, precision);
+    const bool success     = accumulator->prepare(pipelineCache, shaderStage, width, height);
+    return success ? std::move(accumulator) : nullptr;
+}
+
+FrameAccumulator::FrameAccumulator(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue,
+                                   Precision precision) :
+    mDeviceWrapper(deviceWrapper),
+    mQueue(queue),
+    mPrecision(precision),
+    mDescriptorPool(deviceWrapper->logicalDevice),
+    mDescriptorSetLayout(deviceWrapper->logicalDevice),
+    mPipelineLayout(deviceWrapper->logicalDevice),
+    mPipeline(deviceWrapper->logicalDevice)
+{}
+
+FrameAccumulator::~FrameAccumulator()
+{
+    // The last dispatch and readback may still use the pipeline, the images and the buffer
+    const UploadManager::Token token = std::max(mLastToken, mReadbackToken);
+    if (token != 0)
+    {
+        mDeviceWrapper->getUploadManager()->wait(token);
+    }
+}
+
+bool FrameAccumulator::prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage,
+                               uint32_t width, uint32_t height)
+{
+    mWidth  = width;
+    mHeight = height;
+
+    Image::ImageBasicInfo imageInfo = {};
+    imageInfo.format = mPrecision == Precision::HALF ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R32G32B32A32_SFLOAT;
+    imageInfo.extent = {width, height, 1};
+    imageInfo.usage  = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.layout = VK_IMAGE_LAYOUT_GENERAL;
+    for (auto &accumulator : mAccumulators)
+    {
+        accumulator = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+        if (accumulator == nullptr)
+        {
+            LOGCATE("FrameAccumulator: Failed to create the %ux%u accumulators", width, height);
+            return false;
+        }
+    }
+
+    // Binding 0: the frame, 1: the previous result, 2: the new result
+    std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings;
+    for (uint32_t binding = 0; binding < 3; binding++)
+    {
+        setLayoutBindings.push_back(vks::initializers::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, binding));
+    }
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = vks::initializers::descriptorSetLayoutCreateInfo(
+        setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+    CALL_VK(vkCreateDescriptorSetLayout(mDeviceWrapper->logicalDevice, &descriptorLayout, nullptr,
+                                        mDescriptorSetLayout.pHandle()));
+
+    const VkPushConstantRange pushConstantRange =
+        vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(mPushConstants), 0);
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo =
+        vks::initializers::pipelineLayoutCreateInfo(mDescriptorSetLayout.pHandle(), 1);
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
+    CALL_VK(vkCreatePipelineLayout(mDeviceWrapper->logicalDevice, &pipelineLayoutCreateInfo, nullptr,
+                                   mPipelineLayout.pHandle()));
+
+    VkDescriptorPoolSize poolSize =
+        vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 3 * ACCUMULATOR_COUNT);
+    const VkDescriptorPoolCreateInfo descriptorPoolInfo =
+        vks::initializers::descriptorPoolCreateInfo(1, &poolSize, ACCUMULATOR_COUNT);
+    CALL_VK(vkCreateDescriptorPool(mDeviceWrapper->logicalDevice, &descriptorPoolInfo, nullptr,
+                                   mDescriptorPool.pHandle()));
+
+    const VkDescriptorSetLayout layouts[ACCUMULATOR_COUNT] = {mDescriptorSetLayout.handle(),
+                                                              mDescriptorSetLayout.handle()};
+    VkDescriptorSetAllocateInfo allocInfo =
+        vks::initializers::descriptorSetAllocateInfo(mDescriptorPool.handle(), layouts, ACCUMULATOR_COUNT);
+    CALL_VK(vkAllocateDescriptorSets(mDeviceWrapper->logicalDevice, &allocInfo, mDescriptorSets));
+
+    VkDescriptorImageInfo descriptors[ACCUMULATOR_COUNT];
+    for (uint32_t i = 0; i < ACCUMULATOR_COUNT; i++)
+    {
+        descriptors[i] = mAccumulators[i]->getDescriptor();
+    }
+    std::vector<VkWriteDescriptorSet> writeDescriptorSets;
+    for (uint32_t i = 0; i < ACCUMULATOR_COUNT; i++)
+    {
+        writeDescriptorSets.push_back(vks::initializers::writeDescriptorSet(
+            mDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, &descriptors[1 - i]));
+        writeDescriptorSets.push_back(vks::initializers::writeDescriptorSet(
+            mDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2, &descriptors[i]));
+    }
+    vkUpdateDescriptorSets(mDeviceWrapper->logicalDevice, static_cast<uint32_t>(writeDescriptorSets.size()),
+                           writeDescriptorSets.data(), 0, nullptr);
+
+    // Same square work group as the other compute samples
+    const auto                                  workGroupSize        = mDeviceWrapper->workGroupSize;
+    const uint32_t                              specializationData[] = {workGroupSize, workGroupSize};
+    const std::vector<VkSpecializationMapEntry> specializationMap    = {
+        // clang-format off
+        // constantID, offset,               size
+        {0, 0 * sizeof(uint32_t), sizeof(uint32_t)},
+        {1, 1 * sizeof(uint32_t), sizeof(uint32_t)},
+        // clang-format on
+    };
+    const VkSpecializationInfo specializationInfo = {
+        .mapEntryCount = static_cast<uint32_t>(specializationMap.size()),
+        .pMapEntries   = specializationMap.data(),
+        .dataSize      = sizeof(specializationData),
+        .pData         = specializationData,
+    };
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo =
+        vks::initializers::computePipelineCreateInfo(mPipelineLayout.handle(), 0);
+    computePipelineCreateInfo.stage                     = shaderStage;
+    computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+    CALL_VK(vkCreateComputePipelines(mDeviceWrapper->logicalDevice, pipelineCache, 1, &computePipelineCreateInfo,
+                                     nullptr, mPipeline.pHandle()));
+    return true;
+}
+
+void FrameAccumulator::reset(Mode mode, float decay)
+{
+    mMode                = mode;
+    mFrameCount          = 0;
+    mPushConstants.mode  = static_cast<int32_t>(mode);
+    mPushConstants.decay = std::clamp(decay, 1.0f / 65536.0f, 1.0f);
+}
+
+void FrameAccumulator::setFrame(const Image &frame)
+{
+    // Both sets are used by the last dispatch
+    if (mLastToken != 0)
+    {
+        mDeviceWrapper->getUploadManager()->wait(mLastToken);
+    }
+
+    VkDescriptorImageInfo frameDescriptor = frame.getDescriptor();
+    frameDescriptor.imageLayout           = VK_IMAGE_LAYOUT_GENERAL;
+    VkWriteDescriptorSet writeDescriptorSets[ACCUMULATOR_COUNT];
+    for (uint32_t i = 0; i < ACCUMULATOR_COUNT; i++)
+    {
+        writeDescriptorSets[i] = vks::initializers::writeDescriptorSet(
+            mDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0, &frameDescriptor);
+    }
+    vkUpdateDescriptorSets(mDeviceWrapper->logicalDevice, ACCUMULATOR_COUNT, writeDescriptorSets, 0, nullptr);
+    mFrame = frame.getImageHandle();
+}
+
+bool FrameAccumulator::accumulate(const Image &frame)
+{
+    if (frame.width() != mWidth || frame.height() != mHeight)
+    {
+        LOGCATE("FrameAccumulator: frame is %ux%u, expected %ux%u", frame.width(), frame.height(), mWidth, mHeight);
+        return false;
+    }
+    if (frame.getImageHandle() != mFrame)
+    {
+        setFrame(frame);
+    }
+
+    // The frame is converted earlier in the same batch
+    UploadManager *uploadManager = mDeviceWrapper->getUploadManager();
+    mPushConstants.frameIndex    = static_cast<int32_t>(mFrameCount);
+    recordDispatch(uploadManager->graphicsCommands(), frame);
+    mLastToken   = uploadManager->pendingToken();
+    mResultIndex = 1 - mResultIndex;
+    mFrameCount++;
+    return true;
+}
+
+void FrameAccumulator::recordDispatch(VkCommandBuffer commandBuffer, const Image &frame)
+{
+    const uint32_t target   = 1 - mResultIndex;
+    const uint32_t previous = mResultIndex;
+
+    VkImageMemoryBarrier barriers[3];
+    uint32_t             barrierCount = 0;
+    // The frame was written by the conversion, which only made it visible to the fragment shaders
+    barriers[barrierCount]                  = vks::initializers::imageMemoryBarrier();
+    barriers[barrierCount].srcAccessMask    = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[barrierCount].dstAccessMask    = VK_ACCESS_SHADER_READ_BIT;
+    barriers[barrierCount].oldLayout        = VK_IMAGE_LAYOUT_GENERAL;
+    barriers[barrierCount].newLayout        = VK_IMAGE_LAYOUT_GENERAL;
+    barriers[barrierCount].image            = frame.getImageHandle();
+    barriers[barrierCount].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrierCount++;
+    // The target is fully rewritten once the earlier frames have sampled or copied it
+    barriers[barrierCount]               = barriers[0];
+    barriers[barrierCount].srcAccessMask = 0;
+    barriers[barrierCount].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[barrierCount].oldLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[barrierCount].image         = mAccumulators[target]->getImageHandle();
+    barrierCount++;
+    if (!mLayoutsReady)
+    {
+        // Bound, but not read by the first frame
+        barriers[barrierCount]       = barriers[1];
+        barriers[barrierCount].image = mAccumulators[previous]->getImageHandle();
+        barrierCount++;
+        mLayoutsReady = true;
+    }
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, barrierCount, barriers);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline.handle());
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout.handle(), 0, 1,
+                            &mDescriptorSets[target], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, mPipelineLayout.handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                       sizeof(mPushConstants), &mPushConstants);
+
+    const uint32_t workGroupSize = mDeviceWrapper->workGroupSize;
+    vkCmdDispatch(commandBuffer, (mWidth + workGroupSize - 1) / workGroupSize,
+                  (mHeight + workGroupSize - 1) / workGroupSize, 1);
+
+    // Read by the next frame, the fragment shaders and requestReadback()
+    VkImageMemoryBarrier barrier = barriers[1];
+    barrier.srcAccessMask        = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask        = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout            = VK_IMAGE_LAYOUT_GENERAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+UploadManager::Token FrameAccumulator::requestReadback()
+{
+    if (mFrameCount == 0)
+        return 0;
+
+    UploadManager *uploadManager = mDeviceWrapper->getUploadManager();
+    if (mReadbackToken != 0 && !uploadManager->isComplete(mReadbackToken))
+        return mReadbackToken;
+
+    const uint32_t size = mWidth * mHeight * texelSize();
+    if (mReadbackBuffer == nullptr)
+    {
+        // The host reads the texels back, faster from cached memory
+        VkBool32 cached = VK_FALSE;
+        mDeviceWrapper->getMemoryType(~0u, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                                      &cached);
+        mReadbackBuffer = Buffer::create(mDeviceWrapper, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                             (cached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT
+                                                     : VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+        if (mReadbackBuffer == nullptr || mReadbackBuffer->map() != VK_SUCCESS)
+        {
+            LOGCATE("FrameAccumulator: Failed to create the %u bytes readback buffer", size);
+            mReadbackBuffer.reset();
+            return 0;
+        }
+    }
+
+    // After the last dispatch, whose barrier made the result visible to the copy
+    VkCommandBuffer   commandBuffer = uploadManager->graphicsCommands();
+    VkBufferImageCopy region        = {};
+    region.imageSubresource         = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent              = {mWidth, mHeight, 1};
+    vkCmdCopyImageToBuffer(commandBuffer, resultImage()->getImageHandle(), VK_IMAGE_LAYOUT_GENERAL,
+                           mReadbackBuffer->getBufferHandle(), 1, &region);
+
+    VkBufferMemoryBarrier barrier = vks::initializers::bufferMemoryBarrier();
+    barrier.srcAccessMask         = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask         = VK_ACCESS_HOST_READ_BIT;
+    barrier.buffer                = mReadbackBuffer->getBufferHandle();
+    barrier.size                  = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr,
+                         1, &barrier, 0, nullptr);
+
+    mReadbackToken = uploadManager->pendingToken();
+    return mReadbackToken;
+}
+
+bool FrameAccumulator::readback(void *texels)
+{
+    if (mReadbackToken == 0)
+        return false;
+
+    mDeviceWrapper->getUploadManager()->wait(mReadbackToken);
+    CALL_VK(mReadbackBuffer->invalidate());
+    memcpy(texels, mReadbackBuffer->getMappedData(), mWidth * mHeight * texelSize());
+    return true;
+}
+}        // namespace vks
@@ -0,0 +1,191 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANFRAMEACCUMULATOR_H
+#define GAINVULKANSAMPLE_VULKANFRAMEACCUMULATOR_H
+
+#include <memory>
+#include <vulkan_wrapper.h>
+
+#include "VulkanBufferWrapper.h"
+#include "VulkanDeviceWrapper.hpp"
+#include "VulkanImageWrapper.h"
+#include "util/VulkanRAIIUtil.h"
+
+namespace vks
+{
+// Integrates a stream of frames into a half or full float RGBA accumulator: long exposures, light
+// trails, motion blur (shaders/glsl/accumulate.glsl). The frames are the RGBA output of a
+// YUVPlaneConverter, or any R8G8B8A8 storage image in VK_IMAGE_LAYOUT_GENERAL.
+//
+// The accumulator is a pair of images: each frame reads the previous result and writes the other
+// image, which becomes the result. The dispatches and the readback copies are recorded into the
+// graphics commands of the open upload batch (see UploadManager), so neither the ingestion nor a
+// readback waits for the GPU. The result is in VK_IMAGE_LAYOUT_GENERAL and ready for the fragment
+// and compute shaders of the frames after accumulate().
+class FrameAccumulator
+{
+  public:
+    enum class Mode
+    {
+        // Average of the frames since reset()
+        MEAN,
+        // Per channel maximum, keeps the highlights of every frame
+        LIGHTEN,
+        // Exponential moving average, each frame weighs decay
+        DECAY,
+    };
+
+    enum class Precision
+    {
+        // VK_FORMAT_R16G16B16A16_SFLOAT (shaders/accumulate.comp)
+        HALF,
+        // VK_FORMAT_R32G32B32A32_SFLOAT (shaders/accumulate_float.comp). Linear filtering of the
+        // result is optional for this format, sample it with texelFetch() or a nearest sampler.
+        FLOAT,
+    };
+
+    // Compute shader implementing precision, to be loaded with VulkanContextBase::loadShader
+    static const char *shaderPath(Precision precision);
+
+    /**
+     * @param shaderStage Stage of shaderPath(precision)
+     * @param width, height Size of the frames, the accumulators are created with it
+     */
+    static std::unique_ptr<FrameAccumulator> create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper,
+                                                    VkQueue queue, VkPipelineCache pipelineCache,
+                                                    const VkPipelineShaderStageCreateInfo &shaderStage,
+                                                    Precision precision, uint32_t width, uint32_t height);
+
+    // Prefer FrameAccumulator::create
+    FrameAccumulator(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue, Precision precision);
+
+    ~FrameAccumulator();
+
+    // Restart the accumulation, the next frame replaces the result. decay is clamped to (0, 1].
+    void reset(Mode mode, float decay = 0.1f);
+
+    // Record the integration of frame, e.g. YUVPlaneConverter::rgbaImage() after convert()
+    bool accumulate(const Image &frame);
+
+    /**
+     * Record a copy of the current result into host memory. The texels are tightly packed, texelSize()
+     * bytes each. The next frames accumulate into the other image meanwhile.
+     *
+     * @return Token to wait on before readback(), 0 if there is no result yet. A request made while
+     *         the previous one is in flight returns the token of the previous one.
+     */
+    UploadManager::Token requestReadback();
+
+    // Wait for the last requestReadback() and copy its texels, width * height * texelSize() bytes
+    bool readback(void *texels);
+
+    Mode mode() const
+    {
+        return mMode;
+    }
+
+    // Frames accumulated since reset()
+    uint32_t frameCount() const
+    {
+        return mFrameCount;
+    }
+
+    // Index of the result in image(), the other image is written by the next frame
+    uint32_t resultIndex() const
+    {
+        return mResultIndex;
+    }
+
+    const Image *image(uint32_t index) const
+    {
+        return mAccumulators[index].get();
+    }
+
+    const Image *resultImage() const
+    {
+        return image(mResultIndex);
+    }
+
+    uint32_t texelSize() const
+    {
+        return mPrecision == Precision::HALF ? 4 * sizeof(uint16_t) : 4 * sizeof(float);
+    }
+
+    // Batch of the last dispatch
+    UploadManager::Token lastToken() const
+    {
+        return mLastToken;
+    }
+
+  private:
+    static constexpr uint32_t ACCUMULATOR_COUNT = 2;
+
+    bool prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage,
+                 uint32_t width, uint32_t height);
+
+    // Point binding 0 of both sets at frame
+    void setFrame(const Image &frame);
+
+    void recordDispatch(VkCommandBuffer commandBuffer, const Image &frame);
+
+    const std::shared_ptr<VulkanDeviceWrapper> mDeviceWrapper;
+    VkQueue                                    mQueue;
+    const Precision                            mPrecision;
+
+    uint32_t mWidth  = 0;
+    uint32_t mHeight = 0;
+
+    VulkanDescriptorPool      mDescriptorPool;
+    VulkanDescriptorSetLayout mDescriptorSetLayout;
+    // Set i reads mAccumulators[1 - i] and writes mAccumulators[i]
+    VkDescriptorSet           mDescriptorSets[ACCUMULATOR_COUNT] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VulkanPipelineLayout      mPipelineLayout;
+    VulkanPipeline            mPipeline;
+
+    std::unique_ptr<Image> mAccumulators[ACCUMULATOR_COUNT];
+    // The accumulators are in VK_IMAGE_LAYOUT_UNDEFINED until the first dispatch
+    bool                   mLayoutsReady = false;
+    VkImage                mFrame        = VK_NULL_HANDLE;
+
+    Mode     mMode        = Mode::MEAN;
+    uint32_t mFrameCount  = 0;
+    uint32_t mResultIndex = 0;
+
+    struct
+    {
+        int32_t mode;
+        int32_t frameIndex;
+        float   decay;
+    } mPushConstants = {};
+
+    // Host copy of the result, see requestReadback()
+    std::unique_ptr<Buffer> mReadbackBuffer;
+    UploadManager::Token    mReadbackToken = 0;
+
+    UploadManager::Token mLastToken = 0;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANFRAMEACCUMULATOR_H
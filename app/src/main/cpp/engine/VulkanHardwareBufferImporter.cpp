@@ -0,0 +1,159 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanHardwareBufferImporter.h"
+
+#include <LogUtil.h>
+#include <cstring>
+
+#include "VulkanDebug.h"
+
+namespace vks
+{
+std::unique_ptr<HardwareBufferImporter> HardwareBufferImporter::create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper)
+{
+    if (!deviceWrapper->extensionEnabled(VK_ANDROID_EXTERNAL_MEMORY_ANDROID_HARDWARE_BUFFER_EXTENSION_NAME))
+    {
+        LOGCATE("HardwareBufferImporter: %s is not enabled", VK_ANDROID_EXTERNAL_MEMORY_ANDROID_HARDWARE_BUFFER_EXTENSION_NAME);
+        return nullptr;
+    }
+    return std::make_unique<HardwareBufferImporter>(deviceWrapper);
+}
+
+HardwareBufferImporter::HardwareBufferImporter(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper) :
+    mDeviceWrapper(deviceWrapper), mConversion(deviceWrapper->logicalDevice), mSampler(deviceWrapper->logicalDevice)
+{}
+
+bool HardwareBufferImporter::describe(AHardwareBuffer *buffer, ExternalBufferDesc *desc)
+{
+    AHardwareBuffer_Desc ahwbDesc{};
+    AHardwareBuffer_describe(buffer, &ahwbDesc);
+    desc->id     = reinterpret_cast<uint64_t>(buffer);
+    desc->width  = ahwbDesc.width;
+    desc->height = ahwbDesc.height;
+    desc->format = ahwbDesc.format;
+    desc->usage  = ahwbDesc.usage;
+    return (ahwbDesc.usage & AHARDWAREBUFFER_USAGE_GPU_SAMPLED_IMAGE) != 0;
+}
+
+std::shared_ptr<Image> HardwareBufferImporter::import(AHardwareBuffer *buffer, const ExternalBufferDesc &desc)
+{
+    VkAndroidHardwareBufferFormatPropertiesANDROID formatProperties = {
+        .sType = VK_STRUCTURE_TYPE_ANDROID_HARDWARE_BUFFER_FORMAT_PROPERTIES_ANDROID,
+        .pNext = nullptr,
+    };
+    VkAndroidHardwareBufferPropertiesANDROID properties = {
+        .sType = VK_STRUCTURE_TYPE_ANDROID_HARDWARE_BUFFER_PROPERTIES_ANDROID,
+        .pNext = &formatProperties,
+    };
+    CALL_VK(vkGetAndroidHardwareBufferPropertiesANDROID(mDeviceWrapper->logicalDevice, buffer, &properties));
+
+    if (!ensureConversion(formatProperties))
+        return nullptr;
+
+    LOGCATI("HardwareBufferImporter: import %ux%u format 0x%x (external 0x%llx)", desc.width, desc.height, desc.format,
+            static_cast<unsigned long long>(formatProperties.externalFormat));
+    return Image::createFromAHardwareBuffer(mDeviceWrapper, buffer, properties, formatProperties, mConversion.handle());
+}
+
+bool HardwareBufferImporter::ensureConversion(const VkAndroidHardwareBufferFormatPropertiesANDROID &formatProperties)
+{
+    const auto sameFormat = [](const VkAndroidHardwareBufferFormatPropertiesANDROID &a,
+                               const VkAndroidHardwareBufferFormatPropertiesANDROID &b) {
+        return a.format == b.format && a.externalFormat == b.externalFormat && a.formatFeatures == b.formatFeatures &&
+               memcmp(&a.samplerYcbcrConversionComponents, &b.samplerYcbcrConversionComponents, sizeof(VkComponentMapping)) == 0 &&
+               a.suggestedYcbcrModel == b.suggestedYcbcrModel && a.suggestedYcbcrRange == b.suggestedYcbcrRange &&
+               a.suggestedXChromaOffset == b.suggestedXChromaOffset && a.suggestedYChromaOffset == b.suggestedYChromaOffset;
+    };
+    if (mConversion.handle() != VK_NULL_HANDLE && sameFormat(mFormatProperties, formatProperties))
+        return true;
+
+    // Use the conversion suggested by the driver, it knows the color space the camera produces
+    VkExternalFormatANDROID externalFormat = {
+        .sType          = VK_STRUCTURE_TYPE_EXTERNAL_FORMAT_ANDROID,
+        .pNext          = nullptr,
+        .externalFormat = formatProperties.format == VK_FORMAT_UNDEFINED ? formatProperties.externalFormat : 0,
+    };
+    // Linear chroma reconstruction is optional for external formats
+    const VkFilter chromaFilter = (formatProperties.formatFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_YCBCR_CONVERSION_LINEAR_FILTER_BIT)
+                                      ? VK_FILTER_LINEAR
+                                      : VK_FILTER_NEAREST;
+    const VkSamplerYcbcrConversionCreateInfo conversionCreateInfo = {
+        .sType                       = VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_CREATE_INFO,
+        .pNext                       = &externalFormat,
+        .format                      = formatProperties.format,
+        .ycbcrModel                  = formatProperties.suggestedYcbcrModel,
+        .ycbcrRange                  = formatProperties.suggestedYcbcrRange,
+        .components                  = formatProperties.samplerYcbcrConversionComponents,
+        .xChromaOffset               = formatProperties.suggestedXChromaOffset,
+        .yChromaOffset               = formatProperties.suggestedYChromaOffset,
+        .chromaFilter                = chromaFilter,
+        .forceExplicitReconstruction = VK_FALSE,
+    };
+    VulkanSamplerYcbcrConversion conversion(mDeviceWrapper->logicalDevice);
+    CALL_VK(vkCreateSamplerYcbcrConversion(mDeviceWrapper->logicalDevice, &conversionCreateInfo, nullptr, conversion.pHandle()));
+
+    // The sampler filters must match the chroma filter for formats without linear filtering
+    const VkSamplerYcbcrConversionInfo conversionInfo = {
+        .sType      = VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO,
+        .pNext      = nullptr,
+        .conversion = conversion.handle(),
+    };
+    const VkSamplerCreateInfo samplerCreateInfo = {
+        .sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .pNext                   = &conversionInfo,
+        .magFilter               = chromaFilter,
+        .minFilter               = chromaFilter,
+        .mipmapMode              = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeW            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .mipLodBias              = 0.0f,
+        .anisotropyEnable        = VK_FALSE,
+        .maxAnisotropy           = 1.0f,
+        .compareEnable           = VK_FALSE,
+        .compareOp               = VK_COMPARE_OP_NEVER,
+        .minLod                  = 0.0f,
+        .maxLod                  = 0.0f,
+        .borderColor             = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK,
+        .unnormalizedCoordinates = VK_FALSE,
+    };
+    VulkanSampler sampler(mDeviceWrapper->logicalDevice);
+    CALL_VK(vkCreateSampler(mDeviceWrapper->logicalDevice, &samplerCreateInfo, nullptr, sampler.pHandle()));
+
+    if (mConversion.handle() != VK_NULL_HANDLE)
+    {
+        mRetiredConversions.push_back(std::move(mConversion));
+        mRetiredSamplers.push_back(std::move(mSampler));
+    }
+    mConversion       = std::move(conversion);
+    mSampler          = std::move(sampler);
+    mFormatProperties = formatProperties;
+    mGeneration++;
+
+    LOGCATI("HardwareBufferImporter: conversion %u, model %d, range %d, chroma filter %d", mGeneration,
+            formatProperties.suggestedYcbcrModel, formatProperties.suggestedYcbcrRange, chromaFilter);
+    return true;
+}
+}        // namespace vks
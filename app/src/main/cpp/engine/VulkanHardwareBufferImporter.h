@@ -0,0 +1,93 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANHARDWAREBUFFERIMPORTER_H
+#define GAINVULKANSAMPLE_VULKANHARDWAREBUFFERIMPORTER_H
+
+#include <android/hardware_buffer.h>
+
+#include <memory>
+#include <vector>
+#include <vulkan_wrapper.h>
+
+#include "ExternalImageCache.h"
+#include "VulkanDeviceWrapper.hpp"
+#include "VulkanImageWrapper.h"
+#include "util/VulkanRAIIUtil.h"
+
+namespace vks
+{
+// Imports AHardwareBuffers (camera, video decoder) as sampled images, the memory of the buffer is
+// bound to the image directly so nothing is copied.
+//
+// YCbCr buffers need a sampler YCbCr conversion matching the format properties reported by the
+// driver. All the buffers of a stream share one conversion and one immutable sampler, both are
+// recreated only if the format properties change (conversionGeneration() is bumped then, the
+// descriptor set layouts and pipelines using sampler() have to be recreated).
+class HardwareBufferImporter : public ExternalImageImporter<AHardwareBuffer, Image>
+{
+  public:
+    // Returns nullptr if the device does not support VK_ANDROID_external_memory_android_hardware_buffer
+    static std::unique_ptr<HardwareBufferImporter> create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper);
+
+    // Prefer HardwareBufferImporter::create
+    explicit HardwareBufferImporter(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper);
+
+    // The id is the address of the buffer. It can not be reused by another buffer while the cache
+    // holds the image, the image keeps a reference to the buffer.
+    bool describe(AHardwareBuffer *buffer, ExternalBufferDesc *desc) override;
+
+    std::shared_ptr<Image> import(AHardwareBuffer *buffer, const ExternalBufferDesc &desc) override;
+
+    // Immutable sampler for the imported images, VK_NULL_HANDLE until the first import
+    VkSampler sampler() const
+    {
+        return mSampler.handle();
+    }
+
+    uint32_t conversionGeneration() const
+    {
+        return mGeneration;
+    }
+
+  private:
+    bool ensureConversion(const VkAndroidHardwareBufferFormatPropertiesANDROID &formatProperties);
+
+    const std::shared_ptr<VulkanDeviceWrapper> mDeviceWrapper;
+
+    VulkanSamplerYcbcrConversion mConversion;
+    VulkanSampler                mSampler;
+    uint32_t                     mGeneration = 0;
+
+    // Format properties the conversion was created for
+    VkAndroidHardwareBufferFormatPropertiesANDROID mFormatProperties = {};
+
+    // Conversions and samplers replaced by a format change. Images and pipelines created with
+    // them may still be alive, they are destroyed with the importer.
+    std::vector<VulkanSamplerYcbcrConversion> mRetiredConversions;
+    std::vector<VulkanSampler>                mRetiredSamplers;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANHARDWAREBUFFERIMPORTER_H
@@ -0,0 +1,187 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanHistogramCalculator.h"
+
+#include <LogUtil.h>
+#include <vector>
+
+#include "VulkanInitializers.hpp"
+
+namespace vks
+{
+const char *HistogramCalculator::shaderPath(Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::GLOBAL_ATOMICS:
+            return "shaders/histogram_global.comp.spv";
+        case Kernel::SUBGROUP:
+            return "shaders/vulkan11/histogram_subgroup.comp.spv";
+        default:
+            return "shaders/histogram.comp.spv";
+    }
+}
+
+bool HistogramCalculator::isSupported(const VulkanDeviceWrapper &deviceWrapper, Kernel kernel)
+{
+    if (kernel != Kernel::SUBGROUP)
+    {
+        return true;
+    }
+    const VkPhysicalDeviceSubgroupProperties &subgroup = deviceWrapper.subgroupProperties;
+    const VkSubgroupFeatureFlags              required = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_BALLOT_BIT;
+    return (subgroup.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0 &&
+           (subgroup.supportedOperations & required) == required;
+}
+
+HistogramCalculator::Kernel HistogramCalculator::preferredKernel(const VulkanDeviceWrapper &deviceWrapper)
+{
+    return isSupported(deviceWrapper, Kernel::SUBGROUP) ? Kernel::SUBGROUP : Kernel::WORKGROUP;
+}
+
+std::unique_ptr<HistogramCalculator> HistogramCalculator::create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper,
+                                                                 VkPipelineCache pipelineCache,
+                                                                 const VkPipelineShaderStageCreateInfo &shaderStage,
+                                                                 Kernel kernel)
+{
+    if (!isSupported(*deviceWrapper, kernel))
+    {
+        LOGCATE("HistogramCalculator: Kernel %d is not supported by the device", static_cast<int>(kernel));
+        return nullptr;
+    }
+    auto       calculator = std::make_unique<HistogramCalculator>(deviceWrapper, kernel);
+    const bool success    = calculator->prepare(pipelineCache, shaderStage);
+    return success ? std::move(calculator) : nullptr;
+}
+
+HistogramCalculator::HistogramCalculator(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, Kernel kernel) :
+    mDeviceWrapper(deviceWrapper),
+    mKernel(kernel),
+    mDescriptorSetLayout(deviceWrapper->logicalDevice),
+    mPipelineLayout(deviceWrapper->logicalDevice),
+    mPipeline(deviceWrapper->logicalDevice)
+{}
+
+bool HistogramCalculator::prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage)
+{
+    std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings;
+    for (uint32_t binding = 0; binding < STORAGE_IMAGE_COUNT; binding++)
+    {
+        setLayoutBindings.push_back(vks::initializers::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, binding));
+    }
+    setLayoutBindings.push_back(vks::initializers::descriptorSetLayoutBinding(
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, STORAGE_IMAGE_COUNT));
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = vks::initializers::descriptorSetLayoutCreateInfo(
+        setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+    CALL_VK(vkCreateDescriptorSetLayout(mDeviceWrapper->logicalDevice, &descriptorLayout, nullptr,
+                                        mDescriptorSetLayout.pHandle()));
+
+    const VkPushConstantRange pushConstantRange =
+        vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(PushConstants), 0);
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo =
+        vks::initializers::pipelineLayoutCreateInfo(mDescriptorSetLayout.pHandle(), 1);
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
+    CALL_VK(vkCreatePipelineLayout(mDeviceWrapper->logicalDevice, &pipelineLayoutCreateInfo, nullptr,
+                                   mPipelineLayout.pHandle()));
+
+    // Same square work group as the other compute samples
+    const auto                                  workGroupSize        = mDeviceWrapper->workGroupSize;
+    const uint32_t                              specializationData[] = {workGroupSize, workGroupSize};
+    const std::vector<VkSpecializationMapEntry> specializationMap    = {
+        // clang-format off
+        // constantID, offset,               size
+        {0, 0 * sizeof(uint32_t), sizeof(uint32_t)},
+        {1, 1 * sizeof(uint32_t), sizeof(uint32_t)},
+        // clang-format on
+    };
+    const VkSpecializationInfo specializationInfo = {
+        .mapEntryCount = static_cast<uint32_t>(specializationMap.size()),
+        .pMapEntries   = specializationMap.data(),
+        .dataSize      = sizeof(specializationData),
+        .pData         = specializationData,
+    };
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo =
+        vks::initializers::computePipelineCreateInfo(mPipelineLayout.handle(), 0);
+    computePipelineCreateInfo.stage                     = shaderStage;
+    computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+    CALL_VK(vkCreateComputePipelines(mDeviceWrapper->logicalDevice, pipelineCache, 1, &computePipelineCreateInfo,
+                                     nullptr, mPipeline.pHandle()));
+    return true;
+}
+
+void HistogramCalculator::updateDescriptorSet(VkDescriptorSet descriptorSet, const VkDescriptorImageInfo &y,
+                                              const VkDescriptorImageInfo &u, const VkDescriptorImageInfo &v,
+                                              const VkDescriptorBufferInfo &bins) const
+{
+    VkDescriptorImageInfo  imageDescriptors[STORAGE_IMAGE_COUNT] = {y, u, v};
+    VkDescriptorBufferInfo binsDescriptor                         = bins;
+    VkWriteDescriptorSet   writeDescriptorSets[STORAGE_IMAGE_COUNT + 1];
+    for (uint32_t i = 0; i < STORAGE_IMAGE_COUNT; i++)
+    {
+        writeDescriptorSets[i] = vks::initializers::writeDescriptorSet(
+            descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, i, &imageDescriptors[i]);
+    }
+    writeDescriptorSets[STORAGE_IMAGE_COUNT] = vks::initializers::writeDescriptorSet(
+        descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, STORAGE_IMAGE_COUNT, &binsDescriptor);
+    vkUpdateDescriptorSets(mDeviceWrapper->logicalDevice, STORAGE_IMAGE_COUNT + 1, writeDescriptorSets, 0, nullptr);
+}
+
+void HistogramCalculator::record(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, VkBuffer bins,
+                                 uint32_t width, uint32_t height, uint32_t uPixelStride, uint32_t vPixelStride,
+                                 histogram::Channel channel) const
+{
+    vkCmdFillBuffer(commandBuffer, bins, 0, BUFFER_SIZE, 0);
+
+    VkBufferMemoryBarrier clearBarrier = vks::initializers::bufferMemoryBarrier();
+    clearBarrier.srcAccessMask         = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask         = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    clearBarrier.buffer                = bins;
+    clearBarrier.offset                = 0;
+    clearBarrier.size                  = BUFFER_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0,
+                         nullptr, 1, &clearBarrier, 0, nullptr);
+
+    const PushConstants pushConstants = {
+        .uPixelStride = static_cast<int32_t>(uPixelStride),
+        .vPixelStride = static_cast<int32_t>(vPixelStride),
+        .channel      = static_cast<int32_t>(channel),
+    };
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline.handle());
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout.handle(), 0, 1,
+                            &descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, mPipelineLayout.handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants),
+                       &pushConstants);
+
+    // The shared memory kernels count a 2x2 block per invocation, the global one a single pixel
+    const uint32_t workGroupSize = mDeviceWrapper->workGroupSize;
+    const uint32_t invocationsX  = mKernel == Kernel::GLOBAL_ATOMICS ? width : (width + 1) / 2;
+    const uint32_t invocationsY  = mKernel == Kernel::GLOBAL_ATOMICS ? height : (height + 1) / 2;
+    vkCmdDispatch(commandBuffer, (invocationsX + workGroupSize - 1) / workGroupSize,
+                  (invocationsY + workGroupSize - 1) / workGroupSize, 1);
+}
+}        // namespace vks
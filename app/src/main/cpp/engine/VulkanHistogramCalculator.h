@@ -0,0 +1,126 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANHISTOGRAMCALCULATOR_H
+#define GAINVULKANSAMPLE_VULKANHISTOGRAMCALCULATOR_H
+
+#include <memory>
+#include <vulkan_wrapper.h>
+
+#include "VulkanDeviceWrapper.hpp"
+#include "util/HistogramUtil.h"
+#include "util/VulkanRAIIUtil.h"
+
+namespace vks
+{
+// Counts the pixels of Y, U, V R8 storage images per bin of a histogram::Channel into a buffer of
+// histogram::BIN_COUNT uint32_t (shaders/glsl/histogram.glsl).
+//
+// The calculator only owns the pipeline. The caller allocates a descriptor set with
+// descriptorSetLayout(), points it at its images and buffer with updateDescriptorSet() and records
+// the dispatch into its own command buffers.
+class HistogramCalculator
+{
+  public:
+    enum class Kernel
+    {
+        // One global atomic per pixel (shaders/histogram_global.comp), the benchmark baseline
+        GLOBAL_ATOMICS,
+        // Workgroup histograms in shared memory (shaders/histogram.comp)
+        WORKGROUP,
+        // WORKGROUP merging the equal bins of a subgroup first (shaders/vulkan11/histogram_subgroup.comp)
+        SUBGROUP,
+    };
+
+    // Bytes of the bins buffer
+    static constexpr uint32_t BUFFER_SIZE = histogram::BIN_COUNT * sizeof(uint32_t);
+    // Descriptors of a set, to size the caller's pool
+    static constexpr uint32_t STORAGE_IMAGE_COUNT  = 3;
+    static constexpr uint32_t STORAGE_BUFFER_COUNT = 1;
+
+    // Compute shader implementing kernel, to be loaded with VulkanContextBase::loadShader
+    static const char *shaderPath(Kernel kernel);
+
+    // SUBGROUP needs a Vulkan 1.1 device with basic and ballot subgroup operations in compute shaders.
+    // Check before loading its shader, a Vulkan 1.0 device can't create the module.
+    static bool isSupported(const VulkanDeviceWrapper &deviceWrapper, Kernel kernel);
+
+    // The fastest kernel the device supports
+    static Kernel preferredKernel(const VulkanDeviceWrapper &deviceWrapper);
+
+    // @param shaderStage Stage of shaderPath(kernel)
+    static std::unique_ptr<HistogramCalculator> create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper,
+                                                       VkPipelineCache pipelineCache,
+                                                       const VkPipelineShaderStageCreateInfo &shaderStage,
+                                                       Kernel kernel);
+
+    // Prefer HistogramCalculator::create
+    HistogramCalculator(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, Kernel kernel);
+
+    Kernel kernel() const
+    {
+        return mKernel;
+    }
+
+    // Layout of the sets passed to record(): binding 0-2 the Y, U and V storage images, 3 the bins
+    VkDescriptorSetLayout descriptorSetLayout() const
+    {
+        return mDescriptorSetLayout.handle();
+    }
+
+    // The images are in VK_IMAGE_LAYOUT_GENERAL, the chroma ones sampled pixel strides apart
+    void updateDescriptorSet(VkDescriptorSet descriptorSet, const VkDescriptorImageInfo &y,
+                             const VkDescriptorImageInfo &u, const VkDescriptorImageInfo &v,
+                             const VkDescriptorBufferInfo &bins) const;
+
+    /**
+     * Record the clearing of the bins and the dispatch. The bins are written by the compute shader
+     * stage, the caller orders the later reads and the earlier users of the buffer (the clear runs
+     * in the transfer stage).
+     *
+     * @param width, height Size of the Y image
+     */
+    void record(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, VkBuffer bins, uint32_t width,
+                uint32_t height, uint32_t uPixelStride, uint32_t vPixelStride, histogram::Channel channel) const;
+
+  private:
+    bool prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage);
+
+    const std::shared_ptr<VulkanDeviceWrapper> mDeviceWrapper;
+    const Kernel                               mKernel;
+
+    VulkanDescriptorSetLayout mDescriptorSetLayout;
+    VulkanPipelineLayout      mPipelineLayout;
+    VulkanPipeline            mPipeline;
+
+    struct PushConstants
+    {
+        int32_t uPixelStride;
+        int32_t vPixelStride;
+        int32_t channel;
+    };
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANHISTOGRAMCALCULATOR_H
@@ -0,0 +1,115 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanHistogramStatistics.h"
+
+#include <LogUtil.h>
+
+#include "VulkanInitializers.hpp"
+
+namespace vks
+{
+const char *HistogramStatistics::shaderPath()
+{
+    return "shaders/histogram_stats.comp.spv";
+}
+
+std::unique_ptr<HistogramStatistics> HistogramStatistics::create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper,
+                                                                 VkPipelineCache pipelineCache,
+                                                                 const VkPipelineShaderStageCreateInfo &shaderStage)
+{
+    auto       statistics = std::make_unique<HistogramStatistics>(deviceWrapper);
+    const bool success    = statistics->prepare(pipelineCache, shaderStage);
+    return success ? std::move(statistics) : nullptr;
+}
+
+HistogramStatistics::HistogramStatistics(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper) :
+    mDeviceWrapper(deviceWrapper),
+    mDescriptorSetLayout(deviceWrapper->logicalDevice),
+    mPipelineLayout(deviceWrapper->logicalDevice),
+    mPipeline(deviceWrapper->logicalDevice)
+{}
+
+bool HistogramStatistics::prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage)
+{
+    const VkDescriptorSetLayoutBinding setLayoutBindings[STORAGE_BUFFER_COUNT] = {
+        vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 0),
+        vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 1),
+    };
+    VkDescriptorSetLayoutCreateInfo descriptorLayout =
+        vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings, STORAGE_BUFFER_COUNT);
+    CALL_VK(vkCreateDescriptorSetLayout(mDeviceWrapper->logicalDevice, &descriptorLayout, nullptr,
+                                        mDescriptorSetLayout.pHandle()));
+
+    const VkPushConstantRange pushConstantRange =
+        vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(histogram::ExposureParams), 0);
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo =
+        vks::initializers::pipelineLayoutCreateInfo(mDescriptorSetLayout.pHandle(), 1);
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
+    CALL_VK(vkCreatePipelineLayout(mDeviceWrapper->logicalDevice, &pipelineLayoutCreateInfo, nullptr,
+                                   mPipelineLayout.pHandle()));
+
+    // The work group size is fixed by the shader, one invocation per two bins
+    VkComputePipelineCreateInfo computePipelineCreateInfo =
+        vks::initializers::computePipelineCreateInfo(mPipelineLayout.handle(), 0);
+    computePipelineCreateInfo.stage = shaderStage;
+    CALL_VK(vkCreateComputePipelines(mDeviceWrapper->logicalDevice, pipelineCache, 1, &computePipelineCreateInfo,
+                                     nullptr, mPipeline.pHandle()));
+    return true;
+}
+
+void HistogramStatistics::updateDescriptorSet(VkDescriptorSet descriptorSet, const VkDescriptorBufferInfo &bins,
+                                              const VkDescriptorBufferInfo &statistics) const
+{
+    VkDescriptorBufferInfo bufferDescriptors[STORAGE_BUFFER_COUNT] = {bins, statistics};
+    VkWriteDescriptorSet   writeDescriptorSets[STORAGE_BUFFER_COUNT];
+    for (uint32_t i = 0; i < STORAGE_BUFFER_COUNT; i++)
+    {
+        writeDescriptorSets[i] = vks::initializers::writeDescriptorSet(
+            descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, i, &bufferDescriptors[i]);
+    }
+    vkUpdateDescriptorSets(mDeviceWrapper->logicalDevice, STORAGE_BUFFER_COUNT, writeDescriptorSets, 0, nullptr);
+}
+
+void HistogramStatistics::record(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, VkBuffer bins,
+                                 const histogram::ExposureParams &params) const
+{
+    VkBufferMemoryBarrier binsBarrier = vks::initializers::bufferMemoryBarrier();
+    binsBarrier.srcAccessMask         = VK_ACCESS_SHADER_WRITE_BIT;
+    binsBarrier.dstAccessMask         = VK_ACCESS_SHADER_READ_BIT;
+    binsBarrier.buffer                = bins;
+    binsBarrier.offset                = 0;
+    binsBarrier.size                  = histogram::BIN_COUNT * sizeof(uint32_t);
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         0, nullptr, 1, &binsBarrier, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline.handle());
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout.handle(), 0, 1,
+                            &descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, mPipelineLayout.handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                       sizeof(histogram::ExposureParams), &params);
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+}
+}        // namespace vks
@@ -0,0 +1,90 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANHISTOGRAMSTATISTICS_H
+#define GAINVULKANSAMPLE_VULKANHISTOGRAMSTATISTICS_H
+
+#include <memory>
+#include <vulkan_wrapper.h>
+
+#include "VulkanDeviceWrapper.hpp"
+#include "util/HistogramUtil.h"
+#include "util/VulkanRAIIUtil.h"
+
+namespace vks
+{
+// Reduces the bins of a HistogramCalculator to a histogram::Statistics buffer: minimum, maximum,
+// mean, percentiles and an auto-exposure compensation (shaders/histogram_stats.comp). The
+// statistics stay on the GPU, later passes bind the buffer instead of waiting for a readback.
+//
+// Like HistogramCalculator it only owns the pipeline, the caller allocates the descriptor sets and
+// records the dispatch after the histogram one.
+class HistogramStatistics
+{
+  public:
+    // Bytes of the statistics buffer
+    static constexpr uint32_t BUFFER_SIZE = sizeof(histogram::Statistics);
+    // Descriptors of a set, to size the caller's pool
+    static constexpr uint32_t STORAGE_BUFFER_COUNT = 2;
+
+    // Compute shader to be loaded with VulkanContextBase::loadShader
+    static const char *shaderPath();
+
+    // @param shaderStage Stage of shaderPath()
+    static std::unique_ptr<HistogramStatistics> create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper,
+                                                       VkPipelineCache pipelineCache,
+                                                       const VkPipelineShaderStageCreateInfo &shaderStage);
+
+    // Prefer HistogramStatistics::create
+    HistogramStatistics(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper);
+
+    // Layout of the sets passed to record(): binding 0 the bins, 1 the statistics
+    VkDescriptorSetLayout descriptorSetLayout() const
+    {
+        return mDescriptorSetLayout.handle();
+    }
+
+    void updateDescriptorSet(VkDescriptorSet descriptorSet, const VkDescriptorBufferInfo &bins,
+                             const VkDescriptorBufferInfo &statistics) const;
+
+    /**
+     * Record the dispatch after the one of HistogramCalculator::record() into bins, with the barrier
+     * between them. The statistics are written by the compute shader stage, the caller orders their
+     * later reads.
+     */
+    void record(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, VkBuffer bins,
+                const histogram::ExposureParams &params) const;
+
+  private:
+    bool prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage);
+
+    const std::shared_ptr<VulkanDeviceWrapper> mDeviceWrapper;
+
+    VulkanDescriptorSetLayout mDescriptorSetLayout;
+    VulkanPipelineLayout      mPipelineLayout;
+    VulkanPipeline            mPipeline;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANHISTOGRAMSTATISTICS_H
@@ -25,10 +25,6 @@
 
 #include "VulkanImageWrapper.h"
 
-#include <android/bitmap.h>
-#include <android/hardware_buffer_jni.h>
-#include <jni.h>
-
 #include <LogUtil.h>
 #include <memory>
 #include <optional>
@@ -38,18 +34,31 @@
 #include <VulkanInitializers.hpp>
 
 #include "VulkanBufferWrapper.h"
+#include "VulkanUploadManager.h"
 #include "../util/VulkanRAIIUtil.h"
 
 namespace vks
 {
 std::unique_ptr<Image> Image::createDeviceLocal(
-    const std::shared_ptr<vks::VulkanDeviceWrapper> context, VkQueue queue, const ImageBasicInfo &imageInfo)
+    const std::shared_ptr<vks::VulkanDeviceWrapper> context, VkQueue queue, const ImageBasicInfo &imageInfo,
+    VkSamplerYcbcrConversion conversion)
 {
     auto image   = std::make_unique<Image>(context, queue, imageInfo);
     bool success = image->createDeviceLocalImage();
     if (image->isYUVFormat())
     {
-        success = success && image->createSamplerYcbcrConversionInfo();
+        if (conversion != VK_NULL_HANDLE)
+        {
+            image->mSamplerYcbcrConversion     = conversion;
+            image->mSamplerYcbcrConversionInfo = {
+                .sType      = VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO,
+                .conversion = conversion,
+            };
+        }
+        else
+        {
+            success = success && image->createSamplerYcbcrConversionInfo();
+        }
     }
     success = success && image->createImageView();
     // Sampler is only needed for sampled images.
@@ -64,6 +73,7 @@ std::unique_ptr<Image> Image::createFromBitmap(
     const std::shared_ptr<vks::VulkanDeviceWrapper> context, VkQueue queue, JNIEnv *env,
     jobject bitmap, VkImageUsageFlags usage, VkImageLayout layout)
 {
+#if defined(__ANDROID__)
     // Get bitmap info
     AndroidBitmapInfo info;
     if (AndroidBitmap_getInfo(env, bitmap, &info) != ANDROID_BITMAP_RESULT_SUCCESS)
@@ -87,30 +97,50 @@ std::unique_ptr<Image> Image::createFromBitmap(
     // Set content from bitmap
     const bool success = image->setContentFromBitmap(env, bitmap);
     return success ? std::move(image) : nullptr;
+#else
+    LOGCATE("Image::createFromBitmap: Android bitmaps are not available on this platform");
+    return nullptr;
+#endif
 }
 
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
+std::unique_ptr<Image> Image::createFromAHardwareBuffer(
+    const std::shared_ptr<vks::VulkanDeviceWrapper> deviceWrapper, AHardwareBuffer *buffer,
+    const VkAndroidHardwareBufferPropertiesANDROID       &properties,
+    const VkAndroidHardwareBufferFormatPropertiesANDROID &formatProperties,
+    VkSamplerYcbcrConversion                              conversion)
+{
+    auto image   = std::make_unique<Image>(deviceWrapper, VK_NULL_HANDLE, ImageBasicInfo{});
+    bool success = image->createImageFromAHardwareBuffer(buffer, properties, formatProperties);
+    if (conversion != VK_NULL_HANDLE)
+    {
+        // The conversion is owned by the caller, it is shared by all the buffers of a stream
+        image->mSamplerYcbcrConversion     = conversion;
+        image->mSamplerYcbcrConversionInfo = {
+            .sType      = VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO,
+            .conversion = conversion,
+        };
+    }
+    success = success && image->createImageView();
+    return success ? std::move(image) : nullptr;
+}
+#endif
+
 std::unique_ptr<Image> Image::createCubeMapFromFile(
-    const std::shared_ptr<vks::VulkanDeviceWrapper> deviceWrapper, VkQueue queue, AAssetManager *assetMgr,
+    const std::shared_ptr<vks::VulkanDeviceWrapper> deviceWrapper, VkQueue queue, const AssetLoader &assets,
     std::string filename, const ImageBasicInfo &info)
 {
     // Textures are stored inside the apk on Android (compressed)
     // So they need to be loaded via the asset manager
-    AAsset *asset = AAssetManager_open(assetMgr, filename.c_str(), AASSET_MODE_STREAMING);
-    if (!asset)
+    std::vector<uint8_t> textureData;
+    if (!assets.read(filename, textureData))
     {
         LOGCATE("Could not load texture %s", filename.c_str());
         exit(-1);
     }
-    size_t size = AAsset_getLength(asset);
-    assert(size > 0);
-
-    void *textureData = malloc(size);
-    AAsset_read(asset, textureData, size);
-    AAsset_close(asset);
+    assert(!textureData.empty());
 
-    gli::texture_cube texCube(gli::load((const char *) textureData, size));
-
-    free(textureData);
+    gli::texture_cube texCube(gli::load(reinterpret_cast<const char *>(textureData.data()), textureData.size()));
 
     assert(!texCube.empty());
 
@@ -133,6 +163,7 @@ std::unique_ptr<Image> Image::create3DImageFromBitmap(
     const std::shared_ptr<vks::VulkanDeviceWrapper> deviceWrapper, VkQueue queue, JNIEnv *env,
     jobject bitmap, VkImageUsageFlags usage, VkImageLayout layout)
 {
+#if defined(__ANDROID__)
     // Get bitmap info
     AndroidBitmapInfo info;
     if (AndroidBitmap_getInfo(env, bitmap, &info) != ANDROID_BITMAP_RESULT_SUCCESS)
@@ -157,6 +188,10 @@ std::unique_ptr<Image> Image::create3DImageFromBitmap(
     // Set content from bitmap
     const bool success = image->setContentFromBitmap(env, bitmap);
     return success ? std::move(image) : nullptr;
+#else
+    LOGCATE("Image::create3DImageFromBitmap: Android bitmaps are not available on this platform");
+    return nullptr;
+#endif
 }
 
 bool Image::createDeviceLocalImage()
@@ -184,72 +219,80 @@ bool Image::createDeviceLocalImage()
         // This flag is required for cube map images
         imageCreateInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
     }
-    if (isYUVFormat())
+    // Planes of a disjoint image are bound separately, at their own offsets of one allocation
+    const uint32_t planes   = planeCount(mImageInfo.format);
+    bool           disjoint = false;
+    if (planes > 1)
+    {
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(mDeviceWrapper->physicalDevice, mImageInfo.format, &formatProperties);
+        disjoint = (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DISJOINT_BIT) != 0;
+    }
+    if (disjoint)
     {
-        imageCreateInfo.flags = VK_IMAGE_CREATE_DISJOINT_BIT;
+        imageCreateInfo.flags |= VK_IMAGE_CREATE_DISJOINT_BIT;
     }
     CALL_VK(
         vkCreateImage(mDeviceWrapper->logicalDevice, &imageCreateInfo, nullptr, mImage.pHandle()));
 
     // Allocate device memory
-    if (mImageInfo.format == VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM)
+    if (disjoint)
     {
-        VkImagePlaneMemoryRequirementsInfo imagePlaneMemoryRequirementsInfo = {VK_STRUCTURE_TYPE_IMAGE_PLANE_MEMORY_REQUIREMENTS_INFO};
-
-        VkImageMemoryRequirementsInfo2 imageMemoryRequirementsInfo2 = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2};
-        imageMemoryRequirementsInfo2.pNext                          = &imagePlaneMemoryRequirementsInfo;
-        imageMemoryRequirementsInfo2.image                          = mImage.handle();
-
-        // Get memory requirement for each plane
-        imagePlaneMemoryRequirementsInfo.planeAspect    = VK_IMAGE_ASPECT_PLANE_0_BIT;
-        VkMemoryRequirements2 memoryRequirements2Plane0 = {VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
-        vkGetImageMemoryRequirements2(mDeviceWrapper->logicalDevice, &imageMemoryRequirementsInfo2, &memoryRequirements2Plane0);
-
-        imagePlaneMemoryRequirementsInfo.planeAspect    = VK_IMAGE_ASPECT_PLANE_1_BIT;
-        VkMemoryRequirements2 memoryRequirements2Plane1 = {VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
-        vkGetImageMemoryRequirements2(mDeviceWrapper->logicalDevice, &imageMemoryRequirementsInfo2, &memoryRequirements2Plane1);
-
-        imagePlaneMemoryRequirementsInfo.planeAspect    = VK_IMAGE_ASPECT_PLANE_2_BIT;
-        VkMemoryRequirements2 memoryRequirements2Plane2 = {VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
-        vkGetImageMemoryRequirements2(mDeviceWrapper->logicalDevice, &imageMemoryRequirementsInfo2, &memoryRequirements2Plane2);
-
-        // Allocate memory for each plane
-        VkMemoryAllocateInfo memoryAllocateInfo = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-
-        memoryAllocateInfo.allocationSize = memoryRequirements2Plane0.memoryRequirements.size;
-        vkAllocateMemory(mDeviceWrapper->logicalDevice, &memoryAllocateInfo, nullptr, &mYMemory);
-
-        memoryAllocateInfo.allocationSize = memoryRequirements2Plane1.memoryRequirements.size;
-        vkAllocateMemory(mDeviceWrapper->logicalDevice, &memoryAllocateInfo, nullptr, &mUMemory);
-
-        memoryAllocateInfo.allocationSize = memoryRequirements2Plane2.memoryRequirements.size;
-        vkAllocateMemory(mDeviceWrapper->logicalDevice, &memoryAllocateInfo, nullptr, &mVMemory);
-
-        // Bind memory for each plane
-        VkBindImagePlaneMemoryInfo bindImagePlaneMemoryInfoY{VK_STRUCTURE_TYPE_BIND_IMAGE_PLANE_MEMORY_INFO};
-        bindImagePlaneMemoryInfoY.planeAspect = VK_IMAGE_ASPECT_PLANE_0_BIT;
-        VkBindImageMemoryInfo bindImageMemoryInfoY{VK_STRUCTURE_TYPE_BIND_IMAGE_MEMORY_INFO};
-        bindImageMemoryInfoY.pNext  = &bindImagePlaneMemoryInfoY;
-        bindImageMemoryInfoY.image  = mImage.handle();
-        bindImageMemoryInfoY.memory = mYMemory;
-
-        VkBindImagePlaneMemoryInfo bindImagePlaneMemoryInfoU{VK_STRUCTURE_TYPE_BIND_IMAGE_PLANE_MEMORY_INFO};
-        bindImagePlaneMemoryInfoU.planeAspect = VK_IMAGE_ASPECT_PLANE_1_BIT;
-        VkBindImageMemoryInfo bindImageMemoryInfoU{VK_STRUCTURE_TYPE_BIND_IMAGE_MEMORY_INFO};
-        bindImageMemoryInfoU.pNext  = &bindImagePlaneMemoryInfoU;
-        bindImageMemoryInfoU.image  = mImage.handle();
-        bindImageMemoryInfoU.memory = mUMemory;
-
-        VkBindImagePlaneMemoryInfo bindImagePlaneMemoryInfoV{VK_STRUCTURE_TYPE_BIND_IMAGE_PLANE_MEMORY_INFO};
-        bindImagePlaneMemoryInfoV.planeAspect = VK_IMAGE_ASPECT_PLANE_2_BIT;
-        VkBindImageMemoryInfo bindImageMemoryInfoV{VK_STRUCTURE_TYPE_BIND_IMAGE_MEMORY_INFO};
-        bindImageMemoryInfoV.pNext  = &bindImagePlaneMemoryInfoV;
-        bindImageMemoryInfoV.image  = mImage.handle();
-        bindImageMemoryInfoV.memory = mVMemory;
-
-        std::vector<VkBindImageMemoryInfo> bindImageMemoryInfos = {bindImageMemoryInfoY, bindImageMemoryInfoU, bindImageMemoryInfoV};
-
-        vkBindImageMemory2(mDeviceWrapper->logicalDevice, static_cast<uint32_t>(bindImageMemoryInfos.size()), bindImageMemoryInfos.data());
+        static const VkImageAspectFlagBits planeAspects[] = {
+            VK_IMAGE_ASPECT_PLANE_0_BIT, VK_IMAGE_ASPECT_PLANE_1_BIT, VK_IMAGE_ASPECT_PLANE_2_BIT};
+
+        // Lay the planes out one after the other, each at the alignment it requires. Only the
+        // memory types all the planes accept can back the block.
+        VkBindImagePlaneMemoryInfo bindPlaneInfos[3];
+        VkBindImageMemoryInfo      bindInfos[3];
+        VkDeviceSize               offset         = 0;
+        uint32_t                   memoryTypeBits = ~0u;
+        for (uint32_t plane = 0; plane < planes; plane++)
+        {
+            VkImagePlaneMemoryRequirementsInfo planeRequirementsInfo = {VK_STRUCTURE_TYPE_IMAGE_PLANE_MEMORY_REQUIREMENTS_INFO};
+            planeRequirementsInfo.planeAspect                        = planeAspects[plane];
+            VkImageMemoryRequirementsInfo2 requirementsInfo          = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2};
+            requirementsInfo.pNext                                   = &planeRequirementsInfo;
+            requirementsInfo.image                                   = mImage.handle();
+            VkMemoryRequirements2 requirements                       = {VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
+            vkGetImageMemoryRequirements2(mDeviceWrapper->logicalDevice, &requirementsInfo, &requirements);
+
+            const VkDeviceSize alignment = requirements.memoryRequirements.alignment;
+            offset                       = (offset + alignment - 1) / alignment * alignment;
+
+            bindPlaneInfos[plane]             = {VK_STRUCTURE_TYPE_BIND_IMAGE_PLANE_MEMORY_INFO};
+            bindPlaneInfos[plane].planeAspect = planeAspects[plane];
+            bindInfos[plane]              = {VK_STRUCTURE_TYPE_BIND_IMAGE_MEMORY_INFO};
+            bindInfos[plane].pNext        = &bindPlaneInfos[plane];
+            bindInfos[plane].image        = mImage.handle();
+            bindInfos[plane].memoryOffset = offset;
+
+            offset += requirements.memoryRequirements.size;
+            memoryTypeBits &= requirements.memoryRequirements.memoryTypeBits;
+        }
+
+        VkBool32       memoryTypeFound = VK_FALSE;
+        const uint32_t memoryTypeIndex =
+            mDeviceWrapper->getMemoryType(memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memoryTypeFound);
+        if (!memoryTypeFound)
+        {
+            LOGCATE("Image::createDeviceLocalImage: No device local memory type for the planes of format %d", mImageInfo.format);
+            return false;
+        }
+        const VkMemoryAllocateInfo allocateInfo = {
+            .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext           = nullptr,
+            .allocationSize  = offset,
+            .memoryTypeIndex = memoryTypeIndex,
+        };
+        CALL_VK(
+            vkAllocateMemory(mDeviceWrapper->logicalDevice, &allocateInfo, nullptr, mMemory.pHandle()));
+
+        for (uint32_t plane = 0; plane < planes; plane++)
+        {
+            bindInfos[plane].memory = mMemory.handle();
+        }
+        CALL_VK(vkBindImageMemory2(mDeviceWrapper->logicalDevice, planes, bindInfos));
     }
     else
     {
@@ -273,177 +316,128 @@ bool Image::createDeviceLocalImage()
 
 bool Image::setYUVContentForYCbCrImage(const void *data, uint32_t size)
 {
-    // Allocate staging buffers
-    auto stagingBuffer =
-        vks::Buffer::create(mDeviceWrapper,
-                       size,
-                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    stagingBuffer->map();
-    stagingBuffer->copyFrom(data, size);
-    stagingBuffer->unmap();
-
-    // Copy buffer to image
-    VulkanCommandBuffer copyCommand(mDeviceWrapper->logicalDevice, mDeviceWrapper->commandPool);
-    assert(mDeviceWrapper->beginSingleTimeCommand(copyCommand.pHandle()));
-
-    // Set layout to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL to prepare for buffer-image copy
-    /*VkImageSubresourceRange subresourceRange = {};
-    subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
-    subresourceRange.baseMipLevel            = 0;
-    subresourceRange.levelCount              = mImageInfo.mipLevels;
-    subresourceRange.layerCount              = mImageInfo.arrayLayers;
-    setImageLayout(copyCommand.handle(), mImage.handle(),
-                   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);*/
+    const uint32_t planes      = planeCount(mImageInfo.format);
+    const uint32_t lumaSize    = mImageInfo.extent.width * mImageInfo.extent.height;
+    const uint32_t chromaWidth = mImageInfo.extent.width / 2, chromaHeight = mImageInfo.extent.height / 2;
+    if ((mImageInfo.format != VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM && mImageInfo.format != VK_FORMAT_G8_B8R8_2PLANE_420_UNORM) ||
+        size < lumaSize + chromaWidth * chromaHeight * 2)
+    {
+        LOGCATE("Image::setYUVContentForYCbCrImage: Unsupported format %d or %u bytes for %ux%u", mImageInfo.format, size,
+                mImageInfo.extent.width, mImageInfo.extent.height);
+        return false;
+    }
 
-    VkImageSubresourceRange subresourceRange = {};
-    subresourceRange.aspectMask              = VK_IMAGE_ASPECT_PLANE_0_BIT;
-    subresourceRange.baseMipLevel            = 0;
-    subresourceRange.levelCount              = mImageInfo.mipLevels;
-    subresourceRange.layerCount              = mImageInfo.arrayLayers;
-    setImageLayout(copyCommand.handle(), mImage.handle(),
-                   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
-    subresourceRange.aspectMask = VK_IMAGE_ASPECT_PLANE_1_BIT;
-    setImageLayout(copyCommand.handle(), mImage.handle(),
-                   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
-    subresourceRange.aspectMask = VK_IMAGE_ASPECT_PLANE_2_BIT;
-    setImageLayout(copyCommand.handle(), mImage.handle(),
-                   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
+    // Stage the planes in the shared staging ring, no allocation happens for per frame updates
+    StagingRing::Allocation staging;
+    if (!mDeviceWrapper->getStagingRing()->upload(data, size, &staging))
+    {
+        LOGCATE("Image::setYUVContentForYCbCrImage: Failed to allocate %u staging bytes", size);
+        return false;
+    }
 
     VkBufferImageCopy bufferCopyRegions[3];
     bufferCopyRegions[0].imageSubresource  = {VK_IMAGE_ASPECT_PLANE_0_BIT, 0, 0, 1};
     bufferCopyRegions[0].imageOffset       = {0, 0, 0};
     bufferCopyRegions[0].imageExtent       = mImageInfo.extent;
-    bufferCopyRegions[0].bufferOffset      = 0;
+    bufferCopyRegions[0].bufferOffset      = staging.offset;
     bufferCopyRegions[0].bufferRowLength   = mImageInfo.extent.width;
     bufferCopyRegions[0].bufferImageHeight = mImageInfo.extent.height;
-    // the Cb component is half the height and width
-    bufferCopyRegions[1].imageOffset       = {0, 0, 0};
-    bufferCopyRegions[1].imageExtent       = {mImageInfo.extent.width / 2, mImageInfo.extent.height / 2, 1};
-    bufferCopyRegions[1].imageSubresource  = {VK_IMAGE_ASPECT_PLANE_1_BIT, 0, 0, 1};
-    bufferCopyRegions[1].bufferOffset      = mImageInfo.extent.width * mImageInfo.extent.height;
-    bufferCopyRegions[1].bufferRowLength   = mImageInfo.extent.width / 2;
-    bufferCopyRegions[1].bufferImageHeight = mImageInfo.extent.height / 2;
-    // the Cr component is half the height and width
-    bufferCopyRegions[2].imageOffset       = {0, 0, 0};
-    bufferCopyRegions[2].imageExtent       = {mImageInfo.extent.width / 2, mImageInfo.extent.height / 2, 1};
-    bufferCopyRegions[2].imageSubresource  = {VK_IMAGE_ASPECT_PLANE_2_BIT, 0, 0, 1};
-    bufferCopyRegions[2].bufferOffset      = mImageInfo.extent.width * mImageInfo.extent.height + mImageInfo.extent.width * mImageInfo.extent.height / 4;
-    bufferCopyRegions[2].bufferRowLength   = mImageInfo.extent.width / 2;
-    bufferCopyRegions[2].bufferImageHeight = mImageInfo.extent.height / 2;
-
-    vkCmdCopyBufferToImage(copyCommand.handle(),
-                           stagingBuffer->getBufferHandle(),
-                           mImage.handle(),
-                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                           3,
-                           bufferCopyRegions);
-
-    if (mImageInfo.layout != VK_IMAGE_LAYOUT_UNDEFINED && mImageInfo.layout != VK_IMAGE_LAYOUT_PREINITIALIZED)
+    // the chroma planes are half the height and width. The CbCr plane of the 2 plane format has
+    // 2 bytes per texel, the rows of the copy are counted in texels.
+    for (uint32_t plane = 1; plane < planes; plane++)
     {
-        VkImageSubresourceRange subresourceRange = {};
-        subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
-        subresourceRange.baseMipLevel            = 0;
-        subresourceRange.levelCount              = mImageInfo.mipLevels;
-        subresourceRange.layerCount              = mImageInfo.arrayLayers;
-        setImageLayout(copyCommand.handle(), mImage.handle(),
-                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mImageInfo.layout, subresourceRange);
+        bufferCopyRegions[plane].imageOffset       = {0, 0, 0};
+        bufferCopyRegions[plane].imageExtent       = {chromaWidth, chromaHeight, 1};
+        bufferCopyRegions[plane].imageSubresource  = {plane == 1 ? VK_IMAGE_ASPECT_PLANE_1_BIT : VK_IMAGE_ASPECT_PLANE_2_BIT, 0, 0, 1};
+        bufferCopyRegions[plane].bufferOffset      = staging.offset + lumaSize + (plane - 1) * chromaWidth * chromaHeight;
+        bufferCopyRegions[plane].bufferRowLength   = chromaWidth;
+        bufferCopyRegions[plane].bufferImageHeight = chromaHeight;
     }
 
-    mDeviceWrapper->endAndSubmitSingleTimeCommand(copyCommand.handle(), mVkQueue, false);
-    return true;
-}
-
-bool Image::setContentFromBytes(const void *data, uint32_t bufferSize, uint32_t stride)
-{
-    // Allocate a staging buffer
-    auto stagingBuffer =
-        vks::Buffer::create(mDeviceWrapper,
-                       bufferSize,
-                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    vks::debug::setDeviceMemoryName(mDeviceWrapper->logicalDevice, stagingBuffer->getMemoryHandle(), "VulkanResources-Image::setContentFromBytes-stagingBuffer");
-
-    // Copy bitmap pixels to the buffer memory
-    stagingBuffer->map();
-    stagingBuffer->copyFrom(data, bufferSize);
-    stagingBuffer->unmap();
-
-    // Copy buffer to image
-    VulkanCommandBuffer copyCommand(mDeviceWrapper->logicalDevice, mDeviceWrapper->commandPool);
-    assert(mDeviceWrapper->beginSingleTimeCommand(copyCommand.pHandle()));
-
-    // Set layout to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL to prepare for buffer-image copy
+    // The color aspect covers all the planes of the multi-planar image
     VkImageSubresourceRange subresourceRange = {};
     subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
     subresourceRange.baseMipLevel            = 0;
     subresourceRange.levelCount              = mImageInfo.mipLevels;
     subresourceRange.layerCount              = mImageInfo.arrayLayers;
-    setImageLayout(copyCommand.handle(), mImage.handle(),
-                   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
+    recordUpload(staging.buffer, planes, bufferCopyRegions, subresourceRange);
+    return true;
+}
+
+bool Image::setContentFromBytes(const void *data, uint32_t bufferSize, uint32_t stride)
+{
+    // Copy the bytes to the shared staging ring
+    StagingRing::Allocation staging;
+    if (!mDeviceWrapper->getStagingRing()->upload(data, bufferSize, &staging))
+    {
+        LOGCATE("Image::setContentFromBytes: Failed to allocate %u staging bytes", bufferSize);
+        return false;
+    }
 
     const VkBufferImageCopy bufferImageCopy = {
-        .bufferOffset      = 0,
+        .bufferOffset      = staging.offset,
         .bufferRowLength   = stride,
         .bufferImageHeight = mImageInfo.extent.depth == 1 ? mImageInfo.extent.height : mImageInfo.extent.height * mImageInfo.extent.height,
         .imageSubresource  = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
         .imageOffset       = {0, 0, 0},
         .imageExtent       = mImageInfo.extent,
     };
-    vkCmdCopyBufferToImage(copyCommand.handle(),
-                           stagingBuffer->getBufferHandle(),
-                           mImage.handle(),
-                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                           1,
-                           &bufferImageCopy);
-
-    if (mImageInfo.layout != VK_IMAGE_LAYOUT_UNDEFINED && mImageInfo.layout != VK_IMAGE_LAYOUT_PREINITIALIZED)
-    {
-        VkImageSubresourceRange subresourceRange = {};
-        subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
-        subresourceRange.baseMipLevel            = 0;
-        subresourceRange.levelCount              = mImageInfo.mipLevels;
-        subresourceRange.layerCount              = mImageInfo.arrayLayers;
-        setImageLayout(copyCommand.handle(), mImage.handle(),
-                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mImageInfo.layout, subresourceRange);
-    }
 
-    mDeviceWrapper->endAndSubmitSingleTimeCommand(copyCommand.handle(), mVkQueue, false);
+    VkImageSubresourceRange subresourceRange = {};
+    subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
+    subresourceRange.baseMipLevel            = 0;
+    subresourceRange.levelCount              = mImageInfo.mipLevels;
+    subresourceRange.layerCount              = mImageInfo.arrayLayers;
+    recordUpload(staging.buffer, 1, &bufferImageCopy, subresourceRange);
     return true;
 }
 
-bool Image::setCubemapData(const gli::texture_cube &texCube)
+bool Image::setRegionFromBytes(const void *data, uint32_t bufferSize, const VkOffset3D &offset,
+                               const VkExtent3D &extent)
 {
-    auto stagingBuffer =
-        vks::Buffer::create(mDeviceWrapper,
-                       texCube.size(),
-                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    vks::debug::setDeviceMemoryName(mDeviceWrapper->logicalDevice, stagingBuffer->getMemoryHandle(), "VulkanResources-Image::createCubeMapFromFile-stagingBuffer");
+    assert(offset.x + extent.width <= mImageInfo.extent.width);
+    assert(offset.y + extent.height <= mImageInfo.extent.height);
+    assert(offset.z + extent.depth <= mImageInfo.extent.depth);
 
-    stagingBuffer->map();
-    stagingBuffer->copyFrom(texCube.data(), texCube.size());
-    stagingBuffer->unmap();
+    StagingRing::Allocation staging;
+    if (!mDeviceWrapper->getStagingRing()->upload(data, bufferSize, &staging))
+    {
+        LOGCATE("Image::setRegionFromBytes: Failed to allocate %u staging bytes", bufferSize);
+        return false;
+    }
 
-    // Copy buffer to image
-    VulkanCommandBuffer copyCommand(mDeviceWrapper->logicalDevice, mDeviceWrapper->commandPool);
-    assert(mDeviceWrapper->beginSingleTimeCommand(copyCommand.pHandle()));
+    const VkBufferImageCopy bufferImageCopy = {
+        .bufferOffset      = staging.offset,
+        .bufferRowLength   = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource  = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, mImageInfo.arrayLayers},
+        .imageOffset       = offset,
+        .imageExtent       = extent,
+    };
 
-    // Set layout to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL to prepare for buffer-image copy
     VkImageSubresourceRange subresourceRange = {};
     subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
     subresourceRange.baseMipLevel            = 0;
     subresourceRange.levelCount              = mImageInfo.mipLevels;
     subresourceRange.layerCount              = mImageInfo.arrayLayers;
-    setImageLayout(copyCommand.handle(), mImage.handle(),
-                   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
+    const bool partial = extent.width != mImageInfo.extent.width || extent.height != mImageInfo.extent.height ||
+                         extent.depth != mImageInfo.extent.depth;
+    recordUpload(staging.buffer, 1, &bufferImageCopy, subresourceRange, partial);
+    return true;
+}
+
+bool Image::setCubemapData(const gli::texture_cube &texCube)
+{
+    StagingRing::Allocation staging;
+    if (!mDeviceWrapper->getStagingRing()->upload(texCube.data(), texCube.size(), &staging))
+    {
+        LOGCATE("Image::setCubemapData: Failed to allocate %zu staging bytes", texCube.size());
+        return false;
+    }
 
     // Setup buffer copy regions for each face including all of it's miplevels
     std::vector<VkBufferImageCopy> bufferCopyRegions;
-    size_t                         offset = 0;
+    VkDeviceSize                   offset = staging.offset;
 
     for (uint32_t face = 0; face < 6; face++)
     {
@@ -466,105 +460,99 @@ bool Image::setCubemapData(const gli::texture_cube &texCube)
         }
     }
 
-    vkCmdCopyBufferToImage(copyCommand.handle(),
-                           stagingBuffer->getBufferHandle(),
-                           mImage.handle(),
-                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                           static_cast<uint32_t>(bufferCopyRegions.size()),
-                           bufferCopyRegions.data());
-
-    if (mImageInfo.layout != VK_IMAGE_LAYOUT_UNDEFINED && mImageInfo.layout != VK_IMAGE_LAYOUT_PREINITIALIZED)
-    {
-        VkImageSubresourceRange subresourceRange = {};
-        subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
-        subresourceRange.baseMipLevel            = 0;
-        subresourceRange.levelCount              = mImageInfo.mipLevels;
-        subresourceRange.layerCount              = mImageInfo.arrayLayers;
-        setImageLayout(copyCommand.handle(), mImage.handle(),
-                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mImageInfo.layout, subresourceRange);
-    }
-
-    mDeviceWrapper->endAndSubmitSingleTimeCommand(copyCommand.handle(), mVkQueue, false);
+    VkImageSubresourceRange subresourceRange = {};
+    subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
+    subresourceRange.baseMipLevel            = 0;
+    subresourceRange.levelCount              = mImageInfo.mipLevels;
+    subresourceRange.layerCount              = mImageInfo.arrayLayers;
+    recordUpload(staging.buffer, static_cast<uint32_t>(bufferCopyRegions.size()), bufferCopyRegions.data(), subresourceRange);
     return true;
 }
 
 bool Image::setContentFromBitmap(JNIEnv *env, jobject bitmap)
 {
+    return setContentFromBitmap(env, bitmap, {0, 0, 0});
+}
+
+bool Image::setContentFromBitmap(JNIEnv *env, jobject bitmap, const VkOffset3D &offset)
+{
+#if defined(__ANDROID__)
     // Get bitmap info
     AndroidBitmapInfo info;
     assert(AndroidBitmap_getInfo(env, bitmap, &info) == ANDROID_BITMAP_RESULT_SUCCESS);
+    VkExtent3D extent = {info.width, info.height, 1};
+    if (mImageInfo.imageType == VK_IMAGE_TYPE_3D)
+    {
+        const uint32_t cubeSize = std::min(info.width, info.height);
+        extent                  = {cubeSize, cubeSize, cubeSize};
+    }
     // We don't assert these in cube image
     if (mImageInfo.extent.depth == 1)
     {
-        assert(info.width == mImageInfo.extent.width);
-        assert(info.height == mImageInfo.extent.height);
+        assert(offset.x + info.width <= mImageInfo.extent.width);
+        assert(offset.y + info.height <= mImageInfo.extent.height);
+    }
+    else
+    {
+        assert(offset.z + extent.depth <= mImageInfo.extent.depth);
     }
     assert(info.format == ANDROID_BITMAP_FORMAT_RGBA_8888);
     assert(info.stride % 4 == 0);
 
-    // Allocate a staging buffer
-    const uint32_t bufferSize = info.stride * info.height;
-    auto           stagingBuffer =
-        vks::Buffer::create(mDeviceWrapper,
-                       bufferSize,
-                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    vks::debug::setDeviceMemoryName(mDeviceWrapper->logicalDevice, stagingBuffer->getMemoryHandle(), "VulkanResources-Image::setContentFromBitmap-stagingBuffer");
-
-    // Copy bitmap pixels to the buffer memory
-    void *bitmapData = nullptr;
+    // Copy bitmap pixels to the shared staging ring
+    const uint32_t          bufferSize = info.stride * info.height;
+    StagingRing::Allocation staging;
+    void                   *bitmapData = nullptr;
     assert(AndroidBitmap_lockPixels(env, bitmap, &bitmapData) == ANDROID_BITMAP_RESULT_SUCCESS);
-    stagingBuffer->map();
-    stagingBuffer->copyFrom(bitmapData, bufferSize);
-    stagingBuffer->unmap();
+    const bool staged = mDeviceWrapper->getStagingRing()->upload(bitmapData, bufferSize, &staging);
     AndroidBitmap_unlockPixels(env, bitmap);
-
-    // Copy buffer to image
-    VulkanCommandBuffer copyCommand(mDeviceWrapper->logicalDevice, mDeviceWrapper->commandPool);
-    assert(mDeviceWrapper->beginSingleTimeCommand(copyCommand.pHandle()));
-
-    // Set layout to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL to prepare for buffer-image copy
-    VkImageSubresourceRange subresourceRange = {};
-    subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
-    subresourceRange.baseMipLevel            = 0;
-    subresourceRange.levelCount              = mImageInfo.mipLevels;
-    subresourceRange.layerCount              = mImageInfo.arrayLayers;
-    setImageLayout(copyCommand.handle(), mImage.handle(),
-                   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
+    if (!staged)
+    {
+        LOGCATE("Image::setContentFromBitmap: Failed to allocate %u staging bytes", bufferSize);
+        return false;
+    }
 
     // TODO: Copy mipmaps
     const VkBufferImageCopy bufferImageCopy = {
-        .bufferOffset      = 0,
+        .bufferOffset      = staging.offset,
         .bufferRowLength   = info.stride / 4,
-        .bufferImageHeight = mImageInfo.extent.height,
+        .bufferImageHeight = extent.height,
         .imageSubresource  = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, mImageInfo.arrayLayers},
-        .imageOffset       = {0, 0, 0},
-        .imageExtent       = mImageInfo.extent,
+        .imageOffset       = offset,
+        .imageExtent       = extent,
     };
-    vkCmdCopyBufferToImage(copyCommand.handle(),
-                           stagingBuffer->getBufferHandle(),
-                           mImage.handle(),
-                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                           1,
-                           &bufferImageCopy);
-
-    if (mImageInfo.layout != VK_IMAGE_LAYOUT_UNDEFINED && mImageInfo.layout != VK_IMAGE_LAYOUT_PREINITIALIZED)
-    {
-        VkImageSubresourceRange subresourceRange = {};
-        subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
-        subresourceRange.baseMipLevel            = 0;
-        subresourceRange.levelCount              = mImageInfo.mipLevels;
-        subresourceRange.layerCount              = mImageInfo.arrayLayers;
-        setImageLayout(copyCommand.handle(), mImage.handle(),
-                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mImageInfo.layout, subresourceRange);
-    }
 
-    mDeviceWrapper->endAndSubmitSingleTimeCommand(copyCommand.handle(), mVkQueue, false);
+    VkImageSubresourceRange subresourceRange = {};
+    subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
+    subresourceRange.baseMipLevel            = 0;
+    subresourceRange.levelCount              = mImageInfo.mipLevels;
+    subresourceRange.layerCount              = mImageInfo.arrayLayers;
+    // A bitmap written into a part of the image (e.g. a slot of a LUT atlas) keeps the rest
+    const bool partial = extent.width != mImageInfo.extent.width || extent.height != mImageInfo.extent.height ||
+                         extent.depth != mImageInfo.extent.depth;
+    recordUpload(staging.buffer, 1, &bufferImageCopy, subresourceRange, partial);
     return true;
+#else
+    LOGCATE("Image::setContentFromBitmap: Android bitmaps are not available on this platform");
+    return false;
+#endif
 }
 
-bool Image::createImageFromAHardwareBuffer(AHardwareBuffer *buffer)
+void Image::recordUpload(VkBuffer stagingBuffer, uint32_t regionCount, const VkBufferImageCopy *regions,
+                         const VkImageSubresourceRange &subresourceRange, bool partial)
+{
+    // The copy is batched with the other uploads of the frame and submitted before the next frame
+    // is rendered, the camera images are rewritten every frame while earlier frames sample them
+    UploadManager *uploadManager = mDeviceWrapper->getUploadManager();
+    uploadManager->copyBufferToImage(stagingBuffer, mImage.handle(), regionCount, regions, subresourceRange,
+                                     mImageInfo.layout, mContentUploaded, partial && mContentUploaded);
+    mUploadToken     = uploadManager->pendingToken();
+    mContentUploaded = true;
+}
+
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
+bool Image::createImageFromAHardwareBuffer(AHardwareBuffer *buffer, const VkAndroidHardwareBufferPropertiesANDROID &properties,
+                                           const VkAndroidHardwareBufferFormatPropertiesANDROID &formatProperties)
 {
     // Acquire the AHardwareBuffer and get the descriptor
     AHardwareBuffer_acquire(buffer);
@@ -572,23 +560,23 @@ bool Image::createImageFromAHardwareBuffer(AHardwareBuffer *buffer)
     AHardwareBuffer_describe(buffer, &ahwbDesc);
     mBuffer           = buffer;
     mImageInfo.extent = {ahwbDesc.width, ahwbDesc.height, 1};
-
-    // Get AHardwareBuffer properties
-    VkAndroidHardwareBufferFormatPropertiesANDROID formatInfo = {
-        .sType = VK_STRUCTURE_TYPE_ANDROID_HARDWARE_BUFFER_FORMAT_PROPERTIES_ANDROID,
-        .pNext = nullptr,
-    };
-    VkAndroidHardwareBufferPropertiesANDROID properties = {
-        .sType = VK_STRUCTURE_TYPE_ANDROID_HARDWARE_BUFFER_PROPERTIES_ANDROID,
-        .pNext = &formatInfo,
-    };
-    CALL_VK(vkGetAndroidHardwareBufferPropertiesANDROID(
-        mDeviceWrapper->logicalDevice, mBuffer, &properties));
+    mImageInfo.format = formatProperties.format;
+    // The camera only writes the buffer, the image is just sampled
+    mImageInfo.usage  = VK_IMAGE_USAGE_SAMPLED_BIT;
+    mImageInfo.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    // Formats without a Vulkan equivalent (most camera YUV layouts) are referred to by the
+    // implementation defined external format
+    mExternalFormat = formatProperties.format == VK_FORMAT_UNDEFINED ? formatProperties.externalFormat : 0;
 
     // Create an image to bind to our AHardwareBuffer
+    VkExternalFormatANDROID externalFormat{
+        .sType          = VK_STRUCTURE_TYPE_EXTERNAL_FORMAT_ANDROID,
+        .pNext          = nullptr,
+        .externalFormat = mExternalFormat,
+    };
     VkExternalMemoryImageCreateInfo externalCreateInfo{
         .sType       = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
-        .pNext       = nullptr,
+        .pNext       = &externalFormat,
         .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_ANDROID_HARDWARE_BUFFER_BIT_ANDROID,
     };
     VkImageCreateInfo createInfo{
@@ -596,13 +584,13 @@ bool Image::createImageFromAHardwareBuffer(AHardwareBuffer *buffer)
         .pNext                 = &externalCreateInfo,
         .flags                 = 0u,
         .imageType             = VK_IMAGE_TYPE_2D,
-        .format                = VK_FORMAT_R8G8B8A8_UNORM,
-        .extent                = {ahwbDesc.width, ahwbDesc.height, 1u},
+        .format                = mImageInfo.format,
+        .extent                = mImageInfo.extent,
         .mipLevels             = 1u,
         .arrayLayers           = 1u,
         .samples               = VK_SAMPLE_COUNT_1_BIT,
         .tiling                = VK_IMAGE_TILING_OPTIMAL,
-        .usage                 = VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .usage                 = mImageInfo.usage,
         .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
         .queueFamilyIndexCount = 0,
         .pQueueFamilyIndices   = nullptr,
@@ -610,9 +598,9 @@ bool Image::createImageFromAHardwareBuffer(AHardwareBuffer *buffer)
     };
     CALL_VK(vkCreateImage(mDeviceWrapper->logicalDevice, &createInfo, nullptr, mImage.pHandle()));
 
-    // Allocate device memory
-    uint32_t                                 memoryTypeIndex = mDeviceWrapper->getMemoryType(properties.memoryTypeBits,
-                                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    // Import the memory of the AHardwareBuffer. It is allocated by the producer already, any
+    // memory type allowed for it will do.
+    uint32_t                                 memoryTypeIndex = mDeviceWrapper->getMemoryType(properties.memoryTypeBits, 0);
     VkImportAndroidHardwareBufferInfoANDROID androidHardwareBufferInfo{
         .sType  = VK_STRUCTURE_TYPE_IMPORT_ANDROID_HARDWARE_BUFFER_INFO_ANDROID,
         .pNext  = nullptr,
@@ -637,12 +625,13 @@ bool Image::createImageFromAHardwareBuffer(AHardwareBuffer *buffer)
     CALL_VK(vkBindImageMemory(mDeviceWrapper->logicalDevice, mImage.handle(), mMemory.handle(), 0));
     return true;
 }
+#endif
 
 bool Image::createSampler()
 {
     VkSamplerCreateInfo samplerCreateInfo{};
     samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerCreateInfo.pNext = isYUVFormat() ? &mSamplerYcbcrConversionInfo : nullptr,
+    samplerCreateInfo.pNext = mSamplerYcbcrConversion != VK_NULL_HANDLE ? &mSamplerYcbcrConversionInfo : nullptr,
     // 如果用于LUT图，这里采样需要设置为linear的，这样可以做差值保持色彩精度
         samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
     samplerCreateInfo.minFilter     = VK_FILTER_LINEAR;
@@ -683,7 +672,7 @@ bool Image::createImageView()
     };
     const VkImageViewCreateInfo viewCreateInfo{
         .sType                       = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .pNext                       = isYUVFormat() ? &mSamplerYcbcrConversionInfo : nullptr,
+        .pNext                       = mSamplerYcbcrConversion != VK_NULL_HANDLE ? &mSamplerYcbcrConversionInfo : nullptr,
         .flags                       = 0,
         .image                       = mImage.handle(),
         .viewType                    = getImageViewType(mImageInfo.imageType),
@@ -699,6 +688,27 @@ bool Image::createImageView()
 }
 
 bool Image::createSamplerYcbcrConversionInfo()
+{
+    const VkComponentMapping identity = {
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+    };
+    if (!createSamplerYcbcrConversion(mDeviceWrapper->logicalDevice, mImageInfo.format, identity, mOwnedConversion.pHandle()))
+        return false;
+
+    mSamplerYcbcrConversion     = mOwnedConversion.handle();
+    mSamplerYcbcrConversionInfo = {
+        .sType      = VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO,
+        .conversion = mSamplerYcbcrConversion,
+    };
+
+    return true;
+}
+
+bool Image::createSamplerYcbcrConversion(VkDevice device, VkFormat format, const VkComponentMapping &components,
+                                         VkSamplerYcbcrConversion *conversion)
 {
     // Create conversion object that describes how to have the implementation do the {YCbCr} conversion
     VkSamplerYcbcrConversionCreateInfo samplerYcbcrConversionCreateInfo = {VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_CREATE_INFO};
@@ -719,12 +729,7 @@ bool Image::createSamplerYcbcrConversionInfo()
     samplerYcbcrConversionCreateInfo.ycbcrRange = VK_SAMPLER_YCBCR_RANGE_ITU_FULL;
 
     // Deal with order of components.
-    samplerYcbcrConversionCreateInfo.components = {
-        VK_COMPONENT_SWIZZLE_IDENTITY,
-        VK_COMPONENT_SWIZZLE_IDENTITY,
-        VK_COMPONENT_SWIZZLE_IDENTITY,
-        VK_COMPONENT_SWIZZLE_IDENTITY,
-    };
+    samplerYcbcrConversionCreateInfo.components = components;
 
     // With NEAREST, chroma is duplicated to a 2x2 block for YUV420p.
     // In fancy video players, you might even get bicubic/sinc
@@ -737,22 +742,16 @@ bool Image::createSamplerYcbcrConversionInfo()
 
     samplerYcbcrConversionCreateInfo.forceExplicitReconstruction = VK_FALSE;
 
-    // For YUV420p.
-    samplerYcbcrConversionCreateInfo.format = mImageInfo.format;
-
-    CALL_VK(vkCreateSamplerYcbcrConversion(mDeviceWrapper->logicalDevice, &samplerYcbcrConversionCreateInfo, nullptr, &mSamplerYcbcrConversion));
-
-    mSamplerYcbcrConversionInfo = {
-        .sType      = VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO,
-        .conversion = mSamplerYcbcrConversion,
-    };
+    // E.g. YUV420p or NV12
+    samplerYcbcrConversionCreateInfo.format = format;
 
+    CALL_VK(vkCreateSamplerYcbcrConversion(device, &samplerYcbcrConversionCreateInfo, nullptr, conversion));
     return true;
 }
 
-bool Image::isYUVFormat()
+uint32_t Image::planeCount(VkFormat format)
 {
-    switch (mImageInfo.format)
+    switch (format)
     {
         case VK_FORMAT_G8_B8R8_2PLANE_420_UNORM:
         case VK_FORMAT_G8_B8R8_2PLANE_422_UNORM:
@@ -762,6 +761,7 @@ bool Image::isYUVFormat()
         case VK_FORMAT_G10X6_B10X6R10X6_2PLANE_422_UNORM_3PACK16:
         case VK_FORMAT_G12X4_B12X4R12X4_2PLANE_420_UNORM_3PACK16:
         case VK_FORMAT_G12X4_B12X4R12X4_2PLANE_422_UNORM_3PACK16:
+            return 2;
         case VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM:
         case VK_FORMAT_G8_B8_R8_3PLANE_422_UNORM:
         case VK_FORMAT_G8_B8_R8_3PLANE_444_UNORM:
@@ -774,9 +774,15 @@ bool Image::isYUVFormat()
         case VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_420_UNORM_3PACK16:
         case VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_422_UNORM_3PACK16:
         case VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_444_UNORM_3PACK16:
-            return true;
+            return 3;
+        default:
+            return 1;
     }
-    return false;
+}
+
+bool Image::isYUVFormat()
+{
+    return planeCount(mImageInfo.format) > 1;
 }
 
 // Create an image memory barrier for changing the layout of
@@ -916,7 +922,7 @@ void Image::setImageLayout(VkCommandBuffer cmdbuffer, VkImage image, VkImageAspe
 }
 
 Image::Image(const std::shared_ptr<vks::VulkanDeviceWrapper> context, VkQueue queue, const ImageBasicInfo &imageInfo) :
-    mDeviceWrapper(context), mVkQueue(queue), mImage(context->logicalDevice), mMemory(context->logicalDevice), mSampler(context->logicalDevice), mImageView(context->logicalDevice), mImageInfo(imageInfo)
+    mDeviceWrapper(context), mVkQueue(queue), mImage(context->logicalDevice), mMemory(context->logicalDevice), mOwnedConversion(context->logicalDevice), mSampler(context->logicalDevice), mImageView(context->logicalDevice), mImageInfo(imageInfo)
 {}
 
 }        // namespace vks
@@ -26,16 +26,13 @@
 #ifndef GAINVULKANSAMPLE_VULKANIMAGEWRAPPER_H
 #define GAINVULKANSAMPLE_VULKANIMAGEWRAPPER_H
 
-#include <android/bitmap.h>
-#include <android/hardware_buffer_jni.h>
-#include <jni.h>
-
-#include <android/asset_manager.h>
 #include <gli/gli.hpp>
 #include <memory>
 #include <optional>
 #include <vector>
 
+#include "../util/AssetUtil.h"
+#include "../util/PlatformUtil.h"
 #include "../util/VulkanRAIIUtil.h"
 #include "VulkanDeviceWrapper.hpp"
 
@@ -56,13 +53,14 @@ class Image
     };
 
     // Create a image backed by device local memory. The layout is VK_IMAGE_LAYOUT_UNDEFINED
-    // after the creation.
+    // after the creation. A multi-planar image is backed by one allocation for all its planes, it
+    // uses conversion if given (owned by the caller, e.g. YCbCrImagePool) or creates its own.
     static std::unique_ptr<Image> createDeviceLocal(
         const std::shared_ptr<vks::VulkanDeviceWrapper> deviceWrapper, VkQueue queue,
-        const ImageBasicInfo &imageInfo);
+        const ImageBasicInfo &imageInfo, VkSamplerYcbcrConversion conversion = VK_NULL_HANDLE);
 
     // Create a image backed by device local memory, and initialize the memory from a bitmap image.
-    // The image is created with usage VK_IMAGE_USAGE_TRANSFER_DST_BIT and
+    // The bitmap functions fail on the host, there are no Android bitmaps there. The image is created with usage VK_IMAGE_USAGE_TRANSFER_DST_BIT and
     // VK_IMAGE_USAGE_SAMPLED_BIT as an input of shader. The layout is set to
     // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL after the creation.
     static std::unique_ptr<Image> createFromBitmap(
@@ -77,10 +75,33 @@ class Image
         const std::shared_ptr<vks::VulkanDeviceWrapper> deviceWrapper, VkQueue queue, JNIEnv *env,
         jobject bitmap, VkImageUsageFlags usage, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
+    // Import an AHardwareBuffer as a sampled image without copying its content. The buffer is
+    // acquired for the lifetime of the image. For YCbCr buffers (including the implementation
+    // defined formats of cameras) conversion must be created from formatProperties, e.g. by
+    // HardwareBufferImporter, and the image has to be sampled with an immutable sampler using the
+    // same conversion; the image has no sampler of its own.
+    // The layout is VK_IMAGE_LAYOUT_UNDEFINED and the image is owned by VK_QUEUE_FAMILY_FOREIGN_EXT,
+    // each use has to acquire it on the queue and release it back.
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
+    static std::unique_ptr<Image> createFromAHardwareBuffer(
+        const std::shared_ptr<vks::VulkanDeviceWrapper> deviceWrapper, AHardwareBuffer *buffer,
+        const VkAndroidHardwareBufferPropertiesANDROID       &properties,
+        const VkAndroidHardwareBufferFormatPropertiesANDROID &formatProperties,
+        VkSamplerYcbcrConversion                              conversion);
+#endif
+
     static std::unique_ptr<Image> createCubeMapFromFile(
-        const std::shared_ptr<vks::VulkanDeviceWrapper> deviceWrapper, VkQueue queue, AAssetManager *asset,
+        const std::shared_ptr<vks::VulkanDeviceWrapper> deviceWrapper, VkQueue queue, const AssetLoader &assets,
         std::string filename, const ImageBasicInfo &imageInfo);
 
+    // Create the conversion of the images sampled by Image: full range BT.709 with linear chroma
+    // reconstruction. components reorders the chroma of e.g. NV21 stored as a CbCr format.
+    static bool createSamplerYcbcrConversion(VkDevice device, VkFormat format, const VkComponentMapping &components,
+                                             VkSamplerYcbcrConversion *conversion);
+
+    // Number of planes of a multi-planar format, 1 for the other formats
+    static uint32_t planeCount(VkFormat format);
+
     // Put an image memory barrier for setting an image layout on the sub resource into the given
     // command buffer
     static void setImageLayout(
@@ -100,27 +121,18 @@ class Image
 
     ~Image()
     {
-        if (mBuffer != nullptr)
+        // The image may still be written by a pending upload
+        if (mUploadToken != 0 && mDeviceWrapper->uploadManager)
         {
-            AHardwareBuffer_release(mBuffer);
+            mDeviceWrapper->uploadManager->wait(mUploadToken);
         }
 
-        if (mYMemory)
-        {
-            vkFreeMemory(mDeviceWrapper->logicalDevice, mYMemory, nullptr);
-        }
-        if (mUMemory)
-        {
-            vkFreeMemory(mDeviceWrapper->logicalDevice, mUMemory, nullptr);
-        }
-        if (mVMemory)
-        {
-            vkFreeMemory(mDeviceWrapper->logicalDevice, mVMemory, nullptr);
-        }
-        if (mSamplerYcbcrConversion)
+#if defined(__ANDROID__)
+        if (mBuffer != nullptr)
         {
-            //            vkDestroySamplerYcbcrConversion(mDeviceWrapper->logicalDevice, mSamplerYcbcrConversion, nullptr);
+            AHardwareBuffer_release(mBuffer);
         }
+#endif
     }
 
     uint32_t width() const
@@ -153,16 +165,33 @@ class Image
         return mBuffer;
     }
 
+    // Batch of the last content upload. The setters below do not wait for the copy, the upload is
+    // submitted before the next frame. Wait on the token before accessing the image from the host
+    // or from another queue.
+    UploadManager::Token uploadToken() const
+    {
+        return mUploadToken;
+    }
+
     // Copy the bytes to the image device memory. The image must be created with
     // VK_IMAGE_USAGE_TRANSFER_DST_BIT.
     bool setContentFromBytes(const void *data, uint32_t bufferSize, uint32_t stride);
 
+    // Write tightly packed texels to a region of the first mip level, the rest keeps its content
+    bool setRegionFromBytes(const void *data, uint32_t bufferSize, const VkOffset3D &offset, const VkExtent3D &extent);
+
+    // Upload a packed 4:2:0 frame to a multi-planar image: Y then U then V for the 3 plane formats,
+    // Y then the interleaved CbCr (or CrCb, see createSamplerYcbcrConversion) for the 2 plane ones.
     bool setYUVContentForYCbCrImage(const void *data, uint32_t size);
 
     // Copy the bitmap pixels to the image device memory. The image must be created with
     // VK_IMAGE_USAGE_TRANSFER_DST_BIT.
     bool setContentFromBitmap(JNIEnv *env, jobject bitmap);
 
+    // Copy the bitmap pixels to the region of the image at offset, the rest of the image is kept.
+    // A 3D image takes the bitmap as a cube of min(width, height) texels (see create3DImageFromBitmap).
+    bool setContentFromBitmap(JNIEnv *env, jobject bitmap, const VkOffset3D &offset);
+
     bool setCubemapData(const gli::texture_cube &texCube);
 
     VkDescriptorImageInfo getDescriptor() const
@@ -174,7 +203,10 @@ class Image
     // Initialization
     bool createDeviceLocalImage();
 
-    bool createImageFromAHardwareBuffer(AHardwareBuffer *buffer);
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
+    bool createImageFromAHardwareBuffer(AHardwareBuffer *buffer, const VkAndroidHardwareBufferPropertiesANDROID &properties,
+                                        const VkAndroidHardwareBufferFormatPropertiesANDROID &formatProperties);
+#endif
 
     bool createSampler();
 
@@ -184,6 +216,11 @@ class Image
 
     bool isYUVFormat();
 
+    // Record the copy from the staging ring and the transition to mImageInfo.layout. A partial
+    // upload keeps the content outside of the regions.
+    void recordUpload(VkBuffer stagingBuffer, uint32_t regionCount, const VkBufferImageCopy *regions,
+                      const VkImageSubresourceRange &subresourceRange, bool partial = false);
+
     // Context
     const std::shared_ptr<vks::VulkanDeviceWrapper> mDeviceWrapper;
 
@@ -194,20 +231,23 @@ class Image
     // The managed AHardwareBuffer handle. Only valid if the image is created from
     // Image::createFromAHardwareBuffer.
     AHardwareBuffer *mBuffer = nullptr;
+    // Implementation defined format of the AHardwareBuffer, 0 if it has a Vulkan format
+    uint64_t mExternalFormat = 0;
 
     // Managed handles
     VulkanImage        mImage;
     VulkanDeviceMemory mMemory;
+    // Conversion created by the image itself, destroyed after the sampler using it
+    VulkanSamplerYcbcrConversion mOwnedConversion;
     VulkanSampler      mSampler;
     VulkanImageView    mImageView;
 
-    // DeviceMemory for YUV
-    VkDeviceMemory mYMemory = VK_NULL_HANDLE;
-    VkDeviceMemory mUMemory = VK_NULL_HANDLE;
-    VkDeviceMemory mVMemory = VK_NULL_HANDLE;
+    UploadManager::Token mUploadToken = 0;
+    // Set after the first upload, later ones have to be ordered after the frames sampling the image
+    bool mContentUploaded = false;
 
     VkSamplerYcbcrConversionKHR  mSamplerYcbcrConversion = VK_NULL_HANDLE;
-    VkSamplerYcbcrConversionInfo mSamplerYcbcrConversionInfo;
+    VkSamplerYcbcrConversionInfo mSamplerYcbcrConversionInfo = {VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO};
 };
 
 }        // namespace vks
@@ -0,0 +1,137 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanLutBank.h"
+
+#include <LogUtil.h>
+#include <algorithm>
+
+namespace vks
+{
+std::unique_ptr<LutBank> LutBank::create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue,
+                                         uint32_t lutSize, uint32_t lutCount, uint32_t minSlots, VkDeviceSize budget,
+                                         Loader loader)
+{
+    if (lutSize == 0 || lutCount == 0)
+        return nullptr;
+
+    const VkDeviceSize lutBytes  = static_cast<VkDeviceSize>(lutSize) * lutSize * lutSize * 4;
+    const uint32_t     maxSlots  = deviceWrapper->properties.limits.maxImageDimension3D / lutSize;
+    uint32_t           slotCount = static_cast<uint32_t>(std::min<VkDeviceSize>(budget / lutBytes, maxSlots));
+    slotCount                    = std::min(std::max(slotCount, minSlots), std::min(lutCount, maxSlots));
+    if (slotCount == 0)
+    {
+        LOGCATE("LutBank: %u^3 LUTs exceed the 3D image limit", lutSize);
+        return nullptr;
+    }
+    if (slotCount < std::min(minSlots, lutCount))
+    {
+        LOGCATE("LutBank: %u LUTs of %u^3 exceed the 3D image limit, only %u are resident at once",
+                minSlots, lutSize, slotCount);
+    }
+
+    auto bank = std::make_unique<LutBank>(lutSize, lutCount, std::move(loader));
+
+    Image::ImageBasicInfo imageInfo = {};
+    imageInfo.imageType             = VK_IMAGE_TYPE_3D;
+    imageInfo.format                = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent                = {lutSize, lutSize, lutSize * slotCount};
+    imageInfo.usage                 = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.layout                = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    bank->mImage                    = Image::createDeviceLocal(deviceWrapper, queue, imageInfo);
+    if (bank->mImage == nullptr)
+    {
+        LOGCATE("LutBank: Failed to create the %ux%ux%u image", lutSize, lutSize, lutSize * slotCount);
+        return nullptr;
+    }
+    bank->mSlots.resize(slotCount);
+
+    LOGCATI("LutBank: %u of %u LUTs resident, %llu KB", slotCount, lutCount,
+            static_cast<unsigned long long>(lutBytes * slotCount / 1024));
+    return bank;
+}
+
+LutBank::LutBank(uint32_t lutSize, uint32_t lutCount, Loader loader) :
+    mLutSize(lutSize), mLoader(std::move(loader)), mSlotOfLut(lutCount, -1)
+{}
+
+void LutBank::beginUse()
+{
+    mUse++;
+}
+
+int32_t LutBank::findSlot() const
+{
+    int32_t lru = -1;
+    for (size_t i = 0; i < mSlots.size(); i++)
+    {
+        if (mSlots[i].lut < 0)
+            return static_cast<int32_t>(i);
+        if (mSlots[i].lastUse != mUse && (lru < 0 || mSlots[i].lastUse < mSlots[lru].lastUse))
+            lru = static_cast<int32_t>(i);
+    }
+    return lru;
+}
+
+int32_t LutBank::acquire(uint32_t lut)
+{
+    if (lut >= mSlotOfLut.size())
+        return -1;
+
+    int32_t slot = mSlotOfLut[lut];
+    if (slot >= 0)
+    {
+        mSlots[slot].lastUse = mUse;
+        return slot;
+    }
+
+    slot = findSlot();
+    if (slot < 0)
+    {
+        LOGCATE("LutBank: No slot left for LUT %u, all %zu are in use", lut, mSlots.size());
+        return -1;
+    }
+
+    const uint32_t texelBytes = mLutSize * mLutSize * mLutSize * 4;
+    mTexels.clear();
+    if (!mLoader(lut, mTexels) || mTexels.size() != texelBytes)
+    {
+        LOGCATE("LutBank: Failed to load LUT %u", lut);
+        return -1;
+    }
+    // Ordered after the frames still sampling the evicted LUT (see Image::setRegionFromBytes)
+    const VkOffset3D offset = {0, 0, static_cast<int32_t>(slot * mLutSize)};
+    if (!mImage->setRegionFromBytes(mTexels.data(), texelBytes, offset, {mLutSize, mLutSize, mLutSize}))
+        return -1;
+
+    if (mSlots[slot].lut >= 0)
+    {
+        mSlotOfLut[mSlots[slot].lut] = -1;
+    }
+    mSlots[slot].lut     = static_cast<int32_t>(lut);
+    mSlots[slot].lastUse = mUse;
+    mSlotOfLut[lut]      = slot;
+    return slot;
+}
+}        // namespace vks
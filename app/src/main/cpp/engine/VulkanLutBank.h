@@ -0,0 +1,108 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANLUTBANK_H
+#define GAINVULKANSAMPLE_VULKANLUTBANK_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <vulkan_wrapper.h>
+
+#include "VulkanDeviceWrapper.hpp"
+#include "VulkanImageWrapper.h"
+
+namespace vks
+{
+// Keeps the 3D LUTs in use in a single 3D image with one memory allocation. The LUTs are stacked
+// along z, slot s spans the depths [s * lutSize, (s + 1) * lutSize).
+//
+// The image is sized once for a memory budget. A LUT is loaded when it is first acquired and stays
+// resident until its slot is needed for another one, the least recently used LUT is evicted, so
+// memory and loading time only depend on the LUTs in use, not on how many exist.
+class LutBank
+{
+  public:
+    // Writes the lutSize^3 RGBA8 texels of a LUT, red varies fastest, then green, then blue
+    using Loader = std::function<bool(uint32_t lut, std::vector<uint8_t> &texels)>;
+
+    /**
+     * @param lutCount Number of LUTs the loader provides
+     * @param minSlots LUTs that have to be resident at once, e.g. the visible ones
+     * @param budget Bytes of the image. Rounded down to whole slots, never fewer than minSlots
+     * and never more than lutCount or the 3D image limit allows.
+     */
+    static std::unique_ptr<LutBank> create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue,
+                                           uint32_t lutSize, uint32_t lutCount, uint32_t minSlots,
+                                           VkDeviceSize budget, Loader loader);
+
+    // Prefer LutBank::create
+    LutBank(uint32_t lutSize, uint32_t lutCount, Loader loader);
+
+    // Start a new use period (e.g. a frame). The LUTs acquired during a period don't evict each other.
+    void beginUse();
+
+    // Slot holding lut, it is loaded into a free or the least recently used slot if it is not
+    // resident. -1 if it can't be loaded or every slot is used by this period already.
+    int32_t acquire(uint32_t lut);
+
+    Image *image() const
+    {
+        return mImage.get();
+    }
+
+    uint32_t lutSize() const
+    {
+        return mLutSize;
+    }
+
+    uint32_t slotCount() const
+    {
+        return static_cast<uint32_t>(mSlots.size());
+    }
+
+  private:
+    struct Slot
+    {
+        int32_t  lut     = -1;
+        uint64_t lastUse = 0;
+    };
+
+    int32_t findSlot() const;
+
+    const uint32_t mLutSize;
+    const Loader   mLoader;
+
+    std::unique_ptr<Image> mImage;
+    std::vector<Slot>      mSlots;
+    // Slot of each LUT, -1 if it is not resident
+    std::vector<int32_t> mSlotOfLut;
+    uint64_t             mUse = 1;
+
+    // Reused by the loads
+    std::vector<uint8_t> mTexels;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANLUTBANK_H
@@ -0,0 +1,245 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanLutChain.h"
+
+#include <LogUtil.h>
+#include <algorithm>
+
+#include "VulkanDebug.h"
+#include "VulkanInitializers.hpp"
+
+namespace vks
+{
+const char *LutChain::shaderPath()
+{
+    return "shaders/lut_bake.comp.spv";
+}
+
+std::unique_ptr<LutChain> LutChain::create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue,
+                                           VkPipelineCache pipelineCache,
+                                           const VkPipelineShaderStageCreateInfo &shaderStage, uint32_t size)
+{
+    auto       chain   = std::make_unique<LutChain>(deviceWrapper, queue);
+    const bool success = chain->prepare(pipelineCache, shaderStage, size);
+    return success ? std::move(chain) : nullptr;
+}
+
+LutChain::LutChain(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue) :
+    mDeviceWrapper(deviceWrapper),
+    mQueue(queue),
+    mDescriptorPool(deviceWrapper->logicalDevice),
+    mDescriptorSetLayout(deviceWrapper->logicalDevice),
+    mPipelineLayout(deviceWrapper->logicalDevice),
+    mPipeline(deviceWrapper->logicalDevice)
+{}
+
+LutChain::~LutChain()
+{
+    // The last bake may still use the pipeline and the LUTs
+    if (mLastToken != 0)
+    {
+        mDeviceWrapper->getUploadManager()->wait(mLastToken);
+    }
+}
+
+bool LutChain::prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage,
+                       uint32_t size)
+{
+    // Half floats keep the precision of the intermediate colors
+    Image::ImageBasicInfo imageInfo = {};
+    imageInfo.imageType             = VK_IMAGE_TYPE_3D;
+    imageInfo.format                = VK_FORMAT_R16G16B16A16_SFLOAT;
+    imageInfo.extent                = {size, size, size};
+    imageInfo.usage                 = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.layout                = VK_IMAGE_LAYOUT_GENERAL;
+    mBaked                          = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+    if (mBaked == nullptr)
+    {
+        LOGCATE("LutChain: Failed to create the %u^3 baked LUT", size);
+        return false;
+    }
+
+    // Binding 0: the LUTs of the steps, 1: the baked LUT
+    const std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings = {
+        vks::initializers::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 0, MAX_STEPS),
+        vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 1),
+    };
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = vks::initializers::descriptorSetLayoutCreateInfo(
+        setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+    CALL_VK(vkCreateDescriptorSetLayout(mDeviceWrapper->logicalDevice, &descriptorLayout, nullptr,
+                                        mDescriptorSetLayout.pHandle()));
+
+    const VkPushConstantRange pushConstantRange =
+        vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(mPushConstants), 0);
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo =
+        vks::initializers::pipelineLayoutCreateInfo(mDescriptorSetLayout.pHandle(), 1);
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
+    CALL_VK(vkCreatePipelineLayout(mDeviceWrapper->logicalDevice, &pipelineLayoutCreateInfo, nullptr,
+                                   mPipelineLayout.pHandle()));
+
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_STEPS),
+        vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1),
+    };
+    const VkDescriptorPoolCreateInfo descriptorPoolInfo = vks::initializers::descriptorPoolCreateInfo(poolSizes, 1);
+    CALL_VK(vkCreateDescriptorPool(mDeviceWrapper->logicalDevice, &descriptorPoolInfo, nullptr,
+                                   mDescriptorPool.pHandle()));
+
+    VkDescriptorSetAllocateInfo allocInfo =
+        vks::initializers::descriptorSetAllocateInfo(mDescriptorPool.handle(), mDescriptorSetLayout.pHandle(), 1);
+    CALL_VK(vkAllocateDescriptorSets(mDeviceWrapper->logicalDevice, &allocInfo, &mDescriptorSet));
+
+    VkDescriptorImageInfo      bakedDescriptor = mBaked->getDescriptor();
+    const VkWriteDescriptorSet writeDescriptorSet =
+        vks::initializers::writeDescriptorSet(mDescriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, &bakedDescriptor);
+    vkUpdateDescriptorSets(mDeviceWrapper->logicalDevice, 1, &writeDescriptorSet, 0, nullptr);
+
+    // Same square work group as the other compute samples, one z slice per work group
+    const auto                                  workGroupSize        = mDeviceWrapper->workGroupSize;
+    const uint32_t                              specializationData[] = {workGroupSize, workGroupSize};
+    const std::vector<VkSpecializationMapEntry> specializationMap    = {
+        // clang-format off
+        // constantID, offset,               size
+        {0, 0 * sizeof(uint32_t), sizeof(uint32_t)},
+        {1, 1 * sizeof(uint32_t), sizeof(uint32_t)},
+        // clang-format on
+    };
+    const VkSpecializationInfo specializationInfo = {
+        .mapEntryCount = static_cast<uint32_t>(specializationMap.size()),
+        .pMapEntries   = specializationMap.data(),
+        .dataSize      = sizeof(specializationData),
+        .pData         = specializationData,
+    };
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo =
+        vks::initializers::computePipelineCreateInfo(mPipelineLayout.handle(), 0);
+    computePipelineCreateInfo.stage                     = shaderStage;
+    computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+    CALL_VK(vkCreateComputePipelines(mDeviceWrapper->logicalDevice, pipelineCache, 1, &computePipelineCreateInfo,
+                                     nullptr, mPipeline.pHandle()));
+    return true;
+}
+
+bool LutChain::setSteps(const std::vector<Step> &steps)
+{
+    if (steps.empty() || steps.size() > MAX_STEPS ||
+        std::any_of(steps.begin(), steps.end(), [](const Step &step) { return step.lut == nullptr; }))
+    {
+        LOGCATE("LutChain: A chain has 1 to %u LUTs, got %zu", MAX_STEPS, steps.size());
+        return false;
+    }
+
+    const bool sameLuts = steps.size() == mSteps.size() &&
+                          std::equal(steps.begin(), steps.end(), mSteps.begin(),
+                                     [](const Step &a, const Step &b) { return a.lut == b.lut; });
+    if (!sameLuts)
+    {
+        // The set is used by the last bake
+        if (mLastToken != 0)
+        {
+            mDeviceWrapper->getUploadManager()->wait(mLastToken);
+        }
+
+        VkDescriptorImageInfo descriptors[MAX_STEPS];
+        for (uint32_t i = 0; i < MAX_STEPS; i++)
+        {
+            descriptors[i] = steps[i < steps.size() ? i : 0].lut->getDescriptor();
+        }
+        const VkWriteDescriptorSet writeDescriptorSet = vks::initializers::writeDescriptorSet(
+            mDescriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, descriptors, MAX_STEPS);
+        vkUpdateDescriptorSets(mDeviceWrapper->logicalDevice, 1, &writeDescriptorSet, 0, nullptr);
+        mDirty = true;
+    }
+
+    mSteps.resize(steps.size());
+    for (uint32_t i = 0; i < steps.size(); i++)
+    {
+        mSteps[i].lut = steps[i].lut;
+        setIntensity(i, steps[i].intensity);
+    }
+    return true;
+}
+
+bool LutChain::setIntensity(uint32_t step, float intensity)
+{
+    if (step >= mSteps.size())
+        return false;
+    intensity              = std::clamp(intensity, 0.0f, 1.0f);
+    mSteps[step].intensity = intensity;
+    if (mPushConstants.intensity[step] != intensity)
+    {
+        mPushConstants.intensity[step] = intensity;
+        mDirty                         = true;
+    }
+    return true;
+}
+
+void LutChain::update()
+{
+    if (!mDirty || mSteps.empty())
+        return;
+
+    // The LUTs uploaded in this batch are ready for the shaders once its copies are done
+    mPushConstants.stepCount     = static_cast<int32_t>(mSteps.size());
+    UploadManager *uploadManager = mDeviceWrapper->getUploadManager();
+    recordBake(uploadManager->graphicsCommands());
+    mLastToken = uploadManager->pendingToken();
+    mDirty     = false;
+}
+
+void LutChain::recordBake(VkCommandBuffer commandBuffer)
+{
+    // The baked LUT is fully rewritten once the earlier frames have sampled it
+    VkImageMemoryBarrier barrier = vks::initializers::imageMemoryBarrier();
+    barrier.srcAccessMask        = 0;
+    barrier.dstAccessMask        = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.oldLayout            = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout            = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.image                = mBaked->getImageHandle();
+    barrier.subresourceRange     = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline.handle());
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout.handle(), 0, 1,
+                            &mDescriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, mPipelineLayout.handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                       sizeof(mPushConstants), &mPushConstants);
+
+    const uint32_t size          = mBaked->width();
+    const uint32_t workGroupSize = mDeviceWrapper->workGroupSize;
+    vkCmdDispatch(commandBuffer, (size + workGroupSize - 1) / workGroupSize, (size + workGroupSize - 1) / workGroupSize,
+                  size);
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout     = VK_IMAGE_LAYOUT_GENERAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr,
+                         0, nullptr, 1, &barrier);
+}
+}        // namespace vks
@@ -0,0 +1,122 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANLUTCHAIN_H
+#define GAINVULKANSAMPLE_VULKANLUTCHAIN_H
+
+#include <memory>
+#include <vector>
+#include <vulkan_wrapper.h>
+
+#include "VulkanDeviceWrapper.hpp"
+#include "VulkanImageWrapper.h"
+#include "util/VulkanRAIIUtil.h"
+
+namespace vks
+{
+// Composes a chain of LUTs, each mixed with its input by an intensity, into one baked 3D LUT
+// (shaders/lut_bake.comp). The shaders sample bakedImage() once, whatever the length of the chain.
+//
+// The bake is recorded into the graphics commands of the open upload batch (see UploadManager) and
+// only when the chain or an intensity changed. The baked LUT is in VK_IMAGE_LAYOUT_GENERAL and
+// ready for the fragment and compute shaders of the frames after update().
+class LutChain
+{
+  public:
+    static constexpr uint32_t MAX_STEPS = 8;
+
+    struct Step
+    {
+        // 3D LUT sampled with a linear filter, e.g. created by Image::create3DImageFromBitmap
+        const Image *lut = nullptr;
+        // 0 keeps the input of the step, 1 takes the LUT output
+        float intensity = 1.0f;
+    };
+
+    // Compute shader to be loaded with VulkanContextBase::loadShader
+    static const char *shaderPath();
+
+    /**
+     * @param shaderStage Stage of shaderPath()
+     * @param size Texels per side of the baked LUT
+     */
+    static std::unique_ptr<LutChain> create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue,
+                                            VkPipelineCache pipelineCache,
+                                            const VkPipelineShaderStageCreateInfo &shaderStage, uint32_t size);
+
+    // Prefer LutChain::create
+    LutChain(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue);
+
+    ~LutChain();
+
+    // Replace the steps, applied in order. The LUTs have to stay alive until the next setSteps()
+    // call, a chain of other LUTs waits for the last bake.
+    bool setSteps(const std::vector<Step> &steps);
+
+    bool setIntensity(uint32_t step, float intensity);
+
+    // Record the bake if the chain changed since the last one
+    void update();
+
+    const Image *bakedImage() const
+    {
+        return mBaked.get();
+    }
+
+    // Batch of the last bake, 0 if there is nothing to wait for
+    UploadManager::Token bakeToken() const
+    {
+        return mLastToken;
+    }
+
+  private:
+    bool prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage, uint32_t size);
+
+    void recordBake(VkCommandBuffer commandBuffer);
+
+    const std::shared_ptr<VulkanDeviceWrapper> mDeviceWrapper;
+    VkQueue                                    mQueue;
+
+    VulkanDescriptorPool      mDescriptorPool;
+    VulkanDescriptorSetLayout mDescriptorSetLayout;
+    VkDescriptorSet           mDescriptorSet = VK_NULL_HANDLE;
+    VulkanPipelineLayout      mPipelineLayout;
+    VulkanPipeline            mPipeline;
+
+    std::unique_ptr<Image> mBaked;
+    std::vector<Step>      mSteps;
+    // Set when the chain differs from the baked LUT
+    bool mDirty = false;
+
+    struct
+    {
+        int32_t stepCount;
+        float   intensity[MAX_STEPS];
+    } mPushConstants = {};
+
+    UploadManager::Token mLastToken = 0;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANLUTCHAIN_H
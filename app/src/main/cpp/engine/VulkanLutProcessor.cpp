@@ -0,0 +1,449 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanLutProcessor.h"
+
+#include <LogUtil.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "VulkanDebug.h"
+#include "VulkanInitializers.hpp"
+
+namespace vks
+{
+namespace
+{
+// Binding of the LUT, 0-2 are the input planes and 4 the output
+constexpr uint32_t kLutBinding    = 3;
+constexpr uint32_t kOutputBinding = 4;
+
+struct PushConstants
+{
+    int32_t lumaSize[2];
+    int32_t chromaSize[2];
+};
+}        // namespace
+
+const char *LutProcessor::shaderPath()
+{
+    return "shaders/lut_apply.comp.spv";
+}
+
+std::unique_ptr<LutProcessor> LutProcessor::create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper,
+                                                   VkQueue queue, VkPipelineCache pipelineCache,
+                                                   const VkPipelineShaderStageCreateInfo &shaderStage,
+                                                   uint32_t tileSize)
+{
+    // Even, so that the chroma samples of a tile do not straddle two tiles
+    tileSize = std::min(tileSize, deviceWrapper->properties.limits.maxImageDimension2D) & ~1u;
+    if (tileSize == 0)
+        return nullptr;
+    auto processor = std::make_unique<LutProcessor>(deviceWrapper, queue, pipelineCache, shaderStage, tileSize);
+    const bool success = processor->prepare();
+    return success ? std::move(processor) : nullptr;
+}
+
+LutProcessor::LutProcessor(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue,
+                           VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage,
+                           uint32_t tileSize) :
+    mDeviceWrapper(deviceWrapper),
+    mQueue(queue),
+    mPipelineCache(pipelineCache),
+    mShaderStage(shaderStage),
+    mTileSize(tileSize),
+    mCommandPool(deviceWrapper->logicalDevice),
+    mDescriptorPool(deviceWrapper->logicalDevice),
+    mDescriptorSetLayout(deviceWrapper->logicalDevice),
+    mPipelineLayout(deviceWrapper->logicalDevice),
+    mPipelines{VulkanPipeline(deviceWrapper->logicalDevice), VulkanPipeline(deviceWrapper->logicalDevice)},
+    mFences{VulkanFence(deviceWrapper->logicalDevice), VulkanFence(deviceWrapper->logicalDevice)}
+{}
+
+LutProcessor::~LutProcessor()
+{
+    // Only left in flight if process() failed
+    for (uint32_t i = 0; i < SLOT_COUNT; i++)
+    {
+        finishTile(i, nullptr, 0);
+    }
+}
+
+bool LutProcessor::prepare()
+{
+    const VkDevice device = mDeviceWrapper->logicalDevice;
+
+    const VkCommandPoolCreateInfo poolInfo = {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext            = nullptr,
+        .flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = mDeviceWrapper->queueFamilyIndices.graphics,
+    };
+    CALL_VK(vkCreateCommandPool(device, &poolInfo, nullptr, mCommandPool.pHandle()));
+
+    std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings;
+    for (uint32_t binding = 0; binding <= kOutputBinding; binding++)
+    {
+        const VkDescriptorType type =
+            binding == kLutBinding ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        setLayoutBindings.push_back(
+            vks::initializers::descriptorSetLayoutBinding(type, VK_SHADER_STAGE_COMPUTE_BIT, binding));
+    }
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = vks::initializers::descriptorSetLayoutCreateInfo(
+        setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+    CALL_VK(vkCreateDescriptorSetLayout(device, &descriptorLayout, nullptr, mDescriptorSetLayout.pHandle()));
+
+    const VkPushConstantRange pushConstantRange =
+        vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(PushConstants), 0);
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo =
+        vks::initializers::pipelineLayoutCreateInfo(mDescriptorSetLayout.pHandle(), 1);
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
+    CALL_VK(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, mPipelineLayout.pHandle()));
+
+    VkDescriptorPoolSize poolSizes[] = {
+        vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, (INPUT_COUNT + 1) * SLOT_COUNT),
+        vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, SLOT_COUNT),
+    };
+    const VkDescriptorPoolCreateInfo descriptorPoolInfo =
+        vks::initializers::descriptorPoolCreateInfo(2, poolSizes, SLOT_COUNT);
+    CALL_VK(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, mDescriptorPool.pHandle()));
+
+    for (uint32_t i = 0; i < SLOT_COUNT; i++)
+    {
+        if (!prepareSlot(i))
+        {
+            LOGCATE("LutProcessor: Failed to create the resources of %ux%u tiles", mTileSize, mTileSize);
+            return false;
+        }
+    }
+    LOGCATI("LutProcessor: %ux%u tiles", mTileSize, mTileSize);
+    return true;
+}
+
+bool LutProcessor::prepareSlot(uint32_t index)
+{
+    const VkDevice device = mDeviceWrapper->logicalDevice;
+    Slot          &slot   = mSlots[index];
+
+    Image::ImageBasicInfo imageInfo = {};
+    imageInfo.format                = VK_FORMAT_R8_UNORM;
+    imageInfo.usage                 = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+    imageInfo.layout                = VK_IMAGE_LAYOUT_GENERAL;
+    imageInfo.extent                = {mTileSize, mTileSize, 1};
+    slot.inputs[0]                  = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+    imageInfo.extent                = {mTileSize / 2, mTileSize / 2, 1};
+    slot.inputs[1]                  = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+    slot.inputs[2]                  = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.usage  = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.extent = {mTileSize, mTileSize, 1};
+    slot.output      = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+
+    // The host writes the inputs and reads the results, the results are read faster from cached memory
+    const uint32_t lumaBytes = mTileSize * mTileSize;
+    slot.upload              = Buffer::create(mDeviceWrapper, lumaBytes + lumaBytes / 2, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    VkBool32 cached = VK_FALSE;
+    mDeviceWrapper->getMemoryType(~0u, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, &cached);
+    slot.readback = Buffer::create(mDeviceWrapper, lumaBytes * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                       (cached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+    if (!slot.inputs[0] || !slot.inputs[1] || !slot.inputs[2] || !slot.output || !slot.upload || !slot.readback)
+        return false;
+    CALL_VK(slot.upload->map());
+    CALL_VK(slot.readback->map());
+
+    const VkCommandBufferAllocateInfo allocateInfo =
+        vks::initializers::commandBufferAllocateInfo(mCommandPool.handle(), VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1);
+    CALL_VK(vkAllocateCommandBuffers(device, &allocateInfo, &slot.commandBuffer));
+    vks::debug::setCommandBufferName(device, slot.commandBuffer, "LutProcessor");
+
+    const VkFenceCreateInfo fenceInfo = vks::initializers::fenceCreateInfo(0);
+    CALL_VK(vkCreateFence(device, &fenceInfo, nullptr, mFences[index].pHandle()));
+
+    VkDescriptorSetAllocateInfo setInfo =
+        vks::initializers::descriptorSetAllocateInfo(mDescriptorPool.handle(), mDescriptorSetLayout.pHandle(), 1);
+    CALL_VK(vkAllocateDescriptorSets(device, &setInfo, &slot.descriptorSet));
+
+    VkDescriptorImageInfo descriptors[INPUT_COUNT + 1];
+    VkWriteDescriptorSet  writeDescriptorSets[INPUT_COUNT + 1];
+    for (uint32_t i = 0; i < INPUT_COUNT + 1; i++)
+    {
+        const uint32_t binding = i < INPUT_COUNT ? i : kOutputBinding;
+        descriptors[i]         = i < INPUT_COUNT ? slot.inputs[i]->getDescriptor() : slot.output->getDescriptor();
+        writeDescriptorSets[i] = vks::initializers::writeDescriptorSet(
+            slot.descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, binding, &descriptors[i]);
+    }
+    vkUpdateDescriptorSets(device, INPUT_COUNT + 1, writeDescriptorSets, 0, nullptr);
+    return true;
+}
+
+void LutProcessor::setLut(const Image *lut)
+{
+    mLut = lut;
+    if (lut == nullptr)
+        return;
+
+    // process() returns with no tile in flight, the sets are not in use
+    VkDescriptorImageInfo descriptor = lut->getDescriptor();
+    VkWriteDescriptorSet  writeDescriptorSets[SLOT_COUNT];
+    for (uint32_t i = 0; i < SLOT_COUNT; i++)
+    {
+        writeDescriptorSets[i] = vks::initializers::writeDescriptorSet(
+            mSlots[i].descriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, kLutBinding, &descriptor);
+    }
+    vkUpdateDescriptorSets(mDeviceWrapper->logicalDevice, SLOT_COUNT, writeDescriptorSets, 0, nullptr);
+}
+
+VkPipeline LutProcessor::pipeline(Interpolation interpolation)
+{
+    VulkanPipeline &pipeline = mPipelines[static_cast<uint32_t>(interpolation)];
+    if (pipeline.handle() != VK_NULL_HANDLE)
+        return pipeline.handle();
+
+    // Same square work group as the other compute samples
+    const auto     workGroupSize        = mDeviceWrapper->workGroupSize;
+    const uint32_t specializationData[] = {workGroupSize, workGroupSize, static_cast<uint32_t>(interpolation)};
+    const std::vector<VkSpecializationMapEntry> specializationMap = {
+        // clang-format off
+        // constantID, offset,               size
+        {0, 0 * sizeof(uint32_t), sizeof(uint32_t)},
+        {1, 1 * sizeof(uint32_t), sizeof(uint32_t)},
+        {2, 2 * sizeof(uint32_t), sizeof(uint32_t)},
+        // clang-format on
+    };
+    const VkSpecializationInfo specializationInfo = {
+        .mapEntryCount = static_cast<uint32_t>(specializationMap.size()),
+        .pMapEntries   = specializationMap.data(),
+        .dataSize      = sizeof(specializationData),
+        .pData         = specializationData,
+    };
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo =
+        vks::initializers::computePipelineCreateInfo(mPipelineLayout.handle(), 0);
+    computePipelineCreateInfo.stage                     = mShaderStage;
+    computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+    CALL_VK(vkCreateComputePipelines(mDeviceWrapper->logicalDevice, mPipelineCache, 1, &computePipelineCreateInfo,
+                                     nullptr, pipeline.pHandle()));
+    return pipeline.handle();
+}
+
+bool LutProcessor::process(const yuv::Frame &frame, Interpolation interpolation, uint8_t *dst, uint32_t dstStride)
+{
+    if (mLut == nullptr || dst == nullptr || dstStride < frame.width * 4)
+    {
+        LOGCATE("LutProcessor: No LUT or destination to process a %ux%u frame", frame.width, frame.height);
+        return false;
+    }
+    // Camera frames (YUV_420_888) have a chroma sample per 2x2 pixels
+    if (frame.width == 0 || frame.height == 0 || frame.width % 2 != 0 || frame.height % 2 != 0)
+    {
+        LOGCATE("LutProcessor: %ux%u is not a 4:2:0 frame size", frame.width, frame.height);
+        return false;
+    }
+
+    // The LUT may still be in the open upload batch, which is submitted with the next frame
+    UploadManager *uploadManager = mDeviceWrapper->getUploadManager();
+    if (mLut->uploadToken() != 0)
+    {
+        uploadManager->wait(mLut->uploadToken());
+    }
+
+    const VkPipeline pipeline = this->pipeline(interpolation);
+    const yuv::Frame i420     = mUnpacker.unpack(frame);
+
+    // Tile n + 1 is copied in while the GPU processes tile n, then tile n - 1 is copied out
+    uint32_t tile    = 0;
+    bool     success = true;
+    for (uint32_t y = 0; y < frame.height && success; y += mTileSize)
+    {
+        for (uint32_t x = 0; x < frame.width && success; x += mTileSize, tile++)
+        {
+            const uint32_t slot = tile % SLOT_COUNT;
+            const VkRect2D rect = {{static_cast<int32_t>(x), static_cast<int32_t>(y)},
+                                   {std::min(mTileSize, frame.width - x), std::min(mTileSize, frame.height - y)}};
+            success = finishTile(slot, dst, dstStride) && submitTile(slot, i420, rect, pipeline);
+        }
+    }
+    for (uint32_t i = 0; i < SLOT_COUNT; i++)
+    {
+        const uint32_t slot = (tile + i) % SLOT_COUNT;
+        success             = finishTile(slot, success ? dst : nullptr, dstStride) && success;
+    }
+    return success;
+}
+
+bool LutProcessor::submitTile(uint32_t index, const yuv::Frame &frame, const VkRect2D &rect, VkPipeline pipeline)
+{
+    Slot &slot = mSlots[index];
+
+    // The tiles and the frame have even sizes, the chroma of a tile is its half
+    const uint32_t chromaX      = rect.offset.x / 2;
+    const uint32_t chromaY      = rect.offset.y / 2;
+    const uint32_t chromaWidth  = rect.extent.width / 2;
+    const uint32_t chromaHeight = rect.extent.height / 2;
+
+    // Y, U and V packed one after the other
+    const VkExtent3D   extents[INPUT_COUNT] = {{rect.extent.width, rect.extent.height, 1},
+                                               {chromaWidth, chromaHeight, 1},
+                                               {chromaWidth, chromaHeight, 1}};
+    const uint8_t     *planes[INPUT_COUNT]  = {frame.y + rect.offset.y * frame.yStride + rect.offset.x,
+                                               frame.u + chromaY * frame.uStride + chromaX,
+                                               frame.v + chromaY * frame.vStride + chromaX};
+    const uint32_t     strides[INPUT_COUNT] = {frame.yStride, frame.uStride, frame.vStride};
+    VkBufferImageCopy  regions[INPUT_COUNT] = {};
+    uint8_t           *upload               = static_cast<uint8_t *>(slot.upload->getMappedData());
+    VkDeviceSize       offset               = 0;
+    for (uint32_t i = 0; i < INPUT_COUNT; i++)
+    {
+        for (uint32_t row = 0; row < extents[i].height; row++)
+        {
+            memcpy(upload + offset + row * extents[i].width, planes[i] + row * strides[i], extents[i].width);
+        }
+        regions[i].bufferOffset     = offset;
+        regions[i].imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        regions[i].imageExtent      = extents[i];
+        offset += extents[i].width * extents[i].height;
+    }
+
+    const VkCommandBuffer          commandBuffer = slot.commandBuffer;
+    const VkCommandBufferBeginInfo beginInfo     = {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext            = nullptr,
+            .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = nullptr,
+    };
+    CALL_VK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+    // The previous tile of the slot has completed (fence), all content is overwritten
+    VkImageMemoryBarrier barriers[INPUT_COUNT + 1];
+    for (uint32_t i = 0; i < INPUT_COUNT + 1; i++)
+    {
+        barriers[i]                  = vks::initializers::imageMemoryBarrier();
+        barriers[i].srcAccessMask    = 0;
+        barriers[i].dstAccessMask    = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers[i].oldLayout        = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[i].newLayout        = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[i].image            = i < INPUT_COUNT ? slot.inputs[i]->getImageHandle() : slot.output->getImageHandle();
+        barriers[i].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                         nullptr, 0, nullptr, INPUT_COUNT, barriers);
+    for (uint32_t i = 0; i < INPUT_COUNT; i++)
+    {
+        vkCmdCopyBufferToImage(commandBuffer, slot.upload->getBufferHandle(), slot.inputs[i]->getImageHandle(),
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &regions[i]);
+        barriers[i].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barriers[i].oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[i].newLayout     = VK_IMAGE_LAYOUT_GENERAL;
+    }
+    barriers[INPUT_COUNT].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[INPUT_COUNT].newLayout     = VK_IMAGE_LAYOUT_GENERAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0,
+                         nullptr, 0, nullptr, INPUT_COUNT + 1, barriers);
+
+    const PushConstants pushConstants = {
+        {static_cast<int32_t>(rect.extent.width), static_cast<int32_t>(rect.extent.height)},
+        {static_cast<int32_t>(chromaWidth), static_cast<int32_t>(chromaHeight)},
+    };
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout.handle(), 0, 1,
+                            &slot.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, mPipelineLayout.handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants),
+                       &pushConstants);
+    const uint32_t workGroupSize = mDeviceWrapper->workGroupSize;
+    vkCmdDispatch(commandBuffer, (rect.extent.width + workGroupSize - 1) / workGroupSize,
+                  (rect.extent.height + workGroupSize - 1) / workGroupSize, 1);
+
+    VkImageMemoryBarrier &outputBarrier = barriers[INPUT_COUNT];
+    outputBarrier.srcAccessMask         = VK_ACCESS_SHADER_WRITE_BIT;
+    outputBarrier.dstAccessMask         = VK_ACCESS_TRANSFER_READ_BIT;
+    outputBarrier.oldLayout             = VK_IMAGE_LAYOUT_GENERAL;
+    outputBarrier.newLayout             = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &outputBarrier);
+
+    // Tightly packed rows of the tile
+    VkBufferImageCopy readbackRegion = {};
+    readbackRegion.imageSubresource  = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    readbackRegion.imageExtent       = extents[0];
+    vkCmdCopyImageToBuffer(commandBuffer, slot.output->getImageHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           slot.readback->getBufferHandle(), 1, &readbackRegion);
+
+    VkBufferMemoryBarrier hostBarrier = vks::initializers::bufferMemoryBarrier();
+    hostBarrier.srcAccessMask         = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask         = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.buffer                = slot.readback->getBufferHandle();
+    hostBarrier.size                  = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1,
+                         &hostBarrier, 0, nullptr);
+    CALL_VK(vkEndCommandBuffer(commandBuffer));
+
+    VkSubmitInfo submitInfo       = vks::initializers::submitInfo();
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers    = &commandBuffer;
+    if (vkQueueSubmit(mQueue, 1, &submitInfo, mFences[index].handle()) != VK_SUCCESS)
+    {
+        LOGCATE("LutProcessor: Failed to submit the tile at %d,%d", rect.offset.x, rect.offset.y);
+        return false;
+    }
+    slot.pending = rect;
+    return true;
+}
+
+bool LutProcessor::finishTile(uint32_t index, uint8_t *dst, uint32_t dstStride)
+{
+    Slot &slot = mSlots[index];
+    if (slot.pending.extent.width == 0)
+        return true;
+
+    const VkDevice device = mDeviceWrapper->logicalDevice;
+    const VkResult result = vkWaitForFences(device, 1, mFences[index].pHandle(), VK_TRUE, UINT64_MAX);
+    vkResetFences(device, 1, mFences[index].pHandle());
+    const VkRect2D rect = slot.pending;
+    slot.pending        = {};
+    if (result != VK_SUCCESS)
+    {
+        LOGCATE("LutProcessor: Failed to wait for the tile at %d,%d", rect.offset.x, rect.offset.y);
+        return false;
+    }
+    if (dst == nullptr)
+        return true;
+
+    // No-op on coherent memory
+    slot.readback->invalidate();
+    const uint8_t *src      = static_cast<const uint8_t *>(slot.readback->getMappedData());
+    const uint32_t rowBytes = rect.extent.width * 4;
+    for (uint32_t row = 0; row < rect.extent.height; row++)
+    {
+        memcpy(dst + static_cast<size_t>(rect.offset.y + row) * dstStride + rect.offset.x * 4, src + row * rowBytes,
+               rowBytes);
+    }
+    return true;
+}
+}        // namespace vks
@@ -0,0 +1,152 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANLUTPROCESSOR_H
+#define GAINVULKANSAMPLE_VULKANLUTPROCESSOR_H
+
+#include <memory>
+#include <vulkan_wrapper.h>
+
+#include "VulkanBufferWrapper.h"
+#include "VulkanDeviceWrapper.hpp"
+#include "VulkanImageWrapper.h"
+#include "util/VulkanRAIIUtil.h"
+#include "util/YUVUtil.h"
+
+namespace vks
+{
+// Converts camera frames to RGB and applies a 3D LUT offscreen at full resolution
+// (shaders/lut_apply.comp), the result is read back into memory of the caller.
+//
+// Frames of any size are processed in tiles of tileSize x tileSize pixels, so the device memory
+// used and the length of a submission do not grow with the frame. Two tiles are in flight: while
+// the GPU processes one, the host copies the next one in and the previous result out.
+//
+// The work is submitted to the queue on the calling thread, it must not be used by another
+// thread during process().
+class LutProcessor
+{
+  public:
+    enum class Interpolation : uint32_t
+    {
+        // Filtered by the sampler from the 8 texels around the color
+        TRILINEAR = 0,
+        // Weighted from 4 of the 8 texels, keeps the grays of the LUT gray
+        TETRAHEDRAL = 1,
+    };
+
+    static constexpr uint32_t DEFAULT_TILE_SIZE = 1024;
+
+    // Compute shader to be loaded with VulkanContextBase::loadShader
+    static const char *shaderPath();
+
+    /**
+     * @param queue Queue of the graphics family, the LUT is sampled as uploaded by UploadManager
+     * @param shaderStage Stage of shaderPath()
+     * @param tileSize Width and height of the tiles in pixels, rounded down to an even size
+     */
+    static std::unique_ptr<LutProcessor> create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper,
+                                                VkQueue queue, VkPipelineCache pipelineCache,
+                                                const VkPipelineShaderStageCreateInfo &shaderStage,
+                                                uint32_t tileSize = DEFAULT_TILE_SIZE);
+
+    // Prefer LutProcessor::create
+    LutProcessor(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue,
+                 VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage,
+                 uint32_t tileSize);
+
+    ~LutProcessor();
+
+    // The LUT is a 3D image in the layout of its descriptor, e.g. created by
+    // Image::create3DImageFromBitmap or baked by LutChain. It has to stay alive until the next
+    // setLut() call. process() waits for its upload, the caller for anything else writing it.
+    void setLut(const Image *lut);
+
+    /**
+     * Apply the LUT to the frame and write frame.width x frame.height RGBA8 pixels to dst.
+     * Blocks until dst is written.
+     *
+     * @param dstStride Bytes between the rows of dst, at least frame.width * 4
+     */
+    bool process(const yuv::Frame &frame, Interpolation interpolation, uint8_t *dst, uint32_t dstStride);
+
+    uint32_t tileSize() const
+    {
+        return mTileSize;
+    }
+
+  private:
+    static constexpr uint32_t SLOT_COUNT  = 2;
+    static constexpr uint32_t INPUT_COUNT = 3;
+
+    // Resources of a tile in flight
+    struct Slot
+    {
+        // Y, U and V of the tile, packed
+        std::unique_ptr<Image>  inputs[INPUT_COUNT];
+        std::unique_ptr<Image>  output;
+        std::unique_ptr<Buffer> upload;
+        std::unique_ptr<Buffer> readback;
+        VkCommandBuffer         commandBuffer = VK_NULL_HANDLE;
+        VkDescriptorSet         descriptorSet = VK_NULL_HANDLE;
+
+        // Pixels of the frame being processed or waiting in readback, width 0 if there are none
+        VkRect2D pending = {};
+    };
+
+    bool prepare();
+
+    bool prepareSlot(uint32_t index);
+
+    // Pipeline specialized for the interpolation, created on first use
+    VkPipeline pipeline(Interpolation interpolation);
+
+    // Copy the tile of the I420 frame to the slot and submit its processing
+    bool submitTile(uint32_t index, const yuv::Frame &frame, const VkRect2D &rect, VkPipeline pipeline);
+
+    // Wait for the tile of the slot, if any, and copy its result to dst unless it is nullptr
+    bool finishTile(uint32_t index, uint8_t *dst, uint32_t dstStride);
+
+    const std::shared_ptr<VulkanDeviceWrapper> mDeviceWrapper;
+    VkQueue                                    mQueue;
+    VkPipelineCache                            mPipelineCache;
+    const VkPipelineShaderStageCreateInfo      mShaderStage;
+    const uint32_t                             mTileSize;
+
+    const Image *mLut = nullptr;
+
+    VulkanCommandPool         mCommandPool;
+    VulkanDescriptorPool      mDescriptorPool;
+    VulkanDescriptorSetLayout mDescriptorSetLayout;
+    VulkanPipelineLayout      mPipelineLayout;
+    VulkanPipeline            mPipelines[2];
+    VulkanFence               mFences[SLOT_COUNT];
+    Slot                      mSlots[SLOT_COUNT];
+
+    // Camera planes to packed I420, reused between the frames
+    yuv::I420Unpacker mUnpacker;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANLUTPROCESSOR_H
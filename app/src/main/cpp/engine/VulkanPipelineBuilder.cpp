@@ -0,0 +1,67 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "VulkanPipelineBuilder.h"
+
+#include <LogUtil.h>
+
+namespace vks
+{
+std::unique_ptr<PipelineBuilder> PipelineBuilder::create(VkDevice device, VkPipelineCache pipelineCache,
+                                                         uint32_t threadCount)
+{
+    return std::make_unique<PipelineBuilder>(device, pipelineCache, threadCount);
+}
+
+PipelineBuilder::PipelineBuilder(VkDevice device, VkPipelineCache pipelineCache, uint32_t threadCount) :
+    mDevice(device), mPipelineCache(pipelineCache), mPool(threadCount)
+{}
+
+std::future<VkPipeline> PipelineBuilder::createGraphicsPipeline(const VkGraphicsPipelineCreateInfo &createInfo)
+{
+    return mPool.submit([this, createInfo]() {
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (vkCreateGraphicsPipelines(mDevice, mPipelineCache, 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
+        {
+            LOGCATE("PipelineBuilder: Failed to create a graphics pipeline");
+            return static_cast<VkPipeline>(VK_NULL_HANDLE);
+        }
+        return pipeline;
+    });
+}
+
+std::future<VkPipeline> PipelineBuilder::createComputePipeline(const VkComputePipelineCreateInfo &createInfo)
+{
+    return mPool.submit([this, createInfo]() {
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (vkCreateComputePipelines(mDevice, mPipelineCache, 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
+        {
+            LOGCATE("PipelineBuilder: Failed to create a compute pipeline");
+            return static_cast<VkPipeline>(VK_NULL_HANDLE);
+        }
+        return pipeline;
+    });
+}
+}        // namespace vks
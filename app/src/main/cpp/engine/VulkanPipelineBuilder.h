@@ -0,0 +1,77 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef GAINVULKANSAMPLE_VULKANPIPELINEBUILDER_H
+#define GAINVULKANSAMPLE_VULKANPIPELINEBUILDER_H
+
+#include <future>
+#include <memory>
+#include <vulkan_wrapper.h>
+
+#include "util/ThreadPool.h"
+
+namespace vks
+{
+// Compiles pipelines on worker threads so that the pipelines of a sample are built in parallel.
+//
+// All the pipelines go through the same VkPipelineCache, which is internally synchronized. A
+// create info and all the state it points to (stages, specialization, fixed function states) is
+// read by the worker, it must stay valid until the future is ready. Pipelines whose state is
+// built on the fly are better created from a task given to run().
+class PipelineBuilder
+{
+  public:
+    // threadCount 0 uses one thread per core
+    static std::unique_ptr<PipelineBuilder> create(VkDevice device, VkPipelineCache pipelineCache,
+                                                   uint32_t threadCount = 0);
+
+    // Prefer PipelineBuilder::create
+    PipelineBuilder(VkDevice device, VkPipelineCache pipelineCache, uint32_t threadCount);
+
+    // The futures hold VK_NULL_HANDLE if the creation failed
+    std::future<VkPipeline> createGraphicsPipeline(const VkGraphicsPipelineCreateInfo &createInfo);
+
+    std::future<VkPipeline> createComputePipeline(const VkComputePipelineCreateInfo &createInfo);
+
+    // Run a task creating a pipeline (or anything else) on a worker
+    template <typename F>
+    auto run(F &&task) -> std::future<decltype(task())>
+    {
+        return mPool.submit(std::forward<F>(task));
+    }
+
+    VkPipelineCache pipelineCache() const
+    {
+        return mPipelineCache;
+    }
+
+  private:
+    const VkDevice        mDevice;
+    const VkPipelineCache mPipelineCache;
+    ThreadPool            mPool;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANPIPELINEBUILDER_H
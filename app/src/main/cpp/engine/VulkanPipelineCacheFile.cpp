@@ -0,0 +1,165 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanPipelineCacheFile.h"
+
+#include <LogUtil.h>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+namespace vks
+{
+namespace
+{
+constexpr uint32_t kMagic         = 0x43505647;        // "GVPC"
+constexpr uint32_t kHeaderVersion = 1;
+
+struct FileCloser
+{
+    void operator()(FILE *file) const
+    {
+        fclose(file);
+    }
+};
+using FilePtr = std::unique_ptr<FILE, FileCloser>;
+}        // namespace
+
+std::unique_ptr<PipelineCacheFile> PipelineCacheFile::create(const std::string &directory,
+                                                             const VkPhysicalDeviceProperties &properties)
+{
+    if (directory.empty())
+        return nullptr;
+    return std::make_unique<PipelineCacheFile>(directory + "/pipeline_cache.bin", properties);
+}
+
+PipelineCacheFile::PipelineCacheFile(const std::string &path, const VkPhysicalDeviceProperties &properties) :
+    mPath(path), mProperties(properties)
+{}
+
+uint64_t PipelineCacheFile::checksum(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+PipelineCacheFile::Header PipelineCacheFile::makeHeader(uint64_t dataSize, uint64_t dataChecksum) const
+{
+    Header header        = {};
+    header.magic         = kMagic;
+    header.headerVersion = kHeaderVersion;
+    header.vendorID      = mProperties.vendorID;
+    header.deviceID      = mProperties.deviceID;
+    header.driverVersion = mProperties.driverVersion;
+    memcpy(header.pipelineCacheUUID, mProperties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = dataSize;
+    header.checksum = dataChecksum;
+    return header;
+}
+
+std::vector<uint8_t> PipelineCacheFile::load()
+{
+    FilePtr file(fopen(mPath.c_str(), "rb"));
+    if (!file)
+        return {};
+
+    Header header;
+    if (fread(&header, sizeof(header), 1, file.get()) != 1)
+    {
+        LOGCATE("PipelineCacheFile: %s has no header", mPath.c_str());
+        return {};
+    }
+
+    const Header expected = makeHeader(header.dataSize, header.checksum);
+    if (memcmp(&header, &expected, sizeof(Header)) != 0)
+    {
+        // Another driver (e.g. after a system update) would reject or, worse, misuse the data
+        LOGCATI("PipelineCacheFile: %s was written by another device or driver, ignored", mPath.c_str());
+        return {};
+    }
+
+    // The size comes from the file, it is checked against the bytes really there before allocating
+    struct stat info;
+    if (fstat(fileno(file.get()), &info) != 0 ||
+        header.dataSize != static_cast<uint64_t>(info.st_size) - sizeof(Header))
+    {
+        LOGCATE("PipelineCacheFile: %s is truncated or corrupted, ignored", mPath.c_str());
+        return {};
+    }
+
+    std::vector<uint8_t> data(header.dataSize);
+    if (fread(data.data(), 1, data.size(), file.get()) != data.size() ||
+        checksum(data.data(), data.size()) != header.checksum)
+    {
+        LOGCATE("PipelineCacheFile: %s is truncated or corrupted, ignored", mPath.c_str());
+        return {};
+    }
+
+    mSavedSize = data.size();
+    return data;
+}
+
+bool PipelineCacheFile::save(VkDevice device, VkPipelineCache cache)
+{
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS || size == 0)
+        return false;
+    // The cache only grows, the same size means no pipeline was added
+    if (size == mSavedSize)
+        return true;
+
+    std::vector<uint8_t> data(size);
+    if (vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS)
+        return false;
+    data.resize(size);
+
+    const Header       header  = makeHeader(data.size(), checksum(data.data(), data.size()));
+    const std::string  tmpPath = mPath + ".tmp";
+    {
+        FilePtr file(fopen(tmpPath.c_str(), "wb"));
+        if (!file || fwrite(&header, sizeof(header), 1, file.get()) != 1 ||
+            fwrite(data.data(), 1, data.size(), file.get()) != data.size() || fflush(file.get()) != 0)
+        {
+            LOGCATE("PipelineCacheFile: Failed to write %s", tmpPath.c_str());
+            remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (rename(tmpPath.c_str(), mPath.c_str()) != 0)
+    {
+        LOGCATE("PipelineCacheFile: Failed to replace %s", mPath.c_str());
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    LOGCATI("PipelineCacheFile: saved %zu bytes to %s", data.size(), mPath.c_str());
+    mSavedSize = data.size();
+    return true;
+}
+}        // namespace vks
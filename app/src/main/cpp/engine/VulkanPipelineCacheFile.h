@@ -0,0 +1,90 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANPIPELINECACHEFILE_H
+#define GAINVULKANSAMPLE_VULKANPIPELINECACHEFILE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <vulkan_wrapper.h>
+
+namespace vks
+{
+// Persists the content of a VkPipelineCache between launches.
+//
+// The file starts with a header naming the device and driver the data was produced by and a
+// checksum of the data. A file written by another device or driver version, a truncated or a
+// corrupted one is ignored, the pipelines are then compiled from scratch and the file is replaced
+// on the next save.
+class PipelineCacheFile
+{
+  public:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t headerVersion;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+        // Keeps the header free of padding, it is compared with memcmp
+        uint32_t reserved;
+        uint64_t dataSize;
+        // FNV-1a of the data
+        uint64_t checksum;
+    };
+
+    static std::unique_ptr<PipelineCacheFile> create(const std::string &directory,
+                                                     const VkPhysicalDeviceProperties &properties);
+
+    // Prefer PipelineCacheFile::create
+    PipelineCacheFile(const std::string &path, const VkPhysicalDeviceProperties &properties);
+
+    // Returns the data of a valid file, empty if there is none
+    std::vector<uint8_t> load();
+
+    // Write the cache content if it grew since the last load or save. The file is replaced
+    // atomically, a crash while saving leaves the previous file.
+    bool save(VkDevice device, VkPipelineCache cache);
+
+    const std::string &path() const
+    {
+        return mPath;
+    }
+
+    static uint64_t checksum(const uint8_t *data, size_t size);
+
+  private:
+    Header makeHeader(uint64_t dataSize, uint64_t dataChecksum) const;
+
+    const std::string                mPath;
+    const VkPhysicalDeviceProperties mProperties;
+
+    // Size of the data last loaded or written
+    size_t mSavedSize = 0;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANPIPELINECACHEFILE_H
@@ -0,0 +1,98 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "VulkanShaderLibrary.h"
+
+#include <LogUtil.h>
+#include <vector>
+
+#include "VulkanPipelineCacheFile.h"
+
+namespace vks
+{
+std::unique_ptr<ShaderLibrary> ShaderLibrary::create(VkDevice device, std::shared_ptr<AssetLoader> assets)
+{
+    return std::make_unique<ShaderLibrary>(device, std::move(assets));
+}
+
+ShaderLibrary::ShaderLibrary(VkDevice device, std::shared_ptr<AssetLoader> assets) :
+    mDevice(device), mAssets(std::move(assets))
+{}
+
+VkShaderModule ShaderLibrary::module(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto                        it = mModulesByPath.find(path);
+    if (it != mModulesByPath.end())
+        return it->second;
+
+    VkShaderModule module = createModule(path);
+    if (module != VK_NULL_HANDLE)
+    {
+        mModulesByPath.emplace(path, module);
+    }
+    return module;
+}
+
+VkShaderModule ShaderLibrary::createModule(const std::string &path)
+{
+    std::vector<uint8_t> code;
+    if (!mAssets->read(path, code) || code.empty())
+    {
+        LOGCATE("ShaderLibrary: %s not found", path.c_str());
+        return VK_NULL_HANDLE;
+    }
+    const size_t size = code.size();
+
+    const uint64_t hash  = PipelineCacheFile::checksum(code.data(), size) ^ size;
+    auto           range = mModulesByHash.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second.code == code)
+        {
+            return it->second.module.handle();
+        }
+    }
+
+    // vkCreateShaderModule wants the code 4-byte aligned, which the allocation of the vector is
+    const VkShaderModuleCreateInfo shaderDesc = {
+        .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .flags    = 0,
+        .codeSize = size,
+        .pCode    = reinterpret_cast<const uint32_t *>(code.data()),
+    };
+    VulkanShaderModule shaderModule(mDevice);
+    VkResult           result = vkCreateShaderModule(mDevice, &shaderDesc, nullptr, shaderModule.pHandle());
+    if (result != VK_SUCCESS)
+    {
+        LOGCATE("ShaderLibrary: Failed to create the module of %s (%d)", path.c_str(), result);
+        return VK_NULL_HANDLE;
+    }
+
+    const VkShaderModule handle = shaderModule.handle();
+    mModulesByHash.emplace(hash, Module{std::move(code), std::move(shaderModule)});
+    return handle;
+}
+}        // namespace vks
@@ -0,0 +1,79 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef GAINVULKANSAMPLE_VULKANSHADERLIBRARY_H
+#define GAINVULKANSAMPLE_VULKANSHADERLIBRARY_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan_wrapper.h>
+
+#include "util/AssetUtil.h"
+#include "util/VulkanRAIIUtil.h"
+
+namespace vks
+{
+// Shader modules loaded from the SPIR-V assets, shared by all the pipelines of a context.
+//
+// Each asset is read and each module created once: a path is looked up first, then the SPIR-V
+// itself so that identical code under different paths shares a module too. The code is kept with
+// its module and compared byte for byte on a hash match, a collision never hands out the module of
+// another shader. The modules live as long as the library, pipelines may be created from them at
+// any time (e.g. on the workers of PipelineBuilder).
+// Thread safe.
+class ShaderLibrary
+{
+  public:
+    // Prefer ShaderLibrary::create
+    ShaderLibrary(VkDevice device, std::shared_ptr<AssetLoader> assets);
+
+    static std::unique_ptr<ShaderLibrary> create(VkDevice device, std::shared_ptr<AssetLoader> assets);
+
+    // Module of the asset at path, VK_NULL_HANDLE if it can't be read. Not to be destroyed by the caller.
+    VkShaderModule module(const std::string &path);
+
+  private:
+    struct Module
+    {
+        std::vector<uint8_t> code;
+        VulkanShaderModule   module;
+    };
+
+    VkShaderModule createModule(const std::string &path);
+
+    const VkDevice               mDevice;
+    std::shared_ptr<AssetLoader> mAssets;
+
+    std::mutex mMutex;
+    // All the modules by hash of their code, owned
+    std::unordered_multimap<uint64_t, Module>       mModulesByHash;
+    std::unordered_map<std::string, VkShaderModule> mModulesByPath;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANSHADERLIBRARY_H
@@ -0,0 +1,298 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanStagingRing.h"
+
+#include <LogUtil.h>
+#include <algorithm>
+#include <assert.h>
+#include <cstring>
+
+#include "VulkanDebug.h"
+
+namespace vks
+{
+namespace
+{
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+}        // namespace
+
+std::unique_ptr<StagingRing> StagingRing::create(VkDevice device, const VkPhysicalDeviceMemoryProperties &memoryProperties,
+                                                 VkDeviceSize capacity, VkDeviceSize alignment)
+{
+    auto       ring    = std::make_unique<StagingRing>(device, memoryProperties, alignment);
+    const bool success = ring->createBuffer(capacity);
+    return success ? std::move(ring) : nullptr;
+}
+
+StagingRing::StagingRing(VkDevice device, const VkPhysicalDeviceMemoryProperties &memoryProperties, VkDeviceSize alignment) :
+    mDevice(device), mMemoryProperties(memoryProperties), mAlignment(std::max<VkDeviceSize>(alignment, 4)), mBuffer(device), mMemory(device)
+{}
+
+StagingRing::~StagingRing()
+{
+    // The GPU may still be reading from the ring
+    for (const auto &frame : mInFlight)
+    {
+        vkWaitForFences(mDevice, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+    }
+    if (mMapped)
+    {
+        vkUnmapMemory(mDevice, mMemory.handle());
+    }
+}
+
+bool StagingRing::createBuffer(VkDeviceSize capacity)
+{
+    capacity = alignUp(capacity, mAlignment);
+
+    VulkanBuffer       buffer(mDevice);
+    VulkanDeviceMemory memory(mDevice);
+
+    const VkBufferCreateInfo bufferCreateInfo = {
+        .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size        = capacity,
+        .usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    CALL_VK(vkCreateBuffer(mDevice, &bufferCreateInfo, nullptr, buffer.pHandle()));
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(mDevice, buffer.handle(), &memoryRequirements);
+
+    // The ring is written sequentially by the CPU and never read back, coherent memory saves
+    // the explicit flushes
+    const VkMemoryPropertyFlags properties      = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    uint32_t                    memoryTypeIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; i++)
+    {
+        if ((memoryRequirements.memoryTypeBits & (1u << i)) &&
+            (mMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            memoryTypeIndex = i;
+            break;
+        }
+    }
+    if (memoryTypeIndex == UINT32_MAX)
+    {
+        LOGCATE("StagingRing: no host visible coherent memory type");
+        return false;
+    }
+
+    const VkMemoryAllocateInfo allocateInfo = {
+        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext           = nullptr,
+        .allocationSize  = memoryRequirements.size,
+        .memoryTypeIndex = memoryTypeIndex,
+    };
+    CALL_VK(vkAllocateMemory(mDevice, &allocateInfo, nullptr, memory.pHandle()));
+    CALL_VK(vkBindBufferMemory(mDevice, buffer.handle(), memory.handle(), 0));
+
+    void *mapped = nullptr;
+    CALL_VK(vkMapMemory(mDevice, memory.handle(), 0, VK_WHOLE_SIZE, 0, &mapped));
+
+    vks::debug::setDeviceMemoryName(mDevice, memory.handle(), "VulkanResources-StagingRing-mMemory");
+
+    if (mBuffer.handle() != VK_NULL_HANDLE)
+    {
+        // Allocations handed out before the growth may not be submitted yet, keep the old buffer
+        // alive until the next frame retires
+        mOrphans.push_back({std::move(mBuffer), std::move(mMemory)});
+    }
+    mBuffer   = std::move(buffer);
+    mMemory   = std::move(memory);
+    mMapped   = static_cast<uint8_t *>(mapped);
+    mCapacity = capacity;
+
+    // Frames still in flight refer to the old buffer, they must not move the new ring's tail
+    mGeneration++;
+    mHead      = 0;
+    mTail      = 0;
+    mUsed      = 0;
+    mOpenBytes = 0;
+
+    LOGCATI("StagingRing: capacity %llu bytes", static_cast<unsigned long long>(capacity));
+    return true;
+}
+
+bool StagingRing::allocate(VkDeviceSize size, Allocation *allocation)
+{
+    if (allocation == nullptr || size == 0)
+        return false;
+
+    const VkDeviceSize alignedSize = alignUp(size, mAlignment);
+
+    reclaim(false);
+
+    while (true)
+    {
+        if (mUsed == 0)
+        {
+            mHead = 0;
+            mTail = 0;
+        }
+
+        VkDeviceSize offset = UINT64_MAX;
+        if (mHead >= mTail && (mUsed == 0 || mHead != mTail))
+        {
+            // Free space is [mHead, mCapacity) and [0, mTail)
+            if (mCapacity - mHead >= alignedSize)
+            {
+                offset = mHead;
+            }
+            else if (mTail >= alignedSize)
+            {
+                // Skip the end of the ring, the padding is released together with the frame
+                const VkDeviceSize padding = mCapacity - mHead;
+                mUsed += padding;
+                mOpenBytes += padding;
+                offset = 0;
+            }
+        }
+        else if (mHead < mTail && mTail - mHead >= alignedSize)
+        {
+            offset = mHead;
+        }
+
+        if (offset != UINT64_MAX)
+        {
+            mHead = offset + alignedSize;
+            mUsed += alignedSize;
+            mOpenBytes += alignedSize;
+
+            allocation->buffer = mBuffer.handle();
+            allocation->offset = offset;
+            allocation->size   = size;
+            allocation->data   = mMapped + offset;
+
+            mStats.bytesStreamed += size;
+            mStats.allocations++;
+            return true;
+        }
+
+        if (!mInFlight.empty() && alignedSize <= mCapacity)
+        {
+            // Wait for the GPU to release the oldest frame and try again
+            mStats.stalls++;
+            reclaim(true);
+            continue;
+        }
+
+        // Either the request is larger than the ring or the frame being recorded filled it up
+        mStats.grows++;
+        LOGCATI("StagingRing: growing for a %llu bytes upload", static_cast<unsigned long long>(size));
+        if (!createBuffer(std::max(mCapacity * 2, alignedSize)))
+            return false;
+    }
+}
+
+bool StagingRing::upload(const void *data, VkDeviceSize size, Allocation *allocation)
+{
+    if (!allocate(size, allocation))
+        return false;
+    memcpy(allocation->data, data, size);
+    return true;
+}
+
+VkFence StagingRing::closeFrame(bool force)
+{
+    if (!force && mOpenBytes == 0 && mOrphans.empty())
+        return VK_NULL_HANDLE;
+
+    Frame frame;
+    frame.fence      = acquireFence();
+    frame.end        = mHead;
+    frame.bytes      = mOpenBytes;
+    frame.generation = mGeneration;
+    frame.serial     = ++mClosedSerial;
+    frame.orphans    = std::move(mOrphans);
+    mOrphans.clear();
+    mInFlight.push_back(std::move(frame));
+
+    mOpenBytes = 0;
+    return mInFlight.back().fence;
+}
+
+void StagingRing::reclaim(bool wait)
+{
+    if (wait && !mInFlight.empty())
+    {
+        CALL_VK(vkWaitForFences(mDevice, 1, &mInFlight.front().fence, VK_TRUE, UINT64_MAX));
+    }
+
+    // Frames are submitted in order, so they are retired in order as well
+    while (!mInFlight.empty() && vkGetFenceStatus(mDevice, mInFlight.front().fence) == VK_SUCCESS)
+    {
+        Frame &frame = mInFlight.front();
+        if (frame.generation == mGeneration)
+        {
+            mTail = frame.end;
+            mUsed -= frame.bytes;
+        }
+        mRetiredSerial = frame.serial;
+        CALL_VK(vkResetFences(mDevice, 1, &frame.fence));
+        mFreeFences.push_back(frame.fence);
+        mInFlight.pop_front();
+    }
+}
+
+bool StagingRing::isRetired(uint64_t serial)
+{
+    if (serial > mRetiredSerial)
+    {
+        reclaim(false);
+    }
+    return serial <= mRetiredSerial;
+}
+
+void StagingRing::waitRetired(uint64_t serial)
+{
+    assert(serial <= mClosedSerial);
+    while (serial > mRetiredSerial)
+    {
+        reclaim(true);
+    }
+}
+
+VkFence StagingRing::acquireFence()
+{
+    if (mFreeFences.empty())
+    {
+        const VkFenceCreateInfo fenceInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+        };
+        mFences.emplace_back(mDevice);
+        CALL_VK(vkCreateFence(mDevice, &fenceInfo, nullptr, mFences.back().pHandle()));
+        return mFences.back().handle();
+    }
+    VkFence fence = mFreeFences.back();
+    mFreeFences.pop_back();
+    return fence;
+}
+}        // namespace vks
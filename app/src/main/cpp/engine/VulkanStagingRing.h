@@ -0,0 +1,174 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANSTAGINGRING_H
+#define GAINVULKANSAMPLE_VULKANSTAGINGRING_H
+
+#include <deque>
+#include <memory>
+#include <vector>
+#include <vulkan_wrapper.h>
+
+#include "util/VulkanRAIIUtil.h"
+
+namespace vks
+{
+// A persistent, persistently mapped host visible buffer used as the source of buffer->image and
+// buffer->buffer copies. Uploads sub-allocate from it linearly, the space is handed back in
+// batches ("frames"): closeFrame() returns a fence that the submission consuming the allocations
+// must signal, the region is reused once that fence has signaled. Steady state streaming (e.g. a
+// camera frame every draw) therefore does not create any Vulkan object.
+class StagingRing
+{
+  public:
+    struct Allocation
+    {
+        VkBuffer     buffer = VK_NULL_HANDLE;
+        // Offset into buffer, use it as VkBufferImageCopy::bufferOffset / VkBufferCopy::srcOffset
+        VkDeviceSize offset = 0;
+        VkDeviceSize size   = 0;
+        // Host pointer of the allocation, valid until the owning frame is retired
+        void *data = nullptr;
+    };
+
+    struct Stats
+    {
+        // Total bytes handed out by allocate()
+        uint64_t bytesStreamed = 0;
+        uint64_t allocations   = 0;
+        // Number of times allocate() had to block on an in flight fence to get space back
+        uint32_t stalls = 0;
+        // Number of times the ring was recreated because a single request did not fit
+        uint32_t grows = 0;
+    };
+
+    static std::unique_ptr<StagingRing> create(VkDevice device, const VkPhysicalDeviceMemoryProperties &memoryProperties,
+                                               VkDeviceSize capacity, VkDeviceSize alignment);
+
+    // Prefer StagingRing::create
+    StagingRing(VkDevice device, const VkPhysicalDeviceMemoryProperties &memoryProperties, VkDeviceSize alignment);
+
+    ~StagingRing();
+
+    /**
+     * Sub-allocate size bytes from the ring, blocks if the space is still used by the GPU
+     *
+     * @param size Number of bytes to allocate
+     * @param allocation Filled with the buffer, offset and mapped pointer of the allocation
+     *
+     * @return false if the ring could not provide the space
+     */
+    bool allocate(VkDeviceSize size, Allocation *allocation);
+
+    // Allocate and copy data into the ring in one go
+    bool upload(const void *data, VkDeviceSize size, Allocation *allocation);
+
+    /**
+     * Close the current frame. All the allocations made since the previous call are released once
+     * the returned fence signals, so it has to be passed to the vkQueueSubmit that reads them
+     * (an unsubmitted fence would block the next stall forever).
+     * Returns VK_NULL_HANDLE if nothing was allocated, unless force is set.
+     */
+    VkFence closeFrame(bool force = false);
+
+    // Serial of the frame closed by the last closeFrame call, frames are numbered from 1
+    uint64_t lastClosedSerial() const
+    {
+        return mClosedSerial;
+    }
+
+    // Whether the frame with the given serial has been retired, i.e. its fence has signaled
+    bool isRetired(uint64_t serial);
+
+    // Block until the frame with the given serial is retired
+    void waitRetired(uint64_t serial);
+
+    VkDeviceSize capacity() const
+    {
+        return mCapacity;
+    }
+
+    const Stats &stats() const
+    {
+        return mStats;
+    }
+
+  private:
+    // A buffer replaced by a bigger one, destroyed once the frame it is attached to retires
+    struct Orphan
+    {
+        VulkanBuffer       buffer;
+        VulkanDeviceMemory memory;
+    };
+
+    struct Frame
+    {
+        VkFence      fence = VK_NULL_HANDLE;
+        // Ring position right after the last allocation of the frame
+        VkDeviceSize end = 0;
+        // Bytes of the frame including the padding skipped when wrapping around
+        VkDeviceSize        bytes      = 0;
+        uint32_t            generation = 0;
+        uint64_t            serial     = 0;
+        std::vector<Orphan> orphans;
+    };
+
+    bool createBuffer(VkDeviceSize capacity);
+
+    // Retire frames whose fence has signaled, blocks on the oldest one if wait is true
+    void reclaim(bool wait);
+
+    VkFence acquireFence();
+
+    VkDevice                         mDevice;
+    VkPhysicalDeviceMemoryProperties mMemoryProperties;
+    VkDeviceSize                     mAlignment;
+
+    VulkanBuffer       mBuffer;
+    VulkanDeviceMemory mMemory;
+    uint8_t *          mMapped   = nullptr;
+    VkDeviceSize       mCapacity = 0;
+
+    // Allocations are made at mHead, the bytes in [mTail, mHead) (with wrap around) are in use
+    VkDeviceSize mHead = 0;
+    VkDeviceSize mTail = 0;
+    // Bytes in use, disambiguates an empty ring from a full one when mHead == mTail
+    VkDeviceSize mUsed = 0;
+    // Bytes allocated since the last closeFrame
+    VkDeviceSize mOpenBytes = 0;
+    // Incremented every time the buffer is recreated
+    uint32_t mGeneration = 0;
+    uint64_t mClosedSerial  = 0;
+    uint64_t mRetiredSerial = 0;
+
+    std::deque<Frame>        mInFlight;
+    std::vector<Orphan>      mOrphans;
+    std::vector<VkFence>     mFreeFences;
+    std::vector<VulkanFence> mFences;
+
+    Stats mStats;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANSTAGINGRING_H
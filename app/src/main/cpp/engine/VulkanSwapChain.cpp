@@ -30,10 +30,16 @@ void VulkanSwapChain::initSurface(ANativeWindow *window)
     VkResult err = VK_SUCCESS;
 
     // Create the os-specific surface
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
     VkAndroidSurfaceCreateInfoKHR surfaceCreateInfo = {};
     surfaceCreateInfo.sType                         = VK_STRUCTURE_TYPE_ANDROID_SURFACE_CREATE_INFO_KHR;
     surfaceCreateInfo.window                        = window;
     err                                             = vkCreateAndroidSurfaceKHR(instance, &surfaceCreateInfo, NULL, &surface);
+#else
+    // Host builds only render headless, see initHeadless
+    LOGCATE("Could not create surface, window surfaces are only supported on Android!");
+    return;
+#endif
 
     if (err != VK_SUCCESS)
     {
@@ -148,6 +154,25 @@ void VulkanSwapChain::initSurface(ANativeWindow *window)
     }
 }
 
+/**
+ * Render into offscreen images instead of a window surface
+ *
+ * @param queue Queue the frames are submitted to, used to signal and consume the acquire and
+ * present semaphores
+ * @param queueFamilyIndex Family index of that queue
+ *
+ * @note No surface or VK_KHR_swapchain is required, so this also works on ICDs without any
+ * presentation support (e.g. lavapipe on a build box)
+ */
+void VulkanSwapChain::initHeadless(VkQueue queue, uint32_t queueFamilyIndex)
+{
+    headless       = true;
+    headlessQueue  = queue;
+    queueNodeIndex = queueFamilyIndex;
+    colorFormat    = VK_FORMAT_R8G8B8A8_UNORM;
+    colorSpace     = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+}
+
 /**
  * Set instance, physical and logical device to use for the swapchain and get all required function
  * pointers
@@ -177,6 +202,12 @@ void VulkanSwapChain::connect(VkInstance instance, VkPhysicalDevice physicalDevi
  */
 void VulkanSwapChain::create(int32_t *width, int32_t *height, bool vsync)
 {
+    if (headless)
+    {
+        createHeadless(*width, *height);
+        return;
+    }
+
     // Store the current swap chain handle so we can use it later on to ease up recreation
     VkSwapchainKHR oldSwapchain = swapChain;
 
@@ -352,6 +383,83 @@ void VulkanSwapChain::create(int32_t *width, int32_t *height, bool vsync)
     }
 }
 
+/**
+ * Create the offscreen images used in headless mode
+ *
+ * @param width Width of the render target
+ * @param height Height of the render target
+ */
+void VulkanSwapChain::createHeadless(uint32_t width, uint32_t height)
+{
+    // Same count as a triple buffered swap chain, so frames in flight behave the same
+    imageCount = 3;
+    images.resize(imageCount);
+    buffers.resize(imageCount);
+    headlessMemory.resize(imageCount);
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    for (uint32_t i = 0; i < imageCount; i++)
+    {
+        VkImageCreateInfo imageCI = {};
+        imageCI.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCI.imageType         = VK_IMAGE_TYPE_2D;
+        imageCI.format            = colorFormat;
+        imageCI.extent            = {width, height, 1};
+        imageCI.mipLevels         = 1;
+        imageCI.arrayLayers       = 1;
+        imageCI.samples           = VK_SAMPLE_COUNT_1_BIT;
+        imageCI.tiling            = VK_IMAGE_TILING_OPTIMAL;
+        // Transfer source so the rendered frame can be read back to the host
+        imageCI.usage         = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageCI.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+        imageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        CALL_VK(vkCreateImage(device, &imageCI, nullptr, &images[i]));
+
+        VkMemoryRequirements memReqs;
+        vkGetImageMemoryRequirements(device, images[i], &memReqs);
+
+        uint32_t memoryTypeIndex = UINT32_MAX;
+        for (uint32_t t = 0; t < memoryProperties.memoryTypeCount; t++)
+        {
+            if ((memReqs.memoryTypeBits & (1u << t)) &&
+                (memoryProperties.memoryTypes[t].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+            {
+                memoryTypeIndex = t;
+                break;
+            }
+        }
+        assert(memoryTypeIndex != UINT32_MAX);
+
+        VkMemoryAllocateInfo memAlloc = {};
+        memAlloc.sType                = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        memAlloc.allocationSize       = memReqs.size;
+        memAlloc.memoryTypeIndex      = memoryTypeIndex;
+        CALL_VK(vkAllocateMemory(device, &memAlloc, nullptr, &headlessMemory[i]));
+        CALL_VK(vkBindImageMemory(device, images[i], headlessMemory[i], 0));
+
+        VkImageViewCreateInfo colorAttachmentView           = {};
+        colorAttachmentView.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        colorAttachmentView.format                          = colorFormat;
+        colorAttachmentView.components                      = {VK_COMPONENT_SWIZZLE_R,
+                                          VK_COMPONENT_SWIZZLE_G,
+                                          VK_COMPONENT_SWIZZLE_B,
+                                          VK_COMPONENT_SWIZZLE_A};
+        colorAttachmentView.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        colorAttachmentView.subresourceRange.baseMipLevel   = 0;
+        colorAttachmentView.subresourceRange.levelCount     = 1;
+        colorAttachmentView.subresourceRange.baseArrayLayer = 0;
+        colorAttachmentView.subresourceRange.layerCount     = 1;
+        colorAttachmentView.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
+        colorAttachmentView.image                           = images[i];
+
+        buffers[i].image = images[i];
+        CALL_VK(vkCreateImageView(device, &colorAttachmentView, nullptr, &buffers[i].view));
+    }
+    nextHeadlessImage = 0;
+}
+
 /**
  * Acquires the next image in the swap chain
  *
@@ -368,6 +476,21 @@ void VulkanSwapChain::create(int32_t *width, int32_t *height, bool vsync)
 VkResult VulkanSwapChain::acquireNextImage(VkSemaphore presentCompleteSemaphore,
                                            uint32_t *  imageIndex)
 {
+    if (headless)
+    {
+        // Offscreen images are handed out round robin, the caller's per-image fences make sure an
+        // image is not rendered to while still in use. An empty submission signals the semaphore
+        // just like the presentation engine would
+        *imageIndex       = nextHeadlessImage;
+        nextHeadlessImage = (nextHeadlessImage + 1) % imageCount;
+
+        VkSubmitInfo submitInfo         = {};
+        submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.signalSemaphoreCount = presentCompleteSemaphore != VK_NULL_HANDLE ? 1 : 0;
+        submitInfo.pSignalSemaphores    = &presentCompleteSemaphore;
+        return vkQueueSubmit(headlessQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    }
+
     // By setting timeout to UINT64_MAX we will always wait until the next image has been acquired
     // or an actual error is thrown With that we don't have to handle VK_NOT_READY
     return vkAcquireNextImageKHR(
@@ -387,6 +510,23 @@ VkResult VulkanSwapChain::acquireNextImage(VkSemaphore presentCompleteSemaphore,
 VkResult VulkanSwapChain::queuePresent(VkQueue queue, uint32_t imageIndex,
                                        VkSemaphore waitSemaphore)
 {
+    if (headless)
+    {
+        // Nothing to present, but the render complete semaphore still has to be waited on so it
+        // is unsignaled before the frame slot reuses it
+        if (waitSemaphore == VK_NULL_HANDLE)
+        {
+            return VK_SUCCESS;
+        }
+        VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        VkSubmitInfo         submitInfo    = {};
+        submitInfo.sType                   = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount      = 1;
+        submitInfo.pWaitSemaphores         = &waitSemaphore;
+        submitInfo.pWaitDstStageMask       = &waitStageMask;
+        return vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    }
+
     VkPresentInfoKHR presentInfo = {};
     presentInfo.sType            = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.pNext            = NULL;
@@ -407,6 +547,19 @@ VkResult VulkanSwapChain::queuePresent(VkQueue queue, uint32_t imageIndex,
  */
 void VulkanSwapChain::cleanup()
 {
+    if (headless)
+    {
+        for (uint32_t i = 0; i < buffers.size(); i++)
+        {
+            vkDestroyImageView(device, buffers[i].view, nullptr);
+            vkDestroyImage(device, images[i], nullptr);
+            vkFreeMemory(device, headlessMemory[i], nullptr);
+        }
+        buffers.clear();
+        images.clear();
+        headlessMemory.clear();
+        return;
+    }
     if (swapChain != VK_NULL_HANDLE)
     {
         for (uint32_t i = 0; i < imageCount; i++)
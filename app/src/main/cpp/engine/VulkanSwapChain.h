@@ -32,6 +32,7 @@
 #include <vector>
 
 #include "../util/LogUtil.h"
+#include "../util/PlatformUtil.h"
 #include "../vulkan_wrapper/vulkan_wrapper.h"
 
 typedef struct _SwapChainBuffers
@@ -46,7 +47,14 @@ class VulkanSwapChain
     VkInstance       instance;
     VkDevice         device;
     VkPhysicalDevice physicalDevice;
-    VkSurfaceKHR     surface;
+    VkSurfaceKHR     surface = VK_NULL_HANDLE;
+
+    // Headless mode: device local images stand in for the presentable swap chain images
+    VkQueue                     headlessQueue     = VK_NULL_HANDLE;
+    uint32_t                    nextHeadlessImage = 0;
+    std::vector<VkDeviceMemory> headlessMemory;
+
+    void createHeadless(uint32_t width, uint32_t height);
 
   public:
     VkFormat                     colorFormat;
@@ -56,8 +64,15 @@ class VulkanSwapChain
     std::vector<VkImage>         images;
     std::vector<SwapChainBuffer> buffers;
     uint32_t                     queueNodeIndex = UINT32_MAX;
+    bool                         headless       = false;
 
     void     initSurface(ANativeWindow *window);
+    void     initHeadless(VkQueue queue, uint32_t queueFamilyIndex);
+    // Layout the color attachment has to be in once a frame has been rendered
+    VkImageLayout presentLayout() const
+    {
+        return headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    }
     void     connect(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device);
     void     create(int32_t *width, int32_t *height, bool vsync = false);
     VkResult acquireNextImage(VkSemaphore presentCompleteSemaphore, uint32_t *imageIndex);
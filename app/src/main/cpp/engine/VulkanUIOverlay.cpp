@@ -26,6 +26,7 @@
 #include "VulkanUIOverlay.h"
 #include "VulkanContextBase.h"
 #include "VulkanInitializers.hpp"
+#include <cstring>
 
 namespace vks
 {
@@ -70,15 +71,14 @@ void UIOverlay::prepareResources()
     unsigned char *fontData;
     int            texWidth, texHeight;
 
-    float   scale = (float) screenDensity / (float) ACONFIGURATION_DENSITY_MEDIUM;
-    AAsset *asset = AAssetManager_open(assetManager, "Roboto-Medium.ttf", AASSET_MODE_STREAMING);
-    if (asset)
+    float                scale = (float) screenDensity / (float) ACONFIGURATION_DENSITY_MEDIUM;
+    std::vector<uint8_t> font;
+    if (assets->read("Roboto-Medium.ttf", font))
     {
-        size_t size = AAsset_getLength(asset);
+        size_t size = font.size();
         assert(size > 0);
         char *fontAsset = new char[size];
-        AAsset_read(asset, fontAsset, size);
-        AAsset_close(asset);
+        memcpy(fontAsset, font.data(), size);
         io.Fonts->AddFontFromMemoryTTF(fontAsset, size, 12.0f * scale);
         // fontAsset will be deleted by freeResources method
         // delete[] fontAsset;
@@ -39,7 +39,7 @@
 #include "../util/imgui/imgui.h"
 #include "VulkanImageWrapper.h"
 #include "VulkanBufferWrapper.h"
-#include <android/asset_manager.h>
+#include "util/AssetUtil.h"
 
 using namespace vks;
 
@@ -51,7 +51,7 @@ class UIOverlay
     std::shared_ptr<VulkanDeviceWrapper> deviceWrapper;
     VkQueue                              queue;
     uint32_t                             screenDensity;
-    AAssetManager *                      assetManager;
+    std::shared_ptr<AssetLoader>         assets;
 
     VkSampleCountFlagBits rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
     uint32_t              subpass              = 0;
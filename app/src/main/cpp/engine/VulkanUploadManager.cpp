@@ -0,0 +1,399 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanUploadManager.h"
+
+#include <LogUtil.h>
+#include <assert.h>
+
+#include "VulkanDebug.h"
+
+namespace vks
+{
+namespace
+{
+// Accesses of the consumers of an upload, used as the destination of the last barrier
+VkAccessFlags accessMaskForLayout(VkImageLayout layout)
+{
+    switch (layout)
+    {
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+            return VK_ACCESS_TRANSFER_WRITE_BIT;
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            return VK_ACCESS_TRANSFER_READ_BIT;
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+            return VK_ACCESS_SHADER_READ_BIT;
+        case VK_IMAGE_LAYOUT_GENERAL:
+            return VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+            return VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        default:
+            return VK_ACCESS_MEMORY_READ_BIT;
+    }
+}
+
+// Buffers uploaded here are vertex, index, uniform or storage data
+constexpr VkAccessFlags kBufferReadAccess = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                            VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+}        // namespace
+
+std::unique_ptr<UploadManager> UploadManager::create(VkDevice device, StagingRing *stagingRing,
+                                                     uint32_t graphicsFamily, uint32_t transferFamily)
+{
+    if (stagingRing == nullptr)
+        return nullptr;
+    return std::make_unique<UploadManager>(device, stagingRing, graphicsFamily, transferFamily);
+}
+
+UploadManager::UploadManager(VkDevice device, StagingRing *stagingRing, uint32_t graphicsFamily, uint32_t transferFamily) :
+    mDevice(device), mStagingRing(stagingRing), mGraphicsFamily(graphicsFamily), mTransferFamily(transferFamily), mGraphicsPool(device), mTransferPool(device)
+{
+    VkCommandPoolCreateInfo poolInfo = {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext            = nullptr,
+        .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = mGraphicsFamily,
+    };
+    CALL_VK(vkCreateCommandPool(mDevice, &poolInfo, nullptr, mGraphicsPool.pHandle()));
+    vkGetDeviceQueue(mDevice, mGraphicsFamily, 0, &mGraphicsQueue);
+
+    if (hasDedicatedTransferQueue())
+    {
+        poolInfo.queueFamilyIndex = mTransferFamily;
+        CALL_VK(vkCreateCommandPool(mDevice, &poolInfo, nullptr, mTransferPool.pHandle()));
+        vkGetDeviceQueue(mDevice, mTransferFamily, 0, &mTransferQueue);
+    }
+    else
+    {
+        mTransferQueue = mGraphicsQueue;
+    }
+
+    LOGCATI("UploadManager: %s", hasDedicatedTransferQueue() ? "dedicated transfer queue" : "uploads on the graphics queue");
+}
+
+UploadManager::~UploadManager()
+{
+    wait(pendingToken());
+    retire();
+    assert(mInFlight.empty());
+}
+
+VkCommandBuffer UploadManager::beginCommandBuffer(VkCommandPool pool, std::vector<VkCommandBuffer> &freeList)
+{
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    if (freeList.empty())
+    {
+        const VkCommandBufferAllocateInfo allocateInfo = {
+            .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext              = nullptr,
+            .commandPool        = pool,
+            .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        CALL_VK(vkAllocateCommandBuffers(mDevice, &allocateInfo, &commandBuffer));
+        vks::debug::setCommandBufferName(mDevice, commandBuffer, "UploadManager");
+    }
+    else
+    {
+        commandBuffer = freeList.back();
+        freeList.pop_back();
+    }
+
+    // The pool is created with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, begin resets it
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext            = nullptr,
+        .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr,
+    };
+    CALL_VK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+    return commandBuffer;
+}
+
+VkCommandBuffer UploadManager::transferCommands()
+{
+    if (!hasDedicatedTransferQueue())
+    {
+        return graphicsCommands();
+    }
+    if (mOpen.transferCmd == VK_NULL_HANDLE)
+    {
+        mOpen.transferCmd = beginCommandBuffer(mTransferPool.handle(), mFreeTransferCmds);
+    }
+    return mOpen.transferCmd;
+}
+
+VkCommandBuffer UploadManager::graphicsCommands()
+{
+    if (mOpen.graphicsCmd == VK_NULL_HANDLE)
+    {
+        mOpen.graphicsCmd = beginCommandBuffer(mGraphicsPool.handle(), mFreeGraphicsCmds);
+    }
+    return mOpen.graphicsCmd;
+}
+
+void UploadManager::transferOwnership(VkImageMemoryBarrier barrier)
+{
+    barrier.srcQueueFamilyIndex = mTransferFamily;
+    barrier.dstQueueFamilyIndex = mGraphicsFamily;
+
+    // Release, the destination access is ignored
+    VkImageMemoryBarrier release = barrier;
+    release.dstAccessMask        = 0;
+    vkCmdPipelineBarrier(transferCommands(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &release);
+
+    // Acquire, the source access is ignored. The layout transition happens once, between the two
+    VkImageMemoryBarrier acquire = barrier;
+    acquire.srcAccessMask        = 0;
+    vkCmdPipelineBarrier(graphicsCommands(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &acquire);
+}
+
+void UploadManager::transferOwnership(VkBufferMemoryBarrier barrier)
+{
+    barrier.srcQueueFamilyIndex = mTransferFamily;
+    barrier.dstQueueFamilyIndex = mGraphicsFamily;
+
+    VkBufferMemoryBarrier release = barrier;
+    release.dstAccessMask         = 0;
+    vkCmdPipelineBarrier(transferCommands(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 1, &release, 0, nullptr);
+
+    VkBufferMemoryBarrier acquire = barrier;
+    acquire.srcAccessMask         = 0;
+    vkCmdPipelineBarrier(graphicsCommands(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 0, nullptr, 1, &acquire, 0, nullptr);
+}
+
+void UploadManager::copyBufferToImage(VkBuffer src, VkImage dst, uint32_t regionCount, const VkBufferImageCopy *regions,
+                                      const VkImageSubresourceRange &range, VkImageLayout finalLayout, bool inUse,
+                                      bool keepContent)
+{
+    // An image that earlier frames may still sample has to be written on the graphics queue, the
+    // transfer queue is not ordered against them. Keeping the content would need an ownership
+    // transfer to the transfer queue as well.
+    const bool      onTransferQueue = hasDedicatedTransferQueue() && !inUse && !keepContent;
+    VkCommandBuffer commandBuffer   = onTransferQueue ? transferCommands() : graphicsCommands();
+
+    if (finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || finalLayout == VK_IMAGE_LAYOUT_PREINITIALIZED)
+    {
+        finalLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    }
+
+    // Unless it is kept, the previous content is discarded, so no ownership transfer is needed to
+    // write the image
+    VkImageMemoryBarrier barrier = {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext               = nullptr,
+        .srcAccessMask       = keepContent ? accessMaskForLayout(finalLayout) : 0,
+        .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout           = keepContent ? finalLayout : VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image               = dst,
+        .subresourceRange    = range,
+    };
+    vkCmdPipelineBarrier(commandBuffer,
+                         inUse ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    vkCmdCopyBufferToImage(commandBuffer, src, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regionCount, regions);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = accessMaskForLayout(finalLayout);
+    barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout     = finalLayout;
+    if (onTransferQueue)
+    {
+        transferOwnership(barrier);
+    }
+    else
+    {
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+    mOpenCopies++;
+}
+
+void UploadManager::copyBuffer(VkBuffer src, VkBuffer dst, uint32_t regionCount, const VkBufferCopy *regions)
+{
+    vkCmdCopyBuffer(transferCommands(), src, dst, regionCount, regions);
+
+    VkBufferMemoryBarrier barrier = {
+        .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext               = nullptr,
+        .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask       = kBufferReadAccess,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer              = dst,
+        .offset              = 0,
+        .size                = VK_WHOLE_SIZE,
+    };
+    if (hasDedicatedTransferQueue())
+    {
+        transferOwnership(barrier);
+    }
+    else
+    {
+        vkCmdPipelineBarrier(graphicsCommands(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+    mOpenCopies++;
+}
+
+void UploadManager::deferUntilComplete(std::function<void()> callback)
+{
+    mOpen.callbacks.push_back(std::move(callback));
+}
+
+UploadManager::Token UploadManager::pendingToken() const
+{
+    // The staging ring frames are closed by flush() only, so the open batch becomes the next one
+    const bool empty = mOpen.transferCmd == VK_NULL_HANDLE && mOpen.graphicsCmd == VK_NULL_HANDLE && mOpen.callbacks.empty();
+    return empty ? mStagingRing->lastClosedSerial() : mStagingRing->lastClosedSerial() + 1;
+}
+
+UploadManager::Token UploadManager::flush()
+{
+    retire();
+
+    if (mOpen.transferCmd == VK_NULL_HANDLE && mOpen.graphicsCmd == VK_NULL_HANDLE && mOpen.callbacks.empty())
+    {
+        return mStagingRing->lastClosedSerial();
+    }
+
+    // The fence retires the staging memory of the batch as well as the batch itself
+    VkFence fence = mStagingRing->closeFrame(true);
+    mOpen.token   = mStagingRing->lastClosedSerial();
+
+    if (mOpen.transferCmd != VK_NULL_HANDLE)
+    {
+        CALL_VK(vkEndCommandBuffer(mOpen.transferCmd));
+
+        VkSubmitInfo submitInfo       = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &mOpen.transferCmd;
+        if (mOpen.graphicsCmd != VK_NULL_HANDLE)
+        {
+            // The graphics part acquires what the transfer part released
+            if (mFreeSemaphores.empty())
+            {
+                const VkSemaphoreCreateInfo semaphoreInfo = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+                mSemaphores.emplace_back(mDevice);
+                CALL_VK(vkCreateSemaphore(mDevice, &semaphoreInfo, nullptr, mSemaphores.back().pHandle()));
+                mFreeSemaphores.push_back(mSemaphores.back().handle());
+            }
+            mOpen.transferSemaphore = mFreeSemaphores.back();
+            mFreeSemaphores.pop_back();
+
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores    = &mOpen.transferSemaphore;
+            CALL_VK(vkQueueSubmit(mTransferQueue, 1, &submitInfo, VK_NULL_HANDLE));
+        }
+        else
+        {
+            CALL_VK(vkQueueSubmit(mTransferQueue, 1, &submitInfo, fence));
+        }
+    }
+
+    if (mOpen.graphicsCmd != VK_NULL_HANDLE || mOpen.transferCmd == VK_NULL_HANDLE)
+    {
+        // A batch made of callbacks only still needs a submission to signal the fence
+        const VkPipelineStageFlags waitStage  = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        VkSubmitInfo               submitInfo = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        if (mOpen.graphicsCmd != VK_NULL_HANDLE)
+        {
+            CALL_VK(vkEndCommandBuffer(mOpen.graphicsCmd));
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers    = &mOpen.graphicsCmd;
+        }
+        if (mOpen.transferSemaphore != VK_NULL_HANDLE)
+        {
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores    = &mOpen.transferSemaphore;
+            submitInfo.pWaitDstStageMask  = &waitStage;
+        }
+        CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, fence));
+    }
+
+    mStats.batches++;
+    mStats.copies += mOpenCopies;
+    mOpenCopies = 0;
+
+    const Token token = mOpen.token;
+    mInFlight.push_back(std::move(mOpen));
+    mOpen = Batch();
+    return token;
+}
+
+bool UploadManager::isComplete(Token token)
+{
+    if (token > mStagingRing->lastClosedSerial())
+        return false;
+    return mStagingRing->isRetired(token);
+}
+
+void UploadManager::wait(Token token)
+{
+    if (token > mStagingRing->lastClosedSerial())
+    {
+        flush();
+    }
+    if (!mStagingRing->isRetired(token))
+    {
+        mStats.waits++;
+        mStagingRing->waitRetired(token);
+    }
+    retire();
+}
+
+void UploadManager::retire()
+{
+    while (!mInFlight.empty() && mStagingRing->isRetired(mInFlight.front().token))
+    {
+        Batch &batch = mInFlight.front();
+        for (auto &callback : batch.callbacks)
+        {
+            callback();
+        }
+        if (batch.transferCmd != VK_NULL_HANDLE)
+        {
+            mFreeTransferCmds.push_back(batch.transferCmd);
+        }
+        if (batch.graphicsCmd != VK_NULL_HANDLE)
+        {
+            mFreeGraphicsCmds.push_back(batch.graphicsCmd);
+        }
+        if (batch.transferSemaphore != VK_NULL_HANDLE)
+        {
+            mFreeSemaphores.push_back(batch.transferSemaphore);
+        }
+        mInFlight.pop_front();
+    }
+}
+}        // namespace vks
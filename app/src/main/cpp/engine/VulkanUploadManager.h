@@ -0,0 +1,165 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANUPLOADMANAGER_H
+#define GAINVULKANSAMPLE_VULKANUPLOADMANAGER_H
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <vulkan_wrapper.h>
+
+#include "VulkanStagingRing.h"
+
+namespace vks
+{
+// Records the uploads of a frame (buffer->image and buffer->buffer copies sourced from the
+// staging ring) into one batch and submits it without waiting for it.
+//
+// A batch has two command buffers: transferCommands() runs on a dedicated transfer queue when the
+// device has one, graphicsCommands() runs on the graphics queue after it (semaphore) and is where
+// the queue family ownership is acquired and anything needing a graphics queue (blits, render
+// passes) is recorded. Without a dedicated transfer queue both are the same command buffer.
+//
+// Consumers on the graphics queue do not need to wait: the batch is submitted before the frame
+// that samples the resources, and its barriers order the later submissions. Host side users
+// (destroying a resource, reading back) wait on the batch's token.
+class UploadManager
+{
+  public:
+    // Identifies a batch, 0 means there is nothing to wait for
+    using Token = uint64_t;
+
+    struct Stats
+    {
+        uint64_t batches = 0;
+        uint64_t copies  = 0;
+        // Number of times the host had to block on a batch
+        uint64_t waits = 0;
+    };
+
+    static std::unique_ptr<UploadManager> create(VkDevice device, StagingRing *stagingRing,
+                                                 uint32_t graphicsFamily, uint32_t transferFamily);
+
+    // Prefer UploadManager::create
+    UploadManager(VkDevice device, StagingRing *stagingRing, uint32_t graphicsFamily, uint32_t transferFamily);
+
+    ~UploadManager();
+
+    bool hasDedicatedTransferQueue() const
+    {
+        return mTransferFamily != mGraphicsFamily;
+    }
+
+    // Command buffer of the open batch that runs on the transfer queue. Only transfer commands
+    // may be recorded, resources written here have to be released to the graphics queue family.
+    VkCommandBuffer transferCommands();
+
+    // Command buffer of the open batch that runs on the graphics queue after transferCommands()
+    VkCommandBuffer graphicsCommands();
+
+    /**
+     * Copy staged data to an image and transition it to finalLayout
+     *
+     * @param src Source buffer, usually StagingRing::Allocation::buffer
+     * @param regionCount Number of copy regions, offsets already include the staging offset
+     * @param range Subresource range that is written and transitioned
+     * @param finalLayout Layout of range after the upload, VK_IMAGE_LAYOUT_UNDEFINED keeps VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+     * @param inUse Set if earlier frames may still read the image, the copy is then ordered after
+     * them on the graphics queue instead of running on the transfer queue
+     * @param keepContent Set if the regions only cover a part of range, which is in finalLayout
+     * already and keeps the rest of its content. The copy then runs on the graphics queue.
+     */
+    void copyBufferToImage(VkBuffer src, VkImage dst, uint32_t regionCount, const VkBufferImageCopy *regions,
+                           const VkImageSubresourceRange &range, VkImageLayout finalLayout, bool inUse = false,
+                           bool keepContent = false);
+
+    // Copy staged data to a buffer that is not used by the GPU yet (vertex, index, uniform data)
+    void copyBuffer(VkBuffer src, VkBuffer dst, uint32_t regionCount, const VkBufferCopy *regions);
+
+    // Run callback once the open batch has completed on the GPU, e.g. to free temporary objects
+    // the recorded commands refer to
+    void deferUntilComplete(std::function<void()> callback);
+
+    // Token of the commands recorded so far, they are submitted by the next flush()
+    Token pendingToken() const;
+
+    // Submit the open batch (if any) and return its token, does not block
+    Token flush();
+
+    bool isComplete(Token token);
+
+    // Block until the batch has completed, flushes it first if it is still open
+    void wait(Token token);
+
+    const Stats &stats() const
+    {
+        return mStats;
+    }
+
+  private:
+    struct Batch
+    {
+        Token                              token             = 0;
+        VkCommandBuffer                    transferCmd       = VK_NULL_HANDLE;
+        VkCommandBuffer                    graphicsCmd       = VK_NULL_HANDLE;
+        VkSemaphore                        transferSemaphore = VK_NULL_HANDLE;
+        std::vector<std::function<void()>> callbacks;
+    };
+
+    VkCommandBuffer beginCommandBuffer(VkCommandPool pool, std::vector<VkCommandBuffer> &freeList);
+
+    // Release the resource from the transfer queue family and acquire it on the graphics one
+    void transferOwnership(VkImageMemoryBarrier barrier);
+    void transferOwnership(VkBufferMemoryBarrier barrier);
+
+    // Finish the batches completed on the GPU and recycle their objects
+    void retire();
+
+    VkDevice     mDevice;
+    StagingRing *mStagingRing;
+
+    uint32_t mGraphicsFamily;
+    uint32_t mTransferFamily;
+    VkQueue  mGraphicsQueue = VK_NULL_HANDLE;
+    VkQueue  mTransferQueue = VK_NULL_HANDLE;
+
+    VulkanCommandPool mGraphicsPool;
+    VulkanCommandPool mTransferPool;
+
+    std::vector<VkCommandBuffer> mFreeGraphicsCmds;
+    std::vector<VkCommandBuffer> mFreeTransferCmds;
+    std::vector<VkSemaphore>     mFreeSemaphores;
+    std::vector<VulkanSemaphore> mSemaphores;
+
+    Batch             mOpen;
+    uint32_t          mOpenCopies = 0;
+    std::deque<Batch> mInFlight;
+
+    Stats mStats;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANUPLOADMANAGER_H
@@ -0,0 +1,192 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanYCbCrImagePool.h"
+
+#include <LogUtil.h>
+
+#include "VulkanDebug.h"
+
+namespace vks
+{
+std::unique_ptr<YCbCrImagePool> YCbCrImagePool::create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue)
+{
+    if (!deviceWrapper->extensionEnabled(VK_KHR_SAMPLER_YCBCR_CONVERSION_EXTENSION_NAME))
+    {
+        LOGCATE("YCbCrImagePool: %s is not enabled", VK_KHR_SAMPLER_YCBCR_CONVERSION_EXTENSION_NAME);
+        return nullptr;
+    }
+    return std::make_unique<YCbCrImagePool>(deviceWrapper, queue);
+}
+
+YCbCrImagePool::YCbCrImagePool(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue) :
+    mDeviceWrapper(deviceWrapper), mQueue(queue)
+{
+    for (uint32_t i = 0; i < LAYOUT_COUNT; i++)
+    {
+        mConversions.push_back({VulkanSamplerYcbcrConversion(deviceWrapper->logicalDevice),
+                                VulkanSampler(deviceWrapper->logicalDevice)});
+    }
+}
+
+YCbCrImagePool::~YCbCrImagePool()
+{
+    // The images use the conversions, destroy them first
+    trim();
+}
+
+VkFormat YCbCrImagePool::format(yuv::ChromaLayout layout)
+{
+    switch (layout)
+    {
+        case yuv::ChromaLayout::I420:
+            return VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM;
+        case yuv::ChromaLayout::NV12:
+        case yuv::ChromaLayout::NV21:
+            return VK_FORMAT_G8_B8R8_2PLANE_420_UNORM;
+        default:
+            return VK_FORMAT_UNDEFINED;
+    }
+}
+
+bool YCbCrImagePool::isSupported(yuv::ChromaLayout layout) const
+{
+    const VkFormat imageFormat = format(layout);
+    if (imageFormat == VK_FORMAT_UNDEFINED)
+        return false;
+
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(mDeviceWrapper->physicalDevice, imageFormat, &formatProperties);
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT |
+                                          VK_FORMAT_FEATURE_MIDPOINT_CHROMA_SAMPLES_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_YCBCR_CONVERSION_LINEAR_FILTER_BIT;
+    return (formatProperties.optimalTilingFeatures & required) == required;
+}
+
+std::unique_ptr<Image> YCbCrImagePool::acquire(yuv::ChromaLayout layout, uint32_t width, uint32_t height)
+{
+    for (auto it = mFreeImages.begin(); it != mFreeImages.end(); ++it)
+    {
+        if (it->layout == layout && it->image->width() == width && it->image->height() == height)
+        {
+            auto image = std::move(it->image);
+            mFreeImages.erase(it);
+            return image;
+        }
+    }
+
+    if (!ensureConversion(layout))
+        return nullptr;
+
+    Image::ImageBasicInfo imageInfo = {
+        .format = format(layout),
+        .layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .extent = {width, height, 1},
+        .usage  = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+    };
+    LOGCATI("YCbCrImagePool: new %ux%u image of layout %d", width, height, static_cast<int>(layout));
+    return Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo,
+                                    mConversions[static_cast<uint32_t>(layout)].conversion.handle());
+}
+
+void YCbCrImagePool::release(yuv::ChromaLayout layout, std::unique_ptr<Image> image)
+{
+    if (image == nullptr)
+        return;
+    if (mFreeImages.size() == MAX_FREE_IMAGES)
+    {
+        // Drop the oldest one, it is the least likely to match the next acquire
+        mFreeImages.erase(mFreeImages.begin());
+    }
+    mFreeImages.push_back({layout, std::move(image)});
+}
+
+void YCbCrImagePool::trim()
+{
+    mFreeImages.clear();
+}
+
+VkSampler YCbCrImagePool::sampler(yuv::ChromaLayout layout)
+{
+    if (!ensureConversion(layout))
+        return VK_NULL_HANDLE;
+    return mConversions[static_cast<uint32_t>(layout)].sampler.handle();
+}
+
+bool YCbCrImagePool::ensureConversion(yuv::ChromaLayout layout)
+{
+    if (!isSupported(layout))
+    {
+        LOGCATE("YCbCrImagePool: layout %d is not supported", static_cast<int>(layout));
+        return false;
+    }
+    Conversion &conversion = mConversions[static_cast<uint32_t>(layout)];
+    if (conversion.conversion.handle() != VK_NULL_HANDLE)
+        return true;
+
+    // NV21 interleaves CrCb, the format reads the first byte as Cb
+    VkComponentMapping components = {
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+        VK_COMPONENT_SWIZZLE_IDENTITY,
+    };
+    if (layout == yuv::ChromaLayout::NV21)
+    {
+        components.r = VK_COMPONENT_SWIZZLE_B;
+        components.b = VK_COMPONENT_SWIZZLE_R;
+    }
+    if (!Image::createSamplerYcbcrConversion(mDeviceWrapper->logicalDevice, format(layout), components,
+                                             conversion.conversion.pHandle()))
+        return false;
+
+    // A sampler with a YCbCr conversion has to clamp to the edge and can not use mipmaps
+    const VkSamplerYcbcrConversionInfo conversionInfo = {
+        .sType      = VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO,
+        .pNext      = nullptr,
+        .conversion = conversion.conversion.handle(),
+    };
+    const VkSamplerCreateInfo samplerCreateInfo = {
+        .sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .pNext                   = &conversionInfo,
+        .magFilter               = VK_FILTER_LINEAR,
+        .minFilter               = VK_FILTER_LINEAR,
+        .mipmapMode              = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeW            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .mipLodBias              = 0.0f,
+        .anisotropyEnable        = VK_FALSE,
+        .maxAnisotropy           = 1.0f,
+        .compareEnable           = VK_FALSE,
+        .compareOp               = VK_COMPARE_OP_NEVER,
+        .minLod                  = 0.0f,
+        .maxLod                  = 0.0f,
+        .borderColor             = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK,
+        .unnormalizedCoordinates = VK_FALSE,
+    };
+    CALL_VK(vkCreateSampler(mDeviceWrapper->logicalDevice, &samplerCreateInfo, nullptr, conversion.sampler.pHandle()));
+    return true;
+}
+}        // namespace vks
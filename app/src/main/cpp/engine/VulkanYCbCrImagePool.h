@@ -0,0 +1,109 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANYCBCRIMAGEPOOL_H
+#define GAINVULKANSAMPLE_VULKANYCBCRIMAGEPOOL_H
+
+#include <memory>
+#include <vector>
+#include <vulkan_wrapper.h>
+
+#include "VulkanDeviceWrapper.hpp"
+#include "VulkanImageWrapper.h"
+#include "util/VulkanRAIIUtil.h"
+#include "util/YUVUtil.h"
+
+namespace vks
+{
+// Hands out multi-planar images sampled through a YCbCr conversion and takes them back for reuse,
+// so a stream of frames does not create an image (and its memory, view and sampler) per frame.
+//
+// I420 frames go to VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM. NV12 and NV21 frames go to
+// VK_FORMAT_G8_B8R8_2PLANE_420_UNORM as they are, the chroma is not de-interleaved on the CPU; the
+// conversion of NV21 swaps Cb and Cr. Each layout has one conversion and one immutable sampler
+// shared by all its images, created on first use and destroyed with the pool. The pool has to
+// outlive its images and the descriptor set layouts using sampler().
+class YCbCrImagePool
+{
+  public:
+    static std::unique_ptr<YCbCrImagePool> create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue);
+
+    // Prefer YCbCrImagePool::create
+    YCbCrImagePool(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue);
+
+    ~YCbCrImagePool();
+
+    // Format of the images of a layout, VK_FORMAT_UNDEFINED if the layout has none
+    static VkFormat format(yuv::ChromaLayout layout);
+
+    // Whether the device can upload to and sample the format of the layout with linear filtering
+    bool isSupported(yuv::ChromaLayout layout) const;
+
+    // A released image of the same layout and size, or a new one. The image is created with
+    // VK_IMAGE_USAGE_TRANSFER_DST_BIT and VK_IMAGE_USAGE_SAMPLED_BIT, its content is undefined until
+    // Image::setYUVContentForYCbCrImage.
+    std::unique_ptr<Image> acquire(yuv::ChromaLayout layout, uint32_t width, uint32_t height);
+
+    // Keep the image for a later acquire. Frames in flight may still sample it, the next upload to
+    // it is ordered after them (see Image::setYUVContentForYCbCrImage).
+    void release(yuv::ChromaLayout layout, std::unique_ptr<Image> image);
+
+    // Destroy the released images
+    void trim();
+
+    // Immutable sampler for the images of the layout, VK_NULL_HANDLE if it is not supported
+    VkSampler sampler(yuv::ChromaLayout layout);
+
+    size_t freeCount() const
+    {
+        return mFreeImages.size();
+    }
+
+  private:
+    static constexpr uint32_t LAYOUT_COUNT = 3;
+    // Released images beyond this are destroyed, a stream only cycles through a few
+    static constexpr size_t MAX_FREE_IMAGES = 4;
+
+    bool ensureConversion(yuv::ChromaLayout layout);
+
+    const std::shared_ptr<VulkanDeviceWrapper> mDeviceWrapper;
+    VkQueue                                    mQueue;
+
+    struct Conversion
+    {
+        VulkanSamplerYcbcrConversion conversion;
+        VulkanSampler                sampler;
+    };
+    std::vector<Conversion> mConversions;
+
+    struct FreeImage
+    {
+        yuv::ChromaLayout      layout;
+        std::unique_ptr<Image> image;
+    };
+    std::vector<FreeImage> mFreeImages;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANYCBCRIMAGEPOOL_H
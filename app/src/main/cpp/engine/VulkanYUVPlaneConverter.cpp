@@ -0,0 +1,329 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanYUVPlaneConverter.h"
+
+#include <LogUtil.h>
+#include <algorithm>
+#include <vector>
+
+#include "VulkanDebug.h"
+#include "VulkanInitializers.hpp"
+
+namespace vks
+{
+const char *YUVPlaneConverter::shaderPath(Output output)
+{
+    return output == Output::PLANAR ? "shaders/yuv_planes.comp.spv" : "shaders/yuv_to_rgba.comp.spv";
+}
+
+std::unique_ptr<YUVPlaneConverter> YUVPlaneConverter::create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper,
+                                                             VkQueue queue, VkPipelineCache pipelineCache,
+                                                             const VkPipelineShaderStageCreateInfo &shaderStage,
+                                                             Output output, uint32_t width, uint32_t height)
+{
+    auto converter = std::make_unique<YUVPlaneConverter>(deviceWrapper, queue, output);
+    const bool success = converter->prepare(pipelineCache, shaderStage, width, height);
+    return success ? std::move(converter) : nullptr;
+}
+
+YUVPlaneConverter::YUVPlaneConverter(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue,
+                                     Output output) :
+    mDeviceWrapper(deviceWrapper),
+    mQueue(queue),
+    mOutput(output),
+    mDescriptorPool(deviceWrapper->logicalDevice),
+    mDescriptorSetLayout(deviceWrapper->logicalDevice),
+    mPipelineLayout(deviceWrapper->logicalDevice),
+    mPipeline(deviceWrapper->logicalDevice)
+{}
+
+YUVPlaneConverter::~YUVPlaneConverter()
+{
+    // The last dispatch may still use the pipeline and the images
+    if (mLastToken != 0)
+    {
+        mDeviceWrapper->getUploadManager()->wait(mLastToken);
+    }
+}
+
+bool YUVPlaneConverter::InputLayout::operator==(const InputLayout &other) const
+{
+    return yStride == other.yStride && uStride == other.uStride && vStride == other.vStride &&
+           uPixelStride == other.uPixelStride && vPixelStride == other.vPixelStride && chroma == other.chroma;
+}
+
+bool YUVPlaneConverter::prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage,
+                                uint32_t width, uint32_t height)
+{
+    mWidth  = width;
+    mHeight = height;
+
+    // Outputs, sampled by the fragment shaders in VK_IMAGE_LAYOUT_GENERAL
+    Image::ImageBasicInfo imageInfo = {};
+    imageInfo.usage                 = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.layout                = VK_IMAGE_LAYOUT_GENERAL;
+    if (mOutput == Output::PLANAR)
+    {
+        imageInfo.format = VK_FORMAT_R8_UNORM;
+        imageInfo.extent = {width, height, 1};
+        mOutputs[0]      = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+        imageInfo.extent = {width / 2, height / 2, 1};
+        mOutputs[1]      = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+        mOutputs[2]      = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+    }
+    else
+    {
+        imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+        imageInfo.extent = {width, height, 1};
+        mOutputs[0]      = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+    }
+    for (uint32_t i = 0; i < outputCount(); i++)
+    {
+        if (mOutputs[i] == nullptr)
+        {
+            LOGCATE("YUVPlaneConverter: Failed to create the output images");
+            return false;
+        }
+    }
+
+    // Binding 0-2: input planes, 3-5: outputs
+    const uint32_t                            bindingCount = INPUT_COUNT + outputCount();
+    std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings;
+    for (uint32_t binding = 0; binding < bindingCount; binding++)
+    {
+        setLayoutBindings.push_back(vks::initializers::descriptorSetLayoutBinding(
+            VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, binding));
+    }
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = vks::initializers::descriptorSetLayoutCreateInfo(
+        setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+    CALL_VK(vkCreateDescriptorSetLayout(mDeviceWrapper->logicalDevice, &descriptorLayout, nullptr,
+                                        mDescriptorSetLayout.pHandle()));
+
+    const VkPushConstantRange pushConstantRange =
+        vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(mPushConstants), 0);
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo =
+        vks::initializers::pipelineLayoutCreateInfo(mDescriptorSetLayout.pHandle(), 1);
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
+    CALL_VK(vkCreatePipelineLayout(mDeviceWrapper->logicalDevice, &pipelineLayoutCreateInfo, nullptr,
+                                   mPipelineLayout.pHandle()));
+
+    VkDescriptorPoolSize       poolSize = vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, bindingCount);
+    const VkDescriptorPoolCreateInfo descriptorPoolInfo = vks::initializers::descriptorPoolCreateInfo(1, &poolSize, 1);
+    CALL_VK(vkCreateDescriptorPool(mDeviceWrapper->logicalDevice, &descriptorPoolInfo, nullptr, mDescriptorPool.pHandle()));
+
+    VkDescriptorSetAllocateInfo allocInfo =
+        vks::initializers::descriptorSetAllocateInfo(mDescriptorPool.handle(), mDescriptorSetLayout.pHandle(), 1);
+    CALL_VK(vkAllocateDescriptorSets(mDeviceWrapper->logicalDevice, &allocInfo, &mDescriptorSet));
+
+    std::vector<VkDescriptorImageInfo> outputDescriptors(outputCount());
+    std::vector<VkWriteDescriptorSet>  writeDescriptorSets(outputCount());
+    for (uint32_t i = 0; i < outputCount(); i++)
+    {
+        outputDescriptors[i]   = mOutputs[i]->getDescriptor();
+        writeDescriptorSets[i] = vks::initializers::writeDescriptorSet(
+            mDescriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, INPUT_COUNT + i, &outputDescriptors[i]);
+    }
+    vkUpdateDescriptorSets(mDeviceWrapper->logicalDevice, static_cast<uint32_t>(writeDescriptorSets.size()),
+                           writeDescriptorSets.data(), 0, nullptr);
+
+    // Same square work group as the other compute samples
+    const auto                                  workGroupSize        = mDeviceWrapper->workGroupSize;
+    const uint32_t                              specializationData[] = {workGroupSize, workGroupSize};
+    const std::vector<VkSpecializationMapEntry> specializationMap    = {
+        // clang-format off
+        // constantID, offset,               size
+        {0, 0 * sizeof(uint32_t), sizeof(uint32_t)},
+        {1, 1 * sizeof(uint32_t), sizeof(uint32_t)},
+        // clang-format on
+    };
+    const VkSpecializationInfo specializationInfo = {
+        .mapEntryCount = static_cast<uint32_t>(specializationMap.size()),
+        .pMapEntries   = specializationMap.data(),
+        .dataSize      = sizeof(specializationData),
+        .pData         = specializationData,
+    };
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo =
+        vks::initializers::computePipelineCreateInfo(mPipelineLayout.handle(), 0);
+    computePipelineCreateInfo.stage                     = shaderStage;
+    computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+    CALL_VK(vkCreateComputePipelines(mDeviceWrapper->logicalDevice, pipelineCache, 1, &computePipelineCreateInfo,
+                                     nullptr, mPipeline.pHandle()));
+    return true;
+}
+
+bool YUVPlaneConverter::prepareInputs(const InputLayout &layout)
+{
+    // The set and the current inputs are used by the last dispatch
+    if (mLastToken != 0)
+    {
+        mDeviceWrapper->getUploadManager()->wait(mLastToken);
+    }
+
+    const uint32_t chromaWidth  = mWidth / 2;
+    const uint32_t chromaHeight = mHeight / 2;
+
+    Image::ImageBasicInfo imageInfo = {};
+    imageInfo.format                = VK_FORMAT_R8_UNORM;
+    imageInfo.usage                 = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+    imageInfo.layout                = VK_IMAGE_LAYOUT_GENERAL;
+
+    imageInfo.extent = {mWidth, mHeight, 1};
+    mInputs[0]       = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+
+    if (layout.chroma == yuv::ChromaLayout::NV12 || layout.chroma == yuv::ChromaLayout::NV21)
+    {
+        // One image over the interleaved plane, U and V are the even and odd texels
+        imageInfo.extent = {chromaWidth * 2, chromaHeight, 1};
+        mInputs[1]       = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+        mInputs[2].reset();
+        mPushConstants.uOffset = layout.chroma == yuv::ChromaLayout::NV12 ? 0 : 1;
+        mPushConstants.vOffset = layout.chroma == yuv::ChromaLayout::NV12 ? 1 : 0;
+    }
+    else
+    {
+        // Only the texels up to the last sample of a row exist in memory
+        imageInfo.extent = {(chromaWidth - 1) * layout.uPixelStride + 1, chromaHeight, 1};
+        mInputs[1]       = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+        imageInfo.extent = {(chromaWidth - 1) * layout.vPixelStride + 1, chromaHeight, 1};
+        mInputs[2]       = Image::createDeviceLocal(mDeviceWrapper, mQueue, imageInfo);
+        mPushConstants.uOffset = 0;
+        mPushConstants.vOffset = 0;
+    }
+    mPushConstants.uPixelStride = static_cast<int32_t>(layout.uPixelStride);
+    mPushConstants.vPixelStride = static_cast<int32_t>(layout.vPixelStride);
+
+    const Image *inputs[INPUT_COUNT] = {mInputs[0].get(), mInputs[1].get(), mInputs[2] ? mInputs[2].get() : mInputs[1].get()};
+    VkDescriptorImageInfo descriptors[INPUT_COUNT];
+    VkWriteDescriptorSet  writeDescriptorSets[INPUT_COUNT];
+    for (uint32_t i = 0; i < INPUT_COUNT; i++)
+    {
+        if (inputs[i] == nullptr)
+        {
+            LOGCATE("YUVPlaneConverter: Failed to create the input images");
+            mInputLayout = {};
+            return false;
+        }
+        descriptors[i]         = inputs[i]->getDescriptor();
+        writeDescriptorSets[i] = vks::initializers::writeDescriptorSet(
+            mDescriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, i, &descriptors[i]);
+    }
+    vkUpdateDescriptorSets(mDeviceWrapper->logicalDevice, INPUT_COUNT, writeDescriptorSets, 0, nullptr);
+
+    mInputLayout = layout;
+    LOGCATI("YUVPlaneConverter: %ux%u, chroma layout %d, pixel strides %u/%u", mWidth, mHeight,
+            static_cast<int>(layout.chroma), layout.uPixelStride, layout.vPixelStride);
+    return true;
+}
+
+bool YUVPlaneConverter::convert(const yuv::Frame &frame)
+{
+    if (frame.width != mWidth || frame.height != mHeight)
+    {
+        LOGCATE("YUVPlaneConverter: frame is %ux%u, expected %ux%u", frame.width, frame.height, mWidth, mHeight);
+        return false;
+    }
+
+    InputLayout layout;
+    layout.yStride      = frame.yStride;
+    layout.uStride      = frame.uStride;
+    layout.vStride      = frame.vStride;
+    layout.uPixelStride = frame.uPixelStride;
+    layout.vPixelStride = frame.vPixelStride;
+    layout.chroma       = yuv::detectChromaLayout(frame);
+    if (!(layout == mInputLayout) && !prepareInputs(layout))
+        return false;
+
+    // Upload only the bytes of the planes, the padding after the last row may not be mapped
+    const uint32_t chromaHeight = mHeight / 2;
+    bool           success      = mInputs[0]->setContentFromBytes(
+        frame.y, frame.yStride * (mHeight - 1) + mInputs[0]->width(), frame.yStride);
+    if (mInputs[2] == nullptr)
+    {
+        const uint8_t *interleaved = std::min(frame.u, frame.v);
+        success = success && mInputs[1]->setContentFromBytes(
+                                 interleaved, frame.uStride * (chromaHeight - 1) + mInputs[1]->width(), frame.uStride);
+    }
+    else
+    {
+        success = success && mInputs[1]->setContentFromBytes(
+                                 frame.u, frame.uStride * (chromaHeight - 1) + mInputs[1]->width(), frame.uStride);
+        success = success && mInputs[2]->setContentFromBytes(
+                                 frame.v, frame.vStride * (chromaHeight - 1) + mInputs[2]->width(), frame.vStride);
+    }
+    if (!success)
+        return false;
+
+    // Recorded after the copies, which end with a barrier to the shader reads
+    UploadManager *uploadManager = mDeviceWrapper->getUploadManager();
+    recordDispatch(uploadManager->graphicsCommands());
+    mLastToken = uploadManager->pendingToken();
+    return true;
+}
+
+void YUVPlaneConverter::recordDispatch(VkCommandBuffer commandBuffer)
+{
+    VkImageMemoryBarrier barriers[MAX_OUTPUT_COUNT];
+    for (uint32_t i = 0; i < outputCount(); i++)
+    {
+        // The outputs are fully rewritten, the previous content is discarded once the earlier
+        // frames have sampled it
+        barriers[i]                  = vks::initializers::imageMemoryBarrier();
+        barriers[i].srcAccessMask    = 0;
+        barriers[i].dstAccessMask    = VK_ACCESS_SHADER_WRITE_BIT;
+        barriers[i].oldLayout        = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[i].newLayout        = VK_IMAGE_LAYOUT_GENERAL;
+        barriers[i].image            = mOutputs[i]->getImageHandle();
+        barriers[i].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    }
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 0, nullptr, 0, nullptr, outputCount(), barriers);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline.handle());
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout.handle(), 0, 1,
+                            &mDescriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, mPipelineLayout.handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                       sizeof(mPushConstants), &mPushConstants);
+
+    // yuv_planes.comp handles a 2x2 luma block per invocation, yuv_to_rgba.comp a single pixel
+    const uint32_t workGroupSize = mDeviceWrapper->workGroupSize;
+    const uint32_t invocationsX  = mOutput == Output::PLANAR ? (mWidth + 1) / 2 : mWidth;
+    const uint32_t invocationsY  = mOutput == Output::PLANAR ? (mHeight + 1) / 2 : mHeight;
+    vkCmdDispatch(commandBuffer, (invocationsX + workGroupSize - 1) / workGroupSize,
+                  (invocationsY + workGroupSize - 1) / workGroupSize, 1);
+
+    for (uint32_t i = 0; i < outputCount(); i++)
+    {
+        barriers[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barriers[i].oldLayout     = VK_IMAGE_LAYOUT_GENERAL;
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, 0, nullptr, 0, nullptr, outputCount(), barriers);
+}
+}        // namespace vks
@@ -0,0 +1,158 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANYUVPLANECONVERTER_H
+#define GAINVULKANSAMPLE_VULKANYUVPLANECONVERTER_H
+
+#include <memory>
+#include <vulkan_wrapper.h>
+
+#include "VulkanDeviceWrapper.hpp"
+#include "VulkanImageWrapper.h"
+#include "util/VulkanRAIIUtil.h"
+#include "util/YUVUtil.h"
+
+namespace vks
+{
+// Uploads camera frames (YUV_420_888) as they are in memory, whatever the row and pixel strides,
+// and unpacks them with a compute shader into images the fragment shaders sample.
+//
+// The upload and the dispatch are recorded into the graphics commands of the open upload batch
+// (see UploadManager), which is submitted before the next frame. The outputs are in
+// VK_IMAGE_LAYOUT_GENERAL and ready for the fragment shaders of the frames after convert().
+class YUVPlaneConverter
+{
+  public:
+    enum class Output
+    {
+        // Three packed R8 planes: yImage(), uImage(), vImage() (shaders/yuv_planes.comp)
+        PLANAR,
+        // One R8G8B8A8 image: rgbaImage() (shaders/yuv_to_rgba.comp)
+        RGBA,
+    };
+
+    // Compute shader implementing output, to be loaded with VulkanContextBase::loadShader
+    static const char *shaderPath(Output output);
+
+    /**
+     * @param shaderStage Stage of shaderPath(output)
+     * @param width, height Size of the frames, the outputs are created with it
+     */
+    static std::unique_ptr<YUVPlaneConverter> create(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper,
+                                                     VkQueue queue, VkPipelineCache pipelineCache,
+                                                     const VkPipelineShaderStageCreateInfo &shaderStage,
+                                                     Output output, uint32_t width, uint32_t height);
+
+    // Prefer YUVPlaneConverter::create
+    YUVPlaneConverter(const std::shared_ptr<VulkanDeviceWrapper> deviceWrapper, VkQueue queue, Output output);
+
+    ~YUVPlaneConverter();
+
+    // Upload the planes and record the conversion. The plane memory is only read during the call.
+    bool convert(const yuv::Frame &frame);
+
+    Image *yImage() const
+    {
+        return mOutputs[0].get();
+    }
+
+    Image *uImage() const
+    {
+        return mOutputs[1].get();
+    }
+
+    Image *vImage() const
+    {
+        return mOutputs[2].get();
+    }
+
+    Image *rgbaImage() const
+    {
+        return mOutputs[0].get();
+    }
+
+  private:
+    static constexpr uint32_t INPUT_COUNT      = 3;
+    static constexpr uint32_t MAX_OUTPUT_COUNT = 3;
+
+    // Plane geometry the input images were created for
+    struct InputLayout
+    {
+        uint32_t          yStride = 0;
+        uint32_t          uStride = 0;
+        uint32_t          vStride = 0;
+        uint32_t          uPixelStride = 0;
+        uint32_t          vPixelStride = 0;
+        yuv::ChromaLayout chroma = yuv::ChromaLayout::I420;
+
+        bool operator==(const InputLayout &other) const;
+    };
+
+    bool prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage,
+                 uint32_t width, uint32_t height);
+
+    uint32_t outputCount() const
+    {
+        return mOutput == Output::PLANAR ? 3 : 1;
+    }
+
+    // (Re)create the input images for the layout and point the descriptor set at them
+    bool prepareInputs(const InputLayout &layout);
+
+    void recordDispatch(VkCommandBuffer commandBuffer);
+
+    const std::shared_ptr<VulkanDeviceWrapper> mDeviceWrapper;
+    VkQueue                                    mQueue;
+    const Output                               mOutput;
+
+    uint32_t mWidth  = 0;
+    uint32_t mHeight = 0;
+
+    VulkanDescriptorPool      mDescriptorPool;
+    VulkanDescriptorSetLayout mDescriptorSetLayout;
+    VkDescriptorSet           mDescriptorSet = VK_NULL_HANDLE;
+    VulkanPipelineLayout      mPipelineLayout;
+    VulkanPipeline            mPipeline;
+
+    // Y and the chroma images in the camera layout. NV12/NV21 upload the interleaved chroma once,
+    // both U and V are then read from mInputs[1].
+    std::unique_ptr<Image> mInputs[INPUT_COUNT];
+    InputLayout            mInputLayout;
+
+    std::unique_ptr<Image> mOutputs[MAX_OUTPUT_COUNT];
+
+    struct
+    {
+        int32_t uPixelStride;
+        int32_t vPixelStride;
+        int32_t uOffset;
+        int32_t vOffset;
+    } mPushConstants = {};
+
+    // Batch of the last dispatch
+    UploadManager::Token mLastToken = 0;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_VULKANYUVPLANECONVERTER_H
@@ -0,0 +1,95 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANGLTFANIMATION_H
+#define GAINVULKANSAMPLE_VULKANGLTFANIMATION_H
+
+#include <cstdint>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include <glm/glm.hpp>
+
+namespace vkglTF
+{
+struct Model;
+struct Node;
+struct AnimationSampler;
+
+// Poses the nodes of a model from one or more of its animations, each with a weight.
+//
+// Every channel keeps a cursor on the key interval it sampled last. Playing forward the time is
+// found in that interval or the next one, so a frame costs O(channels) whatever the length of the
+// clips; only a seek or a loop falls back to a binary search. STEP, LINEAR and CUBICSPLINE samplers
+// are interpolated as the glTF specification describes, times outside of the keys are clamped.
+class AnimationEvaluator
+{
+  public:
+    struct Layer
+    {
+        uint32_t animation;
+        // Seconds, in the range of the keys of the animation
+        float time;
+        float weight = 1.0f;
+    };
+
+    // Sample at time, the rotation path is slerped (or normalized) as a quaternion stored xyzw.
+    // cursor is the key interval to try first and is moved to the interval of time.
+    static glm::vec4 sample(const AnimationSampler &sampler, float time, bool rotation, uint32_t *cursor);
+
+    // Blend the layers into model.transforms, then Model::updateTransforms has to be called. A
+    // node path animated by layers whose weights sum below 1 is blended toward its loaded
+    // transform for the rest, above 1 the weights are normalized. Paths animated by none of the
+    // layers are left as they are.
+    void evaluate(Model &model, const std::vector<Layer> &layers);
+
+  private:
+    // [animation][channel]
+    std::vector<std::vector<uint32_t>> mCursors;
+
+    // Weighted sums per node, only the entries of mTouched are non-zero between evaluations
+    struct Accumulator
+    {
+        // Node of the entry, nullptr if it is not in mTouched
+        const Node *node = nullptr;
+        glm::vec3   translation{0.0f};
+        glm::vec4   rotation{0.0f};
+        glm::vec3   scale{0.0f};
+        float       translationWeight = 0.0f;
+        float       rotationWeight    = 0.0f;
+        float       scaleWeight       = 0.0f;
+    };
+    std::vector<Accumulator> mAccumulators;
+    std::vector<uint32_t>    mTouched;
+};
+
+// Sample long synthetic clips with the cursors and with a scan of all the keys per frame, check
+// they agree and log the timings.
+// Run on demand by Sample::runEngineBenchmarks.
+void runAnimationBenchmark();
+}        // namespace vkglTF
+
+#endif        // GAINVULKANSAMPLE_VULKANGLTFANIMATION_H
@@ -30,17 +30,92 @@
 
 #include "VulkanglTFModel.h"
 #include "VulkanInitializers.hpp"
+#include "util/ThreadPool.h"
 
 namespace vkglTF
 {
-#ifdef __ANDROID__
-#    ifdef TINYGLTF_ANDROID_LOAD_FROM_ASSETS
-void setupAssetManager(AAssetManager *assetManager)
+namespace
 {
-    tinygltf::asset_manager = assetManager;
+std::shared_ptr<vks::AssetLoader> gAssets;
+
+// File system callbacks of tinygltf reading the assets of setupAssetLoader
+bool assetExists(const std::string &path, void *userData)
+{
+    return static_cast<const vks::AssetLoader *>(userData)->exists(path);
+}
+
+std::string expandAssetPath(const std::string &path, void *)
+{
+    return path;
+}
+
+bool readAsset(std::vector<unsigned char> *out, std::string *err, const std::string &path, void *userData)
+{
+    if (!static_cast<const vks::AssetLoader *>(userData)->read(path, *out))
+    {
+        if (err != nullptr)
+        {
+            *err += "Could not read asset " + path + "\n";
+        }
+        return false;
+    }
+    return true;
+}
+
+bool writeAsset(std::string *err, const std::string &path, const std::vector<unsigned char> &, void *)
+{
+    if (err != nullptr)
+    {
+        *err += "Assets are read only, could not write " + path + "\n";
+    }
+    return false;
+}
+
+// Image loader of tinygltf that keeps the encoded bytes, the images are decoded by decodeImage on
+// the loader threads once the file is parsed
+bool keepEncodedImage(tinygltf::Image *image, const int imageIndex, std::string *err, std::string *warn, int reqWidth,
+                      int reqHeight, const unsigned char *bytes, int size, void *userData)
+{
+    image->image.assign(bytes, bytes + size);
+    image->as_is = true;
+    return true;
+}
+
+// Decode to RGBA8, the format of Texture::fromglTfImage. An image that is missing or fails to
+// decode becomes a white texel, the rest of the model still loads.
+void decodeImage(tinygltf::Image &image)
+{
+    int      width = 0, height = 0, components = 0;
+    stbi_uc *pixels = nullptr;
+    if (image.as_is && !image.image.empty())
+    {
+        pixels = stbi_load_from_memory(image.image.data(), static_cast<int>(image.image.size()), &width, &height,
+                                       &components, 4);
+    }
+    if (pixels != nullptr)
+    {
+        image.image.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+    }
+    else
+    {
+        LOGCATE("Model: Failed to decode image %s%s", image.name.c_str(), image.uri.c_str());
+        width = height = 1;
+        image.image.assign(4, 0xff);
+    }
+    image.width      = width;
+    image.height     = height;
+    image.component  = 4;
+    image.bits       = 8;
+    image.pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+    image.as_is      = false;
+}
+}        // namespace
+
+void setupAssetLoader(std::shared_ptr<vks::AssetLoader> assets)
+{
+    gAssets = std::move(assets);
 }
-#    endif
-#endif
 
 // Bounding box
 
@@ -145,25 +220,12 @@ void Texture::fromglTfImage(tinygltf::Image &gltfimage, TextureSampler textureSa
     memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
     VkMemoryRequirements memReqs{};
 
-    VkBuffer       stagingBuffer;
-    VkDeviceMemory stagingMemory;
-
-    VkBufferCreateInfo bufferCreateInfo{};
-    bufferCreateInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferCreateInfo.size        = bufferSize;
-    bufferCreateInfo.usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    CALL_VK(vkCreateBuffer(device->logicalDevice, &bufferCreateInfo, nullptr, &stagingBuffer));
-    vkGetBufferMemoryRequirements(device->logicalDevice, stagingBuffer, &memReqs);
-    memAllocInfo.allocationSize  = memReqs.size;
-    memAllocInfo.memoryTypeIndex = device->getMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    CALL_VK(vkAllocateMemory(device->logicalDevice, &memAllocInfo, nullptr, &stagingMemory));
-    CALL_VK(vkBindBufferMemory(device->logicalDevice, stagingBuffer, stagingMemory, 0));
-
-    uint8_t *data;
-    CALL_VK(vkMapMemory(device->logicalDevice, stagingMemory, 0, memReqs.size, 0, (void **) &data));
-    memcpy(data, buffer, bufferSize);
-    vkUnmapMemory(device->logicalDevice, stagingMemory);
+    vks::StagingRing::Allocation staging;
+    if (!device->getStagingRing()->upload(buffer, bufferSize, &staging))
+    {
+        LOGCATE("Texture::fromglTfImage: Failed to allocate %llu staging bytes", static_cast<unsigned long long>(bufferSize));
+        assert(false);
+    }
 
     VkImageCreateInfo imageCreateInfo{};
     imageCreateInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -187,26 +249,15 @@ void Texture::fromglTfImage(tinygltf::Image &gltfimage, TextureSampler textureSa
 
     vks::debug::setDeviceMemoryName(device->logicalDevice, deviceMemory, "VulkanglTFModel-fromglTfImage-deviceMemory");
 
-    VkCommandBuffer copyCmd = device->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+    vks::UploadManager *uploadManager = device->getUploadManager();
 
     VkImageSubresourceRange subresourceRange = {};
     subresourceRange.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
     subresourceRange.levelCount              = 1;
     subresourceRange.layerCount              = 1;
 
-    {
-        VkImageMemoryBarrier imageMemoryBarrier{};
-        imageMemoryBarrier.sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        imageMemoryBarrier.oldLayout        = VK_IMAGE_LAYOUT_UNDEFINED;
-        imageMemoryBarrier.newLayout        = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        imageMemoryBarrier.srcAccessMask    = 0;
-        imageMemoryBarrier.dstAccessMask    = VK_ACCESS_TRANSFER_WRITE_BIT;
-        imageMemoryBarrier.image            = image;
-        imageMemoryBarrier.subresourceRange = subresourceRange;
-        vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
-    }
-
     VkBufferImageCopy bufferCopyRegion               = {};
+    bufferCopyRegion.bufferOffset                    = staging.offset;
     bufferCopyRegion.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
     bufferCopyRegion.imageSubresource.mipLevel       = 0;
     bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
@@ -215,27 +266,13 @@ void Texture::fromglTfImage(tinygltf::Image &gltfimage, TextureSampler textureSa
     bufferCopyRegion.imageExtent.height              = height;
     bufferCopyRegion.imageExtent.depth               = 1;
 
-    vkCmdCopyBufferToImage(copyCmd, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferCopyRegion);
-
-    {
-        VkImageMemoryBarrier imageMemoryBarrier{};
-        imageMemoryBarrier.sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        imageMemoryBarrier.oldLayout        = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        imageMemoryBarrier.newLayout        = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        imageMemoryBarrier.srcAccessMask    = VK_ACCESS_TRANSFER_WRITE_BIT;
-        imageMemoryBarrier.dstAccessMask    = VK_ACCESS_TRANSFER_READ_BIT;
-        imageMemoryBarrier.image            = image;
-        imageMemoryBarrier.subresourceRange = subresourceRange;
-        vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
-    }
-
-    device->endAndSubmitSingleTimeCommand(copyCmd, copyQueue, true);
-
-    vkFreeMemory(device->logicalDevice, stagingMemory, nullptr);
-    vkDestroyBuffer(device->logicalDevice, stagingBuffer, nullptr);
+    // The base level is left in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL (and owned by the graphics
+    // queue family) for the blits below
+    uploadManager->copyBufferToImage(staging.buffer, image, 1, &bufferCopyRegion, subresourceRange, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 
     // Generate the mip chain (glTF uses jpg and png, so we need to create this manually)
-    VkCommandBuffer blitCmd = device->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+    // Blits need a graphics queue, they are recorded into the same upload batch after the copy
+    VkCommandBuffer blitCmd = uploadManager->graphicsCommands();
     for (uint32_t i = 1; i < mipLevels; i++)
     {
         VkImageBlit imageBlit{};
@@ -296,14 +333,12 @@ void Texture::fromglTfImage(tinygltf::Image &gltfimage, TextureSampler textureSa
         imageMemoryBarrier.oldLayout        = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
         imageMemoryBarrier.newLayout        = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         imageMemoryBarrier.srcAccessMask    = VK_ACCESS_TRANSFER_WRITE_BIT;
-        imageMemoryBarrier.dstAccessMask    = VK_ACCESS_TRANSFER_READ_BIT;
+        imageMemoryBarrier.dstAccessMask    = VK_ACCESS_SHADER_READ_BIT;
         imageMemoryBarrier.image            = image;
         imageMemoryBarrier.subresourceRange = subresourceRange;
         vkCmdPipelineBarrier(blitCmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
     }
 
-    device->endAndSubmitSingleTimeCommand(blitCmd, copyQueue, true);
-
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType            = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     samplerInfo.magFilter        = textureSampler.magFilter;
@@ -385,11 +420,19 @@ void Mesh::setBoundingBox(glm::vec3 min, glm::vec3 max)
 // Node
 glm::mat4 Node::localMatrix()
 {
+    if (transforms)
+    {
+        return transforms->localMatrix(transformIndex);
+    }
     return glm::translate(glm::mat4(1.0f), translation) * glm::mat4(rotation) * glm::scale(glm::mat4(1.0f), scale) * matrix;
 }
 
 glm::mat4 Node::getMatrix()
 {
+    if (transforms)
+    {
+        return transforms->worldMatrix(transformIndex);
+    }
     glm::mat4     m = localMatrix();
     vkglTF::Node *p = parent;
     while (p)
@@ -400,36 +443,50 @@ glm::mat4 Node::getMatrix()
     return m;
 }
 
-void Node::update()
+void Node::update(bool jointMatrices)
 {
-    if (mesh)
+    if (!mesh)
+    {
+        return;
+    }
+
+    const auto changed = [](const Node *node) {
+        return node->transforms == nullptr || node->transforms->worldChanged(node->transformIndex);
+    };
+    const bool skinned     = skin != nullptr && jointMatrices;
+    bool       meshChanged = changed(this);
+    if (skinned)
     {
-        glm::mat4 m = getMatrix();
-        if (skin)
+        for (size_t i = 0; i < skin->joints.size() && !meshChanged; i++)
         {
-            mesh->uniformBlock.matrix = m;
-            // Update join ubo
-            glm::mat4 inverseTransform = glm::inverse(m);
-            size_t    numJoints        = std::min((uint32_t) skin->joints.size(), MAX_NUM_JOINTS);
-            for (size_t i = 0; i < numJoints; i++)
-            {
-                vkglTF::Node *jointNode           = skin->joints[i];
-                glm::mat4     jointMat            = jointNode->getMatrix() * skin->inverseBindMatrices[i];
-                jointMat                          = inverseTransform * jointMat;
-                mesh->uniformBlock.jointMatrix[i] = jointMat;
-            }
-            mesh->uniformBlock.jointcount = (float) numJoints;
-            mesh->uniformBuffer.buffer->copyFrom(&mesh->uniformBlock, sizeof(mesh->uniformBlock));
+            meshChanged = changed(skin->joints[i]);
         }
-        else
+    }
+    if (!meshChanged)
+    {
+        return;
+    }
+
+    glm::mat4 m = getMatrix();
+    if (skinned)
+    {
+        mesh->uniformBlock.matrix = m;
+        // Update join ubo
+        glm::mat4 inverseTransform = glm::inverse(m);
+        size_t    numJoints        = std::min((uint32_t) skin->joints.size(), MAX_NUM_JOINTS);
+        for (size_t i = 0; i < numJoints; i++)
         {
-            mesh->uniformBuffer.buffer->copyFrom(&m, sizeof(m));
+            vkglTF::Node *jointNode           = skin->joints[i];
+            glm::mat4     jointMat            = jointNode->getMatrix() * skin->inverseBindMatrices[i];
+            jointMat                          = inverseTransform * jointMat;
+            mesh->uniformBlock.jointMatrix[i] = jointMat;
         }
+        mesh->uniformBlock.jointcount = (float) numJoints;
+        mesh->uniformBuffer.buffer->copyFrom(&mesh->uniformBlock, sizeof(mesh->uniformBlock));
     }
-
-    for (auto &child : children)
+    else
     {
-        child->update();
+        mesh->uniformBuffer.buffer->copyFrom(&m, sizeof(m));
     }
 }
 
@@ -463,6 +520,8 @@ void Model::destroy(VkDevice device)
     animations.resize(0);
     nodes.resize(0);
     linearNodes.resize(0);
+    transforms.clear();
+    animator = AnimationEvaluator();
     extensions.resize(0);
     for (auto skin : skins)
     {
@@ -471,7 +530,7 @@ void Model::destroy(VkDevice device)
     skins.resize(0);
 };
 
-void Model::loadNode(vkglTF::Node *parent, const tinygltf::Node &node, uint32_t nodeIndex, const tinygltf::Model &model, std::vector<uint32_t> &indexBuffer, std::vector<Vertex> &vertexBuffer, float globalscale)
+void Model::loadNode(vkglTF::Node *parent, const tinygltf::Node &node, uint32_t nodeIndex, const tinygltf::Model &model, LoaderInfo &loaderInfo, float globalscale)
 {
     vkglTF::Node *newNode = new Node{};
     newNode->index        = nodeIndex;
@@ -509,184 +568,37 @@ void Model::loadNode(vkglTF::Node *parent, const tinygltf::Node &node, uint32_t
     {
         for (size_t i = 0; i < node.children.size(); i++)
         {
-            loadNode(newNode, model.nodes[node.children[i]], node.children[i], model, indexBuffer, vertexBuffer, globalscale);
+            loadNode(newNode, model.nodes[node.children[i]], node.children[i], model, loaderInfo, globalscale);
         }
     }
 
-    // Node contains mesh data
+    // Node contains mesh data, its primitives are only counted here and read by loadPrimitiveData
     if (node.mesh > -1)
     {
-        const tinygltf::Mesh mesh    = model.meshes[node.mesh];
-        Mesh *               newMesh = new Mesh(device, newNode->matrix);
+        const tinygltf::Mesh &mesh    = model.meshes[node.mesh];
+        Mesh *                newMesh = new Mesh(device, newNode->matrix);
         for (size_t j = 0; j < mesh.primitives.size(); j++)
         {
-            const tinygltf::Primitive &primitive   = mesh.primitives[j];
-            uint32_t                   indexStart  = static_cast<uint32_t>(indexBuffer.size());
-            uint32_t                   vertexStart = static_cast<uint32_t>(vertexBuffer.size());
-            uint32_t                   indexCount  = 0;
-            uint32_t                   vertexCount = 0;
-            glm::vec3                  posMin{};
-            glm::vec3                  posMax{};
-            bool                       hasSkin    = false;
-            bool                       hasIndices = primitive.indices > -1;
-            // Vertices
-            {
-                const float *bufferPos          = nullptr;
-                const float *bufferNormals      = nullptr;
-                const float *bufferTexCoordSet0 = nullptr;
-                const float *bufferTexCoordSet1 = nullptr;
-                const void * bufferJoints       = nullptr;
-                const float *bufferWeights      = nullptr;
-
-                int posByteStride;
-                int normByteStride;
-                int uv0ByteStride;
-                int uv1ByteStride;
-                int jointByteStride;
-                int weightByteStride;
-
-                int jointComponentType;
-
-                // Position attribute is required
-                assert(primitive.attributes.find("POSITION") != primitive.attributes.end());
-
-                const tinygltf::Accessor &  posAccessor = model.accessors[primitive.attributes.find("POSITION")->second];
-                const tinygltf::BufferView &posView     = model.bufferViews[posAccessor.bufferView];
-                bufferPos                               = reinterpret_cast<const float *>(&(model.buffers[posView.buffer].data[posAccessor.byteOffset + posView.byteOffset]));
-                posMin                                  = glm::vec3(posAccessor.minValues[0], posAccessor.minValues[1], posAccessor.minValues[2]);
-                posMax                                  = glm::vec3(posAccessor.maxValues[0], posAccessor.maxValues[1], posAccessor.maxValues[2]);
-                vertexCount                             = static_cast<uint32_t>(posAccessor.count);
-                posByteStride                           = posAccessor.ByteStride(posView) ? (posAccessor.ByteStride(posView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC3);
-
-                if (primitive.attributes.find("NORMAL") != primitive.attributes.end())
-                {
-                    const tinygltf::Accessor &  normAccessor = model.accessors[primitive.attributes.find("NORMAL")->second];
-                    const tinygltf::BufferView &normView     = model.bufferViews[normAccessor.bufferView];
-                    bufferNormals                            = reinterpret_cast<const float *>(&(model.buffers[normView.buffer].data[normAccessor.byteOffset + normView.byteOffset]));
-                    normByteStride                           = normAccessor.ByteStride(normView) ? (normAccessor.ByteStride(normView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC3);
-                }
-
-                if (primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end())
-                {
-                    const tinygltf::Accessor &  uvAccessor = model.accessors[primitive.attributes.find("TEXCOORD_0")->second];
-                    const tinygltf::BufferView &uvView     = model.bufferViews[uvAccessor.bufferView];
-                    bufferTexCoordSet0                     = reinterpret_cast<const float *>(&(model.buffers[uvView.buffer].data[uvAccessor.byteOffset + uvView.byteOffset]));
-                    uv0ByteStride                          = uvAccessor.ByteStride(uvView) ? (uvAccessor.ByteStride(uvView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC2);
-                }
-                if (primitive.attributes.find("TEXCOORD_1") != primitive.attributes.end())
-                {
-                    const tinygltf::Accessor &  uvAccessor = model.accessors[primitive.attributes.find("TEXCOORD_1")->second];
-                    const tinygltf::BufferView &uvView     = model.bufferViews[uvAccessor.bufferView];
-                    bufferTexCoordSet1                     = reinterpret_cast<const float *>(&(model.buffers[uvView.buffer].data[uvAccessor.byteOffset + uvView.byteOffset]));
-                    uv1ByteStride                          = uvAccessor.ByteStride(uvView) ? (uvAccessor.ByteStride(uvView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC2);
-                }
+            const tinygltf::Primitive &primitive = mesh.primitives[j];
 
-                // Skinning
-                // Joints
-                if (primitive.attributes.find("JOINTS_0") != primitive.attributes.end())
-                {
-                    const tinygltf::Accessor &  jointAccessor = model.accessors[primitive.attributes.find("JOINTS_0")->second];
-                    const tinygltf::BufferView &jointView     = model.bufferViews[jointAccessor.bufferView];
-                    bufferJoints                              = &(model.buffers[jointView.buffer].data[jointAccessor.byteOffset + jointView.byteOffset]);
-                    jointComponentType                        = jointAccessor.componentType;
-                    jointByteStride                           = jointAccessor.ByteStride(jointView) ? (jointAccessor.ByteStride(jointView) / tinygltf::GetComponentSizeInBytes(jointComponentType)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC4);
-                }
-
-                if (primitive.attributes.find("WEIGHTS_0") != primitive.attributes.end())
-                {
-                    const tinygltf::Accessor &  weightAccessor = model.accessors[primitive.attributes.find("WEIGHTS_0")->second];
-                    const tinygltf::BufferView &weightView     = model.bufferViews[weightAccessor.bufferView];
-                    bufferWeights                              = reinterpret_cast<const float *>(&(model.buffers[weightView.buffer].data[weightAccessor.byteOffset + weightView.byteOffset]));
-                    weightByteStride                           = weightAccessor.ByteStride(weightView) ? (weightAccessor.ByteStride(weightView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC4);
-                }
-
-                hasSkin = (bufferJoints && bufferWeights);
-
-                for (size_t v = 0; v < posAccessor.count; v++)
-                {
-                    Vertex vert{};
-                    vert.pos    = glm::vec4(glm::make_vec3(&bufferPos[v * posByteStride]), 1.0f);
-                    vert.normal = glm::normalize(glm::vec3(bufferNormals ? glm::make_vec3(&bufferNormals[v * normByteStride]) : glm::vec3(0.0f)));
-                    vert.uv0    = bufferTexCoordSet0 ? glm::make_vec2(&bufferTexCoordSet0[v * uv0ByteStride]) : glm::vec3(0.0f);
-                    vert.uv1    = bufferTexCoordSet1 ? glm::make_vec2(&bufferTexCoordSet1[v * uv1ByteStride]) : glm::vec3(0.0f);
+            // Position attribute is required
+            assert(primitive.attributes.find("POSITION") != primitive.attributes.end());
 
-                    if (hasSkin)
-                    {
-                        switch (jointComponentType)
-                        {
-                            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
-                                const uint16_t *buf = static_cast<const uint16_t *>(bufferJoints);
-                                vert.joint0         = glm::vec4(glm::make_vec4(&buf[v * jointByteStride]));
-                                break;
-                            }
-                            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
-                                const uint8_t *buf = static_cast<const uint8_t *>(bufferJoints);
-                                vert.joint0        = glm::vec4(glm::make_vec4(&buf[v * jointByteStride]));
-                                break;
-                            }
-                            default:
-                                // Not supported by spec
-                                LOGCATE("Joint component type  %d not supported!", jointComponentType);
-                                break;
-                        }
-                    }
-                    else
-                    {
-                        vert.joint0 = glm::vec4(0.0f);
-                    }
-                    vert.weight0 = hasSkin ? glm::make_vec4(&bufferWeights[v * weightByteStride]) : glm::vec4(0.0f);
-                    // Fix for all zero weights
-                    if (glm::length(vert.weight0) == 0.0f)
-                    {
-                        vert.weight0 = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-                    }
-                    vertexBuffer.push_back(vert);
-                }
-            }
-            // Indices
-            if (hasIndices)
-            {
-                const tinygltf::Accessor &  accessor   = model.accessors[primitive.indices > -1 ? primitive.indices : 0];
-                const tinygltf::BufferView &bufferView = model.bufferViews[accessor.bufferView];
-                const tinygltf::Buffer &    buffer     = model.buffers[bufferView.buffer];
+            const tinygltf::Accessor &posAccessor = model.accessors[primitive.attributes.find("POSITION")->second];
+            const glm::vec3           posMin      = glm::vec3(posAccessor.minValues[0], posAccessor.minValues[1], posAccessor.minValues[2]);
+            const glm::vec3           posMax      = glm::vec3(posAccessor.maxValues[0], posAccessor.maxValues[1], posAccessor.maxValues[2]);
+            const uint32_t            vertexCount = static_cast<uint32_t>(posAccessor.count);
+            const uint32_t            indexCount  = primitive.indices > -1 ? static_cast<uint32_t>(model.accessors[primitive.indices].count) : 0;
 
-                indexCount          = static_cast<uint32_t>(accessor.count);
-                const void *dataPtr = &(buffer.data[accessor.byteOffset + bufferView.byteOffset]);
+            loaderInfo.primitives.push_back({&primitive, loaderInfo.vertexCount, loaderInfo.indexCount});
 
-                switch (accessor.componentType)
-                {
-                    case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
-                        const uint32_t *buf = static_cast<const uint32_t *>(dataPtr);
-                        for (size_t index = 0; index < accessor.count; index++)
-                        {
-                            indexBuffer.push_back(buf[index] + vertexStart);
-                        }
-                        break;
-                    }
-                    case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
-                        const uint16_t *buf = static_cast<const uint16_t *>(dataPtr);
-                        for (size_t index = 0; index < accessor.count; index++)
-                        {
-                            indexBuffer.push_back(buf[index] + vertexStart);
-                        }
-                        break;
-                    }
-                    case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
-                        const uint8_t *buf = static_cast<const uint8_t *>(dataPtr);
-                        for (size_t index = 0; index < accessor.count; index++)
-                        {
-                            indexBuffer.push_back(buf[index] + vertexStart);
-                        }
-                        break;
-                    }
-                    default:
-                        LOGCATE("Index component type  %d not supported!", accessor.componentType);
-                        return;
-                }
-            }
-            Primitive *newPrimitive = new Primitive(indexStart, indexCount, vertexCount, primitive.material > -1 ? materials[primitive.material] : materials.back());
+            Primitive *newPrimitive = new Primitive(loaderInfo.indexCount, indexCount, vertexCount, primitive.material > -1 ? materials[primitive.material] : materials.back());
+            newPrimitive->firstVertex = loaderInfo.vertexCount;
             newPrimitive->setBoundingBox(posMin, posMax);
             newMesh->primitives.push_back(newPrimitive);
+
+            loaderInfo.vertexCount += vertexCount;
+            loaderInfo.indexCount += indexCount;
         }
         // Mesh BB from BBs of primitives
         for (auto p : newMesh->primitives)
@@ -712,6 +624,187 @@ void Model::loadNode(vkglTF::Node *parent, const tinygltf::Node &node, uint32_t
     linearNodes.push_back(newNode);
 }
 
+// Runs on the loader threads, the primitives write disjoint ranges of the buffers
+void Model::loadPrimitiveData(const tinygltf::Model &model, const LoaderInfo::PrimitiveRange &range, const VertexLayout &layout, uint8_t *vertexData, size_t attributeOffset, uint32_t *indexBuffer)
+{
+    const tinygltf::Primitive &primitive  = *range.primitive;
+    bool                       hasSkin    = false;
+    bool                       hasIndices = primitive.indices > -1;
+    // Vertices
+    {
+        const float *bufferPos          = nullptr;
+        const float *bufferNormals      = nullptr;
+        const float *bufferTexCoordSet0 = nullptr;
+        const float *bufferTexCoordSet1 = nullptr;
+        const void * bufferJoints       = nullptr;
+        const float *bufferWeights      = nullptr;
+
+        int posByteStride;
+        int normByteStride;
+        int uv0ByteStride;
+        int uv1ByteStride;
+        int jointByteStride;
+        int weightByteStride;
+
+        int jointComponentType;
+
+        const tinygltf::Accessor &  posAccessor = model.accessors[primitive.attributes.find("POSITION")->second];
+        const tinygltf::BufferView &posView     = model.bufferViews[posAccessor.bufferView];
+        bufferPos                               = reinterpret_cast<const float *>(&(model.buffers[posView.buffer].data[posAccessor.byteOffset + posView.byteOffset]));
+        posByteStride                           = posAccessor.ByteStride(posView) ? (posAccessor.ByteStride(posView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC3);
+
+        if (primitive.attributes.find("NORMAL") != primitive.attributes.end())
+        {
+            const tinygltf::Accessor &  normAccessor = model.accessors[primitive.attributes.find("NORMAL")->second];
+            const tinygltf::BufferView &normView     = model.bufferViews[normAccessor.bufferView];
+            bufferNormals                            = reinterpret_cast<const float *>(&(model.buffers[normView.buffer].data[normAccessor.byteOffset + normView.byteOffset]));
+            normByteStride                           = normAccessor.ByteStride(normView) ? (normAccessor.ByteStride(normView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC3);
+        }
+
+        if (primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end())
+        {
+            const tinygltf::Accessor &  uvAccessor = model.accessors[primitive.attributes.find("TEXCOORD_0")->second];
+            const tinygltf::BufferView &uvView     = model.bufferViews[uvAccessor.bufferView];
+            bufferTexCoordSet0                     = reinterpret_cast<const float *>(&(model.buffers[uvView.buffer].data[uvAccessor.byteOffset + uvView.byteOffset]));
+            uv0ByteStride                          = uvAccessor.ByteStride(uvView) ? (uvAccessor.ByteStride(uvView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC2);
+        }
+        if (primitive.attributes.find("TEXCOORD_1") != primitive.attributes.end())
+        {
+            const tinygltf::Accessor &  uvAccessor = model.accessors[primitive.attributes.find("TEXCOORD_1")->second];
+            const tinygltf::BufferView &uvView     = model.bufferViews[uvAccessor.bufferView];
+            bufferTexCoordSet1                     = reinterpret_cast<const float *>(&(model.buffers[uvView.buffer].data[uvAccessor.byteOffset + uvView.byteOffset]));
+            uv1ByteStride                          = uvAccessor.ByteStride(uvView) ? (uvAccessor.ByteStride(uvView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC2);
+        }
+
+        // Skinning
+        // Joints
+        if (primitive.attributes.find("JOINTS_0") != primitive.attributes.end())
+        {
+            const tinygltf::Accessor &  jointAccessor = model.accessors[primitive.attributes.find("JOINTS_0")->second];
+            const tinygltf::BufferView &jointView     = model.bufferViews[jointAccessor.bufferView];
+            bufferJoints                              = &(model.buffers[jointView.buffer].data[jointAccessor.byteOffset + jointView.byteOffset]);
+            jointComponentType                        = jointAccessor.componentType;
+            jointByteStride                           = jointAccessor.ByteStride(jointView) ? (jointAccessor.ByteStride(jointView) / tinygltf::GetComponentSizeInBytes(jointComponentType)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC4);
+        }
+
+        if (primitive.attributes.find("WEIGHTS_0") != primitive.attributes.end())
+        {
+            const tinygltf::Accessor &  weightAccessor = model.accessors[primitive.attributes.find("WEIGHTS_0")->second];
+            const tinygltf::BufferView &weightView     = model.bufferViews[weightAccessor.bufferView];
+            bufferWeights                              = reinterpret_cast<const float *>(&(model.buffers[weightView.buffer].data[weightAccessor.byteOffset + weightView.byteOffset]));
+            weightByteStride                           = weightAccessor.ByteStride(weightView) ? (weightAccessor.ByteStride(weightView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC4);
+        }
+
+        hasSkin = (bufferJoints && bufferWeights);
+
+        const bool     standardLayout = layout == VertexLayout::standard();
+        const uint32_t strides[2]     = {layout.stride(0), layout.stride(1)};
+        uint8_t *const streams[2]     = {vertexData, vertexData + attributeOffset};
+        uint32_t       offsets[VertexLayout::LOCATION_COUNT];
+        for (uint32_t location = 0; location < VertexLayout::LOCATION_COUNT; location++)
+        {
+            offsets[location] = layout.has(static_cast<VertexLayout::Location>(location)) ? layout.offset(static_cast<VertexLayout::Location>(location)) : 0;
+        }
+
+        for (size_t v = 0; v < posAccessor.count; v++)
+        {
+            Vertex vert{};
+            vert.pos    = glm::vec4(glm::make_vec3(&bufferPos[v * posByteStride]), 1.0f);
+            vert.normal = glm::normalize(glm::vec3(bufferNormals ? glm::make_vec3(&bufferNormals[v * normByteStride]) : glm::vec3(0.0f)));
+            vert.uv0    = bufferTexCoordSet0 ? glm::make_vec2(&bufferTexCoordSet0[v * uv0ByteStride]) : glm::vec3(0.0f);
+            vert.uv1    = bufferTexCoordSet1 ? glm::make_vec2(&bufferTexCoordSet1[v * uv1ByteStride]) : glm::vec3(0.0f);
+
+            if (hasSkin)
+            {
+                switch (jointComponentType)
+                {
+                    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+                        const uint16_t *buf = static_cast<const uint16_t *>(bufferJoints);
+                        vert.joint0         = glm::vec4(glm::make_vec4(&buf[v * jointByteStride]));
+                        break;
+                    }
+                    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+                        const uint8_t *buf = static_cast<const uint8_t *>(bufferJoints);
+                        vert.joint0        = glm::vec4(glm::make_vec4(&buf[v * jointByteStride]));
+                        break;
+                    }
+                    default:
+                        // Not supported by spec
+                        LOGCATE("Joint component type  %d not supported!", jointComponentType);
+                        break;
+                }
+            }
+            else
+            {
+                vert.joint0 = glm::vec4(0.0f);
+            }
+            vert.weight0 = hasSkin ? glm::make_vec4(&bufferWeights[v * weightByteStride]) : glm::vec4(0.0f);
+            // Fix for all zero weights
+            if (glm::length(vert.weight0) == 0.0f)
+            {
+                vert.weight0 = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+            }
+            if (standardLayout)
+            {
+                memcpy(vertexData + (range.firstVertex + v) * sizeof(Vertex), &vert, sizeof(Vertex));
+                continue;
+            }
+            const glm::vec4 attributes[VertexLayout::LOCATION_COUNT] = {
+                glm::vec4(vert.pos, 1.0f), glm::vec4(vert.normal, 0.0f), glm::vec4(vert.uv0, 0.0f, 0.0f),
+                glm::vec4(vert.uv1, 0.0f, 0.0f), vert.joint0, vert.weight0};
+            for (uint32_t location = 0; location < VertexLayout::LOCATION_COUNT; location++)
+            {
+                const VertexLayout::Location attribute = static_cast<VertexLayout::Location>(location);
+                if (layout.has(attribute))
+                {
+                    const uint32_t binding = layout.binding(attribute);
+                    layout.encode(attribute, attributes[location], streams[binding] + (range.firstVertex + v) * strides[binding] + offsets[location]);
+                }
+            }
+        }
+    }
+    // Indices
+    if (hasIndices)
+    {
+        const tinygltf::Accessor &  accessor   = model.accessors[primitive.indices > -1 ? primitive.indices : 0];
+        const tinygltf::BufferView &bufferView = model.bufferViews[accessor.bufferView];
+        const tinygltf::Buffer &    buffer     = model.buffers[bufferView.buffer];
+
+        const void *dataPtr = &(buffer.data[accessor.byteOffset + bufferView.byteOffset]);
+
+        switch (accessor.componentType)
+        {
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
+                const uint32_t *buf = static_cast<const uint32_t *>(dataPtr);
+                for (size_t index = 0; index < accessor.count; index++)
+                {
+                    indexBuffer[range.firstIndex + index] = buf[index] + range.firstVertex;
+                }
+                break;
+            }
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
+                const uint16_t *buf = static_cast<const uint16_t *>(dataPtr);
+                for (size_t index = 0; index < accessor.count; index++)
+                {
+                    indexBuffer[range.firstIndex + index] = buf[index] + range.firstVertex;
+                }
+                break;
+            }
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
+                const uint8_t *buf = static_cast<const uint8_t *>(dataPtr);
+                for (size_t index = 0; index < accessor.count; index++)
+                {
+                    indexBuffer[range.firstIndex + index] = buf[index] + range.firstVertex;
+                }
+                break;
+            }
+            default:
+                LOGCATE("Index component type  %d not supported!", accessor.componentType);
+                return;
+        }
+    }
+}
+
 void Model::loadSkins(tinygltf::Model &gltfModel)
 {
     for (tinygltf::Skin &source : gltfModel.skins)
@@ -751,11 +844,16 @@ void Model::loadSkins(tinygltf::Model &gltfModel)
 
 void Model::loadTextures(tinygltf::Model &                         gltfModel,
                          std::shared_ptr<vks::VulkanDeviceWrapper> device,
-                         VkQueue                                   transferQueue)
+                         VkQueue                                   transferQueue,
+                         std::vector<std::future<void>> &          imageDecodes)
 {
-    for (tinygltf::Texture &tex : gltfModel.textures)
+    // Usually sized by loadFromFile already, before the materials point into it
+    textures.resize(gltfModel.textures.size());
+    for (size_t i = 0; i < gltfModel.textures.size(); i++)
     {
-        tinygltf::Image        image = gltfModel.images[tex.source];
+        const tinygltf::Texture &tex = gltfModel.textures[i];
+        imageDecodes[tex.source].wait();
+        tinygltf::Image &      image = gltfModel.images[tex.source];
         vkglTF::TextureSampler textureSampler;
         if (tex.sampler == -1)
         {
@@ -770,9 +868,7 @@ void Model::loadTextures(tinygltf::Model &                         gltfModel,
         {
             textureSampler = textureSamplers[tex.sampler];
         }
-        vkglTF::Texture texture;
-        texture.fromglTfImage(image, textureSampler, device, transferQueue);
-        textures.push_back(texture);
+        textures[i].fromglTfImage(image, textureSampler, device, transferQueue);
     }
 }
 
@@ -1064,7 +1160,7 @@ void Model::loadAnimations(tinygltf::Model &gltfModel)
     }
 }
 
-void Model::loadFromFile(std::string filename, std::shared_ptr<vks::VulkanDeviceWrapper> device, VkQueue transferQueue, float scale)
+void Model::loadFromFile(std::string filename, std::shared_ptr<vks::VulkanDeviceWrapper> device, VkQueue transferQueue, float scale, uint32_t threadCount)
 {
     tinygltf::Model    gltfModel;
     tinygltf::TinyGLTF gltfContext;
@@ -1080,107 +1176,161 @@ void Model::loadFromFile(std::string filename, std::shared_ptr<vks::VulkanDevice
         binary = (filename.substr(extpos + 1, filename.length() - extpos) == "glb");
     }
 
+    if (gAssets)
+    {
+        gltfContext.SetFsCallbacks({assetExists, expandAssetPath, readAsset, writeAsset, gAssets.get()});
+    }
+    // The images are decoded after parsing, in parallel
+    gltfContext.SetImageLoader(keepEncodedImage, nullptr);
     bool fileLoaded = binary ? gltfContext.LoadBinaryFromFile(&gltfModel, &error, &warning, filename.c_str()) : gltfContext.LoadASCIIFromFile(&gltfModel, &error, &warning, filename.c_str());
 
-    std::vector<uint32_t> indexBuffer;
-    std::vector<Vertex>   vertexBuffer;
+    if (!fileLoaded)
+    {
+        // TODO: throw
+        LOGCATE("Could not load gltf file ");
+        return;
+    }
 
-    if (fileLoaded)
+    // Without a pool the tasks run on the calling thread when they are submitted
+    std::unique_ptr<vks::ThreadPool> pool;
+    if (threadCount != 1)
     {
-        loadTextureSamplers(gltfModel);
-        loadTextures(gltfModel, device, transferQueue);
-        loadMaterials(gltfModel);
-        // TODO: scene handling with no default scene
-        const tinygltf::Scene &scene = gltfModel.scenes[gltfModel.defaultScene > -1 ? gltfModel.defaultScene : 0];
-        for (size_t i = 0; i < scene.nodes.size(); i++)
-        {
-            const tinygltf::Node node = gltfModel.nodes[scene.nodes[i]];
-            loadNode(nullptr, node, scene.nodes[i], gltfModel, indexBuffer, vertexBuffer, scale);
-        }
-        if (gltfModel.animations.size() > 0)
+        pool = std::make_unique<vks::ThreadPool>(threadCount);
+    }
+    const auto submit = [&pool](std::function<void()> task) {
+        if (pool)
         {
-            loadAnimations(gltfModel);
+            return pool->submit(std::move(task));
         }
-        loadSkins(gltfModel);
+        std::packaged_task<void()> packaged(std::move(task));
+        packaged();
+        return packaged.get_future();
+    };
+
+    // The decoding overlaps with building the scene below
+    std::vector<std::future<void>> imageDecodes;
+    for (tinygltf::Image &image : gltfModel.images)
+    {
+        imageDecodes.push_back(submit([&image]() { decodeImage(image); }));
+    }
 
-        for (auto node : linearNodes)
+    // The materials point into textures, they are created in place by loadTextures
+    textures.resize(gltfModel.textures.size());
+    loadTextureSamplers(gltfModel);
+    loadMaterials(gltfModel);
+
+    LoaderInfo loaderInfo;
+    // TODO: scene handling with no default scene
+    const tinygltf::Scene &scene = gltfModel.scenes[gltfModel.defaultScene > -1 ? gltfModel.defaultScene : 0];
+    for (size_t i = 0; i < scene.nodes.size(); i++)
+    {
+        const tinygltf::Node &node = gltfModel.nodes[scene.nodes[i]];
+        loadNode(nullptr, node, scene.nodes[i], gltfModel, loaderInfo, scale);
+    }
+
+    if (!vertexLayout.isValid())
+    {
+        LOGCATE("Model::loadFromFile: Unsupported vertex layout, loading the standard one");
+        vertexLayout = VertexLayout::standard();
+    }
+    // Joint indices are relative to the skin, narrow joints are widened for the largest skin
+    size_t maxJointCount = 0;
+    for (const tinygltf::Skin &skin : gltfModel.skins)
+    {
+        maxJointCount = std::max(maxJointCount, skin.joints.size());
+    }
+    if (maxJointCount > 0 && maxJointCount - 1 > vertexLayout.maxJointIndex() && vertexLayout.has(VertexLayout::JOINT0))
+    {
+        LOGCATI("Model::loadFromFile: %zu joints in a skin, storing the joints in 16 bits", maxJointCount);
+        vertexLayout.formats[VertexLayout::JOINT0] = VK_FORMAT_R16G16B16A16_UINT;
+    }
+
+    // Each primitive fills its own ranges of the buffers. The attribute stream of a split layout
+    // follows the positions, aligned for its largest attribute.
+    const size_t positionBytes = static_cast<size_t>(loaderInfo.vertexCount) * vertexLayout.stride(0);
+    vertices.attributeOffset   = vertexLayout.splitPositions ? (positionBytes + 15) & ~static_cast<size_t>(15) : 0;
+    std::vector<uint8_t>           vertexBuffer(vertexLayout.splitPositions ? vertices.attributeOffset + static_cast<size_t>(loaderInfo.vertexCount) * vertexLayout.stride(1) : positionBytes);
+    std::vector<uint32_t>          indexBuffer(loaderInfo.indexCount);
+    std::vector<std::future<void>> primitiveLoads;
+    for (const LoaderInfo::PrimitiveRange &range : loaderInfo.primitives)
+    {
+        primitiveLoads.push_back(submit([this, &gltfModel, &range, &vertexBuffer, &indexBuffer]() {
+            loadPrimitiveData(gltfModel, range, vertexLayout, vertexBuffer.data(), vertices.attributeOffset, indexBuffer.data());
+        }));
+    }
+
+    if (gltfModel.animations.size() > 0)
+    {
+        loadAnimations(gltfModel);
+    }
+    loadSkins(gltfModel);
+
+    for (auto node : linearNodes)
+    {
+        // Assign skins
+        if (node->skinIndex > -1)
         {
-            // Assign skins
-            if (node->skinIndex > -1)
-            {
-                node->skin = skins[node->skinIndex];
-            }
-            // Initial pose
-            if (node->mesh)
-            {
-                node->update();
-            }
+            node->skin = skins[node->skinIndex];
         }
     }
-    else
+    // Initial pose
+    transforms.build(nodes);
+    updateTransforms();
+
+    // Recorded in the order of the textures, each as soon as its image is decoded
+    loadTextures(gltfModel, device, transferQueue, imageDecodes);
+
+    for (auto &load : primitiveLoads)
     {
-        // TODO: throw
-        LOGCATE("Could not load gltf file ");
-        return;
+        load.wait();
     }
 
     extensions = gltfModel.extensionsUsed;
 
-    size_t vertexBufferSize = vertexBuffer.size() * sizeof(Vertex);
+    size_t vertexBufferSize = vertexBuffer.size();
     size_t indexBufferSize  = indexBuffer.size() * sizeof(uint32_t);
     indices.count           = static_cast<uint32_t>(indexBuffer.size());
 
     assert(vertexBufferSize > 0);
 
-    // Create staging buffers
+    // Stage the data in the shared staging ring
     // Vertex data
-    auto vertexStaging = vks::Buffer::create(
-        device,
-        vertexBufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    vertexStaging->map();
-    vertexStaging->copyFrom(vertexBuffer.data(), vertexBufferSize);
-    vertexStaging->unmap();
-
-    vks::debug::setDeviceMemoryName(this->device->logicalDevice, vertexStaging->getMemoryHandle(), "VulkanglTFModel-loadFromFile-vertexStaging");
+    vks::StagingRing::Allocation vertexStaging;
+    if (!device->getStagingRing()->upload(vertexBuffer.data(), vertexBufferSize, &vertexStaging))
+    {
+        LOGCATE("Model::loadFromFile: Failed to allocate %zu staging bytes", vertexBufferSize);
+        return;
+    }
 
     // Create device local buffers
-    // Vertex buffer
+    // Vertex buffer, also read by ComputeSkinner in the standard layout
     vertices.buffer = vks::Buffer::create(
         device,
         vertexBufferSize,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
     vks::debug::setDeviceMemoryName(this->device->logicalDevice, vertices.buffer->getMemoryHandle(), "VulkanglTFModel-loadFromFile-vertices.buffer");
 
-    // Copy from staging buffers
-    VkCommandBuffer copyCmd = device->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+    // Copy from staging buffers, the copies are batched with the texture uploads and submitted
+    // with the next frame
+    vks::UploadManager *uploadManager = device->getUploadManager();
 
     VkBufferCopy copyRegion = {};
 
-    copyRegion.size = vertexBufferSize;
-    vkCmdCopyBuffer(copyCmd,
-                    vertexStaging->getBufferHandle(),
-                    vertices.buffer->getBufferHandle(),
-                    1,
-                    &copyRegion);
+    copyRegion.srcOffset = vertexStaging.offset;
+    copyRegion.size      = vertexBufferSize;
+    uploadManager->copyBuffer(vertexStaging.buffer, vertices.buffer->getBufferHandle(), 1, &copyRegion);
 
     // Index data
-    std::unique_ptr<vks::Buffer> indexStaging;
     if (indexBufferSize > 0)
     {
-        indexStaging = vks::Buffer::create(
-            device,
-            indexBufferSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        indexStaging->map();
-        indexStaging->copyFrom(indexBuffer.data(), indexBufferSize);
-        indexStaging->unmap();
-
-        vks::debug::setDeviceMemoryName(this->device->logicalDevice, indexStaging->getMemoryHandle(), "VulkanglTFModel-loadFromFile-indexStaging");
+        vks::StagingRing::Allocation indexStaging;
+        if (!device->getStagingRing()->upload(indexBuffer.data(), indexBufferSize, &indexStaging))
+        {
+            LOGCATE("Model::loadFromFile: Failed to allocate %zu staging bytes", indexBufferSize);
+            return;
+        }
 
         // Create device local buffers
         indices.buffer = vks::Buffer::create(
@@ -1191,16 +1341,11 @@ void Model::loadFromFile(std::string filename, std::shared_ptr<vks::VulkanDevice
 
         vks::debug::setDeviceMemoryName(this->device->logicalDevice, indices.buffer->getMemoryHandle(), "VulkanglTFModel-loadFromFile-indices.buffer");
 
-        copyRegion.size = indexBufferSize;
-        vkCmdCopyBuffer(copyCmd,
-                        indexStaging->getBufferHandle(),
-                        indices.buffer->getBufferHandle(),
-                        1,
-                        &copyRegion);
+        copyRegion.srcOffset = indexStaging.offset;
+        copyRegion.size      = indexBufferSize;
+        uploadManager->copyBuffer(indexStaging.buffer, indices.buffer->getBufferHandle(), 1, &copyRegion);
     }
 
-    device->endAndSubmitSingleTimeCommand(copyCmd, transferQueue, true);
-
     getSceneDimensions();
 }
 
@@ -1219,12 +1364,17 @@ void Model::drawNode(Node *node, VkCommandBuffer commandBuffer)
     }
 }
 
+void Model::bindVertexBuffers(VkCommandBuffer commandBuffer)
+{
+    const VkDeviceSize offsets[2]     = {0, vertices.attributeOffset};
+    const VkBuffer     verticesBuf[2] = {vertices.buffer->getBufferHandle(), vertices.buffer->getBufferHandle()};
+    vkCmdBindVertexBuffers(commandBuffer, 0, vertexLayout.bindingCount(), verticesBuf, offsets);
+}
+
 void Model::draw(VkCommandBuffer commandBuffer)
 {
-    const VkDeviceSize offsets[1]  = {0};
-    auto               verticesBuf = vertices.buffer->getBufferHandle();
-    auto               indicesBuf  = indices.buffer->getBufferHandle();
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &verticesBuf, offsets);
+    auto indicesBuf = indices.buffer->getBufferHandle();
+    bindVertexBuffers(commandBuffer);
     vkCmdBindIndexBuffer(commandBuffer, indicesBuf, 0, VK_INDEX_TYPE_UINT32);
     for (auto &node : nodes)
     {
@@ -1298,62 +1448,25 @@ void Model::updateAnimation(uint32_t index, float time)
         LOGCATE("No animation with index %d", index);
         return;
     }
-    Animation &animation = animations[index];
+    blendAnimations({{index, time, 1.0f}});
+}
 
-    bool updated = false;
-    for (auto &channel : animation.channels)
-    {
-        vkglTF::AnimationSampler &sampler = animation.samplers[channel.samplerIndex];
-        if (sampler.inputs.size() > sampler.outputsVec4.size())
-        {
-            continue;
-        }
+void Model::blendAnimations(const std::vector<AnimationEvaluator::Layer> &layers)
+{
+    animator.evaluate(*this, layers);
+    updateTransforms();
+}
 
-        for (size_t i = 0; i < sampler.inputs.size() - 1; i++)
-        {
-            if ((time >= sampler.inputs[i]) && (time <= sampler.inputs[i + 1]))
-            {
-                float u = std::max(0.0f, time - sampler.inputs[i]) / (sampler.inputs[i + 1] - sampler.inputs[i]);
-                if (u <= 1.0f)
-                {
-                    switch (channel.path)
-                    {
-                        case vkglTF::AnimationChannel::PathType::TRANSLATION: {
-                            glm::vec4 trans           = glm::mix(sampler.outputsVec4[i], sampler.outputsVec4[i + 1], u);
-                            channel.node->translation = glm::vec3(trans);
-                            break;
-                        }
-                        case vkglTF::AnimationChannel::PathType::SCALE: {
-                            glm::vec4 trans     = glm::mix(sampler.outputsVec4[i], sampler.outputsVec4[i + 1], u);
-                            channel.node->scale = glm::vec3(trans);
-                            break;
-                        }
-                        case vkglTF::AnimationChannel::PathType::ROTATION: {
-                            glm::quat q1;
-                            q1.x = sampler.outputsVec4[i].x;
-                            q1.y = sampler.outputsVec4[i].y;
-                            q1.z = sampler.outputsVec4[i].z;
-                            q1.w = sampler.outputsVec4[i].w;
-                            glm::quat q2;
-                            q2.x                   = sampler.outputsVec4[i + 1].x;
-                            q2.y                   = sampler.outputsVec4[i + 1].y;
-                            q2.z                   = sampler.outputsVec4[i + 1].z;
-                            q2.w                   = sampler.outputsVec4[i + 1].w;
-                            channel.node->rotation = glm::normalize(glm::slerp(q1, q2, u));
-                            break;
-                        }
-                    }
-                    updated = true;
-                }
-            }
-        }
+void Model::updateTransforms()
+{
+    // Each node matrix is computed once, then only the meshes whose matrices changed are uploaded
+    if (transforms.update() == 0)
+    {
+        return;
     }
-    if (updated)
+    for (auto node : linearNodes)
     {
-        for (auto &node : nodes)
-        {
-            node->update();
-        }
+        node->update(!computeSkinned);
     }
 }
 
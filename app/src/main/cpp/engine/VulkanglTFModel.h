@@ -26,12 +26,16 @@
 #pragma once
 
 #include <fstream>
+#include <future>
 #include <stdlib.h>
 #include <string>
 #include <vector>
 
 #include "VulkanDeviceWrapper.hpp"
 #include "VulkanImageWrapper.h"
+#include "VulkanglTFAnimation.h"
+#include "VulkanglTFTransformHierarchy.h"
+#include "VulkanglTFVertexLayout.h"
 
 /*#include <ktx/include/ktx.h>
 #include <ktx/include/ktxvulkan.h>*/
@@ -44,29 +48,19 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #define TINYGLTF_NO_STB_IMAGE_WRITE
-#ifdef VK_USE_PLATFORM_ANDROID_KHR
-#    define TINYGLTF_ANDROID_LOAD_FROM_ASSETS
-#endif
 
+#include "../util/AssetUtil.h"
 #include "../util/tinygltf/tiny_gltf.h"
 #include "VulkanBufferWrapper.h"
 
-#if defined(__ANDROID__)
-
-#    include <android/asset_manager.h>
-
-#endif
-
 // Changing this value here also requires changing it in the vertex shader
 #define MAX_NUM_JOINTS 128u
 
 namespace vkglTF
 {
-#ifdef __ANDROID__
-#    ifdef TINYGLTF_ANDROID_LOAD_FROM_ASSETS
-void setupAssetManager(AAssetManager *assetManager);
-#    endif
-#endif
+// Assets the models and their buffers and images are read from (the APK assets on Android,
+// directories on the host), to be set before Model::loadFromFile
+void setupAssetLoader(std::shared_ptr<vks::AssetLoader> assets);
 
 struct Node;
 
@@ -160,6 +154,8 @@ struct Primitive
     uint32_t  firstIndex;
     uint32_t  indexCount;
     uint32_t  vertexCount;
+    // Of the vertices in Model::vertices, the primitives of a mesh are contiguous
+    uint32_t  firstVertex = 0;
     Material &material;
 
     bool        hasIndices;
@@ -216,17 +212,26 @@ struct Node
     Mesh *              mesh;
     Skin *              skin;
     int32_t             skinIndex = -1;
+    // Local transform as loaded, the model moves it into transforms where the animations set it
     glm::vec3           translation{};
     glm::vec3           scale{1.0f};
     glm::quat           rotation{};
     BoundingBox         bvh;
     BoundingBox         aabb;
+    // Set by TransformHierarchy::build
+    TransformHierarchy *transforms     = nullptr;
+    uint32_t            transformIndex = 0;
 
     glm::mat4 localMatrix();
 
+    // Cached by transforms as of its last update, composed up the parent chain for a node without
+    // transforms
     glm::mat4 getMatrix();
 
-    void update();
+    // Upload the matrix of the mesh and the joint matrices of its skin, only if one of them
+    // changed in the last update of transforms. Without jointMatrices only the mesh matrix is
+    // uploaded, for skins applied elsewhere (see ComputeSkinner)
+    void update(bool jointMatrices = true);
 
     ~Node();
 };
@@ -280,9 +285,15 @@ struct Model
         glm::vec4 weight0;
     };
 
+    // Format of the vertex buffer, set before loadFromFile. Model::Vertex is the standard layout,
+    // loadFromFile may widen the joints of a compact one when a skin has more joints than they hold.
+    VertexLayout vertexLayout;
+
     struct Vertices
     {
         std::unique_ptr<vks::Buffer> buffer;
+        // Start of binding 1 in buffer when vertexLayout.splitPositions is set
+        VkDeviceSize attributeOffset = 0;
     } vertices;
     struct Indices
     {
@@ -294,6 +305,12 @@ struct Model
 
     std::vector<Node *> nodes;
     std::vector<Node *> linearNodes;
+    // Transforms of all the nodes, parents first
+    TransformHierarchy  transforms;
+    AnimationEvaluator  animator;
+    // Set while a ComputeSkinner skins the vertices, the joint matrices then stay out of the mesh
+    // uniform blocks
+    bool                computeSkinned = false;
 
     std::vector<Skin *> skins;
 
@@ -309,21 +326,45 @@ struct Model
         glm::vec3 max = glm::vec3(-FLT_MAX);
     } dimensions;
 
+    // Vertex and index ranges reserved by loadNode, the primitives are then read into them in
+    // parallel
+    struct LoaderInfo
+    {
+        struct PrimitiveRange
+        {
+            const tinygltf::Primitive *primitive;
+            uint32_t                   firstVertex;
+            uint32_t                   firstIndex;
+        };
+        std::vector<PrimitiveRange> primitives;
+        uint32_t                    vertexCount = 0;
+        uint32_t                    indexCount  = 0;
+    };
+
     void                 destroy(VkDevice device);
-    void                 loadNode(vkglTF::Node *parent, const tinygltf::Node &node, uint32_t nodeIndex, const tinygltf::Model &model, std::vector<uint32_t> &indexBuffer, std::vector<Vertex> &vertexBuffer, float globalscale);
+    void                 loadNode(vkglTF::Node *parent, const tinygltf::Node &node, uint32_t nodeIndex, const tinygltf::Model &model, LoaderInfo &loaderInfo, float globalscale);
+    // The vertices are written in layout, binding 1 starting at attributeOffset of vertexData
+    static void          loadPrimitiveData(const tinygltf::Model &model, const LoaderInfo::PrimitiveRange &range, const VertexLayout &layout, uint8_t *vertexData, size_t attributeOffset, uint32_t *indexBuffer);
     void                 loadSkins(tinygltf::Model &gltfModel);
-    void                 loadTextures(tinygltf::Model &gltfModel, std::shared_ptr<vks::VulkanDeviceWrapper> device, VkQueue transferQueue);
+    // imageDecodes holds a future per image of gltfModel, each texture waits for the one of its image
+    void                 loadTextures(tinygltf::Model &gltfModel, std::shared_ptr<vks::VulkanDeviceWrapper> device, VkQueue transferQueue, std::vector<std::future<void>> &imageDecodes);
     VkSamplerAddressMode getVkWrapMode(int32_t wrapMode);
     VkFilter             getVkFilterMode(int32_t filterMode);
     void                 loadTextureSamplers(tinygltf::Model &gltfModel);
     void                 loadMaterials(tinygltf::Model &gltfModel);
     void                 loadAnimations(tinygltf::Model &gltfModel);
-    void                 loadFromFile(std::string filename, std::shared_ptr<vks::VulkanDeviceWrapper> device, VkQueue transferQueue, float scale = 1.0f);
+    // Images are decoded and primitives read on threadCount threads, 0 uses one per core and 1 loads
+    // everything on the calling thread. The uploads are recorded into the open upload batch.
+    void                 loadFromFile(std::string filename, std::shared_ptr<vks::VulkanDeviceWrapper> device, VkQueue transferQueue, float scale = 1.0f, uint32_t threadCount = 0);
     void                 drawNode(Node *node, VkCommandBuffer commandBuffer);
     void                 draw(VkCommandBuffer commandBuffer);
+    // The bindings of vertexLayout, for pipelines drawing the primitives themselves
+    void                 bindVertexBuffers(VkCommandBuffer commandBuffer);
     void                 calculateBoundingBox(Node *node, Node *parent);
     void                 getSceneDimensions();
     void                 updateAnimation(uint32_t index, float time);
+    void                 blendAnimations(const std::vector<AnimationEvaluator::Layer> &layers);
+    void                 updateTransforms();
     Node *               findNode(Node *parent, uint32_t index);
     Node *               nodeFromIndex(uint32_t index);
 };
@@ -0,0 +1,281 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanglTFSkinning.h"
+
+#include <LogUtil.h>
+#include <algorithm>
+
+#include "VulkanDebug.h"
+#include "VulkanInitializers.hpp"
+#include "VulkanglTFModel.h"
+
+namespace vkglTF
+{
+const char *ComputeSkinner::shaderPath()
+{
+    return "shaders/gltf_skinning.comp.spv";
+}
+
+std::unique_ptr<ComputeSkinner> ComputeSkinner::create(Model *model, VkPipelineCache pipelineCache,
+                                                       const VkPipelineShaderStageCreateInfo &shaderStage)
+{
+    auto       skinner = std::make_unique<ComputeSkinner>(model);
+    const bool success = skinner->prepare(pipelineCache, shaderStage);
+    return success ? std::move(skinner) : nullptr;
+}
+
+ComputeSkinner::ComputeSkinner(Model *model) :
+    mModel(model),
+    mDeviceWrapper(model->device),
+    mDescriptorPool(model->device->logicalDevice),
+    mDescriptorSetLayout(model->device->logicalDevice),
+    mPipelineLayout(model->device->logicalDevice),
+    mPipeline(model->device->logicalDevice)
+{}
+
+ComputeSkinner::~ComputeSkinner()
+{
+    // The last skinning may still use the pipeline and the buffers
+    if (mLastToken != 0)
+    {
+        mDeviceWrapper->getUploadManager()->wait(mLastToken);
+    }
+    mModel->computeSkinned = false;
+}
+
+bool ComputeSkinner::prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage)
+{
+    if (mModel->vertices.buffer == nullptr)
+    {
+        LOGCATE("ComputeSkinner: The model has no vertices");
+        return false;
+    }
+    // The shader reads and writes Model::Vertex
+    if (mModel->vertexLayout != VertexLayout::standard())
+    {
+        LOGCATE("ComputeSkinner: The model is not loaded in the standard vertex layout");
+        return false;
+    }
+
+    // A range per mesh, the skinned ones take their joints from the palette one after another
+    for (Node *node : mModel->linearNodes)
+    {
+        if (node->mesh == nullptr || node->mesh->primitives.empty())
+            continue;
+        uint32_t first = UINT32_MAX, end = 0;
+        for (const Primitive *primitive : node->mesh->primitives)
+        {
+            first = std::min(first, primitive->firstVertex);
+            end   = std::max(end, primitive->firstVertex + primitive->vertexCount);
+        }
+        Range range = {node, first, end - first, NO_SKIN};
+        if (node->skin != nullptr && !node->skin->joints.empty())
+        {
+            range.firstJoint = mJointCount;
+            mJointCount += static_cast<uint32_t>(node->skin->joints.size());
+        }
+        mRanges.push_back(range);
+    }
+
+    const VkDeviceSize vertexBufferSize = mModel->vertices.buffer->getDescriptor().range;
+    mSkinned = vks::Buffer::create(mDeviceWrapper, static_cast<uint32_t>(vertexBufferSize),
+                                   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (mSkinned == nullptr)
+    {
+        LOGCATE("ComputeSkinner: Failed to create the %llu byte vertex buffer", (unsigned long long) vertexBufferSize);
+        return false;
+    }
+    vks::debug::setDeviceMemoryName(mDeviceWrapper->logicalDevice, mSkinned->getMemoryHandle(),
+                                    "ComputeSkinner-mSkinned");
+
+    // The slots are bound with a dynamic offset
+    const VkDeviceSize alignment = std::max<VkDeviceSize>(
+        mDeviceWrapper->properties.limits.minStorageBufferOffsetAlignment, 1);
+    mSlotSize = std::max(mJointCount, 1u) * sizeof(glm::mat4);
+    mSlotSize = (mSlotSize + alignment - 1) / alignment * alignment;
+    mPalette  = vks::Buffer::create(mDeviceWrapper, static_cast<uint32_t>(mSlotSize * PALETTE_SLOTS),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (mPalette == nullptr || mPalette->map() != VK_SUCCESS)
+    {
+        LOGCATE("ComputeSkinner: Failed to create the palette of %u joints", mJointCount);
+        return false;
+    }
+
+    // Binding 0: the loaded vertices, 1: the skinned vertices, 2: the joint palette
+    const std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings = {
+        vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 0),
+        vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 1),
+        vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+                                                      VK_SHADER_STAGE_COMPUTE_BIT, 2),
+    };
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = vks::initializers::descriptorSetLayoutCreateInfo(
+        setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+    CALL_VK(vkCreateDescriptorSetLayout(mDeviceWrapper->logicalDevice, &descriptorLayout, nullptr,
+                                        mDescriptorSetLayout.pHandle()));
+
+    const VkPushConstantRange pushConstantRange =
+        vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 3 * sizeof(uint32_t), 0);
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo =
+        vks::initializers::pipelineLayoutCreateInfo(mDescriptorSetLayout.pHandle(), 1);
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
+    CALL_VK(vkCreatePipelineLayout(mDeviceWrapper->logicalDevice, &pipelineLayoutCreateInfo, nullptr,
+                                   mPipelineLayout.pHandle()));
+
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2),
+        vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1),
+    };
+    const VkDescriptorPoolCreateInfo descriptorPoolInfo = vks::initializers::descriptorPoolCreateInfo(poolSizes, 1);
+    CALL_VK(vkCreateDescriptorPool(mDeviceWrapper->logicalDevice, &descriptorPoolInfo, nullptr,
+                                   mDescriptorPool.pHandle()));
+
+    VkDescriptorSetAllocateInfo allocInfo =
+        vks::initializers::descriptorSetAllocateInfo(mDescriptorPool.handle(), mDescriptorSetLayout.pHandle(), 1);
+    CALL_VK(vkAllocateDescriptorSets(mDeviceWrapper->logicalDevice, &allocInfo, &mDescriptorSet));
+
+    VkDescriptorBufferInfo sourceDescriptor  = mModel->vertices.buffer->getDescriptor();
+    VkDescriptorBufferInfo skinnedDescriptor = mSkinned->getDescriptor();
+    VkDescriptorBufferInfo paletteDescriptor = {mPalette->getBufferHandle(), 0, mSlotSize};
+    const std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+        vks::initializers::writeDescriptorSet(mDescriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0, &sourceDescriptor),
+        vks::initializers::writeDescriptorSet(mDescriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, &skinnedDescriptor),
+        vks::initializers::writeDescriptorSet(mDescriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 2,
+                                              &paletteDescriptor),
+    };
+    vkUpdateDescriptorSets(mDeviceWrapper->logicalDevice, static_cast<uint32_t>(writeDescriptorSets.size()),
+                           writeDescriptorSets.data(), 0, nullptr);
+
+    // As many invocations as a square work group of the other compute samples, in one row
+    mGroupSize = std::min(mDeviceWrapper->workGroupSize * mDeviceWrapper->workGroupSize,
+                          mDeviceWrapper->properties.limits.maxComputeWorkGroupSize[0]);
+    const VkSpecializationMapEntry specializationEntry = {0, 0, sizeof(uint32_t)};
+    const VkSpecializationInfo     specializationInfo  = {
+        .mapEntryCount = 1,
+        .pMapEntries   = &specializationEntry,
+        .dataSize      = sizeof(mGroupSize),
+        .pData         = &mGroupSize,
+    };
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo =
+        vks::initializers::computePipelineCreateInfo(mPipelineLayout.handle(), 0);
+    computePipelineCreateInfo.stage                     = shaderStage;
+    computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+    CALL_VK(vkCreateComputePipelines(mDeviceWrapper->logicalDevice, pipelineCache, 1, &computePipelineCreateInfo,
+                                     nullptr, mPipeline.pHandle()));
+
+    // The vertex shader only applies the mesh matrix from now on
+    mModel->computeSkinned = true;
+    LOGCATI("ComputeSkinner: %zu meshes, %u joints", mRanges.size(), mJointCount);
+    return true;
+}
+
+bool ComputeSkinner::changed(const Node *node)
+{
+    const auto worldChanged = [](const Node *node) {
+        return node->transforms == nullptr || node->transforms->worldChanged(node->transformIndex);
+    };
+    if (worldChanged(node))
+        return true;
+    return std::any_of(node->skin->joints.begin(), node->skin->joints.end(), worldChanged);
+}
+
+void ComputeSkinner::writePalette(const Range &range, glm::mat4 *palette)
+{
+    // Same matrices as Node::update, without MAX_NUM_JOINTS
+    const Skin     *skin             = range.node->skin;
+    const glm::mat4 inverseTransform = glm::inverse(range.node->getMatrix());
+    for (size_t i = 0; i < skin->joints.size(); i++)
+    {
+        const glm::mat4 inverseBind =
+            i < skin->inverseBindMatrices.size() ? skin->inverseBindMatrices[i] : glm::mat4(1.0f);
+        palette[range.firstJoint + i] = inverseTransform * skin->joints[i]->getMatrix() * inverseBind;
+    }
+}
+
+void ComputeSkinner::update()
+{
+    vks::UploadManager *uploadManager = mDeviceWrapper->getUploadManager();
+
+    // The slot was read by the skinning PALETTE_SLOTS updates ago
+    if (mSlotTokens[mSlot] != 0)
+    {
+        uploadManager->wait(mSlotTokens[mSlot]);
+    }
+    auto *palette = reinterpret_cast<glm::mat4 *>(static_cast<uint8_t *>(mPalette->getMappedData()) +
+                                                  mSlot * mSlotSize);
+    const uint32_t dynamicOffset = static_cast<uint32_t>(mSlot * mSlotSize);
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    for (const Range &range : mRanges)
+    {
+        const bool skinned = range.firstJoint != NO_SKIN;
+        if (!mFirstUpdate && (!skinned || !changed(range.node)))
+            continue;
+
+        if (commandBuffer == VK_NULL_HANDLE)
+        {
+            // The skinned vertices are rewritten once the earlier frames have read them
+            commandBuffer           = uploadManager->graphicsCommands();
+            VkMemoryBarrier barrier = vks::initializers::memoryBarrier();
+            barrier.srcAccessMask   = 0;
+            barrier.dstAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline.handle());
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout.handle(), 0, 1,
+                                    &mDescriptorSet, 1, &dynamicOffset);
+        }
+
+        if (skinned)
+        {
+            writePalette(range, palette);
+        }
+        const uint32_t pushConstants[] = {range.firstVertex, range.vertexCount, range.firstJoint};
+        vkCmdPushConstants(commandBuffer, mPipelineLayout.handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           sizeof(pushConstants), pushConstants);
+        vkCmdDispatch(commandBuffer, (range.vertexCount + mGroupSize - 1) / mGroupSize, 1, 1);
+    }
+    mFirstUpdate = false;
+    if (commandBuffer == VK_NULL_HANDLE)
+        return;
+
+    VkBufferMemoryBarrier barrier = vks::initializers::bufferMemoryBarrier();
+    barrier.srcAccessMask         = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask         = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    barrier.buffer                = mSkinned->getBufferHandle();
+    barrier.offset                = 0;
+    barrier.size                  = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0,
+                         0, nullptr, 1, &barrier, 0, nullptr);
+
+    mLastToken         = uploadManager->pendingToken();
+    mSlotTokens[mSlot] = mLastToken;
+    mSlot              = (mSlot + 1) % PALETTE_SLOTS;
+}
+}        // namespace vkglTF
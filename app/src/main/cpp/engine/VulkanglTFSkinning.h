@@ -0,0 +1,145 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANGLTFSKINNING_H
+#define GAINVULKANSAMPLE_VULKANGLTFSKINNING_H
+
+#include <memory>
+#include <vector>
+#include <vulkan_wrapper.h>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include <glm/glm.hpp>
+
+#include "VulkanBufferWrapper.h"
+#include "VulkanDeviceWrapper.hpp"
+#include "util/VulkanRAIIUtil.h"
+
+namespace vkglTF
+{
+struct Model;
+struct Node;
+
+// Skins the vertices of a model on the GPU (shaders/gltf_skinning.comp) into a device local vertex
+// buffer with the layout of Model::Vertex, so the model has to be loaded in VertexLayout::standard().
+// Every pass drawing the model (shadow, depth prepass, main) binds skinnedVertices() and only
+// applies the mesh matrix, instead of blending the joint matrices per vertex again.
+//
+// The joint matrices of all the skins are written to a palette in a storage buffer, so a skin has
+// no joint limit unlike Mesh::UniformBlock. The palette has a slot per frame in flight: the slot
+// written for a frame is not read by the skinning of the previous ones.
+//
+// The skinning is recorded into the graphics commands of the open upload batch (see UploadManager),
+// only for the meshes whose matrix or joints changed in the last Model::updateTransforms().
+class ComputeSkinner
+{
+  public:
+    // Palette slots, one more than the frames in flight
+    static constexpr uint32_t PALETTE_SLOTS = 3;
+    // firstJoint of a vertex range that is copied without skinning
+    static constexpr uint32_t NO_SKIN = 0xFFFFFFFFu;
+
+    // Compute shader to be loaded with VulkanContextBase::loadShader
+    static const char *shaderPath();
+
+    /**
+     * @param model Loaded model, its vertex buffer has to stay alive as long as the skinner
+     * @param shaderStage Stage of shaderPath()
+     */
+    static std::unique_ptr<ComputeSkinner> create(Model *model, VkPipelineCache pipelineCache,
+                                                  const VkPipelineShaderStageCreateInfo &shaderStage);
+
+    // Prefer ComputeSkinner::create
+    ComputeSkinner(Model *model);
+
+    ~ComputeSkinner();
+
+    // Record the skinning of the meshes that changed, call after each Model::updateTransforms()
+    void update();
+
+    // Bind instead of Model::vertices, ready for the vertex input of the frames after update()
+    const vks::Buffer *skinnedVertices() const
+    {
+        return mSkinned.get();
+    }
+
+    // Joints in the palette of a frame, summed over the skinned meshes
+    uint32_t jointCount() const
+    {
+        return mJointCount;
+    }
+
+    // Batch of the last skinning, 0 if there is nothing to wait for
+    vks::UploadManager::Token skinToken() const
+    {
+        return mLastToken;
+    }
+
+  private:
+    // Vertices of the primitives of a mesh, contiguous in the vertex buffer
+    struct Range
+    {
+        Node    *node;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        uint32_t firstJoint;
+    };
+
+    bool prepare(VkPipelineCache pipelineCache, const VkPipelineShaderStageCreateInfo &shaderStage);
+
+    // Whether the world matrix of the mesh or one of its joints changed in the last update
+    static bool changed(const Node *node);
+
+    void writePalette(const Range &range, glm::mat4 *palette);
+
+    Model                                          *mModel;
+    const std::shared_ptr<vks::VulkanDeviceWrapper> mDeviceWrapper;
+
+    vks::VulkanDescriptorPool      mDescriptorPool;
+    vks::VulkanDescriptorSetLayout mDescriptorSetLayout;
+    VkDescriptorSet                mDescriptorSet = VK_NULL_HANDLE;
+    vks::VulkanPipelineLayout      mPipelineLayout;
+    vks::VulkanPipeline            mPipeline;
+    // Invocations per work group
+    uint32_t mGroupSize = 1;
+
+    std::unique_ptr<vks::Buffer> mSkinned;
+    // PALETTE_SLOTS slots of mSlotSize bytes, host visible and persistently mapped
+    std::unique_ptr<vks::Buffer> mPalette;
+    VkDeviceSize                 mSlotSize = 0;
+    uint32_t                     mSlot     = 0;
+    vks::UploadManager::Token    mSlotTokens[PALETTE_SLOTS] = {};
+
+    std::vector<Range> mRanges;
+    uint32_t           mJointCount = 0;
+    // The first update copies the unskinned ranges and skins all the others
+    bool mFirstUpdate = true;
+
+    vks::UploadManager::Token mLastToken = 0;
+};
+}        // namespace vkglTF
+
+#endif        // GAINVULKANSAMPLE_VULKANGLTFSKINNING_H
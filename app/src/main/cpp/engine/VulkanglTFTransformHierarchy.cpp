@@ -0,0 +1,216 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanglTFTransformHierarchy.h"
+
+#include <LogUtil.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "VulkanglTFModel.h"
+
+namespace vkglTF
+{
+void TransformHierarchy::build(const std::vector<Node *> &roots)
+{
+    clear();
+
+    // Depth first, a node is appended before any of its children
+    std::vector<std::pair<Node *, int32_t>> stack;
+    for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+    {
+        stack.emplace_back(*it, -1);
+    }
+    while (!stack.empty())
+    {
+        Node   *node   = stack.back().first;
+        int32_t parent = stack.back().second;
+        stack.pop_back();
+
+        const auto index     = static_cast<int32_t>(mParents.size());
+        node->transforms     = this;
+        node->transformIndex = static_cast<uint32_t>(index);
+        mParents.push_back(parent);
+        mTranslations.push_back(node->translation);
+        mRotations.push_back(node->rotation);
+        mScales.push_back(node->scale);
+        mMatrices.push_back(node->matrix);
+        mHasMatrix.push_back(node->matrix != glm::mat4(1.0f));
+
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+        {
+            stack.emplace_back(*it, index);
+        }
+    }
+
+    mLocalMatrices.resize(mParents.size(), glm::mat4(1.0f));
+    mWorldMatrices.resize(mParents.size(), glm::mat4(1.0f));
+    mDirty.resize(mParents.size(), 1);
+    mWorldChanged.resize(mParents.size(), 0);
+}
+
+void TransformHierarchy::clear()
+{
+    mParents.clear();
+    mTranslations.clear();
+    mRotations.clear();
+    mScales.clear();
+    mMatrices.clear();
+    mHasMatrix.clear();
+    mLocalMatrices.clear();
+    mWorldMatrices.clear();
+    mDirty.clear();
+    mWorldChanged.clear();
+}
+
+uint32_t TransformHierarchy::update()
+{
+    uint32_t   updated = 0;
+    const auto count   = static_cast<uint32_t>(mParents.size());
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const int32_t parent  = mParents[i];
+        const bool    changed = mDirty[i] || (parent >= 0 && mWorldChanged[parent]);
+        mWorldChanged[i]      = changed;
+        if (!changed)
+            continue;
+
+        if (mDirty[i])
+        {
+            // translate * rotate * scale without the two matrix products
+            glm::mat4 m = glm::mat4_cast(mRotations[i]);
+            m[0] *= mScales[i].x;
+            m[1] *= mScales[i].y;
+            m[2] *= mScales[i].z;
+            m[3] = glm::vec4(mTranslations[i], 1.0f);
+            if (mHasMatrix[i])
+            {
+                m = m * mMatrices[i];
+            }
+            mLocalMatrices[i] = m;
+            mDirty[i]         = 0;
+        }
+        mWorldMatrices[i] = parent >= 0 ? mWorldMatrices[parent] * mLocalMatrices[i] : mLocalMatrices[i];
+        updated++;
+    }
+    return updated;
+}
+
+void runTransformHierarchyBenchmark()
+{
+    // 10 limbs of 100 joints hanging off a root, as deep as the longest chains of real skeletons
+    // get and deeper than most
+    const uint32_t limbCount = 10, limbLength = 100;
+    const int      frames    = 100;
+
+    Node *root   = new Node{};
+    root->matrix = glm::mat4(1.0f);
+    std::vector<Node *> joints;
+    for (uint32_t limb = 0; limb < limbCount; limb++)
+    {
+        Node *parent = root;
+        for (uint32_t j = 0; j < limbLength; j++)
+        {
+            Node *joint        = new Node{};
+            joint->parent      = parent;
+            joint->matrix      = glm::mat4(1.0f);
+            joint->translation = glm::vec3(0.0f, 0.05f, 0.0f);
+            parent->children.push_back(joint);
+            joints.push_back(joint);
+            parent = joint;
+        }
+    }
+
+    const auto pose = [&](int frame, uint32_t joint) {
+        const float angle = 0.01f * static_cast<float>(frame) + 0.001f * static_cast<float>(joint);
+        return glm::angleAxis(angle, glm::normalize(glm::vec3(1.0f, 0.5f, 0.25f)));
+    };
+    const auto measure = [&](auto &&fn) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            fn(frame);
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+    };
+
+    // Every limb animated, or one in ten as for a hand or a face rig
+    for (const uint32_t animatedLimbs : {limbCount, 1u})
+    {
+        const uint32_t animatedJoints = animatedLimbs * limbLength;
+        std::vector<glm::mat4> reference(joints.size()), matrices(joints.size());
+
+        // The old path: every joint matrix walks its parent chain
+        const double walkMs = measure([&](int frame) {
+            for (uint32_t j = 0; j < animatedJoints; j++)
+            {
+                joints[j]->rotation = pose(frame, j);
+            }
+            for (uint32_t j = 0; j < joints.size(); j++)
+            {
+                reference[j] = joints[j]->getMatrix();
+            }
+        });
+
+        TransformHierarchy hierarchy;
+        hierarchy.build({root});
+        hierarchy.update();
+        const double cachedMs = measure([&](int frame) {
+            for (uint32_t j = 0; j < animatedJoints; j++)
+            {
+                hierarchy.setRotation(joints[j]->transformIndex, pose(frame, j));
+            }
+            hierarchy.update();
+            for (uint32_t j = 0; j < joints.size(); j++)
+            {
+                matrices[j] = hierarchy.worldMatrix(joints[j]->transformIndex);
+            }
+        });
+
+        float maxError = 0.0f;
+        for (uint32_t j = 0; j < joints.size(); j++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                const glm::vec4 d = glm::abs(reference[j][c] - matrices[j][c]);
+                maxError          = std::max(maxError, std::max(std::max(d.x, d.y), std::max(d.z, d.w)));
+            }
+        }
+        LOGCATI("glTF transforms %zu joints, %s animated: parent walk %.3f ms, cached hierarchy %.3f ms (%.1fx), max error %g%s",
+                joints.size(), animatedLimbs == limbCount ? "all" : "1/10", walkMs, cachedMs, walkMs / cachedMs, maxError,
+                maxError < 1e-3f ? "" : ", MISMATCH");
+
+        // Back to the parent walk for the next round
+        for (auto joint : joints)
+        {
+            joint->transforms = nullptr;
+        }
+        root->transforms = nullptr;
+    }
+
+    delete root;
+}
+}        // namespace vkglTF
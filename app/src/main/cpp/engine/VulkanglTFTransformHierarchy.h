@@ -0,0 +1,139 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANGLTFTRANSFORMHIERARCHY_H
+#define GAINVULKANSAMPLE_VULKANGLTFTRANSFORMHIERARCHY_H
+
+#include <cstdint>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace vkglTF
+{
+struct Node;
+
+// The local transforms (translation, rotation, scale and matrix) of the nodes of a model and their
+// cached world matrices, stored as arrays in an order where every parent comes before its children.
+//
+// Setting a transform only marks the node dirty. update() then walks the arrays once: the local
+// matrix of a dirty node is recomposed, the world matrix of a node is recomputed if it or one of
+// its ancestors changed, the others are kept. Compared to Node walking up its parent chain for
+// every matrix it needs, each node costs at most one matrix product per update.
+class TransformHierarchy
+{
+  public:
+    // Flatten the trees under roots in depth first order. Each node takes its loaded transform as
+    // the initial one and gets Node::transforms and Node::transformIndex set. All nodes are dirty.
+    void build(const std::vector<Node *> &roots);
+
+    void clear();
+
+    uint32_t size() const
+    {
+        return static_cast<uint32_t>(mParents.size());
+    }
+
+    void setTranslation(uint32_t index, const glm::vec3 &translation)
+    {
+        mTranslations[index] = translation;
+        mDirty[index]        = 1;
+    }
+
+    void setRotation(uint32_t index, const glm::quat &rotation)
+    {
+        mRotations[index] = rotation;
+        mDirty[index]     = 1;
+    }
+
+    void setScale(uint32_t index, const glm::vec3 &scale)
+    {
+        mScales[index] = scale;
+        mDirty[index]  = 1;
+    }
+
+    const glm::vec3 &translation(uint32_t index) const
+    {
+        return mTranslations[index];
+    }
+
+    const glm::quat &rotation(uint32_t index) const
+    {
+        return mRotations[index];
+    }
+
+    const glm::vec3 &scale(uint32_t index) const
+    {
+        return mScales[index];
+    }
+
+    // Recompute the matrices of the dirty nodes and their descendants. Returns how many world
+    // matrices changed, 0 if nothing was set since the last update.
+    uint32_t update();
+
+    // As of the last update()
+    const glm::mat4 &localMatrix(uint32_t index) const
+    {
+        return mLocalMatrices[index];
+    }
+
+    const glm::mat4 &worldMatrix(uint32_t index) const
+    {
+        return mWorldMatrices[index];
+    }
+
+    // Whether the world matrix changed in the last update()
+    bool worldChanged(uint32_t index) const
+    {
+        return mWorldChanged[index] != 0;
+    }
+
+  private:
+    // -1 for the roots
+    std::vector<int32_t>   mParents;
+    std::vector<glm::vec3> mTranslations;
+    std::vector<glm::quat> mRotations;
+    std::vector<glm::vec3> mScales;
+    // Node::matrix, applied after the TRS. Identity for almost all nodes, only multiplied if not.
+    std::vector<glm::mat4> mMatrices;
+    std::vector<uint8_t>   mHasMatrix;
+
+    std::vector<glm::mat4> mLocalMatrices;
+    std::vector<glm::mat4> mWorldMatrices;
+    // Bytes instead of std::vector<bool>, they are written in the hot loop
+    std::vector<uint8_t> mDirty;
+    std::vector<uint8_t> mWorldChanged;
+};
+
+// Pose a synthetic 1000 joint skeleton per frame through Node::getMatrix and through
+// TransformHierarchy, check they agree and log the timings.
+// Run on demand by Sample::runEngineBenchmarks.
+void runTransformHierarchyBenchmark();
+}        // namespace vkglTF
+
+#endif        // GAINVULKANSAMPLE_VULKANGLTFTRANSFORMHIERARCHY_H
@@ -0,0 +1,262 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VulkanglTFVertexLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+namespace vkglTF
+{
+VertexLayout VertexLayout::standard()
+{
+    return VertexLayout();
+}
+
+VertexLayout VertexLayout::compact(bool skinned, bool uv1)
+{
+    VertexLayout layout;
+    layout.splitPositions   = true;
+    layout.formats[NORMAL]  = VK_FORMAT_R16G16_SNORM;
+    layout.formats[UV0]     = VK_FORMAT_R16G16_SFLOAT;
+    layout.formats[UV1]     = uv1 ? VK_FORMAT_R16G16_SFLOAT : VK_FORMAT_UNDEFINED;
+    layout.formats[JOINT0]  = skinned ? VK_FORMAT_R8G8B8A8_UINT : VK_FORMAT_UNDEFINED;
+    layout.formats[WEIGHT0] = skinned ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_UNDEFINED;
+    return layout;
+}
+
+bool VertexLayout::operator==(const VertexLayout &other) const
+{
+    return splitPositions == other.splitPositions && std::equal(formats, formats + LOCATION_COUNT, other.formats);
+}
+
+bool VertexLayout::isValid() const
+{
+    for (uint32_t location = 0; location < LOCATION_COUNT; location++)
+    {
+        VkFormat format = formats[location];
+        bool     valid  = false;
+        switch (location)
+        {
+            case POSITION:
+                valid = format == VK_FORMAT_R32G32B32_SFLOAT;
+                break;
+            case NORMAL:
+                valid = format == VK_FORMAT_UNDEFINED || format == VK_FORMAT_R32G32B32_SFLOAT ||
+                        format == VK_FORMAT_R16G16_SNORM;
+                break;
+            case UV0:
+            case UV1:
+                valid = format == VK_FORMAT_UNDEFINED || format == VK_FORMAT_R32G32_SFLOAT ||
+                        format == VK_FORMAT_R16G16_SFLOAT;
+                break;
+            case JOINT0:
+                valid = format == VK_FORMAT_UNDEFINED || format == VK_FORMAT_R32G32B32A32_SFLOAT ||
+                        format == VK_FORMAT_R8G8B8A8_UINT || format == VK_FORMAT_R16G16B16A16_UINT;
+                break;
+            case WEIGHT0:
+                valid = format == VK_FORMAT_UNDEFINED || format == VK_FORMAT_R32G32B32A32_SFLOAT ||
+                        format == VK_FORMAT_R8G8B8A8_UNORM;
+                break;
+        }
+        if (!valid)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t VertexLayout::formatSize(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return 16;
+        case VK_FORMAT_R32G32B32_SFLOAT:
+            return 12;
+        case VK_FORMAT_R32G32_SFLOAT:
+        case VK_FORMAT_R16G16B16A16_UINT:
+            return 8;
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R8G8B8A8_UINT:
+        case VK_FORMAT_R8G8B8A8_UNORM:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+uint32_t VertexLayout::stride(uint32_t binding) const
+{
+    uint32_t size = 0;
+    for (uint32_t location = 0; location < LOCATION_COUNT; location++)
+    {
+        if (this->binding(static_cast<Location>(location)) == binding)
+        {
+            size += formatSize(formats[location]);
+        }
+    }
+    return size;
+}
+
+uint32_t VertexLayout::offset(Location location) const
+{
+    uint32_t size = 0;
+    for (uint32_t previous = 0; previous < location; previous++)
+    {
+        if (binding(static_cast<Location>(previous)) == binding(location))
+        {
+            size += formatSize(formats[previous]);
+        }
+    }
+    return size;
+}
+
+uint32_t VertexLayout::maxJointIndex() const
+{
+    switch (formats[JOINT0])
+    {
+        case VK_FORMAT_R8G8B8A8_UINT:
+            return UINT8_MAX;
+        case VK_FORMAT_R16G16B16A16_UINT:
+            return UINT16_MAX;
+        case VK_FORMAT_UNDEFINED:
+            return 0;
+        default:
+            // Float joints are exact up to 2^24
+            return 1u << 24;
+    }
+}
+
+void VertexLayout::vertexInput(std::vector<VkVertexInputBindingDescription>   &bindings,
+                               std::vector<VkVertexInputAttributeDescription> &attributes) const
+{
+    bindings.clear();
+    attributes.clear();
+    for (uint32_t binding = 0; binding < bindingCount(); binding++)
+    {
+        bindings.push_back({binding, stride(binding), VK_VERTEX_INPUT_RATE_VERTEX});
+    }
+    for (uint32_t location = 0; location < LOCATION_COUNT; location++)
+    {
+        if (has(static_cast<Location>(location)))
+        {
+            attributes.push_back({location, binding(static_cast<Location>(location)), formats[location],
+                                  offset(static_cast<Location>(location))});
+        }
+    }
+}
+
+namespace
+{
+// Normal on the octahedron |x| + |y| + |z| = 1, the lower half folded over the upper one
+glm::vec2 octEncode(glm::vec3 n)
+{
+    float length = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (length == 0.0f)
+    {
+        return glm::vec2(0.0f, 0.0f);
+    }
+    glm::vec2 p = glm::vec2(n.x, n.y) / length;
+    if (n.z < 0.0f)
+    {
+        glm::vec2 sign = glm::vec2(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+        p              = (1.0f - glm::abs(glm::vec2(p.y, p.x))) * sign;
+    }
+    return p;
+}
+
+// Rounded to a sum of exactly 255, the largest weight takes the rounding error
+glm::u8vec4 quantizeWeights(glm::vec4 weight)
+{
+    float sum = weight.x + weight.y + weight.z + weight.w;
+    if (sum <= 0.0f)
+    {
+        return glm::u8vec4(255, 0, 0, 0);
+    }
+    glm::u8vec4 quantized;
+    int         total   = 0;
+    int         largest = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        quantized[i] = static_cast<uint8_t>(std::lround(glm::clamp(weight[i] / sum, 0.0f, 1.0f) * 255.0f));
+        total += quantized[i];
+        if (weight[i] > weight[largest])
+        {
+            largest = i;
+        }
+    }
+    quantized[largest] = static_cast<uint8_t>(glm::clamp(quantized[largest] + 255 - total, 0, 255));
+    return quantized;
+}
+}        // namespace
+
+void VertexLayout::encode(Location location, const glm::vec4 &value, uint8_t *dst) const
+{
+    switch (formats[location])
+    {
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+        case VK_FORMAT_R32G32B32_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT:
+            memcpy(dst, &value, formatSize(formats[location]));
+            break;
+        case VK_FORMAT_R16G16_SNORM:
+        {
+            uint32_t packed = glm::packSnorm2x16(octEncode(glm::vec3(value)));
+            memcpy(dst, &packed, sizeof(packed));
+            break;
+        }
+        case VK_FORMAT_R16G16_SFLOAT:
+        {
+            uint32_t packed = glm::packHalf2x16(glm::vec2(value));
+            memcpy(dst, &packed, sizeof(packed));
+            break;
+        }
+        case VK_FORMAT_R8G8B8A8_UINT:
+        {
+            glm::u8vec4 joint = glm::u8vec4(glm::clamp(value, 0.0f, float(UINT8_MAX)));
+            memcpy(dst, &joint, sizeof(joint));
+            break;
+        }
+        case VK_FORMAT_R16G16B16A16_UINT:
+        {
+            glm::u16vec4 joint = glm::u16vec4(glm::clamp(value, 0.0f, float(UINT16_MAX)));
+            memcpy(dst, &joint, sizeof(joint));
+            break;
+        }
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        {
+            glm::u8vec4 weight = quantizeWeights(value);
+            memcpy(dst, &weight, sizeof(weight));
+            break;
+        }
+        default:
+            break;
+    }
+}
+}        // namespace vkglTF
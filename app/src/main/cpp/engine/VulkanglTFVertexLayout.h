@@ -0,0 +1,126 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_VULKANGLTFVERTEXLAYOUT_H
+#define GAINVULKANSAMPLE_VULKANGLTFVERTEXLAYOUT_H
+
+#include <cstdint>
+#include <vector>
+#include <vulkan_wrapper.h>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include <glm/glm.hpp>
+
+namespace vkglTF
+{
+// Formats of the vertex attributes of a Model in its vertex buffer, set before Model::loadFromFile.
+// The pipelines take their vertex input from vertexInput() instead of describing Model::Vertex.
+//
+// standard() is Model::Vertex as is, 72 bytes per vertex. compact() stores the positions in their
+// own binding, so that a depth or shadow pass only fetches 12 bytes per vertex, and the rest in
+// 8 to 16 bytes: octahedral normals in two snorm16, half float UVs, uint8 joints and unorm8 weights.
+// The vertex shaders read the compact normal as a vec2, see octDecode in shader_08_3dmodel.vert,
+// and the joints as a uvec4.
+struct VertexLayout
+{
+    // Attribute locations, the same in the vertex shaders of all the glTF samples
+    enum Location : uint32_t
+    {
+        POSITION = 0,
+        NORMAL,
+        UV0,
+        UV1,
+        JOINT0,
+        WEIGHT0,
+        LOCATION_COUNT
+    };
+
+    // Positions in binding 0 and the other attributes interleaved in binding 1, otherwise all of
+    // them interleaved in binding 0
+    bool splitPositions = false;
+
+    // Per location, VK_FORMAT_UNDEFINED leaves the attribute out. Supported:
+    //   POSITION  VK_FORMAT_R32G32B32_SFLOAT
+    //   NORMAL    VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R16G16_SNORM (octahedral)
+    //   UV0, UV1  VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R16G16_SFLOAT
+    //   JOINT0    VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_R8G8B8A8_UINT, VK_FORMAT_R16G16B16A16_UINT
+    //   WEIGHT0   VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_R8G8B8A8_UNORM
+    VkFormat formats[LOCATION_COUNT] = {
+        VK_FORMAT_R32G32B32_SFLOAT,    VK_FORMAT_R32G32B32_SFLOAT,    VK_FORMAT_R32G32_SFLOAT,
+        VK_FORMAT_R32G32_SFLOAT,       VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT,
+    };
+
+    static VertexLayout standard();
+
+    // skinned keeps the joints and the weights, uv1 the second texture coordinates
+    static VertexLayout compact(bool skinned, bool uv1 = false);
+
+    bool operator==(const VertexLayout &other) const;
+
+    bool operator!=(const VertexLayout &other) const
+    {
+        return !(*this == other);
+    }
+
+    // Whether every format is one of the supported ones
+    bool isValid() const;
+
+    bool has(Location location) const
+    {
+        return formats[location] != VK_FORMAT_UNDEFINED;
+    }
+
+    uint32_t bindingCount() const
+    {
+        return splitPositions ? 2 : 1;
+    }
+
+    uint32_t binding(Location location) const
+    {
+        return splitPositions && location != POSITION ? 1 : 0;
+    }
+
+    // Bytes per vertex in binding
+    uint32_t stride(uint32_t binding) const;
+
+    // Of the attribute in its binding, only valid if has(location)
+    uint32_t offset(Location location) const;
+
+    // Largest joint index the joint format holds
+    uint32_t maxJointIndex() const;
+
+    void vertexInput(std::vector<VkVertexInputBindingDescription>   &bindings,
+                     std::vector<VkVertexInputAttributeDescription> &attributes) const;
+
+    // Write one attribute of a vertex at dst in the format of location. The value has the
+    // components of the float format, e.g. a normal in xyz.
+    void encode(Location location, const glm::vec4 &value, uint8_t *dst) const;
+
+    static uint32_t formatSize(VkFormat format);
+};
+}        // namespace vkglTF
+
+#endif        // GAINVULKANSAMPLE_VULKANGLTFVERTEXLAYOUT_H
@@ -0,0 +1,195 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "AssetUtil.h"
+
+#include <LogUtil.h>
+#include <algorithm>
+#include <cstdio>
+
+#if !defined(__ANDROID__)
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace vks
+{
+namespace
+{
+#if !defined(__ANDROID__)
+struct FileCloser
+{
+    void operator()(FILE *file) const
+    {
+        fclose(file);
+    }
+};
+using FilePtr = std::unique_ptr<FILE, FileCloser>;
+
+bool isRegularFile(const std::string &path)
+{
+    struct stat info = {};
+    return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+#endif
+}        // namespace
+
+#if defined(__ANDROID__)
+std::shared_ptr<AssetLoader> AssetLoader::create(AAssetManager *assetManager)
+{
+    if (assetManager == nullptr)
+        return nullptr;
+    return std::make_shared<AssetLoader>(assetManager, std::vector<std::string>());
+}
+#endif
+
+std::shared_ptr<AssetLoader> AssetLoader::create(const std::vector<std::string> &rootDirs)
+{
+    return std::make_shared<AssetLoader>(nullptr, rootDirs);
+}
+
+AssetLoader::AssetLoader(AAssetManager *assetManager, const std::vector<std::string> &rootDirs) :
+    mAssetManager(assetManager), mRootDirs(rootDirs)
+{}
+
+bool AssetLoader::exists(const std::string &path) const
+{
+#if defined(__ANDROID__)
+    if (mAssetManager != nullptr)
+    {
+        AAsset *asset = AAssetManager_open(mAssetManager, path.c_str(), AASSET_MODE_UNKNOWN);
+        if (asset == nullptr)
+            return false;
+        AAsset_close(asset);
+        return true;
+    }
+#else
+    for (const auto &root : mRootDirs)
+    {
+        if (isRegularFile(root + "/" + path))
+            return true;
+    }
+#endif
+    return false;
+}
+
+bool AssetLoader::read(const std::string &path, std::vector<uint8_t> &data, size_t maxSize, size_t *length) const
+{
+#if defined(__ANDROID__)
+    if (mAssetManager != nullptr)
+    {
+        // Only a part of the asset is wanted, don't let the asset manager load all of it
+        AAsset *asset = AAssetManager_open(mAssetManager, path.c_str(),
+                                           maxSize == SIZE_MAX ? AASSET_MODE_BUFFER : AASSET_MODE_STREAMING);
+        if (asset == nullptr)
+            return false;
+        const size_t size = static_cast<size_t>(AAsset_getLength64(asset));
+        data.resize(std::min(size, maxSize));
+        size_t done = 0;
+        while (done < data.size())
+        {
+            const int count = AAsset_read(asset, data.data() + done, data.size() - done);
+            if (count <= 0)
+                break;
+            done += static_cast<size_t>(count);
+        }
+        AAsset_close(asset);
+        if (done != data.size())
+        {
+            LOGCATE("AssetLoader: Failed to read %s", path.c_str());
+            return false;
+        }
+        if (length != nullptr)
+        {
+            *length = size;
+        }
+        return true;
+    }
+#else
+    for (const auto &root : mRootDirs)
+    {
+        const std::string filePath = root + "/" + path;
+        if (!isRegularFile(filePath))
+            continue;
+        FilePtr file(fopen(filePath.c_str(), "rb"));
+        if (!file || fseek(file.get(), 0, SEEK_END) != 0)
+            break;
+        const long size = ftell(file.get());
+        if (size < 0 || fseek(file.get(), 0, SEEK_SET) != 0)
+            break;
+        data.resize(std::min(static_cast<size_t>(size), maxSize));
+        if (fread(data.data(), 1, data.size(), file.get()) != data.size())
+            break;
+        if (length != nullptr)
+        {
+            *length = static_cast<size_t>(size);
+        }
+        return true;
+    }
+    if (exists(path))
+    {
+        LOGCATE("AssetLoader: Failed to read %s", path.c_str());
+    }
+#endif
+    return false;
+}
+
+std::vector<std::string> AssetLoader::list(const std::string &dir) const
+{
+    std::vector<std::string> names;
+#if defined(__ANDROID__)
+    if (mAssetManager != nullptr)
+    {
+        AAssetDir *assetDir = AAssetManager_openDir(mAssetManager, dir.c_str());
+        if (assetDir == nullptr)
+            return names;
+        while (const char *name = AAssetDir_getNextFileName(assetDir))
+        {
+            names.emplace_back(name);
+        }
+        AAssetDir_close(assetDir);
+    }
+#else
+    for (const auto &root : mRootDirs)
+    {
+        const std::string dirPath = root + "/" + dir;
+        DIR              *entries = opendir(dirPath.c_str());
+        if (entries == nullptr)
+            continue;
+        while (const dirent *entry = readdir(entries))
+        {
+            const std::string name = entry->d_name;
+            if (isRegularFile(dirPath + "/" + name) && std::find(names.begin(), names.end(), name) == names.end())
+            {
+                names.push_back(name);
+            }
+        }
+        closedir(entries);
+    }
+#endif
+    std::sort(names.begin(), names.end());
+    return names;
+}
+}        // namespace vks
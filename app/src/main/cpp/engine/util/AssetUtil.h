@@ -0,0 +1,77 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef GAINVULKANSAMPLE_ASSETUTIL_H
+#define GAINVULKANSAMPLE_ASSETUTIL_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PlatformUtil.h"
+
+namespace vks
+{
+// Read only access to the files shipped with the app: the APK assets through the AAssetManager on
+// Android, directories of the file system on the host (app/src/test/cpp). Paths are relative to the
+// assets root, e.g. "shaders/shader_01_triangle.vert.spv".
+// Thread safe.
+class AssetLoader
+{
+  public:
+#if defined(__ANDROID__)
+    static std::shared_ptr<AssetLoader> create(AAssetManager *assetManager);
+#endif
+
+    // The directories are searched in order, e.g. the compiled shaders then the source assets
+    static std::shared_ptr<AssetLoader> create(const std::vector<std::string> &rootDirs);
+
+    // Prefer AssetLoader::create
+    AssetLoader(AAssetManager *assetManager, const std::vector<std::string> &rootDirs);
+
+    bool exists(const std::string &path) const;
+
+    // Read the asset into data, at most maxSize bytes from its start. length (if not null) is set to
+    // the size of the whole asset. Returns false if the asset is missing or could not be read.
+    bool read(const std::string &path, std::vector<uint8_t> &data, size_t maxSize = SIZE_MAX,
+              size_t *length = nullptr) const;
+
+    // Names of the files in the directory dir, sorted
+    std::vector<std::string> list(const std::string &dir) const;
+
+    // The Android asset manager, nullptr on the host
+    AAssetManager *assetManager() const
+    {
+        return mAssetManager;
+    }
+
+  private:
+    AAssetManager           *mAssetManager;
+    std::vector<std::string> mRootDirs;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_ASSETUTIL_H
@@ -0,0 +1,157 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "HistogramUtil.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace vks
+{
+namespace histogram
+{
+uint32_t binOf(uint8_t y, uint8_t u, uint8_t v, Channel channel)
+{
+    if (channel == Channel::LUMA)
+    {
+        return y;
+    }
+
+    // The shaders read the planes as R8_UNORM
+    const float yf = y / 255.0f;
+    const float uf = u / 255.0f - 0.5f;
+    const float vf = v / 255.0f - 0.5f;
+    const float r  = yf + 1.403f * vf;
+    const float g  = yf - 0.344f * uf - 0.714f * vf;
+    const float b  = yf + 1.770f * uf;
+
+    float value;
+    switch (channel)
+    {
+        case Channel::RED:
+            value = r;
+            break;
+        case Channel::GREEN:
+            value = g;
+            break;
+        case Channel::BLUE:
+            value = b;
+            break;
+        default:
+            value = (r + g + b) / 3.0f;
+            break;
+    }
+    return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+}
+
+void computeReference(const yuv::Frame &frame, Channel channel, uint32_t *bins)
+{
+    memset(bins, 0, BIN_COUNT * sizeof(uint32_t));
+    for (uint32_t row = 0; row < frame.height; row++)
+    {
+        const uint8_t *y = frame.y + static_cast<size_t>(row) * frame.yStride;
+        const uint8_t *u = frame.u + static_cast<size_t>(row / 2) * frame.uStride;
+        const uint8_t *v = frame.v + static_cast<size_t>(row / 2) * frame.vStride;
+        for (uint32_t x = 0; x < frame.width; x++)
+        {
+            bins[binOf(y[x], u[x / 2 * frame.uPixelStride], v[x / 2 * frame.vPixelStride], channel)]++;
+        }
+    }
+}
+
+// 1-based rank of the pixel at fraction of total pixels sorted by bin, the same as rankOf() in
+// shaders/histogram_stats.comp
+static uint32_t rankOf(float fraction, uint32_t total)
+{
+    return static_cast<uint32_t>(std::clamp(std::ceil(fraction * static_cast<float>(total)), 1.0f,
+                                            static_cast<float>(total)));
+}
+
+float linearOf(uint32_t bin)
+{
+    return powf(static_cast<float>(bin) / 255.0f, 2.2f);
+}
+
+void computeStatistics(const uint32_t *bins, const ExposureParams &params, Statistics *statistics)
+{
+    memset(statistics, 0, sizeof(Statistics));
+    statistics->exposureScale = 1.0f;
+
+    uint32_t total = 0;
+    for (uint32_t bin = 0; bin < BIN_COUNT; bin++)
+    {
+        total += bins[bin];
+    }
+    if (total == 0)
+    {
+        return;
+    }
+
+    uint32_t percentileRanks[PERCENTILE_COUNT];
+    for (uint32_t i = 0; i < PERCENTILE_COUNT; i++)
+    {
+        percentileRanks[i] = rankOf(PERCENTILES[i], total);
+    }
+    const uint32_t rankLow  = rankOf(params.lowPercentile, total);
+    const uint32_t rankHigh = std::max(rankOf(params.highPercentile, total), rankLow);
+
+    // The pixels of a bin have the ranks below + 1 to through
+    uint32_t below      = 0;
+    // 32 bits like on the GPU, exact up to 16M pixels
+    uint32_t binSum     = 0;
+    float    meteredSum = 0.0f;
+    for (uint32_t bin = 0; bin < BIN_COUNT; bin++)
+    {
+        const uint32_t through = below + bins[bin];
+        if (below == 0 && through > 0)
+        {
+            statistics->minimum = bin;
+        }
+        if (below < total && through == total)
+        {
+            statistics->maximum = bin;
+        }
+        for (uint32_t i = 0; i < PERCENTILE_COUNT; i++)
+        {
+            if (below < percentileRanks[i] && through >= percentileRanks[i])
+            {
+                statistics->percentiles[i] = bin;
+            }
+        }
+        const uint32_t metered = std::clamp(through, rankLow - 1, rankHigh) - std::clamp(below, rankLow - 1, rankHigh);
+        binSum += bin * bins[bin];
+        meteredSum += static_cast<float>(metered) * linearOf(bin);
+        below = through;
+    }
+
+    statistics->pixelCount       = total;
+    statistics->mean             = static_cast<float>(binSum) / static_cast<float>(total);
+    statistics->meteredLuminance = meteredSum / static_cast<float>(rankHigh - rankLow + 1);
+    statistics->exposure         = std::clamp(log2f(params.targetLuminance / std::max(statistics->meteredLuminance, 1e-4f)),
+                                              params.minExposure, params.maxExposure);
+    statistics->exposureScale    = exp2f(statistics->exposure);
+}
+}        // namespace histogram
+}        // namespace vks
@@ -0,0 +1,109 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_HISTOGRAMUTIL_H
+#define GAINVULKANSAMPLE_HISTOGRAMUTIL_H
+
+#include <cstdint>
+
+#include "YUVUtil.h"
+
+// Colour histograms of camera frames and their statistics. The GPU computes them (HistogramCalculator,
+// shaders/glsl/histogram.glsl, HistogramStatistics, shaders/histogram_stats.comp), the scalar versions
+// below are the references the GPU results are checked against.
+namespace vks
+{
+namespace histogram
+{
+constexpr uint32_t BIN_COUNT = 256;
+
+// Value of a pixel that is binned, the same numbers as the channel push constant of the shaders
+enum class Channel : int32_t
+{
+    // (R + G + B) / 3
+    AVERAGE = 0,
+    RED     = 1,
+    GREEN   = 2,
+    BLUE    = 3,
+    // The Y sample, no conversion to RGB
+    LUMA = 4,
+};
+
+// Bin of a pixel, the same math as binOf() in shaders/glsl/histogram.glsl
+uint32_t binOf(uint8_t y, uint8_t u, uint8_t v, Channel channel);
+
+// Count the pixels of frame per bin into bins[BIN_COUNT]. The chroma of pixel (x, y) is the sample
+// (x / 2, y / 2), pixel strides apart, like the shaders read it.
+void computeReference(const yuv::Frame &frame, Channel channel, uint32_t *bins);
+
+// Fractions of the pixels of Statistics::percentiles, the same as PERCENTILES in
+// shaders/histogram_stats.comp
+constexpr uint32_t PERCENTILE_COUNT              = 5;
+constexpr float    PERCENTILES[PERCENTILE_COUNT] = {0.01f, 0.05f, 0.5f, 0.95f, 0.99f};
+
+// Metering of the exposure, the push constants of shaders/histogram_stats.comp
+struct ExposureParams
+{
+    // The pixels below the low and above the high percentile (0 to 1) are not metered, the
+    // exposure ignores the deep shadows and the clipped highlights
+    float lowPercentile  = 0.05f;
+    float highPercentile = 0.95f;
+    // Linear luminance the metered pixels are exposed to, middle grey by default
+    float targetLuminance = 0.18f;
+    // Range of the exposure compensation in EV
+    float minExposure = -4.0f;
+    float maxExposure = 4.0f;
+};
+
+// Summary of a histogram, the std430 layout of the buffer written by shaders/histogram_stats.comp.
+// The bins are those of the histogram, the luminance of a bin is (bin / 255)^2.2. Use Channel::LUMA
+// to meter the luminance of a frame.
+struct Statistics
+{
+    uint32_t pixelCount;
+    // Lowest and highest non-empty bins
+    uint32_t minimum;
+    uint32_t maximum;
+    // Mean bin of all the pixels
+    float mean;
+    // Mean linear luminance of the pixels between the metering percentiles
+    float meteredLuminance;
+    // Compensation bringing meteredLuminance to the target in EV, and the factor 2^exposure it
+    // scales linear values by. 0 and 1 for an empty histogram.
+    float exposure;
+    float exposureScale;
+    // Bin of the pixel at PERCENTILES[i] of the pixels sorted by bin
+    uint32_t percentiles[PERCENTILE_COUNT];
+};
+
+// Linear luminance of a bin, the same as linearOf() in shaders/histogram_stats.comp
+float linearOf(uint32_t bin);
+
+// Compute the statistics of bins[BIN_COUNT] the way shaders/histogram_stats.comp does. The bin
+// mean is exact, the sums of the metered luminance are added in another order on the GPU.
+void computeStatistics(const uint32_t *bins, const ExposureParams &params, Statistics *statistics);
+}        // namespace histogram
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_HISTOGRAMUTIL_H
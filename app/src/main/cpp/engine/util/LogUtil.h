@@ -25,16 +25,38 @@
 #ifndef YUVCROP_LOGUTIL_H
 #define YUVCROP_LOGUTIL_H
 
-#include <android/log.h>
 #include <cassert>
 #include <sys/time.h>
 
 #define LOG_TAG "Vulkan"
 
+#if defined(__ANDROID__)
+#include <android/log.h>
+
 #define LOGCATE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 #define LOGCATV(...) __android_log_print(ANDROID_LOG_VERBOSE, LOG_TAG, __VA_ARGS__)
 #define LOGCATD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
 #define LOGCATI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#else
+#include <cstdarg>
+#include <cstdio>
+
+// Host builds (app/src/test/cpp) log to stderr, in the logcat format
+static inline void hostLogPrint(char level, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	fprintf(stderr, "%c/%s: ", level, LOG_TAG);
+	vfprintf(stderr, format, args);
+	fputc('\n', stderr);
+	va_end(args);
+}
+
+#define LOGCATE(...) hostLogPrint('E', __VA_ARGS__)
+#define LOGCATV(...) hostLogPrint('V', __VA_ARGS__)
+#define LOGCATD(...) hostLogPrint('D', __VA_ARGS__)
+#define LOGCATI(...) hostLogPrint('I', __VA_ARGS__)
+#endif
 
 #define FUN_BEGIN_TIME(FUN)                         \
 	{                                               \
@@ -0,0 +1,709 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LutUtil.h"
+
+#include <LogUtil.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tinygltf/stb_image.h"
+
+namespace vks
+{
+namespace lut
+{
+namespace
+{
+constexpr uint32_t kCacheMagic   = 0x54554c47;        // "GLUT"
+// Version 2 keys on the whole source, version 1 only hashed its first 4 KiB
+constexpr uint32_t kCacheVersion = 2;
+
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t size;
+    uint32_t format;
+    uint64_t dataSize;
+    // The texels start at a 64 byte offset of the mapping
+    uint8_t reserved[32];
+};
+static_assert(sizeof(CacheHeader) == 64, "The texels follow the 64 byte header");
+
+uint64_t fnv1a(const void *data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint16_t toHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign     = (bits >> 16) & 0x8000;
+    const uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t       mantissa = bits & 0x7fffff;
+    if (exponent == 0xff)
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0));
+
+    const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+    if (halfExponent >= 31)
+        return static_cast<uint16_t>(sign | 0x7c00);
+    if (halfExponent <= 0)
+    {
+        // Subnormal or zero
+        if (halfExponent < -10)
+            return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000;
+        const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t       half  = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1)
+            half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+    // A carry of the rounding moves into the exponent, as it should
+    uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+        half++;
+    return static_cast<uint16_t>(half);
+}
+
+void storeTexel(uint8_t *texels, TexelFormat format, size_t index, float r, float g, float b)
+{
+    if (format == TexelFormat::RGBA8)
+    {
+        uint8_t *texel = texels + index * 4;
+        texel[0]       = static_cast<uint8_t>(std::min(std::max(r, 0.0f), 1.0f) * 255.0f + 0.5f);
+        texel[1]       = static_cast<uint8_t>(std::min(std::max(g, 0.0f), 1.0f) * 255.0f + 0.5f);
+        texel[2]       = static_cast<uint8_t>(std::min(std::max(b, 0.0f), 1.0f) * 255.0f + 0.5f);
+        texel[3]       = 255;
+    }
+    else
+    {
+        const uint16_t texel[4] = {toHalf(r), toHalf(g), toHalf(b), 0x3c00};
+        memcpy(texels + index * 8, texel, sizeof(texel));
+    }
+}
+
+// Text of a LUT file read line by line, CR LF line ends are accepted
+class LineReader
+{
+  public:
+    LineReader(const char *text, size_t length) : mNext(text), mEnd(text + length)
+    {}
+
+    // The next line that is neither empty nor a comment, without leading blanks
+    bool next(const char *&begin, const char *&end)
+    {
+        while (mNext < mEnd)
+        {
+            const char *lineEnd = static_cast<const char *>(memchr(mNext, '\n', mEnd - mNext));
+            if (lineEnd == nullptr)
+                lineEnd = mEnd;
+            begin = mNext;
+            end   = lineEnd;
+            mNext = lineEnd + 1;
+
+            while (begin < end && (*begin == ' ' || *begin == '\t'))
+                begin++;
+            while (end > begin && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+                end--;
+            if (begin < end && *begin != '#')
+                return true;
+        }
+        return false;
+    }
+
+  private:
+    const char *mNext;
+    const char *const mEnd;
+};
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+const char *skipBlanks(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    return p;
+}
+
+// [+-]digits[.digits][(e|E)[+-]digits], locale independent and much faster than strtof. The LUT
+// values have far fewer significant digits than the 19 kept in the mantissa.
+const char *parseNumber(const char *p, const char *end, float &value)
+{
+    static const double kPowers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    p                   = skipBlanks(p, end);
+    const bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+'))
+        p++;
+
+    uint64_t mantissa = 0;
+    int32_t  exponent = 0;
+    int32_t  digits   = 0;
+    bool     any      = false;
+    for (; p < end && isDigit(*p); p++, any = true)
+    {
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && isDigit(*p); p++, any = true)
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+    if (!any)
+        return nullptr;
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        const bool negativeExponent = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+'))
+            p++;
+        if (p == end || !isDigit(*p))
+            return nullptr;
+        int32_t e = 0;
+        for (; p < end && isDigit(*p); p++)
+        {
+            e = std::min(e * 10 + (*p - '0'), 1000);
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+    // The number has to end at a blank or the end of the line
+    if (p < end && *p != ' ' && *p != '\t')
+        return nullptr;
+
+    double result = static_cast<double>(mantissa);
+    if (exponent < 0)
+        result = exponent >= -22 ? result / kPowers[-exponent] : result * std::pow(10.0, exponent);
+    else if (exponent > 0)
+        result = exponent <= 22 ? result * kPowers[exponent] : result * std::pow(10.0, exponent);
+    value = static_cast<float>(negative ? -result : result);
+    return p;
+}
+
+// Parse count numbers, the line must have no more
+bool parseNumbers(const char *p, const char *end, float *values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        p = parseNumber(p, end, values[i]);
+        if (p == nullptr)
+            return false;
+    }
+    return skipBlanks(p, end) == end;
+}
+
+bool startsWith(const char *begin, const char *end, const char *keyword)
+{
+    const size_t length = strlen(keyword);
+    return static_cast<size_t>(end - begin) > length && strncmp(begin, keyword, length) == 0 &&
+           (begin[length] == ' ' || begin[length] == '\t');
+}
+
+std::string extension(const std::string &name)
+{
+    const size_t dot = name.find_last_of('.');
+    std::string  ext = dot == std::string::npos ? "" : name.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return static_cast<char>(tolower(c)); });
+    return ext;
+}
+}        // namespace
+
+uint32_t texelBytes(TexelFormat format)
+{
+    return format == TexelFormat::RGBA8 ? 4 : 8;
+}
+
+Table::~Table()
+{
+    release();
+}
+
+Table::Table(Table &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+Table &Table::operator=(Table &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        mSize        = other.mSize;
+        mFormat      = other.mFormat;
+        mOwned       = std::move(other.mOwned);
+        mMapping     = other.mMapping;
+        mMappingSize = other.mMappingSize;
+        mTexels      = mMapping != nullptr ? other.mTexels : mOwned.data();
+        other.mSize    = 0;
+        other.mTexels  = nullptr;
+        other.mMapping = nullptr;
+    }
+    return *this;
+}
+
+void Table::release()
+{
+    if (mMapping != nullptr)
+    {
+        munmap(mMapping, mMappingSize);
+        mMapping = nullptr;
+    }
+    mOwned.clear();
+    mTexels = nullptr;
+    mSize   = 0;
+}
+
+uint8_t *Table::allocate(uint32_t size, TexelFormat format)
+{
+    release();
+    mSize   = size;
+    mFormat = format;
+    mOwned.resize(byteSize());
+    mTexels = mOwned.data();
+    return mOwned.data();
+}
+
+void Table::adopt(void *mapping, size_t mappingSize, const uint8_t *texels, uint32_t size, TexelFormat format)
+{
+    release();
+    mMapping     = mapping;
+    mMappingSize = mappingSize;
+    mTexels      = texels;
+    mSize        = size;
+    mFormat      = format;
+}
+
+bool parseCube(const char *text, size_t length, TexelFormat format, Table &table)
+{
+    LineReader reader(text, length);
+    const char *begin, *end;
+    uint32_t    size      = 0;
+    size_t      index     = 0;
+    size_t      count     = 0;
+    uint8_t    *texels    = nullptr;
+    float       domainMin[3] = {0.0f, 0.0f, 0.0f};
+    float       domainMax[3] = {1.0f, 1.0f, 1.0f};
+    float       scale[3]     = {1.0f, 1.0f, 1.0f};
+
+    while (reader.next(begin, end))
+    {
+        if (texels != nullptr && (isDigit(*begin) || *begin == '-' || *begin == '+' || *begin == '.'))
+        {
+            if (index == 0)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    scale[i] = 1.0f / (domainMax[i] - domainMin[i]);
+                }
+            }
+            float rgb[3];
+            if (index == count || !parseNumbers(begin, end, rgb, 3))
+            {
+                LOGCATE("lut::parseCube: Bad entry %zu: %.*s", index, static_cast<int>(end - begin), begin);
+                return false;
+            }
+            storeTexel(texels, format, index++, (rgb[0] - domainMin[0]) * scale[0],
+                       (rgb[1] - domainMin[1]) * scale[1], (rgb[2] - domainMin[2]) * scale[2]);
+        }
+        else if (startsWith(begin, end, "LUT_3D_SIZE"))
+        {
+            float value;
+            if (texels != nullptr || !parseNumbers(begin + 11, end, &value, 1) || value < 2.0f || value > 256.0f)
+            {
+                LOGCATE("lut::parseCube: Bad %.*s", static_cast<int>(end - begin), begin);
+                return false;
+            }
+            size   = static_cast<uint32_t>(value);
+            count  = static_cast<size_t>(size) * size * size;
+            texels = table.allocate(size, format);
+        }
+        else if (startsWith(begin, end, "DOMAIN_MIN") || startsWith(begin, end, "DOMAIN_MAX"))
+        {
+            float *domain = begin[7] == 'M' && begin[8] == 'I' ? domainMin : domainMax;
+            if (index != 0 || !parseNumbers(begin + 10, end, domain, 3))
+            {
+                LOGCATE("lut::parseCube: Bad %.*s", static_cast<int>(end - begin), begin);
+                return false;
+            }
+        }
+        else if (startsWith(begin, end, "LUT_3D_INPUT_RANGE"))
+        {
+            float range[2];
+            if (index != 0 || !parseNumbers(begin + 18, end, range, 2))
+            {
+                LOGCATE("lut::parseCube: Bad %.*s", static_cast<int>(end - begin), begin);
+                return false;
+            }
+            std::fill(domainMin, domainMin + 3, range[0]);
+            std::fill(domainMax, domainMax + 3, range[1]);
+        }
+        else if (startsWith(begin, end, "LUT_1D_SIZE"))
+        {
+            LOGCATE("lut::parseCube: 1D LUTs are not supported");
+            return false;
+        }
+        else if (texels == nullptr && !startsWith(begin, end, "TITLE"))
+        {
+            LOGCATE("lut::parseCube: Unexpected %.*s", static_cast<int>(end - begin), begin);
+            return false;
+        }
+    }
+
+    if (texels == nullptr || index != count)
+    {
+        LOGCATE("lut::parseCube: %zu of %zu entries", index, count);
+        return false;
+    }
+    return true;
+}
+
+bool parse3dl(const char *text, size_t length, TexelFormat format, Table &table)
+{
+    LineReader reader(text, length);
+    const char *begin, *end;
+    uint32_t    size     = 0;
+    size_t      count    = 0;
+    int32_t     meshBits = 0;
+    // The output depth may only be known once all the values are read
+    std::vector<float> values;
+    float              maxValue = 0.0f;
+
+    while (reader.next(begin, end))
+    {
+        if (startsWith(begin, end, "Mesh"))
+        {
+            float mesh[2];
+            if (!parseNumbers(begin + 4, end, mesh, 2))
+            {
+                LOGCATE("lut::parse3dl: Bad %.*s", static_cast<int>(end - begin), begin);
+                return false;
+            }
+            meshBits = static_cast<int32_t>(mesh[1]);
+            continue;
+        }
+        if (!isDigit(*begin))
+        {
+            // e.g. LUT8, gamma 1.0 or other keywords of the Lustre variants
+            continue;
+        }
+
+        if (size == 0)
+        {
+            // The input shaper: one value per grid point
+            const char *p = begin;
+            float       value;
+            while ((p = parseNumber(p, end, value)) != nullptr && skipBlanks(p, end) != end)
+            {
+                size++;
+            }
+            size += p != nullptr;
+            if (p == nullptr || size < 2 || size > 256)
+            {
+                LOGCATE("lut::parse3dl: Bad shaper %.*s", static_cast<int>(end - begin), begin);
+                return false;
+            }
+            count = static_cast<size_t>(size) * size * size;
+            values.reserve(count * 3);
+            continue;
+        }
+
+        float rgb[3];
+        if (values.size() == count * 3 || !parseNumbers(begin, end, rgb, 3))
+        {
+            LOGCATE("lut::parse3dl: Bad entry %zu: %.*s", values.size() / 3, static_cast<int>(end - begin), begin);
+            return false;
+        }
+        values.insert(values.end(), rgb, rgb + 3);
+        maxValue = std::max(maxValue, std::max(rgb[0], std::max(rgb[1], rgb[2])));
+    }
+
+    if (size == 0 || values.size() != count * 3)
+    {
+        LOGCATE("lut::parse3dl: %zu of %zu entries", values.size() / 3, count);
+        return false;
+    }
+
+    if (meshBits == 0)
+    {
+        meshBits = 10;
+        while (meshBits < 16 && maxValue > static_cast<float>((1 << meshBits) - 1))
+        {
+            meshBits += 2;
+        }
+    }
+    const float scale = 1.0f / static_cast<float>((1 << meshBits) - 1);
+
+    // Blue varies fastest in the file, red in the texels
+    uint8_t *texels = table.allocate(size, format);
+    size_t   entry  = 0;
+    for (uint32_t r = 0; r < size; r++)
+    {
+        for (uint32_t g = 0; g < size; g++)
+        {
+            for (uint32_t b = 0; b < size; b++, entry += 3)
+            {
+                storeTexel(texels, format, (static_cast<size_t>(b) * size + g) * size + r, values[entry] * scale,
+                           values[entry + 1] * scale, values[entry + 2] * scale);
+            }
+        }
+    }
+    return true;
+}
+
+bool parse(const std::string &name, const char *text, size_t length, TexelFormat format, Table &table)
+{
+    const std::string ext = extension(name);
+    if (ext == "cube")
+        return parseCube(text, length, format, table);
+    if (ext == "3dl")
+        return parse3dl(text, length, format, table);
+    LOGCATE("lut::parse: %s is neither a .cube nor a .3dl", name.c_str());
+    return false;
+}
+
+uint64_t sourceKey(const void *source, size_t size)
+{
+    const uint64_t sourceSize = size;
+    return fnv1a(source, size, fnv1a(&sourceSize, sizeof(sourceSize)));
+}
+
+bool writeCache(const std::string &path, const Table &table, uint64_t key)
+{
+    CacheHeader header = {};
+    header.magic       = kCacheMagic;
+    header.version     = kCacheVersion;
+    header.key         = key;
+    header.size        = table.size();
+    header.format      = static_cast<uint32_t>(table.format());
+    header.dataSize    = table.byteSize();
+
+    const std::string tmpPath = path + ".tmp";
+    FILE             *file    = fopen(tmpPath.c_str(), "wb");
+    bool              success = file != nullptr && fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(table.texels(), 1, table.byteSize(), file) == table.byteSize();
+    success = file != nullptr && fclose(file) == 0 && success;
+    if (!success || rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        LOGCATE("lut::writeCache: Failed to write %s", path.c_str());
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool mapCache(const std::string &path, uint64_t key, TexelFormat format, Table &table)
+{
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    void       *mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) > sizeof(CacheHeader))
+    {
+        mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    const size_t       mappingSize = static_cast<size_t>(info.st_size);
+    const CacheHeader *header      = static_cast<const CacheHeader *>(mapping);
+    const uint64_t     expected    = static_cast<uint64_t>(header->size) * header->size * header->size *
+                              texelBytes(static_cast<TexelFormat>(header->format));
+    if (header->magic != kCacheMagic || header->version != kCacheVersion || header->key != key ||
+        header->format != static_cast<uint32_t>(format) || header->dataSize != expected ||
+        sizeof(CacheHeader) + header->dataSize != mappingSize)
+    {
+        munmap(mapping, mappingSize);
+        return false;
+    }
+
+    table.adopt(mapping, mappingSize, static_cast<const uint8_t *>(mapping) + sizeof(CacheHeader), header->size,
+                format);
+    return true;
+}
+
+bool loadAsset(const AssetLoader &assets, const std::string &path, const std::string &cacheDir,
+               TexelFormat format, Table &table)
+{
+    // The whole asset is hashed, an edit anywhere in it makes the cache stale. Hashing is still
+    // far cheaper than parsing the text
+    std::vector<uint8_t> text;
+    if (!assets.read(path, text))
+    {
+        LOGCATE("lut::loadAsset: Could not read %s", path.c_str());
+        return false;
+    }
+    const uint64_t    key       = sourceKey(text.data(), text.size());
+    const std::string cachePath = cacheDir.empty() ? "" :
+                                  cacheDir + "/lut_" + std::to_string(fnv1a(path.data(), path.size())) +
+                                      (format == TexelFormat::RGBA8 ? ".rgba8" : ".rgba16f");
+    if (!cachePath.empty() && mapCache(cachePath, key, format, table))
+        return true;
+
+    if (!parse(path, reinterpret_cast<const char *>(text.data()), text.size(), format, table))
+        return false;
+    if (!cachePath.empty())
+    {
+        writeCache(cachePath, table, key);
+    }
+    return true;
+}
+
+void runParseBenchmark(const AssetLoader &assets, const std::string &cacheDir)
+{
+
+    const int  iterations = 10;
+    const auto measure    = [&](auto &&fn) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            fn();
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    };
+
+    for (const std::string &name : assets.list("lut"))
+    {
+        // The shipped LUTs are size x size^2 strips, written out as the text formats here
+        const std::string    path = "lut/" + name;
+        std::vector<uint8_t> image;
+        if (!assets.read(path, image))
+            continue;
+        int      width = 0, height = 0, channels = 0;
+        stbi_uc *pixels = stbi_load_from_memory(image.data(), static_cast<int>(image.size()), &width, &height,
+                                                &channels, STBI_rgb_alpha);
+        if (pixels == nullptr || height != width * width)
+        {
+            stbi_image_free(pixels);
+            continue;
+        }
+        const uint32_t size  = static_cast<uint32_t>(width);
+        const size_t   count = static_cast<size_t>(size) * size * size;
+
+        char        line[64];
+        std::string cube = "TITLE \"" + path + "\"\nLUT_3D_SIZE " + std::to_string(size) + "\n";
+        for (size_t i = 0; i < count; i++)
+        {
+            const stbi_uc *texel = pixels + i * 4;
+            snprintf(line, sizeof(line), "%.6f %.6f %.6f\n", texel[0] / 255.0, texel[1] / 255.0, texel[2] / 255.0);
+            cube += line;
+        }
+        // 10 bit shaper, 12 bit output without a Mesh line, blue varies fastest
+        std::string threeDl;
+        for (uint32_t i = 0; i < size; i++)
+        {
+            threeDl += std::to_string(i * 1023 / (size - 1)) + (i + 1 < size ? " " : "\n");
+        }
+        for (uint32_t r = 0; r < size; r++)
+        {
+            for (uint32_t g = 0; g < size; g++)
+            {
+                for (uint32_t b = 0; b < size; b++)
+                {
+                    const stbi_uc *texel = pixels + ((static_cast<size_t>(b) * size + g) * size + r) * 4;
+                    snprintf(line, sizeof(line), "%d %d %d\n", (texel[0] * 4095 + 127) / 255,
+                             (texel[1] * 4095 + 127) / 255, (texel[2] * 4095 + 127) / 255);
+                    threeDl += line;
+                }
+            }
+        }
+
+        Table        table;
+        bool         match  = true;
+        const double cubeMs = measure([&]() { parseCube(cube.data(), cube.size(), TexelFormat::RGBA8, table); });
+        match = match && table.size() == size && memcmp(table.texels(), pixels, table.byteSize()) == 0;
+        // The reference: strtof, as the Java parser did with Float.parseFloat
+        std::vector<float> reference(count * 3);
+        const double       strtofMs = measure([&]() {
+            const char *p = strchr(strchr(cube.c_str(), '\n') + 1, '\n') + 1;
+            for (size_t i = 0; i < count * 3; i++)
+            {
+                char *next   = nullptr;
+                reference[i] = strtof(p, &next);
+                p            = next;
+            }
+        });
+        const double threeDlMs =
+            measure([&]() { parse3dl(threeDl.data(), threeDl.size(), TexelFormat::RGBA8, table); });
+        match = match && table.size() == size && memcmp(table.texels(), pixels, table.byteSize()) == 0;
+
+        double mapMs = 0.0;
+        if (!cacheDir.empty())
+        {
+            const std::string cachePath = cacheDir + "/lut_benchmark.rgba8";
+            writeCache(cachePath, table, 1);
+            mapMs = measure([&]() {
+                Table mapped;
+                match = mapCache(cachePath, 1, TexelFormat::RGBA8, mapped) &&
+                        memcmp(mapped.texels(), pixels, mapped.byteSize()) == 0 && match;
+            });
+            remove(cachePath.c_str());
+        }
+        stbi_image_free(pixels);
+
+        LOGCATI("LUT %s %u^3: .cube %.2f ms (%.0f MB/s, strtof %.2f ms), .3dl %.2f ms (%.0f MB/s), cache %.3f ms%s",
+                name.c_str(), size, cubeMs, cube.size() / 1000.0 / cubeMs, strtofMs, threeDlMs,
+                threeDl.size() / 1000.0 / threeDlMs, mapMs, match ? "" : ", MISMATCH");
+    }
+}
+}        // namespace lut
+}        // namespace vks
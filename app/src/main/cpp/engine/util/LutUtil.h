@@ -0,0 +1,139 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_LUTUTIL_H
+#define GAINVULKANSAMPLE_LUTUTIL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AssetUtil.h"
+
+// 3D colour lookup tables: parsing of the .cube (Resolve/Adobe) and .3dl (Lustre/Autodesk) text
+// formats and a binary cache of the parsed texels. The cache file holds the texels as they are
+// uploaded, later loads map it instead of parsing the text again.
+namespace vks
+{
+namespace lut
+{
+enum class TexelFormat : uint32_t
+{
+    // VK_FORMAT_R8G8B8A8_UNORM, the values are clamped to [0, 1]
+    RGBA8 = 0,
+    // VK_FORMAT_R16G16B16A16_SFLOAT, keeps values outside of [0, 1]
+    RGBA16F = 1,
+};
+
+uint32_t texelBytes(TexelFormat format);
+
+// size^3 texels, red varies fastest, then green, then blue: the layout of a VK_IMAGE_TYPE_3D image
+// of size x size x size. The texels are either owned or mapped from a cache file.
+class Table
+{
+  public:
+    Table() = default;
+    ~Table();
+    Table(Table &&other) noexcept;
+    Table &operator=(Table &&other) noexcept;
+    Table(const Table &) = delete;
+    Table &operator=(const Table &) = delete;
+
+    uint32_t size() const
+    {
+        return mSize;
+    }
+
+    TexelFormat format() const
+    {
+        return mFormat;
+    }
+
+    const uint8_t *texels() const
+    {
+        return mTexels;
+    }
+
+    size_t byteSize() const
+    {
+        return static_cast<size_t>(mSize) * mSize * mSize * texelBytes(mFormat);
+    }
+
+    bool mapped() const
+    {
+        return mMapping != nullptr;
+    }
+
+    // Own size^3 texels of format, returns them to be written
+    uint8_t *allocate(uint32_t size, TexelFormat format);
+
+    // Use the texels of a mapped file, the mapping is released with the table
+    void adopt(void *mapping, size_t mappingSize, const uint8_t *texels, uint32_t size, TexelFormat format);
+
+  private:
+    void release();
+
+    uint32_t             mSize   = 0;
+    TexelFormat          mFormat = TexelFormat::RGBA8;
+    const uint8_t       *mTexels = nullptr;
+    std::vector<uint8_t> mOwned;
+    void                *mMapping     = nullptr;
+    size_t               mMappingSize = 0;
+};
+
+// Parse the text of a .cube file. LUT_3D_SIZE, DOMAIN_MIN/MAX and LUT_3D_INPUT_RANGE are
+// supported, 1D LUTs are not.
+bool parseCube(const char *text, size_t length, TexelFormat format, Table &table);
+
+// Parse the text of a .3dl file. The output depth comes from the "Mesh" line, or from the largest
+// value if there is none (10, 12, 14 or 16 bits).
+bool parse3dl(const char *text, size_t length, TexelFormat format, Table &table);
+
+// Parse a .cube or a .3dl text, picked by the extension of name
+bool parse(const std::string &name, const char *text, size_t length, TexelFormat format, Table &table);
+
+// Key of a source in its cache file, a hash of its whole contents and size. A cache file with
+// another key is stale
+uint64_t sourceKey(const void *source, size_t size);
+
+// Write the texels to a cache file. The file is replaced atomically.
+bool writeCache(const std::string &path, const Table &table, uint64_t key);
+
+// Map a cache file written by writeCache, fails if it is missing, stale or of another format
+bool mapCache(const std::string &path, uint64_t key, TexelFormat format, Table &table);
+
+/**
+ * Load a .cube or .3dl asset. With a cacheDir the parsed texels are cached there, the following
+ * loads hash the asset to check the cache is up to date and map it instead of parsing.
+ */
+bool loadAsset(const AssetLoader &assets, const std::string &path, const std::string &cacheDir,
+               TexelFormat format, Table &table);
+
+// Parse throughput and cache load times on the LUT strips of assets/lut converted to .cube and
+// .3dl. Run on demand by Sample::runEngineBenchmarks.
+void runParseBenchmark(const AssetLoader &assets, const std::string &cacheDir);
+}        // namespace lut
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_LUTUTIL_H
@@ -0,0 +1,56 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef GAINVULKANSAMPLE_PLATFORMUTIL_H
+#define GAINVULKANSAMPLE_PLATFORMUTIL_H
+
+// Android types of the engine and sample interfaces. Host builds (app/src/test/cpp) have no NDK:
+// the handles are opaque there and only passed around, the code using them is Android only.
+#if defined(__ANDROID__)
+#include <android/asset_manager.h>
+#include <android/asset_manager_jni.h>
+#include <android/bitmap.h>
+#include <android/configuration.h>
+#include <android/hardware_buffer_jni.h>
+#include <android/native_window_jni.h>
+#include <jni.h>
+#else
+#include <jni.h>
+
+struct AAssetManager;
+struct ANativeWindow;
+struct AHardwareBuffer;
+
+// Screen densities the UI is scaled by, see android/configuration.h
+enum
+{
+    ACONFIGURATION_DENSITY_MEDIUM = 160,
+    ACONFIGURATION_DENSITY_HIGH   = 240,
+    ACONFIGURATION_DENSITY_XHIGH  = 320,
+    ACONFIGURATION_DENSITY_XXHIGH = 480,
+};
+#endif
+
+#endif        // GAINVULKANSAMPLE_PLATFORMUTIL_H
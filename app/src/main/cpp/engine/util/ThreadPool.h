@@ -0,0 +1,85 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef GAINVULKANSAMPLE_THREADPOOL_H
+#define GAINVULKANSAMPLE_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vks
+{
+// Fixed set of worker threads running tasks in submission order
+class ThreadPool
+{
+  public:
+    // threadCount 0 uses one thread per core
+    explicit ThreadPool(uint32_t threadCount = 0);
+
+    // Runs the tasks already submitted, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &)            = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // The future holds the result of task, or the exception it threw
+    template <typename F>
+    auto submit(F &&task) -> std::future<decltype(task())>
+    {
+        using Result = decltype(task());
+        // std::function needs a copyable target, packaged_task is move only
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        auto future   = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTasks.emplace_back([packaged]() { (*packaged)(); });
+        }
+        mCondition.notify_one();
+        return future;
+    }
+
+    uint32_t threadCount() const
+    {
+        return static_cast<uint32_t>(mWorkers.size());
+    }
+
+  private:
+    void workerLoop();
+
+    std::vector<std::thread>          mWorkers;
+    std::mutex                        mMutex;
+    std::condition_variable           mCondition;
+    std::deque<std::function<void()>> mTasks;
+    bool                              mStopping = false;
+};
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_THREADPOOL_H
@@ -181,6 +181,8 @@ VULKAN_RAII_OBJECT_FROM_DEVICE(Sampler, vkDestroySampler);
 VULKAN_RAII_OBJECT_FROM_DEVICE(ImageView, vkDestroyImageView);
 VULKAN_RAII_OBJECT_FROM_DEVICE(Semaphore, vkDestroySemaphore);
 VULKAN_RAII_OBJECT_FROM_DEVICE(Fence, vkDestroyFence);
+VULKAN_RAII_OBJECT_FROM_DEVICE(QueryPool, vkDestroyQueryPool);
+VULKAN_RAII_OBJECT_FROM_DEVICE(SamplerYcbcrConversion, vkDestroySamplerYcbcrConversion);
 
 #undef VULKAN_RAII_OBJECT_FROM_DEVICE
 
@@ -0,0 +1,299 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "YUVUtil.h"
+
+#include <chrono>
+#include <cstring>
+
+#include "LogUtil.h"
+
+#if defined(__ARM_NEON)
+#    include <arm_neon.h>
+#elif defined(__SSE2__)
+#    include <immintrin.h>
+#endif
+
+namespace vks
+{
+namespace yuv
+{
+namespace
+{
+// Split count byte pairs, returns the number of pairs handled so the caller finishes the tail
+using DeinterleaveRowFn = uint32_t (*)(const uint8_t *src, uint32_t count, uint8_t *dst0, uint8_t *dst1);
+
+#if defined(__ARM_NEON)
+uint32_t deinterleaveRowNeon(const uint8_t *src, uint32_t count, uint8_t *dst0, uint8_t *dst1)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        // vld2 de-interleaves while loading
+        const uint8x16x2_t pairs = vld2q_u8(src + 2 * x);
+        vst1q_u8(dst0 + x, pairs.val[0]);
+        vst1q_u8(dst1 + x, pairs.val[1]);
+    }
+    return x;
+}
+#elif defined(__SSE2__)
+uint32_t deinterleaveRowSse2(const uint8_t *src, uint32_t count, uint8_t *dst0, uint8_t *dst1)
+{
+    const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+    uint32_t      x        = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * x));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * x + 16));
+        // Keep the even (low) or the odd (high) byte of every 16 bit lane and pack them
+        const __m128i even = _mm_packus_epi16(_mm_and_si128(a, lowBytes), _mm_and_si128(b, lowBytes));
+        const __m128i odd  = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst0 + x), even);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst1 + x), odd);
+    }
+    return x;
+}
+
+__attribute__((target("avx2"))) uint32_t deinterleaveRowAvx2(const uint8_t *src, uint32_t count, uint8_t *dst0, uint8_t *dst1)
+{
+    const __m256i lowBytes = _mm256_set1_epi16(0x00ff);
+    uint32_t      x        = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 2 * x));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 2 * x + 32));
+        // packus works on each 128 bit half, the permute puts the quarters back in order
+        const __m256i even = _mm256_permute4x64_epi64(
+            _mm256_packus_epi16(_mm256_and_si256(a, lowBytes), _mm256_and_si256(b, lowBytes)), 0xd8);
+        const __m256i odd = _mm256_permute4x64_epi64(
+            _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8)), 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst0 + x), even);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst1 + x), odd);
+    }
+    return x + deinterleaveRowSse2(src + 2 * x, count - x, dst0 + x, dst1 + x);
+}
+#endif
+
+uint32_t deinterleaveRowScalar(const uint8_t *src, uint32_t count, uint8_t *dst0, uint8_t *dst1)
+{
+    for (uint32_t x = 0; x < count; x++)
+    {
+        dst0[x] = src[2 * x];
+        dst1[x] = src[2 * x + 1];
+    }
+    return count;
+}
+
+struct DeinterleaveImpl
+{
+    DeinterleaveRowFn row;
+    const char *      isa;
+};
+
+DeinterleaveImpl selectDeinterleave()
+{
+#if defined(__ARM_NEON)
+    return {deinterleaveRowNeon, "NEON"};
+#elif defined(__SSE2__)
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {deinterleaveRowAvx2, "AVX2"};
+    }
+    return {deinterleaveRowSse2, "SSE2"};
+#else
+    return {deinterleaveRowScalar, "scalar"};
+#endif
+}
+
+const DeinterleaveImpl &deinterleaveImpl()
+{
+    static const DeinterleaveImpl impl = selectDeinterleave();
+    return impl;
+}
+}        // namespace
+
+ChromaLayout detectChromaLayout(const Frame &frame)
+{
+    if (frame.uPixelStride == 1 && frame.vPixelStride == 1)
+        return ChromaLayout::I420;
+    if (frame.uPixelStride == 2 && frame.vPixelStride == 2 && frame.uStride == frame.vStride)
+    {
+        if (frame.v == frame.u + 1)
+            return ChromaLayout::NV12;
+        if (frame.u == frame.v + 1)
+            return ChromaLayout::NV21;
+    }
+    return ChromaLayout::GENERIC;
+}
+
+void copyPlaneScalar(const uint8_t *src, uint32_t width, uint32_t height, uint32_t stride,
+                     uint32_t pixelStride, uint8_t *dst)
+{
+    for (uint32_t row = 0; row < height; row++)
+    {
+        const uint8_t *srcRow = src + static_cast<size_t>(row) * stride;
+        for (uint32_t col = 0; col < width; col++)
+        {
+            *dst++ = srcRow[col * pixelStride];
+        }
+    }
+}
+
+void deinterleaveScalar(const uint8_t *src, uint32_t width, uint32_t height, uint32_t stride,
+                        uint8_t *dst0, uint8_t *dst1)
+{
+    for (uint32_t row = 0; row < height; row++)
+    {
+        deinterleaveRowScalar(src + static_cast<size_t>(row) * stride, width,
+                              dst0 + static_cast<size_t>(row) * width, dst1 + static_cast<size_t>(row) * width);
+    }
+}
+
+void deinterleave(const uint8_t *src, uint32_t width, uint32_t height, uint32_t stride,
+                  uint8_t *dst0, uint8_t *dst1)
+{
+    const DeinterleaveRowFn rowFn = deinterleaveImpl().row;
+    for (uint32_t row = 0; row < height; row++)
+    {
+        const uint8_t *srcRow  = src + static_cast<size_t>(row) * stride;
+        uint8_t *      dst0Row = dst0 + static_cast<size_t>(row) * width;
+        uint8_t *      dst1Row = dst1 + static_cast<size_t>(row) * width;
+        // The vector loop only reads whole pairs of the row, the interleaved plane of the last row
+        // may end right after the last pair
+        const uint32_t done = rowFn(srcRow, width, dst0Row, dst1Row);
+        deinterleaveRowScalar(srcRow + 2 * done, width - done, dst0Row + done, dst1Row + done);
+    }
+}
+
+const char *deinterleaveIsa()
+{
+    return deinterleaveImpl().isa;
+}
+
+Frame I420Unpacker::unpack(const Frame &src)
+{
+    const uint32_t chromaWidth  = src.width / 2;
+    const uint32_t chromaHeight = src.height / 2;
+    const size_t   chromaSize   = static_cast<size_t>(chromaWidth) * chromaHeight;
+
+    Frame dst   = src;
+    dst.uStride = chromaWidth;
+    dst.vStride = chromaWidth;
+    dst.uPixelStride = 1;
+    dst.vPixelStride = 1;
+
+    if (src.yStride != src.width)
+    {
+        mY.resize(static_cast<size_t>(src.width) * src.height);
+        for (uint32_t row = 0; row < src.height; row++)
+        {
+            memcpy(mY.data() + static_cast<size_t>(row) * src.width, src.y + static_cast<size_t>(row) * src.yStride, src.width);
+        }
+        dst.y       = mY.data();
+        dst.yStride = src.width;
+    }
+
+    // resize() keeps the allocation once the vectors have grown to the frame size
+    mU.resize(chromaSize);
+    mV.resize(chromaSize);
+    dst.u = mU.data();
+    dst.v = mV.data();
+
+    mLastLayout = detectChromaLayout(src);
+    switch (mLastLayout)
+    {
+        case ChromaLayout::NV12:
+            deinterleave(src.u, chromaWidth, chromaHeight, src.uStride, mU.data(), mV.data());
+            break;
+        case ChromaLayout::NV21:
+            deinterleave(src.v, chromaWidth, chromaHeight, src.vStride, mV.data(), mU.data());
+            break;
+        case ChromaLayout::I420:
+            if (src.uStride == chromaWidth && src.vStride == chromaWidth)
+            {
+                // Already packed, pass it through
+                dst.u = src.u;
+                dst.v = src.v;
+                break;
+            }
+            for (uint32_t row = 0; row < chromaHeight; row++)
+            {
+                memcpy(mU.data() + static_cast<size_t>(row) * chromaWidth, src.u + static_cast<size_t>(row) * src.uStride, chromaWidth);
+                memcpy(mV.data() + static_cast<size_t>(row) * chromaWidth, src.v + static_cast<size_t>(row) * src.vStride, chromaWidth);
+            }
+            break;
+        case ChromaLayout::GENERIC:
+            copyPlaneScalar(src.u, chromaWidth, chromaHeight, src.uStride, src.uPixelStride, mU.data());
+            copyPlaneScalar(src.v, chromaWidth, chromaHeight, src.vStride, src.vPixelStride, mV.data());
+            break;
+    }
+    return dst;
+}
+
+void runDeinterleaveBenchmark()
+{
+    const uint32_t sizes[][2]  = {{1920, 1080}, {3840, 2160}};
+    const int      iterations = 50;
+
+    for (const auto &size : sizes)
+    {
+        const uint32_t width = size[0] / 2, height = size[1] / 2;
+        // Camera strides are usually padded to 64 bytes
+        const uint32_t       stride = (width * 2 + 63) / 64 * 64;
+        std::vector<uint8_t> nv12(static_cast<size_t>(stride) * height);
+        for (size_t i = 0; i < nv12.size(); i++)
+        {
+            nv12[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+        }
+        std::vector<uint8_t> refU(width * height), refV(width * height), u(width * height), v(width * height);
+
+        const auto measure = [&](auto &&fn) {
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                fn();
+            }
+            const auto end = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+        };
+
+        // The old path: one strided gather per chroma plane
+        const double gatherMs = measure([&]() {
+            copyPlaneScalar(nv12.data(), width, height, stride, 2, refU.data());
+            copyPlaneScalar(nv12.data() + 1, width, height, stride, 2, refV.data());
+        });
+        const double scalarMs = measure([&]() {
+            deinterleaveScalar(nv12.data(), width, height, stride, refU.data(), refV.data());
+        });
+        const double simdMs = measure([&]() {
+            deinterleave(nv12.data(), width, height, stride, u.data(), v.data());
+        });
+
+        const bool match = u == refU && v == refV;
+        LOGCATI("YUV deinterleave %ux%u: gather %.3f ms, scalar %.3f ms, %s %.3f ms%s", size[0], size[1],
+                gatherMs, scalarMs, deinterleaveIsa(), simdMs, match ? "" : ", MISMATCH");
+    }
+}
+}        // namespace yuv
+}        // namespace vks
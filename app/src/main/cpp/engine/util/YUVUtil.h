@@ -0,0 +1,114 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_YUVUTIL_H
+#define GAINVULKANSAMPLE_YUVUTIL_H
+
+#include <cstdint>
+#include <vector>
+
+// CPU side helpers for camera frames (ImageFormat.YUV_420_888). The planes of such a frame are
+// either planar (I420, pixel stride 1) or two views of one interleaved chroma plane (NV12/NV21,
+// pixel stride 2). The samples unpack the planes on the GPU (YUVPlaneConverter), the helpers below
+// are the CPU counterpart and reference.
+namespace vks
+{
+namespace yuv
+{
+enum class ChromaLayout
+{
+    // U and V are separate planes with a pixel stride of 1
+    I420,
+    // U points at CbCrCbCr..., V is U + 1
+    NV12,
+    // V points at CrCbCrCb..., U is V + 1
+    NV21,
+    // Any other pixel stride or plane arrangement, unpacked sample by sample
+    GENERIC,
+};
+
+// A YUV 4:2:0 frame, the chroma planes are width / 2 x height / 2
+struct Frame
+{
+    const uint8_t *y = nullptr;
+    const uint8_t *u = nullptr;
+    const uint8_t *v = nullptr;
+    uint32_t       width   = 0;
+    uint32_t       height  = 0;
+    uint32_t       yStride = 0;
+    uint32_t       uStride = 0;
+    uint32_t       vStride = 0;
+    uint32_t       uPixelStride = 1;
+    uint32_t       vPixelStride = 1;
+};
+
+ChromaLayout detectChromaLayout(const Frame &frame);
+
+/**
+ * Scalar reference: copy width x height samples, pixelStride bytes apart, to a packed plane
+ *
+ * @param stride Bytes between the rows of src
+ */
+void copyPlaneScalar(const uint8_t *src, uint32_t width, uint32_t height, uint32_t stride,
+                     uint32_t pixelStride, uint8_t *dst);
+
+// Scalar reference: split rows of width byte pairs into the packed planes dst0 (first byte of
+// each pair) and dst1 (second byte)
+void deinterleaveScalar(const uint8_t *src, uint32_t width, uint32_t height, uint32_t stride,
+                        uint8_t *dst0, uint8_t *dst1);
+
+// Same as deinterleaveScalar, vectorized with NEON on ARM and SSE2/AVX2 on x86
+void deinterleave(const uint8_t *src, uint32_t width, uint32_t height, uint32_t stride,
+                  uint8_t *dst0, uint8_t *dst1);
+
+// Name of the instruction set deinterleave() runs with on this CPU
+const char *deinterleaveIsa();
+
+// Unpacks camera frames to tightly packed I420. The output planes are owned by the unpacker and
+// reused from frame to frame, they stay valid until the next unpack() call.
+class I420Unpacker
+{
+  public:
+    // Returns the I420 frame. The luma plane is passed through if it has no row padding.
+    Frame unpack(const Frame &src);
+
+    ChromaLayout lastLayout() const
+    {
+        return mLastLayout;
+    }
+
+  private:
+    std::vector<uint8_t> mY;
+    std::vector<uint8_t> mU;
+    std::vector<uint8_t> mV;
+    ChromaLayout         mLastLayout = ChromaLayout::I420;
+};
+
+// Compare deinterleave() against the scalar paths at 1080p and 4K and log the timings.
+// Run on demand by Sample::runEngineBenchmarks.
+void runDeinterleaveBenchmark();
+}        // namespace yuv
+}        // namespace vks
+
+#endif        // GAINVULKANSAMPLE_YUVUTIL_H
@@ -187,6 +187,7 @@ PFN_vkBindImageMemory2KHR vkBindImageMemory2;
 PFN_vkCreateSamplerYcbcrConversionKHR vkCreateSamplerYcbcrConversion;
 PFN_vkDestroySamplerYcbcrConversionKHR vkDestroySamplerYcbcrConversion;
 PFN_vkGetPhysicalDeviceFeatures2KHR vkGetPhysicalDeviceFeatures2;
+PFN_vkGetPhysicalDeviceProperties2KHR vkGetPhysicalDeviceProperties2;
 
 #ifdef VK_USE_PLATFORM_XLIB_KHR
 PFN_vkCreateXlibSurfaceKHR vkCreateXlibSurfaceKHR;
@@ -219,9 +220,13 @@ void *libVulkan;
 bool loadVulkanLibrary()
 {
 
-    // Load vulkan library
+    // Load vulkan library, Linux distributions only ship the versioned name without the SDK
     libVulkan = dlopen("libvulkan.so", RTLD_NOW | RTLD_LOCAL);
     if (!libVulkan)
+    {
+        libVulkan = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+    }
+    if (!libVulkan)
     {
         return false;
     }
@@ -536,6 +541,10 @@ void loadVulkanFunctions(VkInstance instance) {
     vkGetPhysicalDeviceFeatures2 =
             reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(instance,
                                                                                           "vkGetPhysicalDeviceFeatures2KHR"));
+    // Core name, nullptr on a Vulkan 1.0 instance
+    vkGetPhysicalDeviceProperties2 =
+            reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(vkGetInstanceProcAddr(instance,
+                                                                                            "vkGetPhysicalDeviceProperties2"));
 
 #ifdef VK_USE_PLATFORM_XLIB_KHR
     vkCreateXlibSurfaceKHR = reinterpret_cast<PFN_vkCreateXlibSurfaceKHR>(vkGetInstanceProcAddr(instance, "vkCreateXlibSurfaceKHR"));
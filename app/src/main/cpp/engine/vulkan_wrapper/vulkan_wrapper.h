@@ -201,6 +201,7 @@ extern PFN_vkBindImageMemory2KHR vkBindImageMemory2;
 extern PFN_vkCreateSamplerYcbcrConversionKHR vkCreateSamplerYcbcrConversion;
 extern PFN_vkDestroySamplerYcbcrConversionKHR vkDestroySamplerYcbcrConversion;
 extern PFN_vkGetPhysicalDeviceFeatures2KHR vkGetPhysicalDeviceFeatures2;
+extern PFN_vkGetPhysicalDeviceProperties2KHR vkGetPhysicalDeviceProperties2;
 
 #ifdef VK_USE_PLATFORM_XLIB_KHR
 // VK_KHR_xlib_surface
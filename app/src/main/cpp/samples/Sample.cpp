@@ -35,10 +35,18 @@
 #include "Sample_09_3DModelWithAnim.h"
 #include "Sample_10_PBR.h"
 #include "Sample_11_YUVTexture_VK_Conversion.h"
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
+#    include "Sample_12_CameraHardwareBuffer.h"
+#endif
+#include "Sample_13_LongExposure.h"
 #include "includes/cube_data.h"
 #include "jni.h"
 #include "vulkan_wrapper.h"
 #include <VulkanContextBase.h>
+#include <VulkanglTFAnimation.h>
+#include <VulkanglTFTransformHierarchy.h>
+#include <LutUtil.h>
+#include <YUVUtil.h>
 #include <stdexcept>
 #include <vector>
 #include <vulkan/vulkan.h>
@@ -46,10 +54,11 @@
 #include <chrono>
 #include <thread>
 
-std::unique_ptr<Sample> Sample::create(AAssetManager *assetManager, uint32_t type)
+std::unique_ptr<Sample> Sample::create(std::shared_ptr<vks::AssetLoader> assets, uint32_t type, bool headless,
+                                       const std::string &cacheDir)
 {
     auto sample = std::make_unique<Sample>(type);
-    sample->initialize(true, assetManager);
+    sample->initialize(true, assets, headless, cacheDir);
     return std::move(sample);
 }
 
@@ -57,8 +66,12 @@ Sample::Sample(uint32_t type) :
     mSampleType(type)
 {}
 
-void Sample::initialize(bool enableDebug, AAssetManager *assetManager)
+void Sample::initialize(bool enableDebug, std::shared_ptr<vks::AssetLoader> assets, bool headless,
+                        const std::string &cacheDir)
 {
+    mAssets   = assets;
+    mCacheDir = cacheDir;
+
     switch (mSampleType)
     {
         case SampleType::TRIANGLE: {
@@ -106,9 +119,23 @@ void Sample::initialize(bool enableDebug, AAssetManager *assetManager)
             mContext = std::make_unique<Sample_11_YUVTexture_VK_Conversion>();
             break;
         }
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
+        case SampleType::CAMERA_HARDWAREBUFFER: {
+            mContext = std::make_unique<Sample_12_CameraHardwareBuffer>();
+            break;
+        }
+#endif
+        case SampleType::LONG_EXPOSURE: {
+            mContext = std::make_unique<Sample_13_LongExposure>();
+            break;
+        }
+        default: {
+            LOGCATE("Sample::initialize: Sample type %u is not available on this platform", mSampleType);
+            return;
+        }
     }
 
-    const bool success = mContext->create(enableDebug, assetManager);
+    const bool success = mContext->create(enableDebug, assets, headless, cacheDir);
     assert(success);
 }
 
@@ -119,6 +146,43 @@ void Sample::setWindow(ANativeWindow *window, uint32_t w, uint32_t h)
     mContext->setNativeWindow(window, w, h);
 }
 
+void Sample::setHeadlessTarget(uint32_t w, uint32_t h)
+{
+    // init offscreen render target
+    mContext->connectSwapChain();
+    mContext->setHeadlessTarget(w, h);
+}
+
+bool Sample::readbackFrame(void *dst, size_t size)
+{
+    return mContext->readbackFrame(dst, size);
+}
+
+void Sample::setFramesInFlight(uint32_t count)
+{
+    mContext->setFramesInFlight(count);
+}
+
+std::vector<VulkanContextBase::FramePacing> Sample::compareFramesInFlight(uint32_t frameCount)
+{
+    return mContext->compareFramesInFlight(frameCount);
+}
+
+void Sample::runBenchmarks()
+{
+    // The benchmarks submit to the queues of the frames in flight
+    CALL_VK(vkDeviceWaitIdle(mContext->device()));
+    mContext->runBenchmarks();
+}
+
+void Sample::runEngineBenchmarks()
+{
+    yuv::runDeinterleaveBenchmark();
+    lut::runParseBenchmark(*mAssets, mCacheDir);
+    vkglTF::runTransformHierarchyBenchmark();
+    vkglTF::runAnimationBenchmark();
+}
+
 void Sample::prepare(JNIEnv *env)
 {
     mContext->prepare(env);
@@ -134,25 +198,25 @@ void Sample::prepareBitmap(JNIEnv *env, jobject bitmap)
 
 void Sample::prepareYUV(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w,
                         uint32_t h, uint32_t yStride, uint32_t uStride, uint32_t vStride,
-                        uint32_t orientation)
+                        uint32_t uPixelStride, uint32_t vPixelStride, uint32_t orientation)
 {
     if (mSampleType == SampleType::MULTI_LUT)
     {
         Sample_06_MultiLUT *cameraContext = dynamic_cast<Sample_06_MultiLUT *>(mContext.get());
         cameraContext->setYUVImage(
-            yData, uData, vData, w, h, yStride, uStride, vStride, orientation);
+            yData, uData, vData, w, h, yStride, uStride, vStride, uPixelStride, vPixelStride, orientation);
     }
     else if (mSampleType == SampleType::LUT)
     {
         Sample_05_LUT *cameraContext = dynamic_cast<Sample_05_LUT *>(mContext.get());
         cameraContext->setYUVImage(
-            yData, uData, vData, w, h, yStride, uStride, vStride, orientation);
+            yData, uData, vData, w, h, yStride, uStride, vStride, uPixelStride, vPixelStride, orientation);
     }
     else
     {
         Sample_04_YUVTexture *cameraContext = dynamic_cast<Sample_04_YUVTexture *>(mContext.get());
         cameraContext->setYUVImage(
-            yData, uData, vData, w, h, yStride, uStride, vStride, orientation);
+            yData, uData, vData, w, h, yStride, uStride, vStride, uPixelStride, vPixelStride, orientation);
     }
 
     mContext->prepare(env);
@@ -166,6 +230,14 @@ void Sample::prepareI420VkConversion(JNIEnv *env, uint8_t *data, uint32_t w, uin
     mContext->prepare(env);
 }
 
+void Sample::prepareNV12VkConversion(JNIEnv *env, uint8_t *data, uint32_t w, uint32_t h, bool crCb)
+{
+    Sample_11_YUVTexture_VK_Conversion *cameraContext = dynamic_cast<Sample_11_YUVTexture_VK_Conversion *>(mContext.get());
+    cameraContext->setYUVImage(data, w, h, crCb ? vks::yuv::ChromaLayout::NV21 : vks::yuv::ChromaLayout::NV12);
+
+    mContext->prepare(env);
+}
+
 void Sample::prepareHistogram(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8_t *vData,
                               uint32_t w, uint32_t h, uint32_t yStride, uint32_t uStride,
                               uint32_t vStride, uint32_t uPixelStride, uint32_t vPixelStride,
@@ -190,16 +262,101 @@ void Sample::prepareHistogram(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8
     mContext->prepare(env);
 }
 
+void Sample::setHistogramChannel(int32_t channel)
+{
+    Sample_07_Histogram *histogramContext = dynamic_cast<Sample_07_Histogram *>(mContext.get());
+    histogramContext->setChannel(static_cast<vks::histogram::Channel>(channel));
+}
+
+uint64_t Sample::latestHistogram(JNIEnv *env, jintArray bins)
+{
+    if (env->GetArrayLength(bins) < vks::histogram::BIN_COUNT)
+    {
+        LOGCATE("latestHistogram: the array is smaller than %u bins", vks::histogram::BIN_COUNT);
+        return 0;
+    }
+
+    Sample_07_Histogram *histogramContext = dynamic_cast<Sample_07_Histogram *>(mContext.get());
+    uint32_t             latest[vks::histogram::BIN_COUNT];
+    uint64_t             frame = histogramContext->latestHistogram(latest);
+    if (frame != 0)
+    {
+        env->SetIntArrayRegion(bins, 0, vks::histogram::BIN_COUNT, reinterpret_cast<const jint *>(latest));
+    }
+    return frame;
+}
+
 void Sample::prepareLUT(JNIEnv *env, jobject bitmap)
 {
     Sample_05_LUT *lutContext = dynamic_cast<Sample_05_LUT *>(mContext.get());
     lutContext->setLUTImage(env, bitmap);
 }
 
-void Sample::prepareLUTs(JNIEnv *env, jobjectArray bitmapArray)
+void Sample::setLUTChain(JNIEnv *env, jobjectArray bitmapArray)
+{
+    Sample_05_LUT *lutContext = dynamic_cast<Sample_05_LUT *>(mContext.get());
+    lutContext->setLUTChain(env, bitmapArray);
+}
+
+void Sample::setLUTIntensity(uint32_t step, float intensity)
+{
+    Sample_05_LUT *lutContext = dynamic_cast<Sample_05_LUT *>(mContext.get());
+    lutContext->setLUTIntensity(step, intensity);
+}
+
+bool Sample::applyLUT(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h,
+                      uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t uPixelStride,
+                      uint32_t vPixelStride, bool tetrahedral, jobject bitmap)
+{
+    Sample_05_LUT *lutContext = dynamic_cast<Sample_05_LUT *>(mContext.get());
+    if (lutContext == nullptr)
+    {
+        return false;
+    }
+
+#if defined(__ANDROID__)
+    AndroidBitmapInfo info;
+    void             *pixels = nullptr;
+    if (AndroidBitmap_getInfo(env, bitmap, &info) != ANDROID_BITMAP_RESULT_SUCCESS ||
+        info.format != ANDROID_BITMAP_FORMAT_RGBA_8888 || info.width != w || info.height != h)
+    {
+        LOGCATE("Sample::applyLUT: The bitmap is not a %ux%u RGBA_8888 bitmap", w, h);
+        return false;
+    }
+    if (AndroidBitmap_lockPixels(env, bitmap, &pixels) != ANDROID_BITMAP_RESULT_SUCCESS)
+    {
+        LOGCATE("Sample::applyLUT: Failed to lock the bitmap");
+        return false;
+    }
+
+    yuv::Frame frame;
+    frame.y            = yData;
+    frame.u            = uData;
+    frame.v            = vData;
+    frame.width        = w;
+    frame.height       = h;
+    frame.yStride      = yStride;
+    frame.uStride      = uStride;
+    frame.vStride      = vStride;
+    frame.uPixelStride = uPixelStride;
+    frame.vPixelStride = vPixelStride;
+    const bool success = lutContext->applyLUT(
+        frame,
+        tetrahedral ? LutProcessor::Interpolation::TETRAHEDRAL : LutProcessor::Interpolation::TRILINEAR,
+        static_cast<uint8_t *>(pixels),
+        info.stride);
+    AndroidBitmap_unlockPixels(env, bitmap);
+    return success;
+#else
+    LOGCATE("Sample::applyLUT: Android bitmaps are not available on this platform");
+    return false;
+#endif
+}
+
+void Sample::prepareLUTs(JNIEnv *env, jobjectArray pathArray)
 {
     Sample_06_MultiLUT *lutContext = dynamic_cast<Sample_06_MultiLUT *>(mContext.get());
-    lutContext->setLUTImages(env, bitmapArray);
+    lutContext->setLUTAssets(env, pathArray);
 }
 
 void Sample::updateLUTs(JNIEnv *jniEnv, uint32_t itemWidth, uint32_t startIndex, uint32_t drawCount,
@@ -215,8 +372,15 @@ void Sample::updateSelectedIndex(JNIEnv *jniEnv, uint32_t index)
     lutContext->updateSelectedIndex(jniEnv, index);
 }
 
-void Sample::prepareCameraTexture(JNIEnv *env)
-{}
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
+void Sample::prepareCameraTexture(JNIEnv *env, AHardwareBuffer *buffer, uint32_t orientation)
+{
+    Sample_12_CameraHardwareBuffer *cameraContext = dynamic_cast<Sample_12_CameraHardwareBuffer *>(mContext.get());
+    cameraContext->setHardwareBuffer(buffer, orientation);
+
+    mContext->prepare(env);
+}
+#endif
 
 void Sample::prepare3dModel(JNIEnv *env, std::string filePath)
 {
@@ -244,8 +408,21 @@ void Sample::prepare3dModelPBR(JNIEnv *env, std::string filePath)
 
 void Sample::prepareLongExposure(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8_t *vData,
                                  uint32_t w, uint32_t h, uint32_t yStride, uint32_t uStride,
-                                 uint32_t vStride)
-{}
+                                 uint32_t vStride, uint32_t uPixelStride, uint32_t vPixelStride,
+                                 uint32_t orientation)
+{
+    Sample_13_LongExposure *exposureContext = dynamic_cast<Sample_13_LongExposure *>(mContext.get());
+    exposureContext->setYUVImage(
+        yData, uData, vData, w, h, yStride, uStride, vStride, uPixelStride, vPixelStride, orientation);
+
+    mContext->prepare(env);
+}
+
+void Sample::setLongExposureMode(int32_t mode, float decay)
+{
+    Sample_13_LongExposure *exposureContext = dynamic_cast<Sample_13_LongExposure *>(mContext.get());
+    exposureContext->setMode(static_cast<vks::FrameAccumulator::Mode>(mode), decay);
+}
 
 void Sample::onTouchActionMove(float deltaX, float deltaY)
 {
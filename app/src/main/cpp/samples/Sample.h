@@ -27,9 +27,12 @@
 
 #include "../engine/VulkanContextBase.h"
 #include "../engine/VulkanImageWrapper.h"
-#include <android/native_window_jni.h>
+#include "../engine/util/AssetUtil.h"
+#include "../engine/util/PlatformUtil.h"
 #include <glm/vec2.hpp>
 #include <memory>
+#include <string>
+#include <vector>
 #include <vulkan_wrapper.h>
 
 using namespace vks;
@@ -50,6 +53,7 @@ enum SampleType
     LOAD_3D_MODEL,
     LOAD_3D_MODEL_WITH_ANIM,
     LOAD_3D_MODEL_PBR,
+    LONG_EXPOSURE,
 };
 
 class Sample
@@ -57,9 +61,13 @@ class Sample
   public:
     explicit Sample(uint32_t type);
 
-    static std::unique_ptr<Sample> create(AAssetManager *assetManager, uint32_t type);
+    // headless renders offscreen (see setHeadlessTarget) so samples can run without a window, e.g. the
+    // host tests of app/src/test/cpp. cacheDir keeps the pipeline cache between launches.
+    static std::unique_ptr<Sample> create(std::shared_ptr<vks::AssetLoader> assets, uint32_t type,
+                                          bool headless = false, const std::string &cacheDir = "");
 
-    void initialize(bool enableDebug, AAssetManager *assetManager);
+    void initialize(bool enableDebug, std::shared_ptr<vks::AssetLoader> assets, bool headless = false,
+                    const std::string &cacheDir = "");
 
     void unInit(JNIEnv *env);
 
@@ -69,13 +77,26 @@ class Sample
 
     void prepareLUT(JNIEnv *env, jobject bitmap);
 
-    void prepareLUTs(JNIEnv *env, jobjectArray bitmapArray);
+    // LUTs applied after the one of prepareLUT, baked with it into the LUT the frames sample
+    void setLUTChain(JNIEnv *env, jobjectArray bitmapArray);
+
+    // Mix of a LUT of the chain with its input (0 to 1), step 0 is the LUT of prepareLUT
+    void setLUTIntensity(uint32_t step, float intensity);
+
+    // Apply the LUT chain of prepareLUT and setLUTChain to a full resolution frame offscreen and write it to an RGBA_8888
+    // bitmap of the frame size, blocks until the bitmap is written
+    bool applyLUT(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h, uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t uPixelStride, uint32_t vPixelStride, bool tetrahedral, jobject bitmap);
+
+    // Asset paths of the LUTs, they are decoded when they are shown
+    void prepareLUTs(JNIEnv *env, jobjectArray pathArray);
 
     void updateLUTs(JNIEnv *jniEnv, uint32_t itemWidth, uint32_t startIndex, uint32_t drawCount, uint32_t offset);
 
     void updateSelectedIndex(JNIEnv *jniEnv, uint32_t index);
 
-    void prepareCameraTexture(JNIEnv *env);
+#if defined(VK_USE_PLATFORM_ANDROID_KHR)
+    void prepareCameraTexture(JNIEnv *env, AHardwareBuffer *buffer, uint32_t orientation = 0);
+#endif
 
     void prepare3dModel(JNIEnv *env, std::string filePath);
 
@@ -83,13 +104,28 @@ class Sample
 
     void prepare3dModelPBR(JNIEnv *env, std::string filePath);
 
-    void prepareYUV(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h, uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t orientation = 0);
+    // The planes are uploaded as they are, any row and pixel stride (YUV_420_888) is unpacked on the GPU
+    void prepareYUV(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h, uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t uPixelStride = 1, uint32_t vPixelStride = 1, uint32_t orientation = 0);
 
     void prepareI420VkConversion(JNIEnv *env, uint8_t *data, uint32_t w, uint32_t h);
 
+    // Packed NV12 frame, NV21 if crCb. The interleaved chroma is sampled as is.
+    void prepareNV12VkConversion(JNIEnv *env, uint8_t *data, uint32_t w, uint32_t h, bool crCb);
+
     void prepareHistogram(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h, uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t uPixelStride, uint32_t vPixelStride, uint32_t orientation = 0);
 
-    void prepareLongExposure(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h, uint32_t yStride, uint32_t uStride, uint32_t vStride);
+    // Channel counted by the histogram, see histogram::Channel
+    void setHistogramChannel(int32_t channel);
+
+    // Copy the newest histogram read back from the GPU to bins (histogram::BIN_COUNT ints), one or two frames
+    // behind the one on screen. Returns its frame number, 0 if there is none yet.
+    uint64_t latestHistogram(JNIEnv *env, jintArray bins);
+
+    // Accumulate a camera frame into the long exposure, see vks::FrameAccumulator
+    void prepareLongExposure(JNIEnv *env, uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h, uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t uPixelStride, uint32_t vPixelStride, uint32_t orientation = 0);
+
+    // Restart the long exposure with a vks::FrameAccumulator::Mode, decay weighs each frame of the DECAY mode
+    void setLongExposureMode(int32_t mode, float decay);
 
     void render(bool loop);
 
@@ -97,11 +133,31 @@ class Sample
 
     void setWindow(ANativeWindow *window, uint32_t w, uint32_t h);
 
+    void setHeadlessTarget(uint32_t w, uint32_t h);
+
+    bool readbackFrame(void *dst, size_t size);
+
+    void setFramesInFlight(uint32_t count);
+
+    // Call it between frames on the render thread, see VulkanContextBase::compareFramesInFlight
+    std::vector<VulkanContextBase::FramePacing> compareFramesInFlight(uint32_t frameCount);
+
+    // Run the benchmarks of the sample, see VulkanContextBase::runBenchmarks. Call it between frames
+    // on the render thread.
+    void runBenchmarks();
+
+    // Run the CPU benchmarks of the engine, they do not depend on the sample type
+    void runEngineBenchmarks();
+
     void onTouchActionMove(float deltaX, float deltaY);
 
   private:
     std::unique_ptr<VulkanContextBase> mContext;
 
+    // Kept for the engine benchmarks
+    std::shared_ptr<vks::AssetLoader> mAssets;
+    std::string                       mCacheDir;
+
     uint32_t mSampleType;
 
     bool mLoopDraw;
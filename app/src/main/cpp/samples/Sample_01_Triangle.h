@@ -30,8 +30,6 @@
 class Sample_01_Triangle : public VulkanContextBase
 {
   private:
-    void prepareSynchronizationPrimitives();
-
     void setupPipelineLayout();
 
   public:
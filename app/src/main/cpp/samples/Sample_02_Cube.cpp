@@ -34,7 +34,6 @@ void Sample_02_Cube::prepare(JNIEnv *env)
     {
         VulkanContextBase::prepare(env);
 
-        prepareSynchronizationPrimitives();
         prepareVertices(true, g_vbData, sizeof(g_vbData));
         prepareUniformBuffers();
         setupDescriptorPool();
@@ -143,23 +142,6 @@ void Sample_02_Cube::setupDescriptorSet()
     vkUpdateDescriptorSets(device(), 1, &writeDescriptorSet, 0, nullptr);
 }
 
-void Sample_02_Cube::prepareSynchronizationPrimitives()
-{
-    // Semaphores (Used for correct command ordering)
-    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
-    semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext                 = nullptr;
-
-    // Semaphore used to ensures that image presentation is complete before starting to submit again
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, presentCompleteSemaphore.pHandle()));
-
-    // Semaphore used to ensures that all commands submitted have been finished before submitting
-    // the image to the queue
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, renderCompleteSemaphore.pHandle()));
-}
-
 void Sample_02_Cube::prepareUniformBuffers()
 {
     // Prepare and initialize a uniform buffer block containing shader uniforms
@@ -182,7 +164,7 @@ void Sample_02_Cube::updateUniformBuffers()
     uboVS.viewMatrix       = mCamera.matrices.view;
     uboVS.modelMatrix      = glm::mat4(1.0f);
 
-    mUniformBuffer->copyFrom(&uboVS, sizeof(uboVS));
+    updateUniformBuffer(*mUniformBuffer, &uboVS, sizeof(uboVS));
 }
 
 void Sample_02_Cube::preparePipelines()
@@ -336,10 +318,6 @@ void Sample_02_Cube::preparePipelines()
     // Create rendering pipeline using the specified states
     CALL_VK(vkCreateGraphicsPipelines(
         device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
-
-    // Shader modules are no longer needed once the graphics pipeline has been created
-    vkDestroyShaderModule(device(), shaderStages[0].module, nullptr);
-    vkDestroyShaderModule(device(), shaderStages[1].module, nullptr);
 }
 
 void Sample_02_Cube::buildCommandBuffers()
@@ -429,10 +407,10 @@ void Sample_02_Cube::buildCommandBuffers()
 
 void Sample_02_Cube::draw()
 {
-    CALL_VK(mSwapChain.acquireNextImage(presentCompleteSemaphore.handle(), &currentBuffer));
-    // Use a fence to wait until the command buffer has finished execution before using it again
-    CALL_VK(vkWaitForFences(device(), 1, waitFences[currentBuffer].pHandle(), VK_TRUE, UINT64_MAX));
-    CALL_VK(vkResetFences(device(), 1, waitFences[currentBuffer].pHandle()));
+    // Wait for the frame slot to be free and acquire the next swap chain image
+    prepareFrame();
+
+    FrameSync &frame = currentFrameSync();
 
     // Pipeline stage at which the queue submission will wait (via pWaitSemaphores)
     VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
@@ -442,11 +420,11 @@ void Sample_02_Cube::draw()
     submitInfo.pWaitDstStageMask = &waitStageMask;        // Pointer to the list of pipeline stages that
                                                           // the semaphore waits will occur at
     submitInfo.pWaitSemaphores =
-        presentCompleteSemaphore.pHandle();        // Semaphore(s) to wait upon before the submitted
-                                                   // command buffer starts executing
-    submitInfo.waitSemaphoreCount = 1;             // One wait semaphore
+        frame.presentCompleteSemaphore.pHandle();        // Semaphore(s) to wait upon before the submitted
+                                                         // command buffer starts executing
+    submitInfo.waitSemaphoreCount = 1;                   // One wait semaphore
     submitInfo.pSignalSemaphores =
-        renderCompleteSemaphore
+        frame.renderCompleteSemaphore
             .pHandle();                         // Semaphore(s) to be signaled when command buffers have completed
     submitInfo.signalSemaphoreCount = 1;        // One signal semaphore
     submitInfo.pCommandBuffers =
@@ -454,19 +432,11 @@ void Sample_02_Cube::draw()
             .pHandle();                       // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;        // One command buffer
 
-    // Submit to the graphics queue passing a wait fence
-    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, waitFences[currentBuffer].handle()));
+    // Submit to the graphics queue passing the fence of this frame slot
+    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, frame.inFlightFence.handle()));
 
-    // Present the current buffer to the swap chain
-    // Pass the semaphore signaled by the command buffer submission from the submit info as the wait
-    // semaphore for swap chain presentation This ensures that the image is not presented to the
-    // windowing system until all commands have been submitted
-    VkResult present =
-        mSwapChain.queuePresent(mGraphicsQueue, currentBuffer, renderCompleteSemaphore.handle());
-    if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR)))
-    {
-        CALL_VK(present);
-    }
+    // Present the current buffer to the swap chain and move on to the next frame slot
+    submitFrame();
 }
 
 Sample_02_Cube::~Sample_02_Cube()
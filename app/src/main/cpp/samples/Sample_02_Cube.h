@@ -30,8 +30,6 @@
 class Sample_02_Cube : public VulkanContextBase
 {
   private:
-    void prepareSynchronizationPrimitives();
-
     void updateUniformBuffers();
 
     void setupDescriptorSetLayout();
@@ -51,7 +51,6 @@ void Sample_03_Texture::prepare(JNIEnv *env)
 
     prepareBitmapImage();
 
-    prepareSynchronizationPrimitives();
     prepareVertices(true, g_vb_bitmap_texture_Data, sizeof(g_vb_bitmap_texture_Data));
     prepareUniformBuffers();
     setupDescriptorPool();
@@ -172,23 +171,6 @@ void Sample_03_Texture::setupDescriptorSet()
     vkUpdateDescriptorSets(device(), 2, writeDescriptorSet, 0, nullptr);
 }
 
-void Sample_03_Texture::prepareSynchronizationPrimitives()
-{
-    // Semaphores (Used for correct command ordering)
-    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
-    semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext                 = nullptr;
-
-    // Semaphore used to ensures that image presentation is complete before starting to submit again
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, presentCompleteSemaphore.pHandle()));
-
-    // Semaphore used to ensures that all commands submitted have been finished before submitting
-    // the image to the queue
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, renderCompleteSemaphore.pHandle()));
-}
-
 void Sample_03_Texture::prepareUniformBuffers()
 {
     // Prepare and initialize a uniform buffer block containing shader uniforms
@@ -228,7 +210,7 @@ void Sample_03_Texture::updateUniformBuffers()
         uboVS.modelMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(bmpRatio / winRatio, 1.0f, 1.0f));
     }
 
-    mUniformBuffer->copyFrom(&uboVS, sizeof(uboVS));
+    updateUniformBuffer(*mUniformBuffer, &uboVS, sizeof(uboVS));
 }
 
 void Sample_03_Texture::preparePipelines()
@@ -382,10 +364,6 @@ void Sample_03_Texture::preparePipelines()
     // Create rendering pipeline using the specified states
     CALL_VK(vkCreateGraphicsPipelines(
         device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
-
-    // Shader modules are no longer needed once the graphics pipeline has been created
-    vkDestroyShaderModule(device(), shaderStages[0].module, nullptr);
-    vkDestroyShaderModule(device(), shaderStages[1].module, nullptr);
 }
 
 void Sample_03_Texture::buildCommandBuffers()
@@ -479,10 +457,10 @@ void Sample_03_Texture::buildCommandBuffers()
 
 void Sample_03_Texture::draw()
 {
-    CALL_VK(mSwapChain.acquireNextImage(presentCompleteSemaphore.handle(), &currentBuffer));
-    // Use a fence to wait until the command buffer has finished execution before using it again
-    CALL_VK(vkWaitForFences(device(), 1, waitFences[currentBuffer].pHandle(), VK_TRUE, UINT64_MAX));
-    CALL_VK(vkResetFences(device(), 1, waitFences[currentBuffer].pHandle()));
+    // Wait for the frame slot to be free and acquire the next swap chain image
+    prepareFrame();
+
+    FrameSync &frame = currentFrameSync();
 
     // Pipeline stage at which the queue submission will wait (via pWaitSemaphores)
     VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
@@ -492,11 +470,11 @@ void Sample_03_Texture::draw()
     submitInfo.pWaitDstStageMask = &waitStageMask;        // Pointer to the list of pipeline stages that
                                                           // the semaphore waits will occur at
     submitInfo.pWaitSemaphores =
-        presentCompleteSemaphore.pHandle();        // Semaphore(s) to wait upon before the submitted
-                                                   // command buffer starts executing
-    submitInfo.waitSemaphoreCount = 1;             // One wait semaphore
+        frame.presentCompleteSemaphore.pHandle();        // Semaphore(s) to wait upon before the submitted
+                                                         // command buffer starts executing
+    submitInfo.waitSemaphoreCount = 1;                   // One wait semaphore
     submitInfo.pSignalSemaphores =
-        renderCompleteSemaphore
+        frame.renderCompleteSemaphore
             .pHandle();                         // Semaphore(s) to be signaled when command buffers have completed
     submitInfo.signalSemaphoreCount = 1;        // One signal semaphore
     submitInfo.pCommandBuffers =
@@ -504,19 +482,11 @@ void Sample_03_Texture::draw()
             .pHandle();                       // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;        // One command buffer
 
-    // Submit to the graphics queue passing a wait fence
-    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, waitFences[currentBuffer].handle()));
+    // Submit to the graphics queue passing the fence of this frame slot
+    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, frame.inFlightFence.handle()));
 
-    // Present the current buffer to the swap chain
-    // Pass the semaphore signaled by the command buffer submission from the submit info as the wait
-    // semaphore for swap chain presentation This ensures that the image is not presented to the
-    // windowing system until all commands have been submitted
-    VkResult present =
-        mSwapChain.queuePresent(mGraphicsQueue, currentBuffer, renderCompleteSemaphore.handle());
-    if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR)))
-    {
-        CALL_VK(present);
-    }
+    // Present the current buffer to the swap chain and move on to the next frame slot
+    submitFrame();
 }
 
 Sample_03_Texture::~Sample_03_Texture()
@@ -38,8 +38,6 @@ class Sample_03_Texture : public VulkanContextBase
 
     jobject mJBitmap;
 
-    void prepareSynchronizationPrimitives();
-
     void updateUniformBuffers();
 
     void setupDescriptorSetLayout();
@@ -33,7 +33,8 @@
 
 void Sample_04_YUVTexture::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w,
                                        uint32_t h, uint32_t yStride, uint32_t uStride,
-                                       uint32_t vStride, uint32_t orientation)
+                                       uint32_t vStride, uint32_t uPixelStride,
+                                       uint32_t vPixelStride, uint32_t orientation)
 {
     mYUVImages[0] = {
         .data        = yData,
@@ -47,6 +48,7 @@ void Sample_04_YUVTexture::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *
         .w           = w / 2,
         .h           = h / 2,
         .stride      = uStride,
+        .pixelStride = uPixelStride,
         .orientation = orientation,
     };
     mYUVImages[2] = {
@@ -54,30 +56,22 @@ void Sample_04_YUVTexture::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *
         .w           = w / 2,
         .h           = h / 2,
         .stride      = vStride,
+        .pixelStride = vPixelStride,
         .orientation = orientation,
     };
 }
 
 void Sample_04_YUVTexture::prepareYUVImage()
 {
-    Image::ImageBasicInfo imageInfo = {
-        extent: {mYUVImages[0].w, mYUVImages[0].h, 1},
-        usage: VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        format: VK_FORMAT_R8_UNORM
-    };
-    mYImage = Image::createDeviceLocal(mDeviceWrapper,
-                                       mGraphicsQueue,
-                                       imageInfo);
-
-    imageInfo.extent = {mYUVImages[1].w, mYUVImages[1].h, 1};
-    mUImage          = Image::createDeviceLocal(mDeviceWrapper,
-                                       mGraphicsQueue,
-                                       imageInfo);
-
-    imageInfo.extent = {mYUVImages[2].w, mYUVImages[2].h, 1};
-    mVImage          = Image::createDeviceLocal(mDeviceWrapper,
-                                       mGraphicsQueue,
-                                       imageInfo);
+    mYUVConverter = YUVPlaneConverter::create(
+        deviceWrapper(),
+        mGraphicsQueue,
+        mPipelineCache.handle(),
+        loadShader(YUVPlaneConverter::shaderPath(YUVPlaneConverter::Output::PLANAR),
+                   VK_SHADER_STAGE_COMPUTE_BIT),
+        YUVPlaneConverter::Output::PLANAR,
+        mYUVImages[0].w,
+        mYUVImages[0].h);
 }
 
 void Sample_04_YUVTexture::prepare(JNIEnv *env)
@@ -88,7 +82,6 @@ void Sample_04_YUVTexture::prepare(JNIEnv *env)
 
         prepareYUVImage();
 
-        prepareSynchronizationPrimitives();
         prepareVertices(true, g_vb_bitmap_texture_Data, sizeof(g_vb_bitmap_texture_Data));
         setupDescriptorPool();
         setupDescriptorSetLayout();
@@ -105,12 +98,18 @@ void Sample_04_YUVTexture::prepare(JNIEnv *env)
 
 void Sample_04_YUVTexture::updateTexture()
 {
-    mYImage->setContentFromBytes(
-        mYUVImages[0].data, mYUVImages[0].stride * mYUVImages[0].h, mYUVImages[0].stride);
-    mUImage->setContentFromBytes(
-        mYUVImages[1].data, mYUVImages[1].stride * mYUVImages[1].h, mYUVImages[1].stride);
-    mVImage->setContentFromBytes(
-        mYUVImages[2].data, mYUVImages[2].stride * mYUVImages[2].h, mYUVImages[2].stride);
+    yuv::Frame frame;
+    frame.y            = mYUVImages[0].data;
+    frame.u            = mYUVImages[1].data;
+    frame.v            = mYUVImages[2].data;
+    frame.width        = mYUVImages[0].w;
+    frame.height       = mYUVImages[0].h;
+    frame.yStride      = mYUVImages[0].stride;
+    frame.uStride      = mYUVImages[1].stride;
+    frame.vStride      = mYUVImages[2].stride;
+    frame.uPixelStride = mYUVImages[1].pixelStride;
+    frame.vPixelStride = mYUVImages[2].pixelStride;
+    mYUVConverter->convert(frame);
 }
 
 void Sample_04_YUVTexture::setupDescriptorPool()
@@ -214,9 +213,9 @@ void Sample_04_YUVTexture::setupDescriptorSet()
 
     // Binding 1 : Combined Image Sampler
     std::vector<VkDescriptorImageInfo> descriptors(3);
-    descriptors[0]                        = mYImage->getDescriptor();
-    descriptors[1]                        = mUImage->getDescriptor();
-    descriptors[2]                        = mVImage->getDescriptor();
+    descriptors[0]                        = mYUVConverter->yImage()->getDescriptor();
+    descriptors[1]                        = mYUVConverter->uImage()->getDescriptor();
+    descriptors[2]                        = mYUVConverter->vImage()->getDescriptor();
     writeDescriptorSet[1]                 = {};
     writeDescriptorSet[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     writeDescriptorSet[1].dstSet          = mDescriptorSet;
@@ -229,23 +228,6 @@ void Sample_04_YUVTexture::setupDescriptorSet()
     vkUpdateDescriptorSets(device(), 2, writeDescriptorSet, 0, nullptr);
 }
 
-void Sample_04_YUVTexture::prepareSynchronizationPrimitives()
-{
-    // Semaphores (Used for correct command ordering)
-    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
-    semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext                 = nullptr;
-
-    // Semaphore used to ensures that image presentation is complete before starting to submit again
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, presentCompleteSemaphore.pHandle()));
-
-    // Semaphore used to ensures that all commands submitted have been finished before submitting
-    // the image to the queue
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, renderCompleteSemaphore.pHandle()));
-}
-
 void Sample_04_YUVTexture::prepareUniformBuffers()
 {
     // Prepare and initialize a uniform buffer block containing shader uniforms
@@ -265,8 +247,8 @@ void Sample_04_YUVTexture::updateUniformBuffers()
     float winRatio =
         static_cast<float>(mWindow.windowWidth) / static_cast<float>(mWindow.windowHeight);
 
-    uint32_t bmpWidth  = mYImage->width();
-    uint32_t bmpHeight = mYImage->height();
+    uint32_t bmpWidth  = mYUVConverter->yImage()->width();
+    uint32_t bmpHeight = mYUVConverter->yImage()->height();
 
     // Pass matrices to the shaders
     uboVS.projectionMatrix = glm::mat4(1.0f);
@@ -296,7 +278,7 @@ void Sample_04_YUVTexture::updateUniformBuffers()
                                     glm::radians((float) mYUVImages[0].orientation),
                                     glm::vec3(0.0f, 0.0f, 1.0f));
 
-    mUniformBuffer->copyFrom(&uboVS, sizeof(uboVS));
+    updateUniformBuffer(*mUniformBuffer, &uboVS, sizeof(uboVS));
 }
 
 void Sample_04_YUVTexture::preparePipelines()
@@ -450,10 +432,6 @@ void Sample_04_YUVTexture::preparePipelines()
     // Create rendering pipeline using the specified states
     CALL_VK(vkCreateGraphicsPipelines(
         device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
-
-    // Shader modules are no longer needed once the graphics pipeline has been created
-    vkDestroyShaderModule(device(), shaderStages[0].module, nullptr);
-    vkDestroyShaderModule(device(), shaderStages[1].module, nullptr);
 }
 
 void Sample_04_YUVTexture::buildCommandBuffers()
@@ -549,39 +527,6 @@ void Sample_04_YUVTexture::buildCommandBuffers()
 
 void Sample_04_YUVTexture::draw()
 {
-    /*CALL_VK(mSwapChain.acquireNextImage(presentCompleteSemaphore.handle(), &currentBuffer));
-	// Use a fence to wait until the command buffer has finished execution before using it again
-	CALL_VK(vkWaitForFences(device(), 1, waitFences[currentBuffer].pHandle(), VK_TRUE, UINT64_MAX));
-	CALL_VK(vkResetFences(device(), 1, waitFences[currentBuffer].pHandle()));
-
-	// Pipeline stage at which the queue submission will wait (via pWaitSemaphores)
-	VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	// The submit info structure specifies a command buffer queue submission batch
-	VkSubmitInfo submitInfo = {};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.pWaitDstStageMask = &waitStageMask;               // Pointer to the list of pipeline
-	stages that the semaphore waits will occur at submitInfo.pWaitSemaphores =
-	presentCompleteSemaphore.pHandle();      // Semaphore(s) to wait upon before the submitted
-	command buffer starts executing submitInfo.waitSemaphoreCount = 1;                           //
-	One wait semaphore submitInfo.pSignalSemaphores = renderCompleteSemaphore.pHandle();     //
-	Semaphore(s) to be signaled when command buffers have completed submitInfo.signalSemaphoreCount
-	= 1;                         // One signal semaphore submitInfo.pCommandBuffers =
-	drawCmdBuffers[currentBuffer].pHandle(); // Command buffers(s) to execute in this batch
-	(submission) submitInfo.commandBufferCount = 1;                           // One command buffer
-
-	// Submit to the graphics queue passing a wait fence
-	CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, waitFences[currentBuffer].handle()));
-
-	// Present the current buffer to the swap chain
-	// Pass the semaphore signaled by the command buffer submission from the submit info as the wait
-	semaphore for swap chain presentation
-	// This ensures that the image is not presented to the windowing system until all commands have
-	been submitted VkResult present = mSwapChain.queuePresent(mGraphicsQueue, currentBuffer,
-	                                           renderCompleteSemaphore.handle());
-	if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) {
-	    CALL_VK(present);
-	}*/
-
     VulkanContextBase::draw();
 }
 
@@ -27,20 +27,18 @@
 
 #include <VulkanContextBase.h>
 #include <VulkanImageWrapper.h>
+#include <VulkanYUVPlaneConverter.h>
 #include <array>
 
 class Sample_04_YUVTexture : public VulkanContextBase
 {
   private:
     // Images
-    std::unique_ptr<Image> mYImage;
-    std::unique_ptr<Image> mUImage;
-    std::unique_ptr<Image> mVImage;
+    // Uploads the camera planes as they are and unpacks them to I420 on the GPU
+    std::unique_ptr<YUVPlaneConverter> mYUVConverter;
 
     std::array<YUVSinglePassImage, 3> mYUVImages;
 
-    void prepareSynchronizationPrimitives();
-
     void updateUniformBuffers();
 
     void setupDescriptorSetLayout();
@@ -68,7 +66,8 @@ class Sample_04_YUVTexture : public VulkanContextBase
     virtual void draw();
 
     void setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h,
-                     uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t orientation);
+                     uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t uPixelStride,
+                     uint32_t vPixelStride, uint32_t orientation);
 
     void prepareYUVImage();
 
@@ -32,7 +32,8 @@
 
 void Sample_05_LUT::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w,
                                 uint32_t h, uint32_t yStride, uint32_t uStride, uint32_t vStride,
-                                uint32_t orientation)
+                                uint32_t uPixelStride,
+                                uint32_t vPixelStride, uint32_t orientation)
 {
     mYUVImages[0] = {
         .data        = yData,
@@ -46,6 +47,7 @@ void Sample_05_LUT::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData,
         .w           = w / 2,
         .h           = h / 2,
         .stride      = uStride,
+        .pixelStride = uPixelStride,
         .orientation = orientation,
     };
     mYUVImages[2] = {
@@ -53,6 +55,7 @@ void Sample_05_LUT::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData,
         .w           = w / 2,
         .h           = h / 2,
         .stride      = vStride,
+        .pixelStride = vPixelStride,
         .orientation = orientation,
     };
 }
@@ -62,26 +65,104 @@ void Sample_05_LUT::setLUTImage(JNIEnv *jniEnv, jobject jbitmap)
     mGlobalBitmap = jniEnv->NewGlobalRef(jbitmap);
 }
 
-void Sample_05_LUT::prepareImages(JNIEnv *env)
+void Sample_05_LUT::setLUTChain(JNIEnv *jniEnv, jobjectArray jbitmaps)
 {
-    Image::ImageBasicInfo imageInfo = {
-        extent: {mYUVImages[0].w, mYUVImages[0].h, 1},
-        usage: VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        format: VK_FORMAT_R8_UNORM
-    };
-    mYImage = Image::createDeviceLocal(deviceWrapper(),
-                                       mGraphicsQueue,
-                                       imageInfo);
+    std::lock_guard<std::mutex> lock(mChainMutex);
+    for (jobject bitmap : mPendingChainBitmaps)
+    {
+        jniEnv->DeleteGlobalRef(bitmap);
+    }
+    mPendingChainBitmaps.clear();
 
-    imageInfo.extent = {mYUVImages[1].w, mYUVImages[1].h, 1};
-    mUImage          = Image::createDeviceLocal(deviceWrapper(),
-                                       mGraphicsQueue,
-                                       imageInfo);
+    const jsize count = jbitmaps != nullptr ? jniEnv->GetArrayLength(jbitmaps) : 0;
+    for (jsize i = 0; i < count; i++)
+    {
+        jobject bitmap = jniEnv->GetObjectArrayElement(jbitmaps, i);
+        mPendingChainBitmaps.push_back(jniEnv->NewGlobalRef(bitmap));
+        jniEnv->DeleteLocalRef(bitmap);
+    }
+    mChainBitmapsChanged = true;
+}
 
-    imageInfo.extent = {mYUVImages[2].w, mYUVImages[2].h, 1};
-    mVImage          = Image::createDeviceLocal(deviceWrapper(),
-                                       mGraphicsQueue,
-                                       imageInfo);
+void Sample_05_LUT::setLUTIntensity(uint32_t step, float intensity)
+{
+    std::lock_guard<std::mutex> lock(mChainMutex);
+    if (step >= mChainIntensities.size())
+    {
+        mChainIntensities.resize(step + 1, 1.0f);
+    }
+    mChainIntensities[step]  = intensity;
+    mChainIntensitiesChanged = true;
+}
+
+std::vector<LutChain::Step> Sample_05_LUT::chainSteps() const
+{
+    std::vector<LutChain::Step> steps = {{mLUTImage.get()}};
+    for (const auto &image : mChainImages)
+    {
+        steps.push_back({image.get()});
+    }
+    for (size_t i = 0; i < steps.size() && i < mChainIntensities.size(); i++)
+    {
+        steps[i].intensity = mChainIntensities[i];
+    }
+    return steps;
+}
+
+void Sample_05_LUT::updateLUTChain(JNIEnv *env)
+{
+    std::lock_guard<std::mutex> lock(mChainMutex);
+    if (mChainBitmapsChanged)
+    {
+        std::vector<std::unique_ptr<Image>> previousImages = std::move(mChainImages);
+        mChainImages.clear();
+        for (jobject bitmap : mPendingChainBitmaps)
+        {
+            if (mChainImages.size() + 1 < LutChain::MAX_STEPS)
+            {
+                auto image = Image::create3DImageFromBitmap(
+                    deviceWrapper(), mGraphicsQueue, env, bitmap, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+                if (image != nullptr)
+                {
+                    mChainImages.push_back(std::move(image));
+                }
+            }
+            env->DeleteGlobalRef(bitmap);
+        }
+        if (mPendingChainBitmaps.size() + 1 > LutChain::MAX_STEPS)
+        {
+            LOGCATE("Sample_05_LUT: Only the first %u LUTs of the chain are applied", LutChain::MAX_STEPS);
+        }
+        mPendingChainBitmaps.clear();
+
+        // Waits for the last bake, which may still read previousImages
+        mLUTChain->setSteps(chainSteps());
+        mChainBitmapsChanged     = false;
+        mChainIntensitiesChanged = false;
+    }
+    else if (mChainIntensitiesChanged)
+    {
+        // Only the push constants of the bake change
+        for (uint32_t i = 0; i < mChainIntensities.size(); i++)
+        {
+            mLUTChain->setIntensity(i, mChainIntensities[i]);
+        }
+        mChainIntensitiesChanged = false;
+    }
+    mLUTChain->update();
+}
+
+void Sample_05_LUT::prepareImages(JNIEnv *env)
+{
+    mYUVConverter = YUVPlaneConverter::create(
+        deviceWrapper(),
+        mGraphicsQueue,
+        mPipelineCache.handle(),
+        loadShader(YUVPlaneConverter::shaderPath(YUVPlaneConverter::Output::PLANAR),
+                   VK_SHADER_STAGE_COMPUTE_BIT),
+        YUVPlaneConverter::Output::PLANAR,
+        mYUVImages[0].w,
+        mYUVImages[0].h);
 
     mLUTImage =
         Image::create3DImageFromBitmap(deviceWrapper(),
@@ -90,6 +171,14 @@ void Sample_05_LUT::prepareImages(JNIEnv *env)
                                        mGlobalBitmap,
                                        VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                                            VK_IMAGE_USAGE_SAMPLED_BIT);
+
+    // Baked with the size of the LUT, a single LUT at full intensity bakes to itself
+    mLUTChain = LutChain::create(deviceWrapper(),
+                                 mGraphicsQueue,
+                                 mPipelineCache.handle(),
+                                 loadShader(LutChain::shaderPath(), VK_SHADER_STAGE_COMPUTE_BIT),
+                                 mLUTImage->width());
+    mLUTChain->setSteps(chainSteps());
 }
 
 void Sample_05_LUT::prepare(JNIEnv *env)
@@ -100,7 +189,6 @@ void Sample_05_LUT::prepare(JNIEnv *env)
 
         prepareImages(env);
 
-        prepareSynchronizationPrimitives();
         prepareVertices(true, g_vb_bitmap_texture_Data, sizeof(g_vb_bitmap_texture_Data));
         prepareUniformBuffers();
         setupDescriptorPool();
@@ -112,17 +200,24 @@ void Sample_05_LUT::prepare(JNIEnv *env)
         mPrepared = true;
     }
 
+    updateLUTChain(env);
     updateTexture();
 }
 
 void Sample_05_LUT::updateTexture()
 {
-    mYImage->setContentFromBytes(
-        mYUVImages[0].data, mYUVImages[0].stride * mYUVImages[0].h, mYUVImages[0].stride);
-    mUImage->setContentFromBytes(
-        mYUVImages[1].data, mYUVImages[1].stride * mYUVImages[1].h, mYUVImages[1].stride);
-    mVImage->setContentFromBytes(
-        mYUVImages[2].data, mYUVImages[2].stride * mYUVImages[2].h, mYUVImages[2].stride);
+    yuv::Frame frame;
+    frame.y            = mYUVImages[0].data;
+    frame.u            = mYUVImages[1].data;
+    frame.v            = mYUVImages[2].data;
+    frame.width        = mYUVImages[0].w;
+    frame.height       = mYUVImages[0].h;
+    frame.yStride      = mYUVImages[0].stride;
+    frame.uStride      = mYUVImages[1].stride;
+    frame.vStride      = mYUVImages[2].stride;
+    frame.uPixelStride = mYUVImages[1].pixelStride;
+    frame.vPixelStride = mYUVImages[2].pixelStride;
+    mYUVConverter->convert(frame);
 }
 
 void Sample_05_LUT::setupDescriptorPool()
@@ -216,37 +311,20 @@ void Sample_05_LUT::setupDescriptorSet()
 
     // Binding 1 : Combined Image Sampler
     std::vector<VkDescriptorImageInfo> descriptors(3);
-    descriptors[0]        = mYImage->getDescriptor();
-    descriptors[1]        = mUImage->getDescriptor();
-    descriptors[2]        = mVImage->getDescriptor();
+    descriptors[0]        = mYUVConverter->yImage()->getDescriptor();
+    descriptors[1]        = mYUVConverter->uImage()->getDescriptor();
+    descriptors[2]        = mYUVConverter->vImage()->getDescriptor();
     writeDescriptorSet[1] = vks::initializers::writeDescriptorSet(
         mDescriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, descriptors.data(), 3);
 
-    // Binding 2 : Combined Image Sampler
-    auto lutDescriptor    = mLUTImage->getDescriptor();
+    // Binding 2 : Combined Image Sampler, the baked chain
+    auto lutDescriptor    = mLUTChain->bakedImage()->getDescriptor();
     writeDescriptorSet[2] = vks::initializers::writeDescriptorSet(
         mDescriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &lutDescriptor);
 
     vkUpdateDescriptorSets(device(), 3, writeDescriptorSet, 0, nullptr);
 }
 
-void Sample_05_LUT::prepareSynchronizationPrimitives()
-{
-    // Semaphores (Used for correct command ordering)
-    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
-    semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext                 = nullptr;
-
-    // Semaphore used to ensures that image presentation is complete before starting to submit again
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, presentCompleteSemaphore.pHandle()));
-
-    // Semaphore used to ensures that all commands submitted have been finished before submitting
-    // the image to the queue
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, renderCompleteSemaphore.pHandle()));
-}
-
 void Sample_05_LUT::prepareUniformBuffers()
 {
     // Prepare and initialize a uniform buffer block containing shader uniforms
@@ -267,8 +345,8 @@ void Sample_05_LUT::updateUniformBuffers()
     float winRatio =
         static_cast<float>(mWindow.windowWidth) / static_cast<float>(mWindow.windowHeight);
 
-    uint32_t bmpWidth  = mYImage->width();
-    uint32_t bmpHeight = mYImage->height();
+    uint32_t bmpWidth  = mYUVConverter->yImage()->width();
+    uint32_t bmpHeight = mYUVConverter->yImage()->height();
 
     // Pass matrices to the shaders
     uboVS.projectionMatrix = glm::mat4(1.0f);
@@ -298,7 +376,7 @@ void Sample_05_LUT::updateUniformBuffers()
                                     glm::radians((float) mYUVImages[0].orientation),
                                     glm::vec3(0.0f, 0.0f, 1.0f));
 
-    mUniformBuffer->copyFrom(&uboVS, sizeof(uboVS));
+    updateUniformBuffer(*mUniformBuffer, &uboVS, sizeof(uboVS));
 }
 
 void Sample_05_LUT::preparePipelines()
@@ -452,10 +530,6 @@ void Sample_05_LUT::preparePipelines()
     // Create rendering pipeline using the specified states
     CALL_VK(vkCreateGraphicsPipelines(
         device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
-
-    // Shader modules are no longer needed once the graphics pipeline has been created
-    vkDestroyShaderModule(device(), shaderStages[0].module, nullptr);
-    vkDestroyShaderModule(device(), shaderStages[1].module, nullptr);
 }
 
 void Sample_05_LUT::buildCommandBuffers()
@@ -551,12 +625,50 @@ void Sample_05_LUT::buildCommandBuffers()
 
 void Sample_05_LUT::draw()
 {
+    std::lock_guard<std::mutex> lock(mQueueMutex);
     VulkanContextBase::draw();
 }
 
+bool Sample_05_LUT::applyLUT(const yuv::Frame &frame, LutProcessor::Interpolation interpolation, uint8_t *dst,
+                             uint32_t dstStride)
+{
+    std::lock_guard<std::mutex> lock(mQueueMutex);
+    if (mLUTChain == nullptr)
+    {
+        LOGCATE("Sample_05_LUT::applyLUT: No LUT yet");
+        return false;
+    }
+
+    if (mLUTProcessor == nullptr)
+    {
+        mLUTProcessor = LutProcessor::create(deviceWrapper(),
+                                             mGraphicsQueue,
+                                             mPipelineCache.handle(),
+                                             loadShader(LutProcessor::shaderPath(), VK_SHADER_STAGE_COMPUTE_BIT));
+        if (mLUTProcessor == nullptr)
+        {
+            return false;
+        }
+        mLUTProcessor->setLut(mLUTChain->bakedImage());
+    }
+
+    // The same chain as the preview, its last bake may not be submitted yet
+    std::lock_guard<std::mutex> chainLock(mChainMutex);
+    if (mLUTChain->bakeToken() != 0)
+    {
+        deviceWrapper()->getUploadManager()->wait(mLUTChain->bakeToken());
+    }
+    return mLUTProcessor->process(frame, interpolation, dst, dstStride);
+}
+
 void Sample_05_LUT::unInit(JNIEnv *env)
 {
     env->DeleteGlobalRef(mGlobalBitmap);
+    for (jobject bitmap : mPendingChainBitmaps)
+    {
+        env->DeleteGlobalRef(bitmap);
+    }
+    mPendingChainBitmaps.clear();
 }
 
 Sample_05_LUT::~Sample_05_LUT()
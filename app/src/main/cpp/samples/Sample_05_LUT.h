@@ -28,22 +28,40 @@
 #include "VulkanInitializers.hpp"
 #include <VulkanContextBase.h>
 #include <VulkanImageWrapper.h>
+#include <VulkanLutChain.h>
+#include <VulkanLutProcessor.h>
+#include <VulkanYUVPlaneConverter.h>
 #include <array>
+#include <mutex>
 
 class Sample_05_LUT : public VulkanContextBase
 {
   private:
     // Images
-    std::unique_ptr<Image> mYImage;
-    std::unique_ptr<Image> mUImage;
-    std::unique_ptr<Image> mVImage;
+    // Uploads the camera planes as they are and unpacks them to I420 on the GPU
+    std::unique_ptr<YUVPlaneConverter> mYUVConverter;
     std::unique_ptr<Image> mLUTImage;
+    // LUTs of setLUTChain, applied after mLUTImage
+    std::vector<std::unique_ptr<Image>> mChainImages;
+    // mLUTImage and mChainImages baked into the LUT the shaders sample
+    std::unique_ptr<LutChain> mLUTChain;
+
+    // Chain changes of the UI thread, applied with the next frame
+    std::mutex           mChainMutex;
+    std::vector<jobject> mPendingChainBitmaps;
+    bool                 mChainBitmapsChanged = false;
+    // Intensity of each step, mLUTImage first
+    std::vector<float> mChainIntensities;
+    bool               mChainIntensitiesChanged = false;
 
     std::array<YUVSinglePassImage, 3> mYUVImages;
 
-    jobject mGlobalBitmap;
+    // Full resolution path of applyLUT, created on first use
+    std::unique_ptr<LutProcessor> mLUTProcessor;
+    // applyLUT submits from the caller thread, draw from the render thread
+    std::mutex mQueueMutex;
 
-    void prepareSynchronizationPrimitives();
+    jobject mGlobalBitmap;
 
     void updateUniformBuffers();
 
@@ -53,6 +71,11 @@ class Sample_05_LUT : public VulkanContextBase
 
     void updateTexture();
 
+    std::vector<LutChain::Step> chainSteps() const;
+
+    // Apply the pending chain changes and bake the chain if it changed
+    void updateLUTChain(JNIEnv *env);
+
   public:
     Sample_05_LUT() :
         VulkanContextBase("shaders/shader_05_lut.vert.spv", "shaders/shader_05_lut.frag.spv")
@@ -71,10 +94,22 @@ class Sample_05_LUT : public VulkanContextBase
     virtual void draw();
 
     void setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h,
-                     uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t orientation);
+                     uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t uPixelStride,
+                     uint32_t vPixelStride, uint32_t orientation);
 
     void setLUTImage(JNIEnv *jniEnv, jobject jbitmap);
 
+    // LUT bitmaps applied after the one of setLUTImage, they replace the previous ones
+    void setLUTChain(JNIEnv *jniEnv, jobjectArray jbitmaps);
+
+    // Mix of a step of the chain with its input, step 0 is the LUT of setLUTImage
+    void setLUTIntensity(uint32_t step, float intensity);
+
+    // Apply the LUT to a full resolution frame offscreen and write RGBA8 pixels to dst, blocks
+    // until they are written
+    bool applyLUT(const yuv::Frame &frame, LutProcessor::Interpolation interpolation, uint8_t *dst,
+                  uint32_t dstStride);
+
     void prepareImages(JNIEnv *env);
 
     virtual void unInit(JNIEnv *env) override;
@@ -28,12 +28,17 @@
 
 #define GLM_FORCE_RADIANS
 
+#include <LutUtil.h>
+#include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "tinygltf/stb_image.h"
+
 void Sample_06_MultiLUT::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w,
                                      uint32_t h, uint32_t yStride, uint32_t uStride,
-                                     uint32_t vStride, uint32_t orientation)
+                                     uint32_t vStride, uint32_t uPixelStride,
+                                     uint32_t vPixelStride, uint32_t orientation)
 {
     mYUVImages[0] = {
         .data        = yData,
@@ -47,6 +52,7 @@ void Sample_06_MultiLUT::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vD
         .w           = w / 2,
         .h           = h / 2,
         .stride      = uStride,
+        .pixelStride = uPixelStride,
         .orientation = orientation,
     };
     mYUVImages[2] = {
@@ -54,41 +60,84 @@ void Sample_06_MultiLUT::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vD
         .w           = w / 2,
         .h           = h / 2,
         .stride      = vStride,
+        .pixelStride = vPixelStride,
         .orientation = orientation,
     };
 }
 
-void Sample_06_MultiLUT::setLUTImages(JNIEnv *jniEnv, jobjectArray jbitmaps)
+void Sample_06_MultiLUT::setLUTAssets(JNIEnv *jniEnv, jobjectArray jpaths)
 {
-    auto len = jniEnv->GetArrayLength(jbitmaps);
+    auto len = jniEnv->GetArrayLength(jpaths);
     for (int i = 0; i < len; i++)
     {
-        auto jBMPObj = jniEnv->GetObjectArrayElement(jbitmaps, i);
-        mGlobalBitmaps.push_back(jniEnv->NewGlobalRef(jBMPObj));
+        auto        jPath = static_cast<jstring>(jniEnv->GetObjectArrayElement(jpaths, i));
+        const char *chars = jniEnv->GetStringUTFChars(jPath, nullptr);
+        mLUTPaths.push_back(chars);
+        jniEnv->ReleaseStringUTFChars(jPath, chars);
+        jniEnv->DeleteLocalRef(jPath);
     }
 }
 
-void Sample_06_MultiLUT::updateLUTs(JNIEnv *jniEnv, uint32_t itemWidth, uint32_t startIndex,
-                                    uint32_t drawCount, uint32_t offset)
+bool Sample_06_MultiLUT::loadLUT(uint32_t lut, std::vector<uint8_t> &texels, uint32_t *lutSize) const
 {
-    mLUTProperty.itemWidth  = itemWidth;
-    mLUTProperty.startIndex = startIndex;
-    mLUTProperty.drawCount  = drawCount;
-    mLUTProperty.offset     = offset;
-
-    if (mFilters.size() == 0)
+    const std::string &path = mLUTPaths[lut];
+    const size_t       dot  = path.rfind('.');
+    const std::string  ext  = dot == std::string::npos ? std::string() : path.substr(dot);
+    if (ext == ".cube" || ext == ".3dl")
     {
-        for (int i = 0; i < mLUTProperty.drawCount; ++i)
+        // Same texel order as the strips: red fastest, then green, then blue
+        lut::Table table;
+        if (!lut::loadAsset(*mAssets, path, mCacheDir, lut::TexelFormat::RGBA8, table))
+        {
+            return false;
+        }
+        texels.assign(table.texels(), table.texels() + table.byteSize());
+        if (lutSize != nullptr)
         {
-            mFilters.push_back(LutFilter(this));
+            *lutSize = table.size();
         }
+        return true;
     }
 
-    for (int i = 0; i < mLUTProperty.drawCount; ++i)
+    std::vector<uint8_t> image;
+    if (!mAssets->read(mLUTPaths[lut], image))
     {
-        mFilters[i].specializationData.LUT_ITEM_INDEX = (float_t) i;
+        LOGCATE("Sample_06_MultiLUT: Could not open %s", mLUTPaths[lut].c_str());
+        return false;
     }
+    int      width = 0, height = 0, channels = 0;
+    stbi_uc *pixels = stbi_load_from_memory(image.data(),
+                                            static_cast<int>(image.size()),
+                                            &width,
+                                            &height,
+                                            &channels,
+                                            STBI_rgb_alpha);
+
+    // The LUT images stack one size x size tile per blue level vertically
+    if (pixels == nullptr || height != width * width)
+    {
+        LOGCATE("Sample_06_MultiLUT: %s is not a %dx%d LUT strip", mLUTPaths[lut].c_str(), width, width * width);
+        stbi_image_free(pixels);
+        return false;
+    }
+    texels.assign(pixels, pixels + width * height * 4);
+    stbi_image_free(pixels);
+    if (lutSize != nullptr)
+    {
+        *lutSize = static_cast<uint32_t>(width);
+    }
+    return true;
+}
+
+void Sample_06_MultiLUT::updateLUTs(JNIEnv *jniEnv, uint32_t itemWidth, uint32_t startIndex,
+                                    uint32_t drawCount, uint32_t offset)
+{
+    mLUTProperty.itemWidth  = itemWidth;
+    mLUTProperty.startIndex = startIndex;
+    mLUTProperty.drawCount  = drawCount;
+    mLUTProperty.offset     = offset;
 
+    // The LUTs of the new start index are uploaded with the next frame (see updateLUTAtlas)
     if (mPrepared)
     {
         updateLutMatrix();
@@ -97,46 +146,62 @@ void Sample_06_MultiLUT::updateLUTs(JNIEnv *jniEnv, uint32_t itemWidth, uint32_t
 
 void Sample_06_MultiLUT::prepareImages(JNIEnv *env)
 {
-    Image::ImageBasicInfo imageInfo = {
-        extent: {mYUVImages[0].w, mYUVImages[0].h, 1},
+    mYUVConverter = YUVPlaneConverter::create(
+        deviceWrapper(),
+        mGraphicsQueue,
+        mPipelineCache.handle(),
+        loadShader(YUVPlaneConverter::shaderPath(YUVPlaneConverter::Output::PLANAR),
+                   VK_SHADER_STAGE_COMPUTE_BIT),
+        YUVPlaneConverter::Output::PLANAR,
+        mYUVImages[0].w,
+        mYUVImages[0].h);
+
+    // The first LUT is selected and gives the size of all of them
+    std::vector<uint8_t> texels;
+    uint32_t             lutSize = 0;
+    if (mLUTPaths.empty() || !loadLUT(0, texels, &lutSize))
+    {
+        LOGCATE("Sample_06_MultiLUT: No LUT to start with");
+        return;
+    }
+
+    ImageBasicInfo imageInfo = {
+        imageType: VK_IMAGE_TYPE_3D,
+        extent: {lutSize, lutSize, lutSize},
         usage: VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        format: VK_FORMAT_R8_UNORM
+        format: VK_FORMAT_R8G8B8A8_UNORM,
+        layout: VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
     };
-    mYImage = Image::createDeviceLocal(deviceWrapper(),
-                                       mGraphicsQueue,
-                                       imageInfo);
-
-    imageInfo.extent = {mYUVImages[1].w, mYUVImages[1].h, 1};
-    mUImage          = Image::createDeviceLocal(deviceWrapper(),
-                                       mGraphicsQueue,
-                                       imageInfo);
+    mSelectedFilter = Image::createDeviceLocal(deviceWrapper(), mGraphicsQueue, imageInfo);
+    mSelectedFilter->setRegionFromBytes(
+        texels.data(), static_cast<uint32_t>(texels.size()), {0, 0, 0}, imageInfo.extent);
 
-    imageInfo.extent = {mYUVImages[2].w, mYUVImages[2].h, 1};
-    mVImage          = Image::createDeviceLocal(deviceWrapper(),
-                                       mGraphicsQueue,
-                                       imageInfo);
-
-    for (auto bitmap : mGlobalBitmaps)
+    if (mLUTProperty.drawCount == 0)
     {
-        mLUTImages.push_back(Image::create3DImageFromBitmap(
-            deviceWrapper(),
-            mGraphicsQueue,
-            env,
-            bitmap,
-            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+        return;
     }
-
-    if (mGlobalBitmaps.size() > 0)
+    mLUTBank = LutBank::create(deviceWrapper(),
+                               mGraphicsQueue,
+                               lutSize,
+                               static_cast<uint32_t>(mLUTPaths.size()),
+                               mLUTProperty.drawCount,
+                               LUT_BANK_BUDGET,
+                               [this](uint32_t lut, std::vector<uint8_t> &texels) { return loadLUT(lut, texels); });
+    if (mLUTBank == nullptr)
     {
-        mSelectedFilter = Image::create3DImageFromBitmap(
-            deviceWrapper(),
-            mGraphicsQueue,
-            env,
-            mGlobalBitmaps[0],
-            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        return;
     }
+
+    // Every preview needs a slot of its own
+    mPreviews.instanceCount = std::min(mLUTProperty.drawCount, mLUTBank->slotCount());
+    mPreviewSlots           = vks::Buffer::create(deviceWrapper(),
+                                        sizeof(int32_t) * mPreviews.instanceCount,
+                                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    mPreviewSlots->map();
+    mPreviewSlotValues.assign(mPreviews.instanceCount, -1);
+    mPreviewSlots->copyFrom(mPreviewSlotValues.data(), sizeof(int32_t) * mPreviewSlotValues.size());
+    updatePreviewSlots();
 }
 
 void Sample_06_MultiLUT::prepare(JNIEnv *env)
@@ -147,27 +212,16 @@ void Sample_06_MultiLUT::prepare(JNIEnv *env)
 
         prepareImages(env);
 
-        prepareSynchronizationPrimitives();
         prepareVertices(true, g_vb_bitmap_texture_Data, sizeof(g_vb_bitmap_texture_Data));
         prepareUniformBuffers();
         setupDescriptorPool();
         setupDescriptorSetLayout();
         setupDescriptorSet();
-        preparePipelines();
 
-        std::vector<VkDescriptorImageInfo> descriptors(3);
-        descriptors[0] = mYImage->getDescriptor();
-        descriptors[1] = mUImage->getDescriptor();
-        descriptors[2] = mVImage->getDescriptor();
-        for (int i = 0; i < mFilters.size(); ++i)
-        {
-            auto imgInfo = mLUTImages[i]->getDescriptor();
-            mFilters[i].prepare(descriptors,
-                                imgInfo,
-                                mLutUniformBuffer->getDescriptor(),
-                                mPipelineCache.handle(),
-                                mRenderPass);
-        }
+        // The preview pipeline compiles on a worker while the main pipeline is created
+        auto previewPipeline = pipelineBuilder()->run([this]() { preparePreviewPipeline(); });
+        preparePipelines();
+        previewPipeline.get();
 
         buildCommandBuffers();
 
@@ -179,19 +233,44 @@ void Sample_06_MultiLUT::prepare(JNIEnv *env)
 
 void Sample_06_MultiLUT::updateTexture(JNIEnv *env)
 {
-    mYImage->setContentFromBytes(
-        mYUVImages[0].data, mYUVImages[0].stride * mYUVImages[0].h, mYUVImages[0].stride);
-    mUImage->setContentFromBytes(
-        mYUVImages[1].data, mYUVImages[1].stride * mYUVImages[1].h, mYUVImages[1].stride);
-    mVImage->setContentFromBytes(
-        mYUVImages[2].data, mYUVImages[2].stride * mYUVImages[2].h, mYUVImages[2].stride);
-
-    for (int i = 0; i < mLUTProperty.drawCount; i++)
+    yuv::Frame frame;
+    frame.y            = mYUVImages[0].data;
+    frame.u            = mYUVImages[1].data;
+    frame.v            = mYUVImages[2].data;
+    frame.width        = mYUVImages[0].w;
+    frame.height       = mYUVImages[0].h;
+    frame.yStride      = mYUVImages[0].stride;
+    frame.uStride      = mYUVImages[1].stride;
+    frame.vStride      = mYUVImages[2].stride;
+    frame.uPixelStride = mYUVImages[1].pixelStride;
+    frame.vPixelStride = mYUVImages[2].pixelStride;
+    mYUVConverter->convert(frame);
+
+    updatePreviewSlots();
+}
+
+void Sample_06_MultiLUT::updatePreviewSlots()
+{
+    if (mLUTBank == nullptr)
     {
-        if ((i + mLUTProperty.startIndex) < mGlobalBitmaps.size())
-        {
-            mLUTImages[i]->setContentFromBitmap(env, mGlobalBitmaps[i + mLUTProperty.startIndex]);
-        }
+        return;
+    }
+
+    // The visible LUTs are acquired in one use period so that they don't evict each other, the
+    // bank returns -1 past the last LUT
+    mLUTBank->beginUse();
+    bool changed = false;
+    for (uint32_t i = 0; i < mPreviews.instanceCount; i++)
+    {
+        const int32_t slot = mLUTBank->acquire(mLUTProperty.startIndex + i);
+        changed               = changed || slot != mPreviewSlotValues[i];
+        mPreviewSlotValues[i] = slot;
+    }
+    if (changed)
+    {
+        // The slots are read by the recorded command buffers of the frames in flight
+        waitForFramesInFlight();
+        mPreviewSlots->copyFrom(mPreviewSlotValues.data(), sizeof(int32_t) * mPreviewSlotValues.size());
     }
 }
 
@@ -201,12 +280,13 @@ void Sample_06_MultiLUT::setupDescriptorPool()
     VkDescriptorPoolSize typeCounts[2];
     // This example only uses one descriptor type (uniform buffer) and only requests one descriptor
     // of this type
+    // The main image and the LUT previews each use one set
     typeCounts[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = 1;
+    typeCounts[0].descriptorCount = 2;
     // For additional types you need to add new entries in the type count list
     // E.g. for two combined image samplers :
     typeCounts[1].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    typeCounts[1].descriptorCount = 4;
+    typeCounts[1].descriptorCount = 8;
 
     // Create the global descriptor pool
     // All descriptors used in this example are allocated from this pool
@@ -289,9 +369,9 @@ void Sample_06_MultiLUT::setupDescriptorSet()
 
     // Binding 1 : Combined Image Sampler
     std::vector<VkDescriptorImageInfo> descriptors(3);
-    descriptors[0]        = mYImage->getDescriptor();
-    descriptors[1]        = mUImage->getDescriptor();
-    descriptors[2]        = mVImage->getDescriptor();
+    descriptors[0]        = mYUVConverter->yImage()->getDescriptor();
+    descriptors[1]        = mYUVConverter->uImage()->getDescriptor();
+    descriptors[2]        = mYUVConverter->vImage()->getDescriptor();
     writeDescriptorSet[1] = vks::initializers::writeDescriptorSet(
         mDescriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, descriptors.data(), 3);
 
@@ -301,23 +381,23 @@ void Sample_06_MultiLUT::setupDescriptorSet()
         mDescriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &lutDescriptor);
 
     vkUpdateDescriptorSets(device(), 3, writeDescriptorSet, 0, nullptr);
-}
 
-void Sample_06_MultiLUT::prepareSynchronizationPrimitives()
-{
-    // Semaphores (Used for correct command ordering)
-    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
-    semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext                 = nullptr;
-
-    // Semaphore used to ensures that image presentation is complete before starting to submit again
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, presentCompleteSemaphore.pHandle()));
-
-    // Semaphore used to ensures that all commands submitted have been finished before submitting
-    // the image to the queue
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, renderCompleteSemaphore.pHandle()));
+    if (mLUTBank == nullptr)
+    {
+        return;
+    }
+
+    // Same bindings for the previews, with the LUT matrix and the LUT bank
+    CALL_VK(vkAllocateDescriptorSets(device(), &allocInfo, &mPreviews.descriptorSet));
+    auto lutUboDescriptor   = mLutUniformBuffer->getDescriptor();
+    auto lutAtlasDescriptor = mLUTBank->image()->getDescriptor();
+    writeDescriptorSet[0]   = vks::initializers::writeDescriptorSet(
+        mPreviews.descriptorSet, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &lutUboDescriptor);
+    writeDescriptorSet[1] = vks::initializers::writeDescriptorSet(
+        mPreviews.descriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, descriptors.data(), 3);
+    writeDescriptorSet[2] = vks::initializers::writeDescriptorSet(
+        mPreviews.descriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &lutAtlasDescriptor);
+    vkUpdateDescriptorSets(device(), 3, writeDescriptorSet, 0, nullptr);
 }
 
 void Sample_06_MultiLUT::prepareUniformBuffers()
@@ -347,8 +427,8 @@ void Sample_06_MultiLUT::updateUniformBuffers()
     float winRatio =
         static_cast<float>(mWindow.windowWidth) / static_cast<float>(mWindow.windowHeight);
 
-    uint32_t bmpWidth  = mYImage->width();
-    uint32_t bmpHeight = mYImage->height();
+    uint32_t bmpWidth  = mYUVConverter->yImage()->width();
+    uint32_t bmpHeight = mYUVConverter->yImage()->height();
 
     // Pass matrices to the shaders
     uboVS.projectionMatrix = glm::mat4(1.0f);
@@ -378,14 +458,21 @@ void Sample_06_MultiLUT::updateUniformBuffers()
                                     glm::radians((float) mYUVImages[0].orientation),
                                     glm::vec3(0.0f, 0.0f, 1.0f));
 
-    mUniformBuffer->copyFrom(&uboVS, sizeof(uboVS));
+    updateUniformBuffer(*mUniformBuffer, &uboVS, sizeof(uboVS));
 
     updateLutMatrix();
 }
 
 void Sample_06_MultiLUT::updateSelectedIndex(JNIEnv *jniEnv, uint32_t index)
 {
-    mSelectedFilter->setContentFromBitmap(jniEnv, mGlobalBitmaps[index]);
+    std::vector<uint8_t> texels;
+    if (index < mLUTPaths.size() && mSelectedFilter != nullptr && loadLUT(index, texels))
+    {
+        mSelectedFilter->setRegionFromBytes(texels.data(),
+                                            static_cast<uint32_t>(texels.size()),
+                                            {0, 0, 0},
+                                            {mSelectedFilter->width(), mSelectedFilter->width(), mSelectedFilter->width()});
+    }
 }
 
 void Sample_06_MultiLUT::updateLutMatrix()
@@ -393,8 +480,8 @@ void Sample_06_MultiLUT::updateLutMatrix()
     float winRatio =
         static_cast<float>(mWindow.windowWidth) / static_cast<float>(mWindow.windowHeight);
 
-    uint32_t bmpWidth  = mYImage->width();
-    uint32_t bmpHeight = mYImage->height();
+    uint32_t bmpWidth  = mYUVConverter->yImage()->width();
+    uint32_t bmpHeight = mYUVConverter->yImage()->height();
 
     if (mYUVImages[0].orientation % 180 != 0)
     {
@@ -440,7 +527,7 @@ void Sample_06_MultiLUT::updateLutMatrix()
                                        glm::radians((float) mYUVImages[0].orientation),
                                        glm::vec3(0.0f, 0.0f, 1.0f));
 
-    mLutUniformBuffer->copyFrom(&lutUBOVS, sizeof(lutUBOVS));
+    updateUniformBuffer(*mLutUniformBuffer, &lutUBOVS, sizeof(lutUBOVS));
 }
 
 void Sample_06_MultiLUT::preparePipelines()
@@ -594,10 +681,96 @@ void Sample_06_MultiLUT::preparePipelines()
     // Create rendering pipeline using the specified states
     CALL_VK(vkCreateGraphicsPipelines(
         device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
+}
+
+void Sample_06_MultiLUT::preparePreviewPipeline()
+{
+    // Same layout and vertices as the main pipeline, the previews are blended over the image
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState =
+        vks::initializers::pipelineInputAssemblyStateCreateInfo(
+            VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
+
+    VkPipelineRasterizationStateCreateInfo rasterizationState =
+        vks::initializers::pipelineRasterizationStateCreateInfo(
+            VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE);
+
+    // Enable blending
+    VkPipelineColorBlendAttachmentState blendAttachmentState{};
+    blendAttachmentState.blendEnable    = VK_TRUE;
+    blendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                          VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    blendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    blendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachmentState.colorBlendOp        = VK_BLEND_OP_ADD;
+    blendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    blendAttachmentState.alphaBlendOp        = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlendState =
+        vks::initializers::pipelineColorBlendStateCreateInfo(1, &blendAttachmentState);
+
+    VkPipelineDepthStencilStateCreateInfo depthStencilState =
+        vks::initializers::pipelineDepthStencilStateCreateInfo(
+            VK_FALSE, VK_FALSE, VK_COMPARE_OP_ALWAYS);
+
+    VkPipelineViewportStateCreateInfo viewportState =
+        vks::initializers::pipelineViewportStateCreateInfo(1, 1, 0);
+
+    VkPipelineMultisampleStateCreateInfo multisampleState =
+        vks::initializers::pipelineMultisampleStateCreateInfo(VK_SAMPLE_COUNT_1_BIT);
+
+    std::vector<VkDynamicState>      dynamicStateEnables = {VK_DYNAMIC_STATE_VIEWPORT,
+                                                       VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState =
+        vks::initializers::pipelineDynamicStateCreateInfo(dynamicStateEnables);
 
-    // Shader modules are no longer needed once the graphics pipeline has been created
-    vkDestroyShaderModule(device(), shaderStages[0].module, nullptr);
-    vkDestroyShaderModule(device(), shaderStages[1].module, nullptr);
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
+    shaderStages[0] = loadShader("shaders/shader_06_lut_previews.vert.spv", VK_SHADER_STAGE_VERTEX_BIT);
+    shaderStages[1] = loadShader("shaders/shader_06_lut_previews.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    std::vector<VkVertexInputBindingDescription> vertexInputBindings = {
+        vks::initializers::vertexInputBindingDescription(
+            0, sizeof(VertexUV), VK_VERTEX_INPUT_RATE_VERTEX),
+        vks::initializers::vertexInputBindingDescription(
+            1, sizeof(int32_t), VK_VERTEX_INPUT_RATE_INSTANCE),
+    };
+    std::vector<VkVertexInputAttributeDescription> vertexInputAttributes = {
+        vks::initializers::vertexInputAttributeDescription(
+            0,
+            0,
+            VK_FORMAT_R32G32B32A32_SFLOAT,
+            offsetof(VertexUV, posX)),        // Location 0: Position
+        vks::initializers::vertexInputAttributeDescription(
+            0, 1, VK_FORMAT_R32G32_SFLOAT, offsetof(VertexUV, u)),        // Location 1: UV
+        vks::initializers::vertexInputAttributeDescription(
+            1, 2, VK_FORMAT_R32_SINT, 0),        // Location 2: LUT slot of the instance
+    };
+    VkPipelineVertexInputStateCreateInfo vertexInputState =
+        vks::initializers::pipelineVertexInputStateCreateInfo();
+    vertexInputState.vertexBindingDescriptionCount =
+        static_cast<uint32_t>(vertexInputBindings.size());
+    vertexInputState.pVertexBindingDescriptions = vertexInputBindings.data();
+    vertexInputState.vertexAttributeDescriptionCount =
+        static_cast<uint32_t>(vertexInputAttributes.size());
+    vertexInputState.pVertexAttributeDescriptions = vertexInputAttributes.data();
+
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo =
+        vks::initializers::pipelineCreateInfo(mPipelineLayout.handle(), mRenderPass);
+    pipelineCreateInfo.pVertexInputState   = &vertexInputState;
+    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineCreateInfo.pRasterizationState = &rasterizationState;
+    pipelineCreateInfo.pColorBlendState    = &colorBlendState;
+    pipelineCreateInfo.pMultisampleState   = &multisampleState;
+    pipelineCreateInfo.pViewportState      = &viewportState;
+    pipelineCreateInfo.pDepthStencilState  = &depthStencilState;
+    pipelineCreateInfo.pDynamicState       = &dynamicState;
+    pipelineCreateInfo.stageCount          = static_cast<uint32_t>(shaderStages.size());
+    pipelineCreateInfo.pStages             = shaderStages.data();
+    pipelineCreateInfo.subpass             = 0;
+
+    mPreviews.pipeline = VulkanPipeline(device());
+    CALL_VK(vkCreateGraphicsPipelines(
+        device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPreviews.pipeline.pHandle()));
 }
 
 void Sample_06_MultiLUT::buildCommandBuffers()
@@ -690,18 +863,28 @@ void Sample_06_MultiLUT::buildCommandBuffers()
                   0,
                   0);
 
-        // Draw filter
-        for (int j = 0; j < mFilters.size(); ++j)
+        // Draw the LUT previews, one instance per preview. The push constants and the vertex
+        // buffer of the main image are kept.
+        if (mPreviews.instanceCount > 0)
         {
-            const VkViewport viewport = vks::initializers::viewport(
-                (float) mWindow.windowWidth, (float) mWindow.windowHeight, 0.0f, 1.0f);
-            const VkRect2D scissor =
-                vks::initializers::rect2D(mWindow.windowWidth, mWindow.windowHeight, 0, 0);
-            vkCmdSetViewport(drawCmdBuffers[i].handle(), 0, 1, &viewport);
-            vkCmdSetScissor(drawCmdBuffers[i].handle(), 0, 1, &scissor);
-
-            mFilters[j].draw(
-                drawCmdBuffers[i].handle(), mLUTProperty.itemWidth, mWindow.windowWidth);
+            vkCmdBindDescriptorSets(drawCmdBuffers[i].handle(),
+                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    mPipelineLayout.handle(),
+                                    0,
+                                    1,
+                                    &mPreviews.descriptorSet,
+                                    0,
+                                    nullptr);
+            vkCmdBindPipeline(drawCmdBuffers[i].handle(),
+                              VK_PIPELINE_BIND_POINT_GRAPHICS,
+                              mPreviews.pipeline.handle());
+            auto slotsBuf = mPreviewSlots->getBufferHandle();
+            vkCmdBindVertexBuffers(drawCmdBuffers[i].handle(), 1, 1, &slotsBuf, offsets);
+            vkCmdDraw(drawCmdBuffers[i].handle(),
+                      sizeof(g_vb_bitmap_texture_Data) / sizeof(g_vb_bitmap_texture_Data[0]),
+                      mPreviews.instanceCount,
+                      0,
+                      0);
         }
 
         drawUI(drawCmdBuffers[i].handle());
@@ -720,14 +903,6 @@ void Sample_06_MultiLUT::draw()
     VulkanContextBase::draw();
 }
 
-void Sample_06_MultiLUT::unInit(JNIEnv *env)
-{
-    for (auto item : mGlobalBitmaps)
-    {
-        env->DeleteGlobalRef(item);
-    }
-}
-
 Sample_06_MultiLUT::~Sample_06_MultiLUT()
 {
     vkDeviceWaitIdle(device());
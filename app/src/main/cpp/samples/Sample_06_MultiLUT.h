@@ -25,27 +25,44 @@
 #ifndef GAINVULKANSAMPLE_SAMPLE_06_MULTILUT_H
 #define GAINVULKANSAMPLE_SAMPLE_06_MULTILUT_H
 
-#include "LutFilter.h"
 #include "VulkanInitializers.hpp"
 #include <VulkanContextBase.h>
 #include <VulkanImageWrapper.h>
+#include <VulkanLutBank.h>
+#include <VulkanYUVPlaneConverter.h>
 #include <array>
+#include <string>
 #include <vector>
 
+struct LutPushConstantData
+{
+    float_t itemWidth;
+    float_t windowWidth;
+};
+
 class Sample_06_MultiLUT : public VulkanContextBase
 {
   private:
     // Images
-    std::unique_ptr<Image>              mYImage;
-    std::unique_ptr<Image>              mUImage;
-    std::unique_ptr<Image>              mVImage;
-    std::vector<std::unique_ptr<Image>> mLUTImages;
+    // Uploads the camera planes as they are and unpacks them to I420 on the GPU
+    std::unique_ptr<YUVPlaneConverter> mYUVConverter;
+
+    // Memory of the resident preview LUTs, about 58 of 33^3. Always enough for the visible ones.
+    static constexpr VkDeviceSize LUT_BANK_BUDGET = 8 * 1024 * 1024;
+
+    // The LUTs of the previews (see shader_06_lut_previews.frag), decoded from the assets when
+    // they scroll into view
+    std::unique_ptr<LutBank> mLUTBank;
+    // Slot of mLUTBank per preview, -1 past the last LUT. Per instance vertex input.
+    std::unique_ptr<vks::Buffer> mPreviewSlots;
+    std::vector<int32_t>         mPreviewSlotValues;
 
     std::unique_ptr<Image> mSelectedFilter;
 
     std::array<YUVSinglePassImage, 3> mYUVImages;
 
-    std::vector<jobject> mGlobalBitmaps;
+    // Asset path of each LUT
+    std::vector<std::string> mLUTPaths;
 
     struct
     {
@@ -53,7 +70,7 @@ class Sample_06_MultiLUT : public VulkanContextBase
         uint32_t startIndex;
         uint32_t drawCount;
         uint32_t offset;
-    } mLUTProperty;
+    } mLUTProperty = {};
 
     // Uniform buffer block object
     std::unique_ptr<vks::Buffer> mLutUniformBuffer;
@@ -63,13 +80,18 @@ class Sample_06_MultiLUT : public VulkanContextBase
         glm::mat4 projectionMatrix;
         glm::mat4 modelMatrix;
         glm::mat4 viewMatrix;
-    } lutUBOVS;
+    } lutUBOVS = {};
 
     LutPushConstantData mLutPushConstantData;
 
-    std::vector<LutFilter> mFilters;
-
-    void prepareSynchronizationPrimitives();
+    // All the previews are drawn by one instanced draw, one instance per preview. They share the
+    // layouts of the main pipeline, the set points at the LUT matrix and the image of mLUTBank.
+    struct
+    {
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        VulkanPipeline  pipeline      = VulkanPipeline(VK_NULL_HANDLE);
+        uint32_t        instanceCount = 0;
+    } mPreviews;
 
     void updateUniformBuffers();
 
@@ -81,6 +103,14 @@ class Sample_06_MultiLUT : public VulkanContextBase
 
     void updateTexture(JNIEnv *jniEnv);
 
+    // Acquire the LUTs of the visible previews from mLUTBank, loading the ones that became visible
+    void updatePreviewSlots();
+
+    // Decode a LUT asset (an image strip, .cube or .3dl) to lutSize^3 RGBA8 texels
+    bool loadLUT(uint32_t lut, std::vector<uint8_t> &texels, uint32_t *lutSize = nullptr) const;
+
+    void preparePreviewPipeline();
+
   public:
     Sample_06_MultiLUT() :
         VulkanContextBase("shaders/shader_06_multi_lut.vert.spv",
@@ -102,9 +132,10 @@ class Sample_06_MultiLUT : public VulkanContextBase
     virtual void draw();
 
     void setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h,
-                     uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t orientation);
+                     uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t uPixelStride,
+                     uint32_t vPixelStride, uint32_t orientation);
 
-    void setLUTImages(JNIEnv *jniEnv, jobjectArray jbitmaps);
+    void setLUTAssets(JNIEnv *jniEnv, jobjectArray jpaths);
 
     void updateLUTs(JNIEnv *jniEnv, uint32_t itemWidth, uint32_t startIndex, uint32_t drawCount,
                     uint32_t offset);
@@ -113,8 +144,6 @@ class Sample_06_MultiLUT : public VulkanContextBase
 
     void prepareImages(JNIEnv *env);
 
-    virtual void unInit(JNIEnv *env) override;
-
     ~Sample_06_MultiLUT();
 };
 
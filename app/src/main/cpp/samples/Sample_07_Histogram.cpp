@@ -31,6 +31,12 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
 void Sample_07_Histogram::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w,
                                       uint32_t h, uint32_t yStride, uint32_t uStride,
                                       uint32_t vStride, uint32_t uPixelStride,
@@ -83,11 +89,30 @@ void Sample_07_Histogram::prepareImages(JNIEnv *env)
                                        mGraphicsQueue,
                                        imageInfo);
 
-    mStorageBuffer =
-        vks::Buffer::create(deviceWrapper(),
-                       sizeof(int) * 256,
-                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    // The host reads the histograms back, faster from cached memory
+    VkBool32 cached = VK_FALSE;
+    deviceWrapper()->getMemoryType(~0u, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, &cached);
+    mHistogramSlots.clear();
+    for (uint32_t i = 0; i < HISTOGRAM_RING_SIZE; i++)
+    {
+        HistogramSlot slot(device());
+        slot.bins = vks::Buffer::create(deviceWrapper(),
+                                        HistogramCalculator::BUFFER_SIZE,
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        slot.statistics = vks::Buffer::create(deviceWrapper(),
+                                              HistogramStatistics::BUFFER_SIZE,
+                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        slot.readback = vks::Buffer::create(deviceWrapper(),
+                                            HistogramCalculator::BUFFER_SIZE,
+                                            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                (cached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+        CALL_VK(slot.readback->map());
+        mHistogramSlots.push_back(std::move(slot));
+    }
 }
 
 void Sample_07_Histogram::prepare(JNIEnv *env)
@@ -128,103 +153,17 @@ void Sample_07_Histogram::prepareCompute()
     compute.queueFamilyIndex = deviceWrapper()->queueFamilyIndices.compute;
     vkGetDeviceQueue(device(), compute.queueFamilyIndex, 0, &compute.queue);
 
-    std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings = {
-        // Binding 0
-        vks::initializers::descriptorSetLayoutBinding(
-            VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 0),
-        // Binding 1
-        vks::initializers::descriptorSetLayoutBinding(
-            VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 1),
-        // Binding 2
-        vks::initializers::descriptorSetLayoutBinding(
-            VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 2),
-        // Binding 3
-        vks::initializers::descriptorSetLayoutBinding(
-            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 3),
-    };
-
-    VkDescriptorSetLayoutCreateInfo descriptorLayout =
-        vks::initializers::descriptorSetLayoutCreateInfo(
-            setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
-
-    CALL_VK(vkCreateDescriptorSetLayout(
-        device(), &descriptorLayout, nullptr, &compute.descriptorSetLayout));
-
-    VkPipelineLayoutCreateInfo pPipelineLayoutCreateInfo =
-        vks::initializers::pipelineLayoutCreateInfo(&compute.descriptorSetLayout, 1);
-
-    struct pixelStride
-    {
-        int uPixelStride;
-        int vPixelStride;
-    };
-    const VkPushConstantRange pushConstantRange =
-        vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(pixelStride), 0);
-
-    pPipelineLayoutCreateInfo.pushConstantRangeCount = 1;
-    pPipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
-
-    CALL_VK(vkCreatePipelineLayout(
-        device(), &pPipelineLayoutCreateInfo, nullptr, &compute.pipelineLayout));
-
-    VkDescriptorSetAllocateInfo allocInfo = vks::initializers::descriptorSetAllocateInfo(
-        descriptorPool(), &compute.descriptorSetLayout, 1);
-
-    CALL_VK(vkAllocateDescriptorSets(device(), &allocInfo, &compute.descriptorSet));
-
-    auto                              yDes                       = mYImage->getDescriptor();
-    auto                              uDes                       = mUImage->getDescriptor();
-    auto                              vDes                       = mVImage->getDescriptor();
-    auto                              vStorageDes                = mStorageBuffer->getDescriptor();
-    std::vector<VkWriteDescriptorSet> computeWriteDescriptorSets = {
-        // Binding 0 : YImage
-        vks::initializers::writeDescriptorSet(
-            compute.descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0, &yDes),
-        // Binding 1 : UImage
-        vks::initializers::writeDescriptorSet(
-            compute.descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, &uDes),
-        // Binding 2 : VImage
-        vks::initializers::writeDescriptorSet(
-            compute.descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2, &vDes),
-        // Binding 3 : Storage Image
-        vks::initializers::writeDescriptorSet(
-            compute.descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3, &vStorageDes)};
-
-    vkUpdateDescriptorSets(device(),
-                           static_cast<uint32_t>(computeWriteDescriptorSets.size()),
-                           computeWriteDescriptorSets.data(),
-                           0,
-                           nullptr);
-
-    // Create pipelines
-    VkComputePipelineCreateInfo computePipelineCreateInfo =
-        vks::initializers::computePipelineCreateInfo(compute.pipelineLayout, 0);
-
-    const auto                                  workGroupSize        = deviceWrapper()->workGroupSize;
-    const uint32_t                              specializationData[] = {workGroupSize, workGroupSize};
-    const std::vector<VkSpecializationMapEntry> specializationMap    = {
-        // clang-format off
-            // constantID, offset,               size
-            {0, 0 * sizeof(uint32_t), sizeof(uint32_t)},
-            {1, 1 * sizeof(uint32_t), sizeof(uint32_t)},
-        // clang-format on
-    };
-    const VkSpecializationInfo specializationInfo = {
-        .mapEntryCount = static_cast<uint32_t>(specializationMap.size()),
-        .pMapEntries   = specializationMap.data(),
-        .dataSize      = sizeof(specializationData),
-        .pData         = specializationData,
-    };
-
-    computePipelineCreateInfo.stage                     = loadShader(mComputeShaderPath, VK_SHADER_STAGE_COMPUTE_BIT);
-    computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
-
-    CALL_VK(vkCreateComputePipelines(device(),
-                                     mPipelineCache.handle(),
-                                     1,
-                                     &computePipelineCreateInfo,
-                                     nullptr,
-                                     &compute.pipelineYuvToRgba));
+    // Subgroups merge the equal bins before the shared memory atomics where the device has them
+    const HistogramCalculator::Kernel kernel = HistogramCalculator::preferredKernel(*deviceWrapper());
+    mHistogramCalculator                     = HistogramCalculator::create(
+        deviceWrapper(),
+        mPipelineCache.handle(),
+        loadShader(HistogramCalculator::shaderPath(kernel), VK_SHADER_STAGE_COMPUTE_BIT),
+        kernel);
+    mHistogramStatistics = HistogramStatistics::create(
+        deviceWrapper(),
+        mPipelineCache.handle(),
+        loadShader(HistogramStatistics::shaderPath(), VK_SHADER_STAGE_COMPUTE_BIT));
 
     // Separate command pool as queue family for compute may be different than graphics
     VkCommandPoolCreateInfo cmdPoolInfo = {};
@@ -233,67 +172,388 @@ void Sample_07_Histogram::prepareCompute()
     cmdPoolInfo.flags                   = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
     CALL_VK(vkCreateCommandPool(device(), &cmdPoolInfo, nullptr, &compute.commandPool));
 
-    // Create a command buffer for compute operations
-    VkCommandBufferAllocateInfo cmdBufAllocateInfo = vks::initializers::commandBufferAllocateInfo(
-        compute.commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1);
-    CALL_VK(vkAllocateCommandBuffers(device(), &cmdBufAllocateInfo, &compute.commandBuffer));
+    VkDescriptorSetLayout descriptorSetLayout = mHistogramCalculator->descriptorSetLayout();
+    VkDescriptorSetLayout statisticsSetLayout = mHistogramStatistics->descriptorSetLayout();
+    for (auto &slot : mHistogramSlots)
+    {
+        VkDescriptorSetAllocateInfo allocInfo = vks::initializers::descriptorSetAllocateInfo(
+            descriptorPool(), &descriptorSetLayout, 1);
+        CALL_VK(vkAllocateDescriptorSets(device(), &allocInfo, &slot.computeSet));
+        allocInfo.pSetLayouts = &statisticsSetLayout;
+        CALL_VK(vkAllocateDescriptorSets(device(), &allocInfo, &slot.statisticsSet));
+
+        mHistogramCalculator->updateDescriptorSet(slot.computeSet,
+                                                  mYImage->getDescriptor(),
+                                                  mUImage->getDescriptor(),
+                                                  mVImage->getDescriptor(),
+                                                  slot.bins->getDescriptor());
+        mHistogramStatistics->updateDescriptorSet(slot.statisticsSet, slot.bins->getDescriptor(),
+                                                  slot.statistics->getDescriptor());
+
+        // Create a command buffer for compute operations
+        VkCommandBufferAllocateInfo cmdBufAllocateInfo = vks::initializers::commandBufferAllocateInfo(
+            compute.commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1);
+        CALL_VK(vkAllocateCommandBuffers(device(), &cmdBufAllocateInfo, &slot.commandBuffer));
+
+        buildComputeCommandBuffer(slot);
+    }
+}
 
-    // Semaphore for compute & graphics sync
-    VkSemaphoreCreateInfo semaphoreCreateInfo = vks::initializers::semaphoreCreateInfo();
-    CALL_VK(vkCreateSemaphore(device(), &semaphoreCreateInfo, nullptr, &compute.semaphore));
+void Sample_07_Histogram::buildComputeCommandBuffer(HistogramSlot &slot)
+{
+    VkCommandBufferBeginInfo cmdBufInfo = vks::initializers::commandBufferBeginInfo();
 
-    // Signal the semaphore
-    VkSubmitInfo submitInfo         = vks::initializers::submitInfo();
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores    = &compute.semaphore;
-    CALL_VK(vkQueueSubmit(compute.queue, 1, &submitInfo, VK_NULL_HANDLE));
-    CALL_VK(vkQueueWaitIdle(compute.queue));
+    CALL_VK(vkBeginCommandBuffer(slot.commandBuffer, &cmdBufInfo));
 
-    buildComputeCommandBuffer();
+    // Buffer初始用0填充，否则后面帧的buffer会被前面帧的污染
+    slot.recordedChannel = mChannel;
+    mHistogramCalculator->record(slot.commandBuffer,
+                                 slot.computeSet,
+                                 slot.bins->getBufferHandle(),
+                                 mYImage->width(),
+                                 mYImage->height(),
+                                 mUPlane.pixelStride,
+                                 mVPlane.pixelStride,
+                                 slot.recordedChannel);
+    mHistogramStatistics->record(slot.commandBuffer, slot.statisticsSet, slot.bins->getBufferHandle(), mExposureParams);
+
+    // Copy the bins for the host, the fence of the submission tells when they can be read
+    VkBufferMemoryBarrier barrier = vks::initializers::bufferMemoryBarrier();
+    barrier.srcAccessMask         = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask         = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.buffer                = slot.bins->getBufferHandle();
+    barrier.size                  = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(slot.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    const VkBufferCopy copyRegion = {0, 0, HistogramCalculator::BUFFER_SIZE};
+    vkCmdCopyBuffer(slot.commandBuffer, slot.bins->getBufferHandle(), slot.readback->getBufferHandle(), 1, &copyRegion);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    barrier.buffer        = slot.readback->getBufferHandle();
+    vkCmdPipelineBarrier(slot.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    vkEndCommandBuffer(slot.commandBuffer);
 }
 
-void Sample_07_Histogram::buildComputeCommandBuffer()
+void Sample_07_Histogram::setChannel(histogram::Channel channel)
 {
-    VkCommandBufferBeginInfo cmdBufInfo = vks::initializers::commandBufferBeginInfo();
+    mChannel = channel;
+}
 
-    CALL_VK(vkBeginCommandBuffer(compute.commandBuffer, &cmdBufInfo));
+void Sample_07_Histogram::harvestHistograms(HistogramSlot *slot)
+{
+    if (slot != nullptr && slot->pendingFrame != 0)
+    {
+        // The ring is full: the GPU is HISTOGRAM_RING_SIZE frames behind
+        CALL_VK(vkWaitForFences(device(), 1, slot->fence.pHandle(), VK_TRUE, UINT64_MAX));
+    }
 
-    vkCmdBindPipeline(
-        compute.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, compute.pipelineYuvToRgba);
-    vkCmdBindDescriptorSets(compute.commandBuffer,
-                            VK_PIPELINE_BIND_POINT_COMPUTE,
-                            compute.pipelineLayout,
-                            0,
-                            1,
-                            &compute.descriptorSet,
-                            0,
-                            0);
+    for (auto &completed : mHistogramSlots)
+    {
+        if (completed.pendingFrame == 0 || vkGetFenceStatus(device(), completed.fence.handle()) != VK_SUCCESS)
+        {
+            continue;
+        }
+        CALL_VK(vkResetFences(device(), 1, completed.fence.pHandle()));
+        CALL_VK(completed.readback->invalidate());
+
+        std::lock_guard<std::mutex> lock(mLatestMutex);
+        if (completed.pendingFrame > mLatestFrame)
+        {
+            memcpy(mLatestBins, completed.readback->getMappedData(), sizeof(mLatestBins));
+            mLatestChannel = completed.recordedChannel;
+            mLatestFrame   = completed.pendingFrame;
+        }
+        completed.pendingFrame = 0;
+    }
+}
+
+uint64_t Sample_07_Histogram::latestHistogram(uint32_t *bins, histogram::Channel *channel)
+{
+    std::lock_guard<std::mutex> lock(mLatestMutex);
+    if (mLatestFrame != 0)
+    {
+        memcpy(bins, mLatestBins, sizeof(mLatestBins));
+        if (channel != nullptr)
+        {
+            *channel = mLatestChannel;
+        }
+    }
+    return mLatestFrame;
+}
 
-    // Bind push constant
-    struct UVPixelStride
+void Sample_07_Histogram::runBenchmarks()
+{
+    using Kernel                 = HistogramCalculator::Kernel;
+    const uint32_t sizes[][2]    = {{1920, 1080}, {3840, 2160}};
+    const int      iterations    = 20;
+    const char    *kernelNames[] = {"global", "workgroup", "subgroup"};
+    const auto    &limits        = deviceWrapper()->properties.limits;
+    // Timestamps bracket the dispatches, without them the whole submission is timed on the CPU
+    const bool timestamps = limits.timestampComputeAndGraphics == VK_TRUE;
+
+    std::vector<std::unique_ptr<HistogramCalculator>> calculators;
+    for (Kernel kernel : {Kernel::GLOBAL_ATOMICS, Kernel::WORKGROUP, Kernel::SUBGROUP})
     {
-        int uPixelStride;
-        int vPixelStride;
-    } pixelStride;
-
-    pixelStride.uPixelStride = mUPlane.pixelStride;
-    pixelStride.vPixelStride = mVPlane.pixelStride;
-    vkCmdPushConstants(compute.commandBuffer,
-                       compute.pipelineLayout,
-                       VK_SHADER_STAGE_COMPUTE_BIT,
-                       0,
-                       sizeof(UVPixelStride),
-                       &pixelStride);
+        if (!HistogramCalculator::isSupported(*deviceWrapper(), kernel))
+        {
+            continue;
+        }
+        auto calculator = HistogramCalculator::create(
+            deviceWrapper(), mPipelineCache.handle(),
+            loadShader(HistogramCalculator::shaderPath(kernel), VK_SHADER_STAGE_COMPUTE_BIT), kernel);
+        if (calculator != nullptr)
+        {
+            calculators.push_back(std::move(calculator));
+        }
+    }
+    const uint32_t calculatorCount = static_cast<uint32_t>(calculators.size());
+    auto           statisticsStage = HistogramStatistics::create(
+        deviceWrapper(), mPipelineCache.handle(),
+        loadShader(HistogramStatistics::shaderPath(), VK_SHADER_STAGE_COMPUTE_BIT));
+
+    VulkanDescriptorPool benchmarkPool(device());
+    VkDescriptorPoolSize poolSizes[] = {
+        vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                                              HistogramCalculator::STORAGE_IMAGE_COUNT * calculatorCount),
+        vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                              HistogramCalculator::STORAGE_BUFFER_COUNT * calculatorCount +
+                                                  HistogramStatistics::STORAGE_BUFFER_COUNT),
+    };
+    const VkDescriptorPoolCreateInfo poolInfo = vks::initializers::descriptorPoolCreateInfo(2, poolSizes, calculatorCount + 1);
+    CALL_VK(vkCreateDescriptorPool(device(), &poolInfo, nullptr, benchmarkPool.pHandle()));
 
-    // Buffer初始用0填充，否则后面帧的buffer会被前面帧的污染
-    vkCmdFillBuffer(compute.commandBuffer, mStorageBuffer->getBufferHandle(), 0, VK_WHOLE_SIZE, 0);
+    VulkanQueryPool       queryPool(device());
+    VkQueryPoolCreateInfo queryPoolInfo = {};
+    queryPoolInfo.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType             = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount            = 2;
+    CALL_VK(vkCreateQueryPool(device(), &queryPoolInfo, nullptr, queryPool.pHandle()));
 
-    const auto     workGroupSize = deviceWrapper()->workGroupSize;
-    const uint32_t groupCountX   = (mYImage->width() + workGroupSize - 1) / workGroupSize;
-    const uint32_t groupCountY   = (mYImage->height() + workGroupSize - 1) / workGroupSize;
-    vkCmdDispatch(compute.commandBuffer, groupCountX, groupCountY, 1);
+    VulkanFence             fence(device());
+    const VkFenceCreateInfo fenceInfo = vks::initializers::fenceCreateInfo(0);
+    CALL_VK(vkCreateFence(device(), &fenceInfo, nullptr, fence.pHandle()));
 
-    vkEndCommandBuffer(compute.commandBuffer);
+    VkCommandBuffer commandBuffer = deviceWrapper()->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+    for (const auto &size : sizes)
+    {
+        const uint32_t width = size[0], height = size[1];
+
+        // Camera like content: gradients, and a clipped highlight over a quarter of the frame whose
+        // pixels all fall into the same bins
+        std::vector<uint8_t> yPlane(width * height), uPlane(width * height / 4), vPlane(width * height / 4);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const bool highlight  = x < width / 2 && y < height / 2;
+                yPlane[y * width + x] = highlight ? 255 : static_cast<uint8_t>((x + y) * 255 / (width + height));
+            }
+        }
+        for (uint32_t y = 0; y < height / 2; y++)
+        {
+            for (uint32_t x = 0; x < width / 2; x++)
+            {
+                const bool highlight      = x < width / 4 && y < height / 4;
+                uPlane[y * width / 2 + x] = highlight ? 128 : static_cast<uint8_t>(64 + x * 128 / width);
+                vPlane[y * width / 2 + x] = highlight ? 128 : static_cast<uint8_t>(64 + y * 128 / height);
+            }
+        }
+        yuv::Frame frame;
+        frame.y       = yPlane.data();
+        frame.u       = uPlane.data();
+        frame.v       = vPlane.data();
+        frame.width   = width;
+        frame.height  = height;
+        frame.yStride = width;
+        frame.uStride = width / 2;
+        frame.vStride = width / 2;
+
+        const auto cpuStart = std::chrono::high_resolution_clock::now();
+        uint32_t   reference[histogram::BIN_COUNT];
+        histogram::computeReference(frame, histogram::Channel::AVERAGE, reference);
+        const double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - cpuStart).count();
+
+        Image::ImageBasicInfo imageInfo = {};
+        imageInfo.format                = VK_FORMAT_R8_UNORM;
+        imageInfo.usage                 = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+        imageInfo.layout                = VK_IMAGE_LAYOUT_GENERAL;
+        imageInfo.extent                = {width, height, 1};
+        auto yImage                     = Image::createDeviceLocal(deviceWrapper(), mGraphicsQueue, imageInfo);
+        imageInfo.extent                = {width / 2, height / 2, 1};
+        auto uImage                     = Image::createDeviceLocal(deviceWrapper(), mGraphicsQueue, imageInfo);
+        auto vImage                     = Image::createDeviceLocal(deviceWrapper(), mGraphicsQueue, imageInfo);
+        if (yImage == nullptr || uImage == nullptr || vImage == nullptr)
+        {
+            LOGCATE("Histogram benchmark: Failed to create the %ux%u images", width, height);
+            break;
+        }
+        yImage->setContentFromBytes(yPlane.data(), yPlane.size(), frame.yStride);
+        uImage->setContentFromBytes(uPlane.data(), uPlane.size(), frame.uStride);
+        vImage->setContentFromBytes(vPlane.data(), vPlane.size(), frame.vStride);
+        UploadManager *uploadManager = deviceWrapper()->getUploadManager();
+        uploadManager->wait(uploadManager->flush());
+
+        auto bins = vks::Buffer::create(deviceWrapper(),
+                                        HistogramCalculator::BUFFER_SIZE,
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        bins->map();
+
+        CALL_VK(vkResetDescriptorPool(device(), benchmarkPool.handle(), 0));
+        std::string timings;
+        for (const auto &calculator : calculators)
+        {
+            VkDescriptorSetLayout       layout    = calculator->descriptorSetLayout();
+            VkDescriptorSet             set       = VK_NULL_HANDLE;
+            VkDescriptorSetAllocateInfo allocInfo = vks::initializers::descriptorSetAllocateInfo(benchmarkPool.handle(), &layout, 1);
+            CALL_VK(vkAllocateDescriptorSets(device(), &allocInfo, &set));
+            calculator->updateDescriptorSet(set, yImage->getDescriptor(), uImage->getDescriptor(),
+                                            vImage->getDescriptor(), bins->getDescriptor());
+
+            VkCommandBufferBeginInfo beginInfo = vks::initializers::commandBufferBeginInfo();
+            CALL_VK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+            vkCmdResetQueryPool(commandBuffer, queryPool.handle(), 0, 2);
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool.handle(), 0);
+            VkBufferMemoryBarrier barrier = vks::initializers::bufferMemoryBarrier();
+            barrier.buffer                = bins->getBufferHandle();
+            barrier.size                  = VK_WHOLE_SIZE;
+            for (int i = 0; i < iterations; i++)
+            {
+                if (i > 0)
+                {
+                    // The next clear overwrites the bins of this dispatch
+                    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                         0, 0, nullptr, 1, &barrier, 0, nullptr);
+                }
+                calculator->record(commandBuffer, set, bins->getBufferHandle(), width, height, 1, 1,
+                                   histogram::Channel::AVERAGE);
+            }
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool.handle(), 1);
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0,
+                                 nullptr, 1, &barrier, 0, nullptr);
+            CALL_VK(vkEndCommandBuffer(commandBuffer));
+
+            VkSubmitInfo submitInfo       = vks::initializers::submitInfo();
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers    = &commandBuffer;
+            const auto submitStart        = std::chrono::high_resolution_clock::now();
+            CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, fence.handle()));
+            CALL_VK(vkWaitForFences(device(), 1, fence.pHandle(), VK_TRUE, UINT64_MAX));
+            double gpuMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - submitStart).count();
+            CALL_VK(vkResetFences(device(), 1, fence.pHandle()));
+            if (timestamps)
+            {
+                uint64_t ticks[2] = {};
+                CALL_VK(vkGetQueryPoolResults(device(), queryPool.handle(), 0, 2, sizeof(ticks), ticks, sizeof(uint64_t),
+                                              VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+                gpuMs = static_cast<double>(ticks[1] - ticks[0]) * limits.timestampPeriod / 1e6;
+            }
+
+            // Each pixel counted in a wrong bin is two bins off
+            const uint32_t *gpuBins    = static_cast<const uint32_t *>(bins->getMappedData());
+            uint64_t        difference = 0;
+            for (uint32_t bin = 0; bin < histogram::BIN_COUNT; bin++)
+            {
+                difference += gpuBins[bin] > reference[bin] ? gpuBins[bin] - reference[bin] : reference[bin] - gpuBins[bin];
+            }
+
+            char timing[96];
+            snprintf(timing, sizeof(timing), ", %s %.3f ms (%llu pixels off)",
+                     kernelNames[static_cast<int>(calculator->kernel())], gpuMs / iterations,
+                     static_cast<unsigned long long>(difference / 2));
+            timings += timing;
+        }
+        LOGCATI("Histogram %ux%u: CPU reference %.3f ms%s%s", width, height, cpuMs, timings.c_str(),
+                timestamps ? "" : " (no timestamps, submit to fence)");
+
+        if (statisticsStage == nullptr || calculators.empty())
+        {
+            continue;
+        }
+
+        // Statistics of the bins left by the last kernel, the CPU version gets the same bins
+        auto statistics = vks::Buffer::create(deviceWrapper(),
+                                              HistogramStatistics::BUFFER_SIZE,
+                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        statistics->map();
+        VkDescriptorSetLayout       layout    = statisticsStage->descriptorSetLayout();
+        VkDescriptorSet             set       = VK_NULL_HANDLE;
+        VkDescriptorSetAllocateInfo allocInfo = vks::initializers::descriptorSetAllocateInfo(benchmarkPool.handle(), &layout, 1);
+        CALL_VK(vkAllocateDescriptorSets(device(), &allocInfo, &set));
+        statisticsStage->updateDescriptorSet(set, bins->getDescriptor(), statistics->getDescriptor());
+
+        const histogram::ExposureParams params;
+        VkCommandBufferBeginInfo        beginInfo = vks::initializers::commandBufferBeginInfo();
+        CALL_VK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+        vkCmdResetQueryPool(commandBuffer, queryPool.handle(), 0, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool.handle(), 0);
+        VkBufferMemoryBarrier barrier = vks::initializers::bufferMemoryBarrier();
+        barrier.buffer                = statistics->getBufferHandle();
+        barrier.size                  = VK_WHOLE_SIZE;
+        for (int i = 0; i < iterations; i++)
+        {
+            if (i > 0)
+            {
+                // The next dispatch overwrites the statistics of this one
+                barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     0, 0, nullptr, 1, &barrier, 0, nullptr);
+            }
+            statisticsStage->record(commandBuffer, set, bins->getBufferHandle(), params);
+        }
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool.handle(), 1);
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0,
+                             nullptr, 1, &barrier, 0, nullptr);
+        CALL_VK(vkEndCommandBuffer(commandBuffer));
+
+        VkSubmitInfo submitInfo       = vks::initializers::submitInfo();
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &commandBuffer;
+        const auto submitStart        = std::chrono::high_resolution_clock::now();
+        CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, fence.handle()));
+        CALL_VK(vkWaitForFences(device(), 1, fence.pHandle(), VK_TRUE, UINT64_MAX));
+        double gpuMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - submitStart).count();
+        CALL_VK(vkResetFences(device(), 1, fence.pHandle()));
+        if (timestamps)
+        {
+            uint64_t ticks[2] = {};
+            CALL_VK(vkGetQueryPoolResults(device(), queryPool.handle(), 0, 2, sizeof(ticks), ticks, sizeof(uint64_t),
+                                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+            gpuMs = static_cast<double>(ticks[1] - ticks[0]) * limits.timestampPeriod / 1e6;
+        }
+
+        const auto            statisticsStart = std::chrono::high_resolution_clock::now();
+        histogram::Statistics expected;
+        histogram::computeStatistics(static_cast<const uint32_t *>(bins->getMappedData()), params, &expected);
+        const double statisticsMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - statisticsStart).count();
+
+        // The ranks are exact, only the metered sums are added in another order
+        const auto *actual  = static_cast<const histogram::Statistics *>(statistics->getMappedData());
+        const bool  matches = actual->pixelCount == expected.pixelCount && actual->minimum == expected.minimum &&
+                       actual->maximum == expected.maximum &&
+                       memcmp(actual->percentiles, expected.percentiles, sizeof(expected.percentiles)) == 0 &&
+                       std::abs(actual->mean - expected.mean) < 1e-3f &&
+                       std::abs(actual->exposure - expected.exposure) < 1e-3f;
+        LOGCATI("Histogram statistics %ux%u: GPU %.4f ms, CPU %.4f ms, median %u, mean %.2f, exposure %.3f EV, %s",
+                width, height, gpuMs / iterations, statisticsMs, actual->percentiles[2], actual->mean, actual->exposure,
+                matches ? "matches the CPU" : "DIFFERS from the CPU");
+    }
+
+    vkFreeCommandBuffers(device(), deviceWrapper()->commandPool, 1, &commandBuffer);
+    LOGCATI("Histogram: subgroup size %u", deviceWrapper()->subgroupProperties.subgroupSize);
 }
 
 void Sample_07_Histogram::updateTexture(JNIEnv *env)
@@ -309,12 +569,14 @@ void Sample_07_Histogram::setupDescriptorPool()
 {
     // We need to tell the API the number of max. requested descriptors per type
     VkDescriptorPoolSize typeCounts[2];
-    // 三个采样Image，即Y、U、V
+    // 每个slot的直方图和统计buffer，直方图计算、统计计算和绘制各一组descriptor
     typeCounts[0].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    typeCounts[0].descriptorCount = 2;
-    // 一个Storage Image用于存储RGBA
+    typeCounts[0].descriptorCount = (HistogramCalculator::STORAGE_BUFFER_COUNT +
+                                     HistogramStatistics::STORAGE_BUFFER_COUNT + 2) *
+                                    HISTOGRAM_RING_SIZE;
+    // 三个Storage Image，即Y、U、V，每个slot一组
     typeCounts[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    typeCounts[1].descriptorCount = 3;
+    typeCounts[1].descriptorCount = HistogramCalculator::STORAGE_IMAGE_COUNT * HISTOGRAM_RING_SIZE;
 
     // Create the global descriptor pool
     // All descriptors used in this example are allocated from this pool
@@ -325,7 +587,7 @@ void Sample_07_Histogram::setupDescriptorPool()
     descriptorPoolInfo.pPoolSizes                 = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting
     // beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = 4;
+    descriptorPoolInfo.maxSets = 3 * HISTOGRAM_RING_SIZE;
 
     CALL_VK(
         vkCreateDescriptorPool(device(), &descriptorPoolInfo, nullptr, mDescriptorPool.pHandle()));
@@ -337,13 +599,16 @@ void Sample_07_Histogram::setupDescriptorSetLayout()
     // Basically connects the different shader stages to descriptors for binding uniform buffers,
     // image samplers, etc. So every shader binding should map to one descriptor set layout binding
 
-    VkDescriptorSetLayoutBinding layoutBinding = vks::initializers::descriptorSetLayoutBinding(
-        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT, 0);
+    // Binding 0: the bins, binding 1: their statistics
+    VkDescriptorSetLayoutBinding layoutBindings[] = {
+        vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT, 0),
+        vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT, 1),
+    };
 
     VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
     descriptorLayout.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    descriptorLayout.bindingCount                    = 1;
-    descriptorLayout.pBindings                       = &layoutBinding;
+    descriptorLayout.bindingCount                    = 2;
+    descriptorLayout.pBindings                       = layoutBindings;
 
     CALL_VK(vkCreateDescriptorSetLayout(
         device(), &descriptorLayout, nullptr, mDescriptorSetLayout.pHandle()));
@@ -360,24 +625,28 @@ void Sample_07_Histogram::setupDescriptorSetLayout()
 
 void Sample_07_Histogram::setupDescriptorSet()
 {
-    // Allocate a new descriptor set from the global descriptor pool
+    // Allocate a new descriptor set from the global descriptor pool, one per slot of the ring
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool              = mDescriptorPool.handle();
     allocInfo.descriptorSetCount          = 1;
     allocInfo.pSetLayouts                 = mDescriptorSetLayout.pHandle();
 
-    CALL_VK(vkAllocateDescriptorSets(device(), &allocInfo, &mDescriptorSet));
-
-    // Update the descriptor set determining the shader binding points
-    // For every binding point used in a shader there needs to be one
-    // descriptor set matching that binding point
-
-    auto                 desc               = mStorageBuffer->getDescriptor();
-    VkWriteDescriptorSet writeDescriptorSet = vks::initializers::writeDescriptorSet(
-        mDescriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0, &desc);
-
-    vkUpdateDescriptorSets(device(), 1, &writeDescriptorSet, 0, nullptr);
+    for (auto &slot : mHistogramSlots)
+    {
+        CALL_VK(vkAllocateDescriptorSets(device(), &allocInfo, &slot.graphicsSet));
+
+        // Update the descriptor set determining the shader binding points
+        // For every binding point used in a shader there needs to be one
+        // descriptor set matching that binding point
+        VkDescriptorBufferInfo descs[]               = {slot.bins->getDescriptor(), slot.statistics->getDescriptor()};
+        VkWriteDescriptorSet   writeDescriptorSets[] = {
+            vks::initializers::writeDescriptorSet(slot.graphicsSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0, &descs[0]),
+            vks::initializers::writeDescriptorSet(slot.graphicsSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, &descs[1]),
+        };
+
+        vkUpdateDescriptorSets(device(), 2, writeDescriptorSets, 0, nullptr);
+    }
 }
 
 void Sample_07_Histogram::prepareSynchronizationPrimitives()
@@ -387,18 +656,19 @@ void Sample_07_Histogram::prepareSynchronizationPrimitives()
     semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
     semaphoreCreateInfo.pNext                 = nullptr;
 
-    // Semaphore used to ensures that image presentation is complete before starting to submit again
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, presentCompleteSemaphore.pHandle()));
-
-    // Semaphore used to ensures that all commands submitted have been finished before submitting
-    // the image to the queue
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, renderCompleteSemaphore.pHandle()));
-
-    mGraphicsSemaphore = VulkanSemaphore(device());
+    // The present/render semaphores are owned per frame by VulkanContextBase, only the
+    // graphics <-> compute dependencies are specific to this sample
+    mUploadSemaphore = VulkanSemaphore(device());
     CALL_VK(
-        vkCreateSemaphore(device(), &semaphoreCreateInfo, nullptr, mGraphicsSemaphore.pHandle()));
+        vkCreateSemaphore(device(), &semaphoreCreateInfo, nullptr, mUploadSemaphore.pHandle()));
+
+    // The fences are reset when a slot is read back, the first submission of a slot finds them unsignaled
+    VkFenceCreateInfo fenceCreateInfo = vks::initializers::fenceCreateInfo(0);
+    for (auto &slot : mHistogramSlots)
+    {
+        CALL_VK(vkCreateSemaphore(device(), &semaphoreCreateInfo, nullptr, slot.semaphore.pHandle()));
+        CALL_VK(vkCreateFence(device(), &fenceCreateInfo, nullptr, slot.fence.pHandle()));
+    }
 }
 
 void Sample_07_Histogram::prepareUniformBuffers()
@@ -451,7 +721,7 @@ void Sample_07_Histogram::updateUniformBuffers()
     uboVS.modelMatrix = glm::rotate(
         uboVS.modelMatrix, glm::radians((float) mYPlane.orientation), glm::vec3(0.0f, 0.0f, 1.0f));
 
-    mUniformBuffer->copyFrom(&uboVS, sizeof(uboVS));
+    updateUniformBuffer(*mUniformBuffer, &uboVS, sizeof(uboVS));
 }
 
 void Sample_07_Histogram::preparePipelines()
@@ -605,14 +875,20 @@ void Sample_07_Histogram::preparePipelines()
     // Create rendering pipeline using the specified states
     CALL_VK(vkCreateGraphicsPipelines(
         device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
-
-    // Shader modules are no longer needed once the graphics pipeline has been created
-    vkDestroyShaderModule(device(), shaderStages[0].module, nullptr);
-    vkDestroyShaderModule(device(), shaderStages[1].module, nullptr);
 }
 
 void Sample_07_Histogram::buildCommandBuffers()
 {
+    for (uint32_t i = 0; i < drawCmdBuffers.size(); ++i)
+    {
+        recordCommandBuffer(i, mHistogramSlots[0].graphicsSet);
+    }
+}
+
+void Sample_07_Histogram::recordCommandBuffer(uint32_t index, VkDescriptorSet descriptorSet)
+{
+    VkCommandBuffer cmdBuffer = drawCmdBuffers[index].handle();
+
     VkCommandBufferBeginInfo cmdBufInfo = {};
     cmdBufInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     cmdBufInfo.pNext                    = nullptr;
@@ -635,88 +911,124 @@ void Sample_07_Histogram::buildCommandBuffers()
     renderPassBeginInfo.clearValueCount          = 2;
     renderPassBeginInfo.pClearValues             = clearValues;
 
-    for (int32_t i = 0; i < drawCmdBuffers.size(); ++i)
-    {
-        // Set target frame buffer
-        renderPassBeginInfo.framebuffer = frameBuffers[i];
-
-        CALL_VK(vkBeginCommandBuffer(drawCmdBuffers[i].handle(), &cmdBufInfo));
-
-        // Start the first sub pass specified in our default prepare pass setup by the base class
-        // This will clear the color and depth attachment
-        vkCmdBeginRenderPass(
-            drawCmdBuffers[i].handle(), &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-        // Update dynamic viewport state
-        VkViewport viewport = {};
-        viewport.height     = (float) mWindow.windowHeight;
-        viewport.width      = (float) mWindow.windowWidth;
-        viewport.minDepth   = (float) 0.0f;
-        viewport.maxDepth   = (float) 1.0f;
-        vkCmdSetViewport(drawCmdBuffers[i].handle(), 0, 1, &viewport);
-
-        // Update dynamic scissor state
-        VkRect2D scissor      = {};
-        scissor.extent.width  = mWindow.windowWidth;
-        scissor.extent.height = mWindow.windowHeight;
-        scissor.offset.x      = 0;
-        scissor.offset.y      = 0;
-        vkCmdSetScissor(drawCmdBuffers[i].handle(), 0, 1, &scissor);
-
-        // Bind descriptor sets describing shader binding points
-        vkCmdBindDescriptorSets(drawCmdBuffers[i].handle(),
-                                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                mPipelineLayout.handle(),
-                                0,
-                                1,
-                                &mDescriptorSet,
-                                0,
-                                nullptr);
-
-        // Bind the rendering pipeline
-        // The pipeline (state object) contains all states of the rendering pipeline, binding it
-        // will set all the states specified at pipeline creation time
-        vkCmdBindPipeline(
-            drawCmdBuffers[i].handle(), VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline.handle());
-
-        // Bind triangle vertex buffer (contains position and colors)
-        VkDeviceSize offsets[1]  = {0};
-        auto         verticesBuf = mVerticesBuffer->getBufferHandle();
-        vkCmdBindVertexBuffers(drawCmdBuffers[i].handle(), 0, 1, &verticesBuf, offsets);
-
-        // Draw triangle
-        vkCmdDraw(drawCmdBuffers[i].handle(),
-                  sizeof(g_vb_bitmap_texture_Data) / sizeof(g_vb_bitmap_texture_Data[0]),
-                  1,
-                  0,
-                  0);
-
-        //        drawUI(drawCmdBuffers[i].handle());
-
-        vkCmdEndRenderPass(drawCmdBuffers[i].handle());
-
-        // Ending the prepare pass will add an implicit barrier transitioning the frame buffer color
-        // attachment to VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-
-        CALL_VK(vkEndCommandBuffer(drawCmdBuffers[i].handle()));
-    }
+    // Set target frame buffer
+    renderPassBeginInfo.framebuffer = frameBuffers[index];
+
+    CALL_VK(vkBeginCommandBuffer(cmdBuffer, &cmdBufInfo));
+
+    // Start the first sub pass specified in our default prepare pass setup by the base class
+    // This will clear the color and depth attachment
+    vkCmdBeginRenderPass(
+        cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    // Update dynamic viewport state
+    VkViewport viewport = {};
+    viewport.height     = (float) mWindow.windowHeight;
+    viewport.width      = (float) mWindow.windowWidth;
+    viewport.minDepth   = (float) 0.0f;
+    viewport.maxDepth   = (float) 1.0f;
+    vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+
+    // Update dynamic scissor state
+    VkRect2D scissor      = {};
+    scissor.extent.width  = mWindow.windowWidth;
+    scissor.extent.height = mWindow.windowHeight;
+    scissor.offset.x      = 0;
+    scissor.offset.y      = 0;
+    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+    // Bind descriptor sets describing shader binding points
+    vkCmdBindDescriptorSets(cmdBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            mPipelineLayout.handle(),
+                            0,
+                            1,
+                            &descriptorSet,
+                            0,
+                            nullptr);
+
+    // Bind the rendering pipeline
+    // The pipeline (state object) contains all states of the rendering pipeline, binding it
+    // will set all the states specified at pipeline creation time
+    vkCmdBindPipeline(
+        cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline.handle());
+
+    // Bind triangle vertex buffer (contains position and colors)
+    VkDeviceSize offsets[1]  = {0};
+    auto         verticesBuf = mVerticesBuffer->getBufferHandle();
+    vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &verticesBuf, offsets);
+
+    // Draw triangle
+    vkCmdDraw(cmdBuffer,
+              sizeof(g_vb_bitmap_texture_Data) / sizeof(g_vb_bitmap_texture_Data[0]),
+              1,
+              0,
+              0);
+
+    //        drawUI(cmdBuffer);
+
+    vkCmdEndRenderPass(cmdBuffer);
+
+    // Ending the prepare pass will add an implicit barrier transitioning the frame buffer color
+    // attachment to VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
+
+    CALL_VK(vkEndCommandBuffer(cmdBuffer));
 }
 
 void Sample_07_Histogram::draw()
 {
     prepareFrame();
 
-    // Use a fence to wait until the command buffer has finished execution before using it again
-    CALL_VK(vkWaitForFences(device(), 1, waitFences[currentBuffer].pHandle(), VK_TRUE, UINT64_MAX));
-    CALL_VK(vkResetFences(device(), 1, waitFences[currentBuffer].pHandle()));
+    // Reuse the oldest slot, its histogram has been read back unless the GPU is a whole ring behind
+    HistogramSlot &slot = mHistogramSlots[mHistogramFrame % HISTOGRAM_RING_SIZE];
+    harvestHistograms(&slot);
+
+    if (mChannel != slot.recordedChannel)
+    {
+        buildComputeCommandBuffer(slot);
+    }
+
+    // Empty batch on the graphics queue, the compute submission waits for it. A semaphore signal
+    // covers everything submitted to the queue before it: the uploads flushed by prepareFrame()
+    // (the image the histogram reads) and the rendering of the previous frames as well, so compute
+    // N starts after graphics N-1 has finished and the two do not overlap. The rendering part is
+    // needed too: it is the write-after-read guard of the slot, whose bins are cleared by this
+    // compute submission while graphics N-HISTOGRAM_RING_SIZE may still read them in its fragment
+    // shader.
+    VkSubmitInfo uploadSubmitInfo         = vks::initializers::submitInfo();
+    uploadSubmitInfo.signalSemaphoreCount = 1;
+    uploadSubmitInfo.pSignalSemaphores    = mUploadSemaphore.pHandle();
+    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &uploadSubmitInfo, VK_NULL_HANDLE));
+
+    // The bins are cleared in the transfer stage
+    VkPipelineStageFlags computeWaitStageMask =
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    // Submit compute commands
+    VkSubmitInfo computeSubmitInfo         = vks::initializers::submitInfo();
+    computeSubmitInfo.commandBufferCount   = 1;
+    computeSubmitInfo.pCommandBuffers      = &slot.commandBuffer;
+    computeSubmitInfo.waitSemaphoreCount   = 1;
+    computeSubmitInfo.pWaitSemaphores      = mUploadSemaphore.pHandle();
+    computeSubmitInfo.pWaitDstStageMask    = &computeWaitStageMask;
+    computeSubmitInfo.signalSemaphoreCount = 1;
+    computeSubmitInfo.pSignalSemaphores    = slot.semaphore.pHandle();
+    CALL_VK(vkQueueSubmit(compute.queue, 1, &computeSubmitInfo, slot.fence.handle()));
+    slot.pendingFrame = ++mHistogramFrame;
+
+    // The command buffer of this frame is idle since prepareFrame(), point it at the bins of the slot
+    recordCommandBuffer(currentBuffer, slot.graphicsSet);
+
+    FrameSync &frame = currentFrameSync();
 
-    // Pipeline stage at which the queue submission will wait (via pWaitSemaphores)
-    VkPipelineStageFlags graphicsWaitStageMask[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                                                    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    // Pipeline stage at which the queue submission will wait (via pWaitSemaphores). Waiting in the
+    // transfer stage as well keeps the uploads of the next frames behind the histogram reads.
+    VkPipelineStageFlags graphicsWaitStageMask[] = {
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT};
 
-    VkSemaphore graphicsWaitSemaphores[] = {compute.semaphore, presentCompleteSemaphore.handle()};
-    VkSemaphore graphicsSemaphores[]     = {mGraphicsSemaphore.handle(),
-                                        renderCompleteSemaphore.handle()};
+    VkSemaphore graphicsWaitSemaphores[] = {frame.presentCompleteSemaphore.handle(),
+                                            slot.semaphore.handle()};
 
     // The submit info structure specifies a command buffer queue submission batch
     VkSubmitInfo submitInfo = {};
@@ -727,34 +1039,19 @@ void Sample_07_Histogram::draw()
     submitInfo.pWaitSemaphores =
         graphicsWaitSemaphores;               // Semaphore(s) to wait upon before the submitted command buffer
                                               // starts executing
-    submitInfo.waitSemaphoreCount = 2;        // One wait semaphore
+    submitInfo.waitSemaphoreCount = 2;
     submitInfo.pSignalSemaphores =
-        graphicsSemaphores;                     // Semaphore(s) to be signaled when command buffers have completed
-    submitInfo.signalSemaphoreCount = 2;        // One signal semaphore
+        frame.renderCompleteSemaphore.pHandle();        // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.signalSemaphoreCount = 1;                // One signal semaphore
     submitInfo.pCommandBuffers =
         drawCmdBuffers[currentBuffer]
             .pHandle();                       // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;        // One command buffer
 
     // Submit to the graphics queue passing a wait fence
-    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE));
+    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, frame.inFlightFence.handle()));
 
     submitFrame();
-
-    // Wait for rendering finished
-    VkPipelineStageFlags computerWaitStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-
-    // Submit compute commands
-    VkSubmitInfo computeSubmitInfo         = vks::initializers::submitInfo();
-    computeSubmitInfo.commandBufferCount   = 1;
-    computeSubmitInfo.pCommandBuffers      = &compute.commandBuffer;
-    computeSubmitInfo.waitSemaphoreCount   = 1;
-    computeSubmitInfo.pWaitSemaphores      = mGraphicsSemaphore.pHandle();        //&graphics.semaphore;
-    computeSubmitInfo.pWaitDstStageMask    = &computerWaitStageMask;
-    computeSubmitInfo.signalSemaphoreCount = 1;
-    computeSubmitInfo.pSignalSemaphores    = &compute.semaphore;
-    CALL_VK(
-        vkQueueSubmit(compute.queue, 1, &computeSubmitInfo, waitFences[currentBuffer].handle()));
 }
 
 void Sample_07_Histogram::unInit(JNIEnv *env)
@@ -766,4 +1063,10 @@ void Sample_07_Histogram::unInit(JNIEnv *env)
 }
 
 Sample_07_Histogram::~Sample_07_Histogram()
-{}
\ No newline at end of file
+{
+    vkDeviceWaitIdle(device());
+    if (compute.commandPool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(device(), compute.commandPool, nullptr);
+    }
+}
\ No newline at end of file
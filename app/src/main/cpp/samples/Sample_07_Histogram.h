@@ -27,8 +27,12 @@
 
 #include "VulkanInitializers.hpp"
 #include <VulkanContextBase.h>
+#include <VulkanHistogramCalculator.h>
+#include <VulkanHistogramStatistics.h>
 #include <VulkanImageWrapper.h>
 #include <array>
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 class Sample_07_Histogram : public VulkanContextBase
@@ -39,15 +43,56 @@ class Sample_07_Histogram : public VulkanContextBase
     std::unique_ptr<Image> mUImage;
     std::unique_ptr<Image> mVImage;
 
-    std::unique_ptr<vks::Buffer> mStorageBuffer;
-
     YUVSinglePassImage mYPlane;
     YUVSinglePassImage mUPlane;
     YUVSinglePassImage mVPlane;
 
     std::vector<jobject> mGlobalBitmaps;
 
-    const char *mComputeShaderPath;
+    std::unique_ptr<HistogramCalculator> mHistogramCalculator;
+    // Percentiles, mean and exposure of each histogram, drawn over it straight from the GPU buffer
+    std::unique_ptr<HistogramStatistics> mHistogramStatistics;
+    histogram::ExposureParams            mExposureParams;
+
+    // Set from the UI thread, the command buffer of a slot is recorded again when it changes
+    std::atomic<histogram::Channel> mChannel{histogram::Channel::AVERAGE};
+
+    // Frame N computes into slot N % HISTOGRAM_RING_SIZE and draws it, the host reads the slot back
+    // once its fence has signaled. The slots of the frames before are still being read while the
+    // next ones are computed, nothing waits for a histogram unless the ring is full.
+    static constexpr uint32_t HISTOGRAM_RING_SIZE = 3;
+
+    struct HistogramSlot
+    {
+        explicit HistogramSlot(VkDevice device) :
+            fence(device), semaphore(device)
+        {}
+
+        // Written by the compute shader, read by the fragment shader
+        std::unique_ptr<vks::Buffer> bins;
+        std::unique_ptr<vks::Buffer> statistics;
+        // Copy of bins for the host
+        std::unique_ptr<vks::Buffer> readback;
+        VkCommandBuffer              commandBuffer = VK_NULL_HANDLE;
+        VkDescriptorSet              computeSet    = VK_NULL_HANDLE;
+        VkDescriptorSet              statisticsSet = VK_NULL_HANDLE;
+        VkDescriptorSet              graphicsSet   = VK_NULL_HANDLE;
+        // Signaled with the readback copy
+        VulkanFence fence;
+        // Signaled by the compute submission, waited for by the graphics one of the same frame
+        VulkanSemaphore    semaphore;
+        histogram::Channel recordedChannel = histogram::Channel::AVERAGE;
+        // Frame the slot was submitted for, 0 once it has been read back
+        uint64_t pendingFrame = 0;
+    };
+    std::vector<HistogramSlot> mHistogramSlots;
+    uint64_t                   mHistogramFrame = 0;
+
+    // Last histogram read back, for latestHistogram() on other threads
+    std::mutex         mLatestMutex;
+    uint32_t           mLatestBins[histogram::BIN_COUNT] = {};
+    histogram::Channel mLatestChannel                     = histogram::Channel::AVERAGE;
+    uint64_t           mLatestFrame                       = 0;
 
     // 计算管线相关资源
     struct
@@ -58,24 +103,23 @@ class Sample_07_Histogram : public VulkanContextBase
                                           // one used for graphics)
         VkCommandPool commandPool;        // Use a separate command pool (queue family may differ from
                                           // the one used for graphics)
-        VkCommandBuffer
-                              commandBuffer;              // Command buffer storing the dispatch commands and barriers
-        VkSemaphore           semaphore;                  // Execution dependency between compute & graphic submission
-        VkDescriptorSetLayout descriptorSetLayout;        // Compute shader binding layout
-        VkDescriptorSet       descriptorSet;              // Compute shader bindings
-        VkPipelineLayout      pipelineLayout;             // Layout of the compute pipeline
-        VkPipeline
-            pipelineYuvToRgba;        // Compute pipeline for N-Body velocity calculation (1st pass)
-    } compute;
+    } compute = {};
 
     VulkanSemaphore
-        mGraphicsSemaphore;        // Execution dependency between compute & graphic submission
+        mUploadSemaphore;        // Signaled on the graphics queue after the uploads of a frame and
+                                 // the rendering of the previous ones, the compute submission of
+                                 // the frame waits for it (see draw())
 
     void prepareGraphics();
 
     void prepareCompute();
 
-    void buildComputeCommandBuffer();
+    void buildComputeCommandBuffer(HistogramSlot &slot);
+
+    void recordCommandBuffer(uint32_t index, VkDescriptorSet descriptorSet);
+
+    // Copy the slots the GPU has finished to the latest histogram, wait for slot if it is pending
+    void harvestHistograms(HistogramSlot *slot);
 
     void prepareSynchronizationPrimitives();
 
@@ -91,8 +135,7 @@ class Sample_07_Histogram : public VulkanContextBase
     Sample_07_Histogram() :
         VulkanContextBase("shaders/shader_07_histogram.vert.spv",
                           "shaders/shader_07_histogram.frag.spv"),
-        mComputeShaderPath("shaders/histogram.comp.spv"),
-        mGraphicsSemaphore(VK_NULL_HANDLE)
+        mUploadSemaphore(VK_NULL_HANDLE)
     {
         settings.overlay = false;
     }
@@ -109,10 +152,26 @@ class Sample_07_Histogram : public VulkanContextBase
 
     virtual void draw();
 
+    // Time the histogram kernels and the statistics on 1080p and 4K frames and check them against
+    // the CPU references
+    virtual void runBenchmarks() override;
+
     void setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h,
                      uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t uPixelStride,
                      uint32_t vPixelStride, uint32_t orientation);
 
+    // Value the pixels are binned by, applies from the next frame
+    void setChannel(histogram::Channel channel);
+
+    /**
+     * Copy the most recent histogram the GPU has finished, usually one or two frames old.
+     * Does not block, may be called from any thread.
+     *
+     * @param bins histogram::BIN_COUNT pixel counts
+     * @return Frame number of the histogram, 0 if none has completed yet
+     */
+    uint64_t latestHistogram(uint32_t *bins, histogram::Channel *channel = nullptr);
+
     void prepareImages(JNIEnv *env);
 
     virtual void unInit(JNIEnv *env) override;
@@ -31,29 +31,12 @@ void Sample_08_3DModel::set3DModelPath(std::string path)
     mModelPath = path;
 }
 
-void Sample_08_3DModel::prepareSynchronizationPrimitives()
-{
-    // Semaphores (Used for correct command ordering)
-    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
-    semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext                 = nullptr;
-
-    // Semaphore used to ensures that image presentation is complete before starting to submit again
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, presentCompleteSemaphore.pHandle()));
-
-    // Semaphore used to ensures that all commands submitted have been finished before submitting
-    // the image to the queue
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, renderCompleteSemaphore.pHandle()));
-}
-
 void Sample_08_3DModel::updateUniformBuffers()
 {
     shaderData.values.projection = mCamera.matrices.perspective;
     shaderData.values.model      = mCamera.matrices.view;
 
-    mUniformBuffer->copyFrom(&shaderData.values, sizeof(shaderData.values));
+    updateUniformBuffer(*mUniformBuffer, &shaderData.values, sizeof(shaderData.values));
 }
 
 void Sample_08_3DModel::setupDescriptorSetLayout()
@@ -127,7 +110,6 @@ void Sample_08_3DModel::prepare(JNIEnv *env)
 
         initCameraView();
 
-        prepareSynchronizationPrimitives();
         prepareUniformBuffers();
         setupDescriptorPool();
         setupDescriptorSetLayout();
@@ -150,7 +132,9 @@ void Sample_08_3DModel::initCameraView()
 
 void Sample_08_3DModel::prepare3DModel(JNIEnv *env)
 {
-    vkglTF::setupAssetManager(mAssetManager);
+    vkglTF::setupAssetLoader(mAssets);
+    // Only the position, the normal and uv0 are read by the shaders
+    models.scene.vertexLayout = vkglTF::VertexLayout::compact(false);
     models.scene.loadFromFile(mModelPath, deviceWrapper(), mGraphicsQueue);
 }
 
@@ -245,22 +229,16 @@ void Sample_08_3DModel::preparePipelines()
     // Vertex input descriptions
     // Specifies the vertex input parameters for a pipeline
 
-    // Vertex input bindings and attributes
-    VkVertexInputBindingDescription vertexInputBinding = {0, sizeof(vkglTF::Model::Vertex), VK_VERTEX_INPUT_RATE_VERTEX};
-
-    std::vector<VkVertexInputAttributeDescription> vertexInputAttributes = {
-        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(vkglTF::Model::Vertex, pos)},
-        {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(vkglTF::Model::Vertex, normal)},
-        {2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(vkglTF::Model::Vertex, uv0)},
-        {3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(vkglTF::Model::Vertex, uv1)},
-        {4, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(vkglTF::Model::Vertex, joint0)},
-        {5, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(vkglTF::Model::Vertex, weight0)}};
+    // Vertex input bindings and attributes, from the layout the model was loaded in
+    std::vector<VkVertexInputBindingDescription>   vertexInputBindings;
+    std::vector<VkVertexInputAttributeDescription> vertexInputAttributes;
+    models.scene.vertexLayout.vertexInput(vertexInputBindings, vertexInputAttributes);
 
     // Vertex input state used for pipeline creation
     VkPipelineVertexInputStateCreateInfo vertexInputState = {};
     vertexInputState.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputState.vertexBindingDescriptionCount        = 1;
-    vertexInputState.pVertexBindingDescriptions           = &vertexInputBinding;
+    vertexInputState.vertexBindingDescriptionCount        = static_cast<uint32_t>(vertexInputBindings.size());
+    vertexInputState.pVertexBindingDescriptions           = vertexInputBindings.data();
     vertexInputState.vertexAttributeDescriptionCount =
         static_cast<uint32_t>(vertexInputAttributes.size());
     vertexInputState.pVertexAttributeDescriptions = vertexInputAttributes.data();
@@ -293,10 +271,6 @@ void Sample_08_3DModel::preparePipelines()
     // Create rendering pipeline using the specified states
     CALL_VK(vkCreateGraphicsPipelines(
         device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
-
-    // Shader modules are no longer needed once the graphics pipeline has been created
-    vkDestroyShaderModule(device(), shaderStages[0].module, nullptr);
-    vkDestroyShaderModule(device(), shaderStages[1].module, nullptr);
 }
 
 void Sample_08_3DModel::setupDescriptorSet()
@@ -481,10 +455,8 @@ void Sample_08_3DModel::buildCommandBuffers()
         vkCmdBindPipeline(
             drawCmdBuffers[i].handle(), VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline.handle());
 
-        const VkDeviceSize offsets[1]  = {0};
-        auto               verticesBuf = models.scene.vertices.buffer->getBufferHandle();
-        auto               indicesBuf  = models.scene.indices.buffer->getBufferHandle();
-        vkCmdBindVertexBuffers(drawCmdBuffers[i].handle(), 0, 1, &verticesBuf, offsets);
+        auto indicesBuf = models.scene.indices.buffer->getBufferHandle();
+        models.scene.bindVertexBuffers(drawCmdBuffers[i].handle());
         vkCmdBindIndexBuffer(drawCmdBuffers[i].handle(), indicesBuf, 0, VK_INDEX_TYPE_UINT32);
 
         for (auto node : models.scene.nodes)
@@ -37,8 +37,6 @@ class Sample_08_3DModel : public VulkanContextBase
   private:
     void initCameraView();
 
-    void prepareSynchronizationPrimitives();
-
     void updateUniformBuffers();
 
     void setupDescriptorSetLayout();
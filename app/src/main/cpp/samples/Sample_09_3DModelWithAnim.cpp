@@ -32,29 +32,12 @@ void Sample_09_3DModelWithAnim::set3DModelPath(std::string path)
     mModelPath = path;
 }
 
-void Sample_09_3DModelWithAnim::prepareSynchronizationPrimitives()
-{
-    // Semaphores (Used for correct command ordering)
-    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
-    semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext                 = nullptr;
-
-    // Semaphore used to ensures that image presentation is complete before starting to submit again
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, presentCompleteSemaphore.pHandle()));
-
-    // Semaphore used to ensures that all commands submitted have been finished before submitting
-    // the image to the queue
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, renderCompleteSemaphore.pHandle()));
-}
-
 void Sample_09_3DModelWithAnim::updateUniformBuffers()
 {
     shaderData.values.projection = mCamera.matrices.perspective;
     shaderData.values.model      = mCamera.matrices.view;
 
-    mUniformBuffer->copyFrom(&shaderData.values, sizeof(shaderData.values));
+    updateUniformBuffer(*mUniformBuffer, &shaderData.values, sizeof(shaderData.values));
 }
 
 void Sample_09_3DModelWithAnim::setupDescriptorSetLayout()
@@ -127,7 +110,6 @@ void Sample_09_3DModelWithAnim::prepare(JNIEnv *env)
 
         initCameraView();
 
-        prepareSynchronizationPrimitives();
         prepareUniformBuffers();
         setupDescriptorPool();
         setupDescriptorSetLayout();
@@ -150,8 +132,22 @@ void Sample_09_3DModelWithAnim::initCameraView()
 
 void Sample_09_3DModelWithAnim::prepare3DModel(JNIEnv *env)
 {
-    vkglTF::setupAssetManager(mAssetManager);
+    vkglTF::setupAssetLoader(mAssets);
     animModels.scene.loadFromFile(mModelPath, deviceWrapper(), mGraphicsQueue);
+
+    mSkinner = vkglTF::ComputeSkinner::create(
+        &animModels.scene,
+        mPipelineCache.handle(),
+        loadShader(vkglTF::ComputeSkinner::shaderPath(), VK_SHADER_STAGE_COMPUTE_BIT));
+    if (mSkinner)
+    {
+        // Skin the bind pose for the first frame, recorded after the vertex upload
+        mSkinner->update();
+    }
+    else
+    {
+        LOGCATE("Sample_09_3DModelWithAnim: Failed to create the compute skinner, skinning in the vertex shader");
+    }
 }
 
 void Sample_09_3DModelWithAnim::preparePipelines()
@@ -245,22 +241,17 @@ void Sample_09_3DModelWithAnim::preparePipelines()
     // Vertex input descriptions
     // Specifies the vertex input parameters for a pipeline
 
-    // Vertex input bindings and attributes
-    VkVertexInputBindingDescription vertexInputBinding = {0, sizeof(vkglTF::Model::Vertex), VK_VERTEX_INPUT_RATE_VERTEX};
-
-    std::vector<VkVertexInputAttributeDescription> vertexInputAttributes = {
-        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(vkglTF::Model::Vertex, pos)},
-        {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(vkglTF::Model::Vertex, normal)},
-        {2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(vkglTF::Model::Vertex, uv0)},
-        {3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(vkglTF::Model::Vertex, uv1)},
-        {4, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(vkglTF::Model::Vertex, joint0)},
-        {5, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(vkglTF::Model::Vertex, weight0)}};
+    // Vertex input bindings and attributes, from the layout the model was loaded in.
+    // ComputeSkinner writes the skinned vertices in the same layout
+    std::vector<VkVertexInputBindingDescription>   vertexInputBindings;
+    std::vector<VkVertexInputAttributeDescription> vertexInputAttributes;
+    animModels.scene.vertexLayout.vertexInput(vertexInputBindings, vertexInputAttributes);
 
     // Vertex input state used for pipeline creation
     VkPipelineVertexInputStateCreateInfo vertexInputState = {};
     vertexInputState.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputState.vertexBindingDescriptionCount        = 1;
-    vertexInputState.pVertexBindingDescriptions           = &vertexInputBinding;
+    vertexInputState.vertexBindingDescriptionCount        = static_cast<uint32_t>(vertexInputBindings.size());
+    vertexInputState.pVertexBindingDescriptions           = vertexInputBindings.data();
     vertexInputState.vertexAttributeDescriptionCount =
         static_cast<uint32_t>(vertexInputAttributes.size());
     vertexInputState.pVertexAttributeDescriptions = vertexInputAttributes.data();
@@ -268,8 +259,9 @@ void Sample_09_3DModelWithAnim::preparePipelines()
     // Shaders
     std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
 
-    // Vertex shader
-    shaderStages[0] = loadShader(vertFilePath,
+    // Vertex shader, the skinned variant takes the vertices skinned by mSkinner and only applies
+    // the mesh matrix
+    shaderStages[0] = loadShader(mSkinner ? "shaders/shader_09_3dmodel_with_anim_skinned.vert.spv" : vertFilePath,
                                  VK_SHADER_STAGE_VERTEX_BIT);
     // Fragment shader
     shaderStages[1] = loadShader(fragFilePath,
@@ -293,10 +285,6 @@ void Sample_09_3DModelWithAnim::preparePipelines()
     // Create rendering pipeline using the specified states
     CALL_VK(vkCreateGraphicsPipelines(
         device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
-
-    // Shader modules are no longer needed once the graphics pipeline has been created
-    vkDestroyShaderModule(device(), shaderStages[0].module, nullptr);
-    vkDestroyShaderModule(device(), shaderStages[1].module, nullptr);
 }
 
 void Sample_09_3DModelWithAnim::setupDescriptorSet()
@@ -437,7 +425,8 @@ void Sample_09_3DModelWithAnim::buildCommandBuffers()
             drawCmdBuffers[i].handle(), VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline.handle());
 
         const VkDeviceSize offsets[1]  = {0};
-        auto               verticesBuf = animModels.scene.vertices.buffer->getBufferHandle();
+        auto               verticesBuf = mSkinner ? mSkinner->skinnedVertices()->getBufferHandle()
+                                                  : animModels.scene.vertices.buffer->getBufferHandle();
         auto               indicesBuf  = animModels.scene.indices.buffer->getBufferHandle();
         vkCmdBindVertexBuffers(drawCmdBuffers[i].handle(), 0, 1, &verticesBuf, offsets);
         vkCmdBindIndexBuffer(drawCmdBuffers[i].handle(), indicesBuf, 0, VK_INDEX_TYPE_UINT32);
@@ -525,6 +514,10 @@ void Sample_09_3DModelWithAnim::draw()
             animationTimer -= animModels.scene.animations[0].end;
         }
         animModels.scene.updateAnimation(0, animationTimer);
+        if (mSkinner)
+        {
+            mSkinner->update();
+        }
     }
 }
 
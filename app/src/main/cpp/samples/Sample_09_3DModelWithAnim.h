@@ -31,14 +31,13 @@
 
 #include "VulkanInitializers.hpp"
 #include "VulkanglTFModel.h"
+#include "VulkanglTFSkinning.h"
 
 class Sample_09_3DModelWithAnim : public VulkanContextBase
 {
   private:
     void initCameraView();
 
-    void prepareSynchronizationPrimitives();
-
     void updateUniformBuffers();
 
     void setupDescriptorSetLayout();
@@ -58,6 +57,10 @@ class Sample_09_3DModelWithAnim : public VulkanContextBase
         vkglTF::Model scene;
     } animModels;
 
+    // Skins the vertices once per frame for all the passes, nullptr if it could not be created.
+    // The pipeline then blends the joints in the vertex shader as before.
+    std::unique_ptr<vkglTF::ComputeSkinner> mSkinner;
+
     struct DescriptorSetLayouts
     {
         VulkanDescriptorSetLayout ubo      = VulkanDescriptorSetLayout(VK_NULL_HANDLE);
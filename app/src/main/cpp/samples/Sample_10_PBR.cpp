@@ -28,28 +28,16 @@
 
 #include "VulkanglTFModel.h"
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
 void Sample_10_PBR::set3DModelPath(std::string path)
 {
     mModelPath = path;
 }
 
-void Sample_10_PBR::prepareSynchronizationPrimitives()
-{
-    // Semaphores (Used for correct command ordering)
-    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
-    semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext                 = nullptr;
-
-    // Semaphore used to ensures that image presentation is complete before starting to submit again
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, presentCompleteSemaphore.pHandle()));
-
-    // Semaphore used to ensures that all commands submitted have been finished before submitting
-    // the image to the queue
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, renderCompleteSemaphore.pHandle()));
-}
-
 void Sample_10_PBR::updateUniformBuffers()
 {
     // Scene
@@ -79,9 +67,9 @@ void Sample_10_PBR::updateUniformBuffers()
 
     for (auto &uniformBuffer : uniformBuffers)
     {
-        uniformBuffer.scene->copyFrom(&shaderValuesScene, sizeof(shaderValuesScene));
-        uniformBuffer.skybox->copyFrom(&shaderValuesSkybox, sizeof(shaderValuesSkybox));
-        uniformBuffer.params->copyFrom(&shaderValuesParams, sizeof(shaderValuesParams));
+        updateUniformBuffer(*uniformBuffer.scene, &shaderValuesScene, sizeof(shaderValuesScene));
+        updateUniformBuffer(*uniformBuffer.skybox, &shaderValuesSkybox, sizeof(shaderValuesSkybox));
+        updateUniformBuffer(*uniformBuffer.params, &shaderValuesParams, sizeof(shaderValuesParams));
     }
 }
 
@@ -199,7 +187,6 @@ void Sample_10_PBR::prepare(JNIEnv *env)
 
         initCameraView();
 
-        prepareSynchronizationPrimitives();
         prepareUniformBuffers();
         setupDescriptorPool();
         setupDescriptorSetLayout();
@@ -213,6 +200,41 @@ void Sample_10_PBR::prepare(JNIEnv *env)
     updateUniformBuffers();
 }
 
+void Sample_10_PBR::runBenchmarks()
+{
+    vkglTF::setupAssetLoader(mAssets);
+    vks::UploadManager *uploadManager = deviceWrapper()->getUploadManager();
+
+    const int      iterations      = 3;
+    const uint32_t threadCounts[2] = {1, 0};
+    double         milliseconds[2] = {};
+    size_t         counts[2][3]    = {};
+    for (int mode = 0; mode < 2; mode++)
+    {
+        for (int i = 0; i < iterations; i++)
+        {
+            vkglTF::Model model;
+            const auto    start = std::chrono::high_resolution_clock::now();
+            model.loadFromFile(mModelPath, deviceWrapper(), mGraphicsQueue, 1.0f, threadCounts[mode]);
+            // Done once the copies and mip blits have run
+            uploadManager->wait(uploadManager->pendingToken());
+            milliseconds[mode] +=
+                std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() /
+                iterations;
+
+            counts[mode][0] = model.linearNodes.size();
+            counts[mode][1] = model.indices.count;
+            counts[mode][2] = model.textures.size();
+            model.destroy(device());
+        }
+    }
+
+    const bool match = std::equal(counts[0], counts[0] + 3, counts[1]);
+    LOGCATI("glTF load %s: %zu nodes, %zu indices, %zu textures; 1 thread %.1f ms, %u threads %.1f ms%s",
+            mModelPath.c_str(), counts[1][0], counts[1][1], counts[1][2], milliseconds[0],
+            std::thread::hardware_concurrency(), milliseconds[1], match ? "" : ", MISMATCH");
+}
+
 void Sample_10_PBR::initCameraView()
 {
     mCamera.type          = Camera::CameraType::lookat;
@@ -224,7 +246,7 @@ void Sample_10_PBR::initCameraView()
 
 void Sample_10_PBR::prepare3DModel(JNIEnv *env)
 {
-    vkglTF::setupAssetManager(mAssetManager);
+    vkglTF::setupAssetLoader(mAssets);
     pbrModels.scene.destroy(device());
     pbrModels.scene.loadFromFile(mModelPath, deviceWrapper(), mGraphicsQueue);
 
@@ -233,7 +255,7 @@ void Sample_10_PBR::prepare3DModel(JNIEnv *env)
     std::string           envMapFile = "environments/papermill.ktx";
     Image::ImageBasicInfo imageInfo  = {format: VK_FORMAT_R16G16B16A16_SFLOAT,
                                        usage: VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT};
-    textures.environmentCube         = vks::Image::createCubeMapFromFile(deviceWrapper(), mGraphicsQueue, mAssetManager, envMapFile, imageInfo);
+    textures.environmentCube         = vks::Image::createCubeMapFromFile(deviceWrapper(), mGraphicsQueue, *mAssets, envMapFile, imageInfo);
     generateCubemaps();
     generateBRDFLUT();
 }
@@ -395,7 +417,7 @@ void Sample_10_PBR::generateCubemaps()
             framebufferCI.layers          = 1;
             CALL_VK(vkCreateFramebuffer(deviceWrapper()->logicalDevice, &framebufferCI, nullptr, &offscreen.framebuffer));
 
-            VkCommandBuffer      layoutCmd = deviceWrapper()->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+            VkCommandBuffer      layoutCmd = deviceWrapper()->getUploadManager()->graphicsCommands();
             VkImageMemoryBarrier imageMemoryBarrier{};
             imageMemoryBarrier.sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
             imageMemoryBarrier.image            = offscreen.image;
@@ -405,7 +427,6 @@ void Sample_10_PBR::generateCubemaps()
             imageMemoryBarrier.dstAccessMask    = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
             imageMemoryBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
             vkCmdPipelineBarrier(layoutCmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
-            deviceWrapper()->endAndSubmitSingleTimeCommand(layoutCmd, mGraphicsQueue, true);
         }
 
         // Descriptors
@@ -568,10 +589,6 @@ void Sample_10_PBR::generateCubemaps()
         VkPipeline pipeline;
         CALL_VK(vkCreateGraphicsPipelines(device(), mPipelineCache.handle(), 1, &pipelineCI, nullptr, &pipeline));
         vks::debug::setPipelineName(device(), pipeline, "generateCube_pipeline");
-        for (auto shaderStage : shaderStages)
-        {
-            vkDestroyShaderModule(device(), shaderStage.module, nullptr);
-        }
 
         // Render cubemap
         VkClearValue clearValues[1];
@@ -595,7 +612,10 @@ void Sample_10_PBR::generateCubemaps()
             glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
         };
 
-        VkCommandBuffer cmdBuf = mDeviceWrapper->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, false);
+        // All the faces and mip levels are rendered in the upload batch, it is submitted together
+        // with the model and texture uploads ahead of the first frame instead of one blocking
+        // submission per face
+        VkCommandBuffer cmdBuf = mDeviceWrapper->getUploadManager()->graphicsCommands();
 
         VkViewport viewport{};
         viewport.width    = (float) dim;
@@ -615,7 +635,6 @@ void Sample_10_PBR::generateCubemaps()
 
         // Change image layout for all cubemap faces to transfer destination
         {
-            mDeviceWrapper->beginCommandBuffer(cmdBuf);
             VkImageMemoryBarrier imageMemoryBarrier{};
             imageMemoryBarrier.sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
             imageMemoryBarrier.image            = cubemap->getImageHandle();
@@ -625,15 +644,12 @@ void Sample_10_PBR::generateCubemaps()
             imageMemoryBarrier.dstAccessMask    = VK_ACCESS_TRANSFER_WRITE_BIT;
             imageMemoryBarrier.subresourceRange = subresourceRange;
             vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
-            mDeviceWrapper->endAndSubmitSingleTimeCommand(cmdBuf, mGraphicsQueue, false);
         }
 
         for (uint32_t m = 0; m < numMips; m++)
         {
             for (uint32_t f = 0; f < 6; f++)
             {
-                mDeviceWrapper->beginCommandBuffer(cmdBuf);
-
                 viewport.width  = static_cast<float>(dim * std::pow(0.5f, m));
                 viewport.height = static_cast<float>(dim * std::pow(0.5f, m));
                 vkCmdSetViewport(cmdBuf, 0, 1, &viewport);
@@ -722,13 +738,10 @@ void Sample_10_PBR::generateCubemaps()
                     imageMemoryBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
                     vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
                 }
-
-                mDeviceWrapper->endAndSubmitSingleTimeCommand(cmdBuf, mGraphicsQueue, false);
             }
         }
 
         {
-            mDeviceWrapper->beginCommandBuffer(cmdBuf);
             VkImageMemoryBarrier imageMemoryBarrier{};
             imageMemoryBarrier.sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
             imageMemoryBarrier.image            = cubemap->getImageHandle();
@@ -738,18 +751,20 @@ void Sample_10_PBR::generateCubemaps()
             imageMemoryBarrier.dstAccessMask    = VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
             imageMemoryBarrier.subresourceRange = subresourceRange;
             vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
-            mDeviceWrapper->endAndSubmitSingleTimeCommand(cmdBuf, mGraphicsQueue, false);
         }
 
-        vkDestroyRenderPass(device(), renderpass, nullptr);
-        vkDestroyFramebuffer(device(), offscreen.framebuffer, nullptr);
-        vkFreeMemory(device(), offscreen.memory, nullptr);
-        vkDestroyImageView(device(), offscreen.view, nullptr);
-        vkDestroyImage(device(), offscreen.image, nullptr);
-        vkDestroyDescriptorPool(device(), descriptorpool, nullptr);
-        vkDestroyDescriptorSetLayout(device(), descriptorsetlayout, nullptr);
-        vkDestroyPipeline(device(), pipeline, nullptr);
-        vkDestroyPipelineLayout(device(), pipelinelayout, nullptr);
+        // The recorded commands still refer to the temporary objects
+        mDeviceWrapper->getUploadManager()->deferUntilComplete([device = device(), renderpass, offscreen, descriptorpool, descriptorsetlayout, pipeline, pipelinelayout]() {
+            vkDestroyRenderPass(device, renderpass, nullptr);
+            vkDestroyFramebuffer(device, offscreen.framebuffer, nullptr);
+            vkFreeMemory(device, offscreen.memory, nullptr);
+            vkDestroyImageView(device, offscreen.view, nullptr);
+            vkDestroyImage(device, offscreen.image, nullptr);
+            vkDestroyDescriptorPool(device, descriptorpool, nullptr);
+            vkDestroyDescriptorSetLayout(device, descriptorsetlayout, nullptr);
+            vkDestroyPipeline(device, pipeline, nullptr);
+            vkDestroyPipelineLayout(device, pipelinelayout, nullptr);
+        });
 
         switch (target)
         {
@@ -764,7 +779,7 @@ void Sample_10_PBR::generateCubemaps()
 
         auto tEnd  = std::chrono::high_resolution_clock::now();
         auto tDiff = std::chrono::duration<double, std::milli>(tEnd - tStart).count();
-        LOGCATI("Generating cube map with %d  mip levels took %d ms", numMips, tDiff);
+        LOGCATI("Recording cube map generation with %d mip levels took %.2f ms", numMips, tDiff);
     }
 }
 
@@ -934,10 +949,6 @@ void Sample_10_PBR::generateBRDFLUT()
     VkPipeline pipeline;
     CALL_VK(vkCreateGraphicsPipelines(device(), mPipelineCache.handle(), 1, &pipelineCI, nullptr, &pipeline));
     vks::debug::setPipelineName(device(), pipeline, "generateBRDFLUT_pipeline");
-    for (auto shaderStage : shaderStages)
-    {
-        vkDestroyShaderModule(device(), shaderStage.module, nullptr);
-    }
 
     // Render
     VkClearValue clearValues[1];
@@ -952,7 +963,8 @@ void Sample_10_PBR::generateBRDFLUT()
     renderPassBeginInfo.pClearValues             = clearValues;
     renderPassBeginInfo.framebuffer              = framebuffer;
 
-    VkCommandBuffer cmdBuf = mDeviceWrapper->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+    // Rendered in the upload batch, ahead of the first frame that samples the LUT
+    VkCommandBuffer cmdBuf = mDeviceWrapper->getUploadManager()->graphicsCommands();
     vkCmdBeginRenderPass(cmdBuf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     VkViewport viewport{};
@@ -970,19 +982,18 @@ void Sample_10_PBR::generateBRDFLUT()
     vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
     vkCmdDraw(cmdBuf, 3, 1, 0, 0);
     vkCmdEndRenderPass(cmdBuf);
-    mDeviceWrapper->endAndSubmitSingleTimeCommand(cmdBuf, mGraphicsQueue);
 
-    vkQueueWaitIdle(mGraphicsQueue);
-
-    vkDestroyPipeline(device(), pipeline, nullptr);
-    vkDestroyPipelineLayout(device(), pipelinelayout, nullptr);
-    vkDestroyRenderPass(device(), renderpass, nullptr);
-    vkDestroyFramebuffer(device(), framebuffer, nullptr);
-    vkDestroyDescriptorSetLayout(device(), descriptorsetlayout, nullptr);
+    mDeviceWrapper->getUploadManager()->deferUntilComplete([device = device(), pipeline, pipelinelayout, renderpass, framebuffer, descriptorsetlayout]() {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, pipelinelayout, nullptr);
+        vkDestroyRenderPass(device, renderpass, nullptr);
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+        vkDestroyDescriptorSetLayout(device, descriptorsetlayout, nullptr);
+    });
 
     auto tEnd  = std::chrono::high_resolution_clock::now();
     auto tDiff = std::chrono::duration<double, std::milli>(tEnd - tStart).count();
-    LOGCATI("Generating BRDF LUT took %d ms", tDiff);
+    LOGCATI("Recording BRDF LUT generation took %.2f ms", tDiff);
 }
 
 void Sample_10_PBR::preparePipelines()
@@ -1071,39 +1082,30 @@ void Sample_10_PBR::preparePipelines()
     // Vertex input descriptions
     // Specifies the vertex input parameters for a pipeline
 
-    // Vertex input bindings and attributes
-    VkVertexInputBindingDescription vertexInputBinding = {0, sizeof(vkglTF::Model::Vertex), VK_VERTEX_INPUT_RATE_VERTEX};
-
-    std::vector<VkVertexInputAttributeDescription> vertexInputAttributes = {
-        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(vkglTF::Model::Vertex, pos)},
-        {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(vkglTF::Model::Vertex, normal)},
-        {2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(vkglTF::Model::Vertex, uv0)},
-        {3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(vkglTF::Model::Vertex, uv1)},
-        {4, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(vkglTF::Model::Vertex, joint0)},
-        {5, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(vkglTF::Model::Vertex, weight0)}};
+    // Vertex input bindings and attributes, from the layout the models were loaded in.
+    // The skybox and the scene are both in the standard one
+    std::vector<VkVertexInputBindingDescription>   vertexInputBindings;
+    std::vector<VkVertexInputAttributeDescription> vertexInputAttributes;
+    pbrModels.scene.vertexLayout.vertexInput(vertexInputBindings, vertexInputAttributes);
 
     // Vertex input state used for pipeline creation
     VkPipelineVertexInputStateCreateInfo vertexInputState = {};
     vertexInputState.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputState.vertexBindingDescriptionCount        = 1;
-    vertexInputState.pVertexBindingDescriptions           = &vertexInputBinding;
+    vertexInputState.vertexBindingDescriptionCount        = static_cast<uint32_t>(vertexInputBindings.size());
+    vertexInputState.pVertexBindingDescriptions           = vertexInputBindings.data();
     vertexInputState.vertexAttributeDescriptionCount =
         static_cast<uint32_t>(vertexInputAttributes.size());
     vertexInputState.pVertexAttributeDescriptions = vertexInputAttributes.data();
 
     // Shaders
-    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
-
-    // Vertex shader
-    shaderStages[0] = loadShader("shaders/base/skybox.vert.spv",
-                                 VK_SHADER_STAGE_VERTEX_BIT);
-    // Fragment shader
-    shaderStages[1] = loadShader("shaders/base/skybox.frag.spv",
-                                 VK_SHADER_STAGE_FRAGMENT_BIT);
-
-    // Set pipeline shader stage info
-    pipelineCreateInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
-    pipelineCreateInfo.pStages    = shaderStages.data();
+    std::array<VkPipelineShaderStageCreateInfo, 2> skyboxShaderStages = {
+        loadShader("shaders/base/skybox.vert.spv", VK_SHADER_STAGE_VERTEX_BIT),
+        loadShader("shaders/base/skybox.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    std::array<VkPipelineShaderStageCreateInfo, 2> pbrShaderStages = {
+        loadShader(vertFilePath, VK_SHADER_STAGE_VERTEX_BIT),
+        loadShader(fragFilePath, VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
 
     // Assign the pipeline states to the pipeline creation info structure
     pipelineCreateInfo.pVertexInputState   = &vertexInputState;
@@ -1116,38 +1118,63 @@ void Sample_10_PBR::preparePipelines()
     pipelineCreateInfo.renderPass          = mRenderPass;
     pipelineCreateInfo.pDynamicState       = &dynamicState;
 
-    // Skybox pipeline (background cube)
-    pipelines.skybox = VulkanPipeline(device());
-    CALL_VK(vkCreateGraphicsPipelines(
-        device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, pipelines.skybox.pHandle()));
-    vks::debug::setPipelineName(device(), pipelines.skybox.handle(), "pipelines.skybox");
+    // The three pipelines only differ by their shaders and blending, each gets its own copy of
+    // the create info so that they are compiled in parallel
 
-    // Shader modules are no longer needed once the graphics pipeline has been created
-    vkDestroyShaderModule(device(), shaderStages[0].module, nullptr);
-    vkDestroyShaderModule(device(), shaderStages[1].module, nullptr);
+    // Skybox pipeline (background cube)
+    VkGraphicsPipelineCreateInfo skyboxCreateInfo = pipelineCreateInfo;
+    skyboxCreateInfo.stageCount                   = static_cast<uint32_t>(skyboxShaderStages.size());
+    skyboxCreateInfo.pStages                      = skyboxShaderStages.data();
 
     // PBR pipeline
-    shaderStages[0]                    = loadShader(vertFilePath,
-                                 VK_SHADER_STAGE_VERTEX_BIT);
-    shaderStages[1]                    = loadShader(fragFilePath,
-                                 VK_SHADER_STAGE_FRAGMENT_BIT);
-    depthStencilState.depthWriteEnable = VK_TRUE;
-    depthStencilState.depthTestEnable  = VK_TRUE;
+    VkGraphicsPipelineCreateInfo pbrCreateInfo = pipelineCreateInfo;
+    pbrCreateInfo.stageCount                   = static_cast<uint32_t>(pbrShaderStages.size());
+    pbrCreateInfo.pStages                      = pbrShaderStages.data();
+
+    // PBR pipeline with alpha blending
+    VkPipelineColorBlendAttachmentState alphaBlendAttachmentState = blendAttachmentState;
+    alphaBlendAttachmentState.blendEnable                         = VK_TRUE;
+    alphaBlendAttachmentState.srcColorBlendFactor                 = VK_BLEND_FACTOR_SRC_ALPHA;
+    alphaBlendAttachmentState.dstColorBlendFactor                 = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    alphaBlendAttachmentState.colorBlendOp                        = VK_BLEND_OP_ADD;
+    alphaBlendAttachmentState.srcAlphaBlendFactor                 = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    alphaBlendAttachmentState.dstAlphaBlendFactor                 = VK_BLEND_FACTOR_ZERO;
+    alphaBlendAttachmentState.alphaBlendOp                        = VK_BLEND_OP_ADD;
+    VkPipelineColorBlendStateCreateInfo alphaColorBlendState      = colorBlendState;
+    alphaColorBlendState.pAttachments                             = &alphaBlendAttachmentState;
+    VkGraphicsPipelineCreateInfo pbrAlphaBlendCreateInfo          = pbrCreateInfo;
+    pbrAlphaBlendCreateInfo.pColorBlendState                      = &alphaColorBlendState;
+
+    auto skybox        = pipelineBuilder()->createGraphicsPipeline(skyboxCreateInfo);
+    auto pbr           = pipelineBuilder()->createGraphicsPipeline(pbrCreateInfo);
+    auto pbrAlphaBlend = pipelineBuilder()->createGraphicsPipeline(pbrAlphaBlendCreateInfo);
+
+    // The states above are read by the workers, wait before leaving the scope
+    pipelines.skybox                   = VulkanPipeline(device());
+    *pipelines.skybox.pHandle()        = skybox.get();
     pipelines.pbr                      = VulkanPipeline(device());
-    CALL_VK(vkCreateGraphicsPipelines(device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, pipelines.pbr.pHandle()));
+    *pipelines.pbr.pHandle()           = pbr.get();
+    pipelines.pbrAlphaBlend            = VulkanPipeline(device());
+    *pipelines.pbrAlphaBlend.pHandle() = pbrAlphaBlend.get();
+    // Unlike an assert alone, each failed pipeline is also reported in release builds
+    bool failed = false;
+    for (const auto &[pipeline, name] : {std::make_pair(&pipelines.skybox, "skybox"),
+                                         std::make_pair(&pipelines.pbr, "pbr"),
+                                         std::make_pair(&pipelines.pbrAlphaBlend, "pbrAlphaBlend")})
+    {
+        if (pipeline->handle() == VK_NULL_HANDLE)
+        {
+            LOGCATE("Sample_10_PBR::preparePipelines: Failed to create the %s pipeline", name);
+            failed = true;
+        }
+    }
+    if (failed)
+    {
+        assert(false);
+        return;
+    }
+    vks::debug::setPipelineName(device(), pipelines.skybox.handle(), "pipelines.skybox");
     vks::debug::setPipelineName(device(), pipelines.pbr.handle(), "pipelines.pbr");
-
-    rasterizationState.cullMode              = VK_CULL_MODE_NONE;
-    blendAttachmentState.blendEnable         = VK_TRUE;
-    blendAttachmentState.colorWriteMask      = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    blendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-    blendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-    blendAttachmentState.colorBlendOp        = VK_BLEND_OP_ADD;
-    blendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-    blendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-    blendAttachmentState.alphaBlendOp        = VK_BLEND_OP_ADD;
-    pipelines.pbrAlphaBlend                  = VulkanPipeline(device());
-    CALL_VK(vkCreateGraphicsPipelines(device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, pipelines.pbrAlphaBlend.pHandle()));
     vks::debug::setPipelineName(device(), pipelines.pbrAlphaBlend.handle(), "pipelines.pbrAlphaBlend");
 }
 
@@ -1449,8 +1476,6 @@ void Sample_10_PBR::buildCommandBuffers()
         scissor.offset.y      = 0;
         vkCmdSetScissor(drawCmdBuffers[i].handle(), 0, 1, &scissor);
 
-        VkDeviceSize offsets[1] = {0};
-
         if (displayBackground)
         {
             vkCmdBindDescriptorSets(drawCmdBuffers[i].handle(), VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout.handle(), 0, 1, &descriptorSets[i].skybox, 0, nullptr);
@@ -1463,8 +1488,7 @@ void Sample_10_PBR::buildCommandBuffers()
 
         vkglTF::Model &model = pbrModels.scene;
 
-        auto vertexBuf = model.vertices.buffer->getBufferHandle();
-        vkCmdBindVertexBuffers(drawCmdBuffers[i].handle(), 0, 1, &vertexBuf, offsets);
+        model.bindVertexBuffers(drawCmdBuffers[i].handle());
         if (model.indices.buffer != VK_NULL_HANDLE)
         {
             vkCmdBindIndexBuffer(drawCmdBuffers[i].handle(), model.indices.buffer->getBufferHandle(), 0, VK_INDEX_TYPE_UINT32);
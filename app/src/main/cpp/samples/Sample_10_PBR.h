@@ -37,8 +37,6 @@ class Sample_10_PBR : public VulkanContextBase
   private:
     void initCameraView();
 
-    void prepareSynchronizationPrimitives();
-
     void updateUniformBuffers();
 
     void setupDescriptorSetLayout();
@@ -169,6 +167,10 @@ class Sample_10_PBR : public VulkanContextBase
 
     virtual void draw();
 
+    // Load the scene on the calling thread and on one thread per core, including the uploads, and
+    // log the times and whether both loads agree
+    virtual void runBenchmarks() override;
+
     virtual void onTouchActionMove(float deltaX, float deltaY);
 
     virtual void unInit(JNIEnv *env) override;
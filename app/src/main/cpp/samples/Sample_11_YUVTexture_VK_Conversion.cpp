@@ -31,25 +31,30 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-void Sample_11_YUVTexture_VK_Conversion::setYUVImage(uint8_t *data, uint32_t w, uint32_t h)
+void Sample_11_YUVTexture_VK_Conversion::setYUVImage(uint8_t *data, uint32_t w, uint32_t h,
+                                                     vks::yuv::ChromaLayout layout)
 {
     mYUVData = {
-        .data = data,
-        .w    = w,
-        .h    = h,
+        .data   = data,
+        .w      = w,
+        .h      = h,
+        .layout = layout,
     };
 }
 
-void Sample_11_YUVTexture_VK_Conversion::prepareYUVImage()
+bool Sample_11_YUVTexture_VK_Conversion::prepareYUVImage()
 {
-    Image::ImageBasicInfo imageInfo = {
-        extent: {mYUVData.w, mYUVData.h, 1},
-        usage: VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        format: VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM
-    };
-    mYUVImage = Image::createDeviceLocal(mDeviceWrapper,
-                                         mGraphicsQueue,
-                                         imageInfo);
+    // The images and their conversion come from the pool, a new frame of the same size reuses the
+    // image instead of creating one
+    mImagePool = vks::YCbCrImagePool::create(mDeviceWrapper, mGraphicsQueue);
+    if (mImagePool == nullptr || !mImagePool->isSupported(mYUVData.layout))
+    {
+        LOGCATE("Sample_11_YUVTexture_VK_Conversion: Layout %d can not be sampled", static_cast<int>(mYUVData.layout));
+        return false;
+    }
+    mChromaLayout = mYUVData.layout;
+    mYUVImage     = mImagePool->acquire(mChromaLayout, mYUVData.w, mYUVData.h);
+    return mYUVImage != nullptr;
 }
 
 void Sample_11_YUVTexture_VK_Conversion::prepare(JNIEnv *env)
@@ -58,9 +63,9 @@ void Sample_11_YUVTexture_VK_Conversion::prepare(JNIEnv *env)
     {
         VulkanContextBase::prepare(env);
 
-        prepareYUVImage();
+        if (!prepareYUVImage())
+            return;
 
-        prepareSynchronizationPrimitives();
         prepareVertices(true, g_vb_bitmap_texture_Data, sizeof(g_vb_bitmap_texture_Data));
         setupDescriptorPool();
         setupDescriptorSetLayout();
@@ -72,12 +77,37 @@ void Sample_11_YUVTexture_VK_Conversion::prepare(JNIEnv *env)
         mPrepared = true;
     }
 
-    updateTexture();
+    // prepare() is also called on touch, only a new frame is uploaded
+    if (mYUVData.data != nullptr)
+    {
+        updateTexture();
+    }
 }
 
 void Sample_11_YUVTexture_VK_Conversion::updateTexture()
 {
+    if (mYUVData.layout != mChromaLayout)
+    {
+        // The sampler of the layout is baked into the descriptor set layout and the pipeline
+        LOGCATE("Sample_11_YUVTexture_VK_Conversion: Can not switch from layout %d to %d",
+                static_cast<int>(mChromaLayout), static_cast<int>(mYUVData.layout));
+        mYUVData.data = nullptr;
+        return;
+    }
+
+    if (mYUVImage->width() != mYUVData.w || mYUVImage->height() != mYUVData.h)
+    {
+        // The descriptor set is used by the frames in flight, the size rarely changes
+        vkDeviceWaitIdle(device());
+        mImagePool->release(mChromaLayout, std::move(mYUVImage));
+        mYUVImage = mImagePool->acquire(mChromaLayout, mYUVData.w, mYUVData.h);
+        writeImageDescriptor();
+        updateUniformBuffers();
+    }
+
+    // The upload waits for the frames still sampling the image on the GPU
     mYUVImage->setYUVContentForYCbCrImage(mYUVData.data, mYUVData.w * mYUVData.h * 3 / 2);
+    mYUVData.data = nullptr;
 }
 
 void Sample_11_YUVTexture_VK_Conversion::setupDescriptorPool()
@@ -124,7 +154,8 @@ void Sample_11_YUVTexture_VK_Conversion::setupDescriptorSetLayout()
     layoutBinding[0].pImmutableSamplers = nullptr;
 
     // Binding 2: Combined Image Sampler (Fragment shader)
-    auto yuvSampler                     = mYUVImage->getSamplerHandle();
+    // Shared by all the images of the layout taken from the pool
+    auto yuvSampler                     = mImagePool->sampler(mChromaLayout);
     layoutBinding[1]                    = {};
     layoutBinding[1].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     layoutBinding[1].binding            = 1;
@@ -167,7 +198,7 @@ void Sample_11_YUVTexture_VK_Conversion::setupDescriptorSet()
     // For every binding point used in a shader there needs to be one
     // descriptor set matching that binding point
 
-    VkWriteDescriptorSet writeDescriptorSet[2];
+    VkWriteDescriptorSet writeDescriptorSet[1];
 
     // Binding 0 : Uniform buffer
     auto uboDescriptor                    = mUniformBuffer->getDescriptor();
@@ -180,35 +211,25 @@ void Sample_11_YUVTexture_VK_Conversion::setupDescriptorSet()
     // Binds this uniform buffer to binding point 0
     writeDescriptorSet[0].dstBinding = 0;
 
-    // Binding 1 : Combined Image Sampler
-    VkDescriptorImageInfo descriptors     = mYUVImage->getDescriptor();
-    writeDescriptorSet[1]                 = {};
-    writeDescriptorSet[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writeDescriptorSet[1].dstSet          = mDescriptorSet;
-    writeDescriptorSet[1].descriptorCount = 1;
-    writeDescriptorSet[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    writeDescriptorSet[1].pImageInfo      = &descriptors;
-    // Binds this image to binding point 1
-    writeDescriptorSet[1].dstBinding = 1;
+    vkUpdateDescriptorSets(device(), 1, writeDescriptorSet, 0, nullptr);
 
-    vkUpdateDescriptorSets(device(), 2, writeDescriptorSet, 0, nullptr);
+    writeImageDescriptor();
 }
 
-void Sample_11_YUVTexture_VK_Conversion::prepareSynchronizationPrimitives()
+void Sample_11_YUVTexture_VK_Conversion::writeImageDescriptor()
 {
-    // Semaphores (Used for correct command ordering)
-    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
-    semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext                 = nullptr;
-
-    // Semaphore used to ensures that image presentation is complete before starting to submit again
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, presentCompleteSemaphore.pHandle()));
-
-    // Semaphore used to ensures that all commands submitted have been finished before submitting
-    // the image to the queue
-    CALL_VK(vkCreateSemaphore(
-        device(), &semaphoreCreateInfo, nullptr, renderCompleteSemaphore.pHandle()));
+    // Binding 1 : Combined Image Sampler, the sampler is the immutable one of the layout
+    VkDescriptorImageInfo descriptors        = mYUVImage->getDescriptor();
+    VkWriteDescriptorSet  writeDescriptorSet = {};
+    writeDescriptorSet.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.dstSet          = mDescriptorSet;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writeDescriptorSet.pImageInfo      = &descriptors;
+    // Binds this image to binding point 1
+    writeDescriptorSet.dstBinding = 1;
+
+    vkUpdateDescriptorSets(device(), 1, &writeDescriptorSet, 0, nullptr);
 }
 
 void Sample_11_YUVTexture_VK_Conversion::prepareUniformBuffers()
@@ -251,7 +272,7 @@ void Sample_11_YUVTexture_VK_Conversion::updateUniformBuffers()
         uboVS.modelMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(bmpRatio / winRatio, 1.0f, 1.0f));
     }
 
-    mUniformBuffer->copyFrom(&uboVS, sizeof(uboVS));
+    updateUniformBuffer(*mUniformBuffer, &uboVS, sizeof(uboVS));
 }
 
 void Sample_11_YUVTexture_VK_Conversion::preparePipelines()
@@ -405,10 +426,6 @@ void Sample_11_YUVTexture_VK_Conversion::preparePipelines()
     // Create rendering pipeline using the specified states
     CALL_VK(vkCreateGraphicsPipelines(
         device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
-
-    // Shader modules are no longer needed once the graphics pipeline has been created
-    vkDestroyShaderModule(device(), shaderStages[0].module, nullptr);
-    vkDestroyShaderModule(device(), shaderStages[1].module, nullptr);
 }
 
 void Sample_11_YUVTexture_VK_Conversion::buildCommandBuffers()
@@ -510,4 +527,6 @@ void Sample_11_YUVTexture_VK_Conversion::draw()
 Sample_11_YUVTexture_VK_Conversion::~Sample_11_YUVTexture_VK_Conversion()
 {
     vkDeviceWaitIdle(device());
+    // Before the pool owning the conversion of the image
+    mYUVImage.reset();
 }
\ No newline at end of file
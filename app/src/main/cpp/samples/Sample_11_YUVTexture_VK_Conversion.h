@@ -27,22 +27,28 @@
 
 #include <VulkanContextBase.h>
 #include <VulkanImageWrapper.h>
+#include <VulkanYCbCrImagePool.h>
+#include <YUVUtil.h>
 #include <array>
 
 class Sample_11_YUVTexture_VK_Conversion : public VulkanContextBase
 {
   private:
-    // Images
-    std::unique_ptr<Image> mYUVImage;
+    // Images, the pool has to outlive the image taken from it
+    std::unique_ptr<vks::YCbCrImagePool> mImagePool;
+    std::unique_ptr<Image>               mYUVImage;
 
+    // Frame set by setYUVImage, only valid until it is uploaded by the next prepare()
     struct YUVData
     {
-        uint8_t *data;
-        uint32_t w;
-        uint32_t h;
-    } mYUVData;
+        uint8_t               *data;
+        uint32_t               w;
+        uint32_t               h;
+        vks::yuv::ChromaLayout layout;
+    } mYUVData = {};
 
-    void prepareSynchronizationPrimitives();
+    // Layout of mYUVImage, the immutable sampler of the descriptor set layout is created for it
+    vks::yuv::ChromaLayout mChromaLayout = vks::yuv::ChromaLayout::I420;
 
     void updateUniformBuffers();
 
@@ -52,6 +58,8 @@ class Sample_11_YUVTexture_VK_Conversion : public VulkanContextBase
 
     void updateTexture();
 
+    void writeImageDescriptor();
+
   public:
     Sample_11_YUVTexture_VK_Conversion() :
         VulkanContextBase("shaders/shader_11_yuv_vk_conversion.vert.spv",
@@ -70,9 +78,11 @@ class Sample_11_YUVTexture_VK_Conversion : public VulkanContextBase
 
     virtual void draw();
 
-    void setYUVImage(uint8_t *data, uint32_t w, uint32_t h);
+    // Packed I420 (Y, U, V) or NV12/NV21 (Y, interleaved chroma) frame, uploaded by the next prepare()
+    void setYUVImage(uint8_t *data, uint32_t w, uint32_t h,
+                     vks::yuv::ChromaLayout layout = vks::yuv::ChromaLayout::I420);
 
-    void prepareYUVImage();
+    bool prepareYUVImage();
 
     ~Sample_11_YUVTexture_VK_Conversion();
 };
@@ -0,0 +1,565 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Sample_12_CameraHardwareBuffer.h"
+
+#include "includes/cube_data.h"
+
+#define GLM_FORCE_RADIANS
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+void Sample_12_CameraHardwareBuffer::setHardwareBuffer(AHardwareBuffer *buffer, uint32_t orientation)
+{
+    if (mImporter == nullptr)
+    {
+        mImporter = HardwareBufferImporter::create(mDeviceWrapper);
+        if (mImporter == nullptr)
+            return;
+        mImageCache = std::make_unique<ExternalImageCache<AHardwareBuffer, Image>>(mImporter.get(), IMAGE_CACHE_SIZE);
+    }
+
+    auto image = mImageCache->acquire(buffer);
+    if (image == nullptr)
+    {
+        LOGCATE("Sample_12_CameraHardwareBuffer: failed to import the camera buffer");
+        return;
+    }
+    mCameraImage = image;
+    mOrientation = orientation;
+}
+
+void Sample_12_CameraHardwareBuffer::prepare(JNIEnv *env)
+{
+    if (mCameraImage == nullptr)
+        return;
+
+    if (!mPrepared)
+    {
+        VulkanContextBase::prepare(env);
+
+        mDescriptorSets.resize(drawCmdBuffers.size(), VK_NULL_HANDLE);
+        mBoundImages.resize(drawCmdBuffers.size());
+
+        prepareVertices(true, g_vb_bitmap_texture_Data, sizeof(g_vb_bitmap_texture_Data));
+        setupDescriptorPool();
+        setupDescriptorSetLayout();
+        prepareUniformBuffers();
+        setupDescriptorSet();
+        preparePipelines();
+        mConversionGeneration = mImporter->conversionGeneration();
+
+        mPrepared = true;
+    }
+    else if (mConversionGeneration != mImporter->conversionGeneration())
+    {
+        rebuildForConversion();
+    }
+
+    updateUniformBuffers();
+}
+
+void Sample_12_CameraHardwareBuffer::rebuildForConversion()
+{
+    // The old sampler is baked into the set layout and the pipeline layout
+    vkDeviceWaitIdle(device());
+    {
+        // Destroyed at the end of the scope, the descriptor sets are freed with the pool
+        auto pipeline            = std::move(mPipeline);
+        auto pipelineLayout      = std::move(mPipelineLayout);
+        auto descriptorSetLayout = std::move(mDescriptorSetLayout);
+        auto descriptorPool      = std::move(mDescriptorPool);
+    }
+    std::fill(mBoundImages.begin(), mBoundImages.end(), nullptr);
+
+    setupDescriptorPool();
+    setupDescriptorSetLayout();
+    setupDescriptorSet();
+    preparePipelines();
+    mConversionGeneration = mImporter->conversionGeneration();
+}
+
+void Sample_12_CameraHardwareBuffer::setupDescriptorPool()
+{
+    const uint32_t setCount = static_cast<uint32_t>(mDescriptorSets.size());
+
+    // We need to tell the API the number of max. requested descriptors per type
+    VkDescriptorPoolSize typeCounts[2];
+    typeCounts[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    typeCounts[0].descriptorCount = setCount;
+    // A YCbCr sampler may consume more than one descriptor (one per plane), reserve three
+    typeCounts[1].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    typeCounts[1].descriptorCount = setCount * 3;
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
+    descriptorPoolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.pNext                      = nullptr;
+    descriptorPoolInfo.poolSizeCount              = 2;
+    descriptorPoolInfo.pPoolSizes                 = typeCounts;
+    descriptorPoolInfo.maxSets                    = setCount;
+
+    CALL_VK(
+        vkCreateDescriptorPool(device(), &descriptorPoolInfo, nullptr, mDescriptorPool.pHandle()));
+}
+
+void Sample_12_CameraHardwareBuffer::setupDescriptorSetLayout()
+{
+    VkDescriptorSetLayoutBinding layoutBinding[2];
+    // Binding 0: Uniform buffer (Vertex shader)
+    layoutBinding[0]                    = {};
+    layoutBinding[0].descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    layoutBinding[0].binding            = 0;
+    layoutBinding[0].descriptorCount    = 1;
+    layoutBinding[0].stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
+    layoutBinding[0].pImmutableSamplers = nullptr;
+
+    // Binding 1: Combined Image Sampler (Fragment shader)
+    // Samplers with a YCbCr conversion can only be used as immutable samplers
+    auto cameraSampler                  = mImporter->sampler();
+    layoutBinding[1]                    = {};
+    layoutBinding[1].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    layoutBinding[1].binding            = 1;
+    layoutBinding[1].descriptorCount    = 1;
+    layoutBinding[1].stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
+    layoutBinding[1].pImmutableSamplers = &cameraSampler;
+
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
+    descriptorLayout.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptorLayout.bindingCount                    = 2;
+    descriptorLayout.pBindings                       = layoutBinding;
+
+    CALL_VK(vkCreateDescriptorSetLayout(
+        device(), &descriptorLayout, nullptr, mDescriptorSetLayout.pHandle()));
+
+    VkPipelineLayoutCreateInfo pPipelineLayoutCreateInfo = {};
+    pPipelineLayoutCreateInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pPipelineLayoutCreateInfo.setLayoutCount             = 1;
+    pPipelineLayoutCreateInfo.pSetLayouts                = mDescriptorSetLayout.pHandle();
+
+    CALL_VK(vkCreatePipelineLayout(
+        device(), &pPipelineLayoutCreateInfo, nullptr, mPipelineLayout.pHandle()));
+}
+
+void Sample_12_CameraHardwareBuffer::setupDescriptorSet()
+{
+    std::vector<VkDescriptorSetLayout> layouts(mDescriptorSets.size(), mDescriptorSetLayout.handle());
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = mDescriptorPool.handle();
+    allocInfo.descriptorSetCount          = static_cast<uint32_t>(layouts.size());
+    allocInfo.pSetLayouts                 = layouts.data();
+
+    CALL_VK(vkAllocateDescriptorSets(device(), &allocInfo, mDescriptorSets.data()));
+
+    // Binding 0 : Uniform buffer, the camera image is written per frame by updateDescriptorSet
+    auto uboDescriptor = mUniformBuffer->getDescriptor();
+    for (VkDescriptorSet descriptorSet : mDescriptorSets)
+    {
+        VkWriteDescriptorSet writeDescriptorSet = {};
+        writeDescriptorSet.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSet.dstSet               = descriptorSet;
+        writeDescriptorSet.descriptorCount      = 1;
+        writeDescriptorSet.descriptorType       = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writeDescriptorSet.pBufferInfo          = &uboDescriptor;
+        writeDescriptorSet.dstBinding           = 0;
+        vkUpdateDescriptorSets(device(), 1, &writeDescriptorSet, 0, nullptr);
+    }
+}
+
+void Sample_12_CameraHardwareBuffer::updateDescriptorSet(uint32_t index)
+{
+    // Binding 1 : Combined Image Sampler, the sampler is immutable so only the view is written
+    VkDescriptorImageInfo descriptor      = {VK_NULL_HANDLE, mCameraImage->getImageViewHandle(),
+                                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    VkWriteDescriptorSet  writeDescriptorSet = {};
+    writeDescriptorSet.sType                 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.dstSet                = mDescriptorSets[index];
+    writeDescriptorSet.descriptorCount       = 1;
+    writeDescriptorSet.descriptorType        = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writeDescriptorSet.pImageInfo            = &descriptor;
+    writeDescriptorSet.dstBinding            = 1;
+    vkUpdateDescriptorSets(device(), 1, &writeDescriptorSet, 0, nullptr);
+
+    mBoundImages[index] = mCameraImage;
+}
+
+void Sample_12_CameraHardwareBuffer::prepareUniformBuffers()
+{
+    mUniformBuffer =
+        vks::Buffer::create(mDeviceWrapper,
+                            sizeof(uboVS),
+                            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    mUniformBuffer->map();
+}
+
+void Sample_12_CameraHardwareBuffer::updateUniformBuffers()
+{
+    float winRatio =
+        static_cast<float>(mWindow.windowWidth) / static_cast<float>(mWindow.windowHeight);
+
+    uint32_t bmpWidth  = mCameraImage->width();
+    uint32_t bmpHeight = mCameraImage->height();
+
+    // Pass matrices to the shaders
+    uboVS.projectionMatrix = glm::mat4(1.0f);
+    uboVS.viewMatrix       = glm::mat4(1.0f);
+
+    if (mOrientation % 180 != 0)
+    {
+        std::swap(bmpWidth, bmpHeight);
+    }
+
+    float bmpRatio = static_cast<float>(bmpWidth) / static_cast<float>(bmpHeight);
+
+    if (bmpRatio >= winRatio)
+    {
+        // The bitmap's width is to large and the width is compressed, so we compress the height
+        uboVS.modelMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, winRatio / bmpRatio, 1.0f));
+    }
+    else
+    {
+        // The bitmap's height is to large and the height is compressed, so we compress the width
+        uboVS.modelMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(bmpRatio / winRatio, 1.0f, 1.0f));
+    }
+
+    uboVS.modelMatrix = glm::rotate(uboVS.modelMatrix,
+                                    glm::radians((float) mOrientation),
+                                    glm::vec3(0.0f, 0.0f, 1.0f));
+
+    updateUniformBuffer(*mUniformBuffer, &uboVS, sizeof(uboVS));
+}
+
+void Sample_12_CameraHardwareBuffer::preparePipelines()
+{
+    // Create the graphics pipeline used in this example
+    // Vulkan uses the concept of rendering pipelines to encapsulate fixed states, replacing
+    // OpenGL's complex state machine A pipeline is then stored and hashed on the GPU making
+    // pipeline changes very fast Note: There are still a few dynamic states that are not directly
+    // part of the pipeline (but the info that they are used is)
+
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = {};
+    pipelineCreateInfo.sType                        = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    // The layout used for this pipeline (can be shared among multiple pipelines using the same
+    // layout)
+    pipelineCreateInfo.layout = mPipelineLayout.handle();
+    // Renderpass this pipeline is attached to
+    pipelineCreateInfo.renderPass = mRenderPass;
+
+    // Construct the different states making up the pipeline
+
+    // Input assembly state describes how primitives are assembled
+    // This pipeline will assemble vertex data as a triangle lists (though we only use one triangle)
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = {};
+    inputAssemblyState.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssemblyState.topology                               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    // Rasterization state
+    VkPipelineRasterizationStateCreateInfo rasterizationState = {};
+    rasterizationState.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizationState.polygonMode                            = VK_POLYGON_MODE_FILL;
+    rasterizationState.cullMode                               = VK_CULL_MODE_NONE;
+    rasterizationState.frontFace                              = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizationState.depthClampEnable                       = VK_FALSE;
+    rasterizationState.rasterizerDiscardEnable                = VK_FALSE;
+    rasterizationState.depthBiasEnable                        = VK_FALSE;
+    rasterizationState.lineWidth                              = 1.0f;
+
+    // Color blend state describes how blend factors are calculated (if used)
+    // We need one blend attachment state per color attachment (even if blending is not used)
+    VkPipelineColorBlendAttachmentState blendAttachmentState[1] = {};
+    blendAttachmentState[0].colorWriteMask                      = 0xf;
+    blendAttachmentState[0].blendEnable                         = VK_FALSE;
+    VkPipelineColorBlendStateCreateInfo colorBlendState         = {};
+    colorBlendState.sType                                       = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlendState.attachmentCount                             = 1;
+    colorBlendState.pAttachments                                = blendAttachmentState;
+
+    // Viewport state sets the number of viewports and scissor used in this pipeline
+    // Note: This is actually overridden by the dynamic states (see below)
+    VkPipelineViewportStateCreateInfo viewportState = {};
+    viewportState.sType                             = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount                     = 1;
+    viewportState.scissorCount                      = 1;
+
+    // Enable dynamic states
+    // Most states are baked into the pipeline, but there are still a few dynamic states that can be
+    // changed within a command buffer To be able to change these we need do specify which dynamic
+    // states will be changed using this pipeline. Their actual states are set later on in the
+    // command buffer. For this example we will set the viewport and scissor using dynamic states
+    std::vector<VkDynamicState> dynamicStateEnables;
+    dynamicStateEnables.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+    dynamicStateEnables.push_back(VK_DYNAMIC_STATE_SCISSOR);
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType                            = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.pDynamicStates                   = dynamicStateEnables.data();
+    dynamicState.dynamicStateCount                = static_cast<uint32_t>(dynamicStateEnables.size());
+
+    // Depth and stencil state containing depth and stencil compare and test operations
+    // We only use depth tests and want depth tests and writes to be enabled and compare with less
+    // or equal
+    VkPipelineDepthStencilStateCreateInfo depthStencilState = {};
+    depthStencilState.sType                                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencilState.depthTestEnable                       = VK_TRUE;
+    depthStencilState.depthWriteEnable                      = VK_TRUE;
+    depthStencilState.depthCompareOp                        = VK_COMPARE_OP_LESS_OR_EQUAL;
+    depthStencilState.depthBoundsTestEnable                 = VK_FALSE;
+    depthStencilState.back.failOp                           = VK_STENCIL_OP_KEEP;
+    depthStencilState.back.passOp                           = VK_STENCIL_OP_KEEP;
+    depthStencilState.back.compareOp                        = VK_COMPARE_OP_ALWAYS;
+    depthStencilState.stencilTestEnable                     = VK_FALSE;
+    depthStencilState.front                                 = depthStencilState.back;
+
+    // Multi sampling state
+    // This example does not make use of multi sampling (for anti-aliasing), the state must still be
+    // set and passed to the pipeline
+    VkPipelineMultisampleStateCreateInfo multisampleState = {};
+    multisampleState.sType                                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampleState.rasterizationSamples                 = VK_SAMPLE_COUNT_1_BIT;
+    multisampleState.pSampleMask                          = nullptr;
+
+    // Vertex input descriptions
+    // Specifies the vertex input parameters for a pipeline
+
+    // Vertex input binding
+    // This example uses a single vertex input binding at binding point 0 (see
+    // vkCmdBindVertexBuffers)
+    VkVertexInputBindingDescription vertexInputBinding = {};
+    vertexInputBinding.binding                         = 0;
+    vertexInputBinding.stride                          = sizeof(VertexUV);
+    vertexInputBinding.inputRate                       = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    // Input attribute bindings describe shader attribute locations and memory layouts
+    std::array<VkVertexInputAttributeDescription, 2> vertexInputAttributs;
+    // These match the following shader layout (see shader_01_triangle.vert):
+    //	layout (location = 0) in vec4 inPos;
+    //	layout (location = 1) in vec2 inUVPos;
+    // Attribute location 0: Position
+    vertexInputAttributs[0].binding  = 0;
+    vertexInputAttributs[0].location = 0;
+    // Position attribute is four 32 bit signed (SFLOAT) floats (R32 G32 B32)
+    vertexInputAttributs[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    vertexInputAttributs[0].offset = offsetof(VertexUV, posX);
+    // Attribute location 1: Color
+    vertexInputAttributs[1].binding  = 0;
+    vertexInputAttributs[1].location = 1;
+    // Color attribute is two 32 bit signed (SFLOAT) floats (R32 G32)
+    vertexInputAttributs[1].format = VK_FORMAT_R32G32_SFLOAT;
+    vertexInputAttributs[1].offset = offsetof(VertexUV, u);
+
+    // Vertex input state used for pipeline creation
+    VkPipelineVertexInputStateCreateInfo vertexInputState = {};
+    vertexInputState.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputState.vertexBindingDescriptionCount        = 1;
+    vertexInputState.pVertexBindingDescriptions           = &vertexInputBinding;
+    vertexInputState.vertexAttributeDescriptionCount      = 2;
+    vertexInputState.pVertexAttributeDescriptions         = vertexInputAttributs.data();
+
+    // Shaders
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
+
+    // Vertex shader
+    shaderStages[0] = loadShader(vertFilePath, VK_SHADER_STAGE_VERTEX_BIT);
+    // Fragment shader
+    shaderStages[1] = loadShader(fragFilePath, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    // Set pipeline shader stage info
+    pipelineCreateInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+    pipelineCreateInfo.pStages    = shaderStages.data();
+
+    // Assign the pipeline states to the pipeline creation info structure
+    pipelineCreateInfo.pVertexInputState   = &vertexInputState;
+    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineCreateInfo.pRasterizationState = &rasterizationState;
+    pipelineCreateInfo.pColorBlendState    = &colorBlendState;
+    pipelineCreateInfo.pMultisampleState   = &multisampleState;
+    pipelineCreateInfo.pViewportState      = &viewportState;
+    pipelineCreateInfo.pDepthStencilState  = &depthStencilState;
+    pipelineCreateInfo.renderPass          = mRenderPass;
+    pipelineCreateInfo.pDynamicState       = &dynamicState;
+
+    // Create rendering pipeline using the specified states
+    CALL_VK(vkCreateGraphicsPipelines(
+        device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
+}
+
+void Sample_12_CameraHardwareBuffer::buildCommandBuffers()
+{
+    // The command buffers are recorded per frame in draw(), once the descriptor set of the swap
+    // chain image points at the latest camera buffer
+}
+
+void Sample_12_CameraHardwareBuffer::recordCommandBuffer(uint32_t index)
+{
+    VkCommandBuffer cmdBuffer = drawCmdBuffers[index].handle();
+
+    VkCommandBufferBeginInfo cmdBufInfo = {};
+    cmdBufInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBufInfo.pNext                    = nullptr;
+    cmdBufInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    CALL_VK(vkBeginCommandBuffer(cmdBuffer, &cmdBufInfo));
+
+    // The camera owns the buffer between frames. Acquire it from the foreign queue family, this
+    // also makes the writes of the camera visible to the fragment shader.
+    VkImageMemoryBarrier acquireBarrier            = {};
+    acquireBarrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    acquireBarrier.srcAccessMask                   = 0;
+    acquireBarrier.dstAccessMask                   = VK_ACCESS_SHADER_READ_BIT;
+    acquireBarrier.oldLayout                       = VK_IMAGE_LAYOUT_GENERAL;
+    acquireBarrier.newLayout                       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    acquireBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_FOREIGN_EXT;
+    acquireBarrier.dstQueueFamilyIndex             = mDeviceWrapper->queueFamilyIndices.graphics;
+    acquireBarrier.image                           = mBoundImages[index]->getImageHandle();
+    acquireBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    acquireBarrier.subresourceRange.baseMipLevel   = 0;
+    acquireBarrier.subresourceRange.levelCount     = 1;
+    acquireBarrier.subresourceRange.baseArrayLayer = 0;
+    acquireBarrier.subresourceRange.layerCount     = 1;
+    vkCmdPipelineBarrier(cmdBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &acquireBarrier);
+
+    VkClearValue clearValues[2];
+    clearValues[0].color        = {{0.0f, 0.0f, 0.2f, 1.0f}};
+    clearValues[1].depthStencil = {1.0f, 0};
+
+    VkRenderPassBeginInfo renderPassBeginInfo    = {};
+    renderPassBeginInfo.sType                    = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBeginInfo.pNext                    = nullptr;
+    renderPassBeginInfo.renderPass               = mRenderPass;
+    renderPassBeginInfo.renderArea.offset.x      = 0;
+    renderPassBeginInfo.renderArea.offset.y      = 0;
+    renderPassBeginInfo.renderArea.extent.width  = mWindow.windowWidth;
+    renderPassBeginInfo.renderArea.extent.height = mWindow.windowHeight;
+    renderPassBeginInfo.clearValueCount          = 2;
+    renderPassBeginInfo.pClearValues             = clearValues;
+    renderPassBeginInfo.framebuffer              = frameBuffers[index];
+
+    vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport = {};
+    viewport.height     = (float) mWindow.windowHeight;
+    viewport.width      = (float) mWindow.windowWidth;
+    viewport.minDepth   = (float) 0.0f;
+    viewport.maxDepth   = (float) 1.0f;
+    vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor      = {};
+    scissor.extent.width  = mWindow.windowWidth;
+    scissor.extent.height = mWindow.windowHeight;
+    scissor.offset.x      = 0;
+    scissor.offset.y      = 0;
+    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+    vkCmdBindDescriptorSets(cmdBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            mPipelineLayout.handle(),
+                            0,
+                            1,
+                            &mDescriptorSets[index],
+                            0,
+                            nullptr);
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline.handle());
+
+    VkDeviceSize offsets[1]  = {0};
+    auto         verticesBuf = mVerticesBuffer->getBufferHandle();
+    vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &verticesBuf, offsets);
+
+    vkCmdDraw(cmdBuffer,
+              sizeof(g_vb_bitmap_texture_Data) / sizeof(g_vb_bitmap_texture_Data[0]),
+              1,
+              0,
+              0);
+
+    drawUI(cmdBuffer);
+
+    vkCmdEndRenderPass(cmdBuffer);
+
+    // Hand the buffer back to the camera
+    VkImageMemoryBarrier releaseBarrier = acquireBarrier;
+    releaseBarrier.srcAccessMask        = VK_ACCESS_SHADER_READ_BIT;
+    releaseBarrier.dstAccessMask        = 0;
+    releaseBarrier.oldLayout            = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    releaseBarrier.newLayout            = VK_IMAGE_LAYOUT_GENERAL;
+    releaseBarrier.srcQueueFamilyIndex  = mDeviceWrapper->queueFamilyIndices.graphics;
+    releaseBarrier.dstQueueFamilyIndex  = VK_QUEUE_FAMILY_FOREIGN_EXT;
+    vkCmdPipelineBarrier(cmdBuffer,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &releaseBarrier);
+
+    CALL_VK(vkEndCommandBuffer(cmdBuffer));
+}
+
+void Sample_12_CameraHardwareBuffer::draw()
+{
+    if (!mPrepared)
+        return;
+
+    prepareFrame();
+
+    // prepareFrame waited for the last frame rendered into this swap chain image, its descriptor
+    // set and command buffer are free to be pointed at the new camera buffer
+    updateDescriptorSet(currentBuffer);
+    recordCommandBuffer(currentBuffer);
+
+    FrameSync &frame = currentFrameSync();
+
+    VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSubmitInfo         submitInfo    = {};
+    submitInfo.sType                   = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pWaitDstStageMask       = &waitStageMask;
+    submitInfo.pWaitSemaphores         = frame.presentCompleteSemaphore.pHandle();
+    submitInfo.waitSemaphoreCount      = 1;
+    submitInfo.pSignalSemaphores       = frame.renderCompleteSemaphore.pHandle();
+    submitInfo.signalSemaphoreCount    = 1;
+    submitInfo.pCommandBuffers         = drawCmdBuffers[currentBuffer].pHandle();
+    submitInfo.commandBufferCount      = 1;
+
+    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, frame.inFlightFence.handle()));
+
+    submitFrame();
+}
+
+Sample_12_CameraHardwareBuffer::~Sample_12_CameraHardwareBuffer()
+{
+    vkDeviceWaitIdle(device());
+}
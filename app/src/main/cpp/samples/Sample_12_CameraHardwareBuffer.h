@@ -0,0 +1,96 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_SAMPLE_12_CAMERAHARDWAREBUFFER_H
+#define GAINVULKANSAMPLE_SAMPLE_12_CAMERAHARDWAREBUFFER_H
+
+#include <ExternalImageCache.h>
+#include <VulkanContextBase.h>
+#include <VulkanHardwareBufferImporter.h>
+#include <VulkanImageWrapper.h>
+#include <array>
+
+// Camera preview sampling the AHardwareBuffers of the ImageReader directly: no CPU copy and no
+// staging upload per frame. The ImageReader cycles through a few buffers, each one is imported
+// once and then served from the image cache.
+class Sample_12_CameraHardwareBuffer : public VulkanContextBase
+{
+  private:
+    // The BufferQueue of the ImageReader cycles through maxImages buffers plus the ones the camera
+    // keeps dequeued
+    static constexpr size_t IMAGE_CACHE_SIZE = 8;
+
+    std::unique_ptr<HardwareBufferImporter>                     mImporter;
+    std::unique_ptr<ExternalImageCache<AHardwareBuffer, Image>> mImageCache;
+
+    // Latest camera frame
+    std::shared_ptr<Image> mCameraImage;
+    uint32_t               mOrientation = 0;
+
+    // The conversion the set layout and pipeline were created with
+    uint32_t mConversionGeneration = 0;
+
+    // One set per swap chain image, a set is rewritten once the frame using it has completed
+    std::vector<VkDescriptorSet> mDescriptorSets;
+    // Images referenced by the command buffer of each swap chain image, kept alive until it is
+    // recorded again
+    std::vector<std::shared_ptr<Image>> mBoundImages;
+
+    void updateUniformBuffers();
+
+    void setupDescriptorSetLayout();
+
+    void setupDescriptorPool();
+
+    // Recreate the objects built on the immutable sampler after the importer replaced it
+    void rebuildForConversion();
+
+    void updateDescriptorSet(uint32_t index);
+
+    void recordCommandBuffer(uint32_t index);
+
+  public:
+    Sample_12_CameraHardwareBuffer() :
+        VulkanContextBase("shaders/shader_12_camera_hardwarebuffer.vert.spv",
+                          "shaders/shader_12_camera_hardwarebuffer.frag.spv")
+    {}
+
+    virtual void prepare(JNIEnv *env) override;
+
+    virtual void preparePipelines() override;
+
+    virtual void setupDescriptorSet();
+
+    virtual void buildCommandBuffers() override;
+
+    virtual void prepareUniformBuffers();
+
+    virtual void draw();
+
+    void setHardwareBuffer(AHardwareBuffer *buffer, uint32_t orientation);
+
+    ~Sample_12_CameraHardwareBuffer();
+};
+
+#endif        //GAINVULKANSAMPLE_SAMPLE_12_CAMERAHARDWAREBUFFER_H
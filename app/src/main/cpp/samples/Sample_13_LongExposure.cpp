@@ -0,0 +1,738 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Sample_13_LongExposure.h"
+
+#include "includes/cube_data.h"
+
+#define GLM_FORCE_RADIANS
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+void Sample_13_LongExposure::setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w,
+                                         uint32_t h, uint32_t yStride, uint32_t uStride,
+                                         uint32_t vStride, uint32_t uPixelStride,
+                                         uint32_t vPixelStride, uint32_t orientation)
+{
+    mYUVImages[0] = {
+        .data        = yData,
+        .w           = w,
+        .h           = h,
+        .stride      = yStride,
+        .orientation = orientation,
+    };
+    mYUVImages[1] = {
+        .data        = uData,
+        .w           = w / 2,
+        .h           = h / 2,
+        .stride      = uStride,
+        .pixelStride = uPixelStride,
+        .orientation = orientation,
+    };
+    mYUVImages[2] = {
+        .data        = vData,
+        .w           = w / 2,
+        .h           = h / 2,
+        .stride      = vStride,
+        .pixelStride = vPixelStride,
+        .orientation = orientation,
+    };
+}
+
+void Sample_13_LongExposure::setMode(FrameAccumulator::Mode mode, float decay)
+{
+    std::lock_guard<std::mutex> lock(mModeMutex);
+    mRequestedMode  = mode;
+    mRequestedDecay = decay;
+    mResetRequested = true;
+}
+
+void Sample_13_LongExposure::prepareYUVImage()
+{
+    mYUVConverter = YUVPlaneConverter::create(
+        deviceWrapper(),
+        mGraphicsQueue,
+        mPipelineCache.handle(),
+        loadShader(YUVPlaneConverter::shaderPath(YUVPlaneConverter::Output::RGBA),
+                   VK_SHADER_STAGE_COMPUTE_BIT),
+        YUVPlaneConverter::Output::RGBA,
+        mYUVImages[0].w,
+        mYUVImages[0].h);
+
+    // Half floats are filtered by the sampler on all devices and hold a few hundred frames
+    mAccumulator = FrameAccumulator::create(
+        deviceWrapper(),
+        mGraphicsQueue,
+        mPipelineCache.handle(),
+        loadShader(FrameAccumulator::shaderPath(FrameAccumulator::Precision::HALF),
+                   VK_SHADER_STAGE_COMPUTE_BIT),
+        FrameAccumulator::Precision::HALF,
+        mYUVImages[0].w,
+        mYUVImages[0].h);
+    mAccumulator->reset(mRequestedMode, mRequestedDecay);
+}
+
+void Sample_13_LongExposure::prepare(JNIEnv *env)
+{
+    if (!mPrepared)
+    {
+        VulkanContextBase::prepare(env);
+
+        prepareYUVImage();
+
+        prepareVertices(true, g_vb_bitmap_texture_Data, sizeof(g_vb_bitmap_texture_Data));
+        setupDescriptorPool();
+        setupDescriptorSetLayout();
+        prepareUniformBuffers();
+        setupDescriptorSet();
+        preparePipelines();
+        buildCommandBuffers();
+
+        mPrepared = true;
+    }
+
+    updateTexture();
+}
+
+void Sample_13_LongExposure::updateTexture()
+{
+    {
+        std::lock_guard<std::mutex> lock(mModeMutex);
+        if (mResetRequested)
+        {
+            mAccumulator->reset(mRequestedMode, mRequestedDecay);
+            mResetRequested = false;
+        }
+    }
+
+    yuv::Frame frame;
+    frame.y            = mYUVImages[0].data;
+    frame.u            = mYUVImages[1].data;
+    frame.v            = mYUVImages[2].data;
+    frame.width        = mYUVImages[0].w;
+    frame.height       = mYUVImages[0].h;
+    frame.yStride      = mYUVImages[0].stride;
+    frame.uStride      = mYUVImages[1].stride;
+    frame.vStride      = mYUVImages[2].stride;
+    frame.uPixelStride = mYUVImages[1].pixelStride;
+    frame.vPixelStride = mYUVImages[2].pixelStride;
+    if (mYUVConverter->convert(frame) && mAccumulator->accumulate(*mYUVConverter->rgbaImage()))
+    {
+        mDisplayedSet = static_cast<int32_t>(mAccumulator->resultIndex());
+    }
+}
+
+void Sample_13_LongExposure::setupDescriptorPool()
+{
+    // One set per accumulator image, each with the uniform buffer and the image sampler
+    VkDescriptorPoolSize typeCounts[2];
+    typeCounts[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    typeCounts[0].descriptorCount = 2;
+    typeCounts[1].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    typeCounts[1].descriptorCount = 2;
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
+    descriptorPoolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.pNext                      = nullptr;
+    descriptorPoolInfo.poolSizeCount              = 2;
+    descriptorPoolInfo.pPoolSizes                 = typeCounts;
+    descriptorPoolInfo.maxSets                    = 2;
+
+    CALL_VK(
+        vkCreateDescriptorPool(device(), &descriptorPoolInfo, nullptr, mDescriptorPool.pHandle()));
+}
+
+void Sample_13_LongExposure::setupDescriptorSetLayout()
+{
+    // Setup layout of descriptors used in this example
+    // Basically connects the different shader stages to descriptors for binding uniform buffers,
+    // image samplers, etc. So every shader binding should map to one descriptor set layout binding
+
+    VkDescriptorSetLayoutBinding layoutBinding[2];
+    // Binding 0: Uniform buffer (Vertex shader)
+    layoutBinding[0]                    = {};
+    layoutBinding[0].descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    layoutBinding[0].binding            = 0;
+    layoutBinding[0].descriptorCount    = 1;
+    layoutBinding[0].stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
+    layoutBinding[0].pImmutableSamplers = nullptr;
+
+    // Binding 1: Combined Image Sampler of the accumulator (Fragment shader)
+    layoutBinding[1]                    = {};
+    layoutBinding[1].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    layoutBinding[1].binding            = 1;
+    layoutBinding[1].descriptorCount    = 1;
+    layoutBinding[1].stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
+    layoutBinding[1].pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
+    descriptorLayout.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptorLayout.bindingCount                    = 2;
+    descriptorLayout.pBindings                       = layoutBinding;
+
+    CALL_VK(vkCreateDescriptorSetLayout(
+        device(), &descriptorLayout, nullptr, mDescriptorSetLayout.pHandle()));
+
+    // Create the pipeline layout that is used to generate the rendering pipelines that are based on
+    // this descriptor set layout In a more complex scenario you would have different pipeline
+    // layouts for different descriptor set layouts that could be reused
+    VkPipelineLayoutCreateInfo pPipelineLayoutCreateInfo = {};
+    pPipelineLayoutCreateInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pPipelineLayoutCreateInfo.setLayoutCount             = 1;
+    pPipelineLayoutCreateInfo.pSetLayouts                = mDescriptorSetLayout.pHandle();
+
+    CALL_VK(vkCreatePipelineLayout(
+        device(), &pPipelineLayoutCreateInfo, nullptr, mPipelineLayout.pHandle()));
+}
+
+void Sample_13_LongExposure::setupDescriptorSet()
+{
+    VkDescriptorSetLayout layouts[2] = {mDescriptorSetLayout.handle(), mDescriptorSetLayout.handle()};
+
+    // Allocate the sets from the global descriptor pool
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = mDescriptorPool.handle();
+    allocInfo.descriptorSetCount          = 2;
+    allocInfo.pSetLayouts                 = layouts;
+
+    CALL_VK(vkAllocateDescriptorSets(device(), &allocInfo, mDescriptorSets));
+
+    auto uboDescriptor = mUniformBuffer->getDescriptor();
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        VkWriteDescriptorSet writeDescriptorSet[2];
+
+        // Binding 0 : Uniform buffer
+        writeDescriptorSet[0]                 = {};
+        writeDescriptorSet[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSet[0].dstSet          = mDescriptorSets[i];
+        writeDescriptorSet[0].descriptorCount = 1;
+        writeDescriptorSet[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writeDescriptorSet[0].pBufferInfo     = &uboDescriptor;
+        writeDescriptorSet[0].dstBinding      = 0;
+
+        // Binding 1 : Accumulator image i
+        VkDescriptorImageInfo imageDescriptor = mAccumulator->image(i)->getDescriptor();
+        writeDescriptorSet[1]                 = {};
+        writeDescriptorSet[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSet[1].dstSet          = mDescriptorSets[i];
+        writeDescriptorSet[1].descriptorCount = 1;
+        writeDescriptorSet[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writeDescriptorSet[1].pImageInfo      = &imageDescriptor;
+        writeDescriptorSet[1].dstBinding      = 1;
+
+        vkUpdateDescriptorSets(device(), 2, writeDescriptorSet, 0, nullptr);
+    }
+}
+
+void Sample_13_LongExposure::prepareUniformBuffers()
+{
+    // Prepare and initialize a uniform buffer block containing shader uniforms
+    // Single uniforms like in OpenGL are no longer present in Vulkan. All Shader uniforms are
+    // passed via uniform buffer blocks
+    mUniformBuffer =
+        vks::Buffer::create(mDeviceWrapper,
+                       sizeof(uboVS),
+                       VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    mUniformBuffer->map();
+    updateUniformBuffers();
+}
+
+void Sample_13_LongExposure::updateUniformBuffers()
+{
+    float winRatio =
+        static_cast<float>(mWindow.windowWidth) / static_cast<float>(mWindow.windowHeight);
+
+    uint32_t bmpWidth  = mYUVConverter->rgbaImage()->width();
+    uint32_t bmpHeight = mYUVConverter->rgbaImage()->height();
+
+    // Pass matrices to the shaders
+    uboVS.projectionMatrix = glm::mat4(1.0f);
+    uboVS.viewMatrix       = glm::mat4(1.0f);
+
+    if (mYUVImages[0].orientation % 180 != 0)
+    {
+        uint32_t temp = bmpWidth;
+        bmpWidth      = bmpHeight;
+        bmpHeight     = temp;
+    }
+
+    float bmpRatio = static_cast<float>(bmpWidth) / static_cast<float>(bmpHeight);
+
+    if (bmpRatio >= winRatio)
+    {
+        // The bitmap's width is to large and the width is compressed, so we compress the height
+        uboVS.modelMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, winRatio / bmpRatio, 1.0f));
+    }
+    else
+    {
+        // The bitmap's height is to large and the height is compressed, so we compress the width
+        uboVS.modelMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(bmpRatio / winRatio, 1.0f, 1.0f));
+    }
+
+    uboVS.modelMatrix = glm::rotate(uboVS.modelMatrix,
+                                    glm::radians((float) mYUVImages[0].orientation),
+                                    glm::vec3(0.0f, 0.0f, 1.0f));
+
+    updateUniformBuffer(*mUniformBuffer, &uboVS, sizeof(uboVS));
+}
+
+void Sample_13_LongExposure::preparePipelines()
+{
+    // Create the graphics pipeline used in this example
+    // Vulkan uses the concept of rendering pipelines to encapsulate fixed states, replacing
+    // OpenGL's complex state machine A pipeline is then stored and hashed on the GPU making
+    // pipeline changes very fast Note: There are still a few dynamic states that are not directly
+    // part of the pipeline (but the info that they are used is)
+
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = {};
+    pipelineCreateInfo.sType                        = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    // The layout used for this pipeline (can be shared among multiple pipelines using the same
+    // layout)
+    pipelineCreateInfo.layout = mPipelineLayout.handle();
+    // Renderpass this pipeline is attached to
+    pipelineCreateInfo.renderPass = mRenderPass;
+
+    // Construct the different states making up the pipeline
+
+    // Input assembly state describes how primitives are assembled
+    // This pipeline will assemble vertex data as a triangle lists (though we only use one triangle)
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = {};
+    inputAssemblyState.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssemblyState.topology                               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    // Rasterization state
+    VkPipelineRasterizationStateCreateInfo rasterizationState = {};
+    rasterizationState.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizationState.polygonMode                            = VK_POLYGON_MODE_FILL;
+    rasterizationState.cullMode                               = VK_CULL_MODE_NONE;
+    rasterizationState.frontFace                              = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizationState.depthClampEnable                       = VK_FALSE;
+    rasterizationState.rasterizerDiscardEnable                = VK_FALSE;
+    rasterizationState.depthBiasEnable                        = VK_FALSE;
+    rasterizationState.lineWidth                              = 1.0f;
+
+    // Color blend state describes how blend factors are calculated (if used)
+    // We need one blend attachment state per color attachment (even if blending is not used)
+    VkPipelineColorBlendAttachmentState blendAttachmentState[1] = {};
+    blendAttachmentState[0].colorWriteMask                      = 0xf;
+    blendAttachmentState[0].blendEnable                         = VK_FALSE;
+    VkPipelineColorBlendStateCreateInfo colorBlendState         = {};
+    colorBlendState.sType                                       = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlendState.attachmentCount                             = 1;
+    colorBlendState.pAttachments                                = blendAttachmentState;
+
+    // Viewport state sets the number of viewports and scissor used in this pipeline
+    // Note: This is actually overridden by the dynamic states (see below)
+    VkPipelineViewportStateCreateInfo viewportState = {};
+    viewportState.sType                             = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount                     = 1;
+    viewportState.scissorCount                      = 1;
+
+    // Enable dynamic states
+    // Most states are baked into the pipeline, but there are still a few dynamic states that can be
+    // changed within a command buffer To be able to change these we need do specify which dynamic
+    // states will be changed using this pipeline. Their actual states are set later on in the
+    // command buffer. For this example we will set the viewport and scissor using dynamic states
+    std::vector<VkDynamicState> dynamicStateEnables;
+    dynamicStateEnables.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+    dynamicStateEnables.push_back(VK_DYNAMIC_STATE_SCISSOR);
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType                            = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.pDynamicStates                   = dynamicStateEnables.data();
+    dynamicState.dynamicStateCount                = static_cast<uint32_t>(dynamicStateEnables.size());
+
+    // Depth and stencil state containing depth and stencil compare and test operations
+    // We only use depth tests and want depth tests and writes to be enabled and compare with less
+    // or equal
+    VkPipelineDepthStencilStateCreateInfo depthStencilState = {};
+    depthStencilState.sType                                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencilState.depthTestEnable                       = VK_TRUE;
+    depthStencilState.depthWriteEnable                      = VK_TRUE;
+    depthStencilState.depthCompareOp                        = VK_COMPARE_OP_LESS_OR_EQUAL;
+    depthStencilState.depthBoundsTestEnable                 = VK_FALSE;
+    depthStencilState.back.failOp                           = VK_STENCIL_OP_KEEP;
+    depthStencilState.back.passOp                           = VK_STENCIL_OP_KEEP;
+    depthStencilState.back.compareOp                        = VK_COMPARE_OP_ALWAYS;
+    depthStencilState.stencilTestEnable                     = VK_FALSE;
+    depthStencilState.front                                 = depthStencilState.back;
+
+    // Multi sampling state
+    // This example does not make use of multi sampling (for anti-aliasing), the state must still be
+    // set and passed to the pipeline
+    VkPipelineMultisampleStateCreateInfo multisampleState = {};
+    multisampleState.sType                                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampleState.rasterizationSamples                 = VK_SAMPLE_COUNT_1_BIT;
+    multisampleState.pSampleMask                          = nullptr;
+
+    // Vertex input descriptions
+    // Specifies the vertex input parameters for a pipeline
+
+    // Vertex input binding
+    // This example uses a single vertex input binding at binding point 0 (see
+    // vkCmdBindVertexBuffers)
+    VkVertexInputBindingDescription vertexInputBinding = {};
+    vertexInputBinding.binding                         = 0;
+    vertexInputBinding.stride                          = sizeof(VertexUV);
+    vertexInputBinding.inputRate                       = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    // Input attribute bindings describe shader attribute locations and memory layouts
+    std::array<VkVertexInputAttributeDescription, 2> vertexInputAttributs;
+    // These match the following shader layout (see shader_01_triangle.vert):
+    //	layout (location = 0) in vec4 inPos;
+    //	layout (location = 1) in vec2 inUVPos;
+    // Attribute location 0: Position
+    vertexInputAttributs[0].binding  = 0;
+    vertexInputAttributs[0].location = 0;
+    // Position attribute is four 32 bit signed (SFLOAT) floats (R32 G32 B32)
+    vertexInputAttributs[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    vertexInputAttributs[0].offset = offsetof(VertexUV, posX);
+    // Attribute location 1: Color
+    vertexInputAttributs[1].binding  = 0;
+    vertexInputAttributs[1].location = 1;
+    // Color attribute is two 32 bit signed (SFLOAT) floats (R32 G32)
+    vertexInputAttributs[1].format = VK_FORMAT_R32G32_SFLOAT;
+    vertexInputAttributs[1].offset = offsetof(VertexUV, u);
+
+    // Vertex input state used for pipeline creation
+    VkPipelineVertexInputStateCreateInfo vertexInputState = {};
+    vertexInputState.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputState.vertexBindingDescriptionCount        = 1;
+    vertexInputState.pVertexBindingDescriptions           = &vertexInputBinding;
+    vertexInputState.vertexAttributeDescriptionCount      = 2;
+    vertexInputState.pVertexAttributeDescriptions         = vertexInputAttributs.data();
+
+    // Shaders
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
+
+    // Vertex shader
+    shaderStages[0] = loadShader(vertFilePath, VK_SHADER_STAGE_VERTEX_BIT);
+    // Fragment shader
+    shaderStages[1] = loadShader(fragFilePath, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    // Set pipeline shader stage info
+    pipelineCreateInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+    pipelineCreateInfo.pStages    = shaderStages.data();
+
+    // Assign the pipeline states to the pipeline creation info structure
+    pipelineCreateInfo.pVertexInputState   = &vertexInputState;
+    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineCreateInfo.pRasterizationState = &rasterizationState;
+    pipelineCreateInfo.pColorBlendState    = &colorBlendState;
+    pipelineCreateInfo.pMultisampleState   = &multisampleState;
+    pipelineCreateInfo.pViewportState      = &viewportState;
+    pipelineCreateInfo.pDepthStencilState  = &depthStencilState;
+    pipelineCreateInfo.renderPass          = mRenderPass;
+    pipelineCreateInfo.pDynamicState       = &dynamicState;
+
+    // Create rendering pipeline using the specified states
+    CALL_VK(vkCreateGraphicsPipelines(
+        device(), mPipelineCache.handle(), 1, &pipelineCreateInfo, nullptr, mPipeline.pHandle()));
+}
+
+
+void Sample_13_LongExposure::buildCommandBuffers()
+{
+    // Nothing to draw before the first camera frame, draw() records the set of the result
+    for (uint32_t i = 0; i < drawCmdBuffers.size(); ++i)
+    {
+        recordCommandBuffer(i, VK_NULL_HANDLE);
+    }
+}
+
+void Sample_13_LongExposure::recordCommandBuffer(uint32_t index, VkDescriptorSet descriptorSet)
+{
+    VkCommandBuffer cmdBuffer = drawCmdBuffers[index].handle();
+
+    VkCommandBufferBeginInfo cmdBufInfo = {};
+    cmdBufInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBufInfo.pNext                    = nullptr;
+
+    // Set clear values for all framebuffer attachments with loadOp set to clear
+    // We use two attachments (color and depth) that are cleared at the start of the subpass and as
+    // such we need to set clear values for both
+    VkClearValue clearValues[2];
+    clearValues[0].color        = {{0.0f, 0.0f, 0.2f, 1.0f}};
+    clearValues[1].depthStencil = {1.0f, 0};
+
+    VkRenderPassBeginInfo renderPassBeginInfo    = {};
+    renderPassBeginInfo.sType                    = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBeginInfo.pNext                    = nullptr;
+    renderPassBeginInfo.renderPass               = mRenderPass;
+    renderPassBeginInfo.renderArea.offset.x      = 0;
+    renderPassBeginInfo.renderArea.offset.y      = 0;
+    renderPassBeginInfo.renderArea.extent.width  = mWindow.windowWidth;
+    renderPassBeginInfo.renderArea.extent.height = mWindow.windowHeight;
+    renderPassBeginInfo.clearValueCount          = 2;
+    renderPassBeginInfo.pClearValues             = clearValues;
+
+    // Set target frame buffer
+    renderPassBeginInfo.framebuffer = frameBuffers[index];
+
+    CALL_VK(vkBeginCommandBuffer(cmdBuffer, &cmdBufInfo));
+
+    // Start the first sub pass specified in our default prepare pass setup by the base class
+    // This will clear the color and depth attachment
+    vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    if (descriptorSet != VK_NULL_HANDLE)
+    {
+        // Update dynamic viewport state
+        VkViewport viewport = {};
+        viewport.height     = (float) mWindow.windowHeight;
+        viewport.width      = (float) mWindow.windowWidth;
+        viewport.minDepth   = (float) 0.0f;
+        viewport.maxDepth   = (float) 1.0f;
+        vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+
+        // Update dynamic scissor state
+        VkRect2D scissor      = {};
+        scissor.extent.width  = mWindow.windowWidth;
+        scissor.extent.height = mWindow.windowHeight;
+        scissor.offset.x      = 0;
+        scissor.offset.y      = 0;
+        vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+        // Bind descriptor sets describing shader binding points
+        vkCmdBindDescriptorSets(cmdBuffer,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                mPipelineLayout.handle(),
+                                0,
+                                1,
+                                &descriptorSet,
+                                0,
+                                nullptr);
+
+        // Bind the rendering pipeline
+        vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline.handle());
+
+        // Bind triangle vertex buffer (contains position and colors)
+        VkDeviceSize offsets[1]  = {0};
+        auto         verticesBuf = mVerticesBuffer->getBufferHandle();
+        vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &verticesBuf, offsets);
+
+        // Draw triangle
+        vkCmdDraw(cmdBuffer,
+                  sizeof(g_vb_bitmap_texture_Data) / sizeof(g_vb_bitmap_texture_Data[0]),
+                  1,
+                  0,
+                  0);
+    }
+
+    drawUI(cmdBuffer);
+
+    vkCmdEndRenderPass(cmdBuffer);
+
+    // Ending the prepare pass will add an implicit barrier transitioning the frame buffer color
+    // attachment to VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
+
+    CALL_VK(vkEndCommandBuffer(cmdBuffer));
+}
+
+void Sample_13_LongExposure::draw()
+{
+    // Read before prepareFrame() flushes the uploads, the dispatch writing the result is then
+    // submitted ahead of this frame
+    const int32_t displayedSet = mDisplayedSet;
+
+    prepareFrame();
+
+    // The command buffer of this frame is idle since prepareFrame(), point it at the latest result.
+    // The next camera frame accumulates into the other image.
+    recordCommandBuffer(currentBuffer, displayedSet < 0 ? VK_NULL_HANDLE : mDescriptorSets[displayedSet]);
+
+    FrameSync &frame = currentFrameSync();
+
+    // Pipeline stage at which the queue submission will wait (via pWaitSemaphores)
+    VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+    VkSubmitInfo submitInfo         = vks::initializers::submitInfo();
+    submitInfo.pWaitDstStageMask    = &waitStageMask;
+    submitInfo.pWaitSemaphores      = frame.presentCompleteSemaphore.pHandle();
+    submitInfo.waitSemaphoreCount   = 1;
+    submitInfo.pSignalSemaphores    = frame.renderCompleteSemaphore.pHandle();
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pCommandBuffers      = drawCmdBuffers[currentBuffer].pHandle();
+    submitInfo.commandBufferCount   = 1;
+
+    // Submit to the graphics queue passing the fence of this frame slot
+    CALL_VK(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, frame.inFlightFence.handle()));
+
+    submitFrame();
+}
+
+void Sample_13_LongExposure::runBenchmarks()
+{
+    using Mode                      = FrameAccumulator::Mode;
+    using Precision                 = FrameAccumulator::Precision;
+    const uint32_t width            = 1920;
+    const uint32_t height           = 1080;
+    const uint32_t frameCount       = 120;
+    const char    *modeNames[]      = {"mean", "lighten", "decay"};
+    const char    *precisionNames[] = {"RGBA16F", "RGBA32F"};
+
+    // Two camera frames fed alternately: a gradient, then its mirror with warmer colors
+    std::vector<uint8_t> planes[2][3];
+    yuv::Frame           frames[2];
+    for (uint32_t f = 0; f < 2; f++)
+    {
+        planes[f][0].resize(width * height);
+        planes[f][1].resize(width * height / 4);
+        planes[f][2].resize(width * height / 4);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint32_t luma         = (x + y) * 255 / (width + height);
+                planes[f][0][y * width + x] = static_cast<uint8_t>(f == 0 ? luma : 255 - luma);
+            }
+        }
+        for (uint32_t y = 0; y < height / 2; y++)
+        {
+            for (uint32_t x = 0; x < width / 2; x++)
+            {
+                planes[f][1][y * width / 2 + x] = static_cast<uint8_t>(64 + x * 128 / width);
+                planes[f][2][y * width / 2 + x] = static_cast<uint8_t>(64 + y * 128 / height + f * 48);
+            }
+        }
+        frames[f].y       = planes[f][0].data();
+        frames[f].u       = planes[f][1].data();
+        frames[f].v       = planes[f][2].data();
+        frames[f].width   = width;
+        frames[f].height  = height;
+        frames[f].yStride = width;
+        frames[f].uStride = width / 2;
+        frames[f].vStride = width / 2;
+    }
+
+    // Mean of the RGBA8 conversions (shaders/yuv_to_rgba.comp) on a sparse grid of pixels
+    const uint32_t     pixelStep = 61;
+    std::vector<float> expectedMean;
+    for (uint32_t pixel = 0; pixel < width * height; pixel += pixelStep)
+    {
+        const uint32_t x = pixel % width, y = pixel / width;
+        float          mean[3] = {};
+        for (uint32_t f = 0; f < 2; f++)
+        {
+            const float luma = planes[f][0][pixel] / 255.0f;
+            const float u    = planes[f][1][y / 2 * width / 2 + x / 2] / 255.0f - 0.5f;
+            const float v    = planes[f][2][y / 2 * width / 2 + x / 2] / 255.0f - 0.5f;
+            const float rgb[3] = {luma + 1.403f * v, luma - 0.344f * u - 0.714f * v, luma + 1.770f * u};
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                mean[c] += std::round(std::min(std::max(rgb[c], 0.0f), 1.0f) * 255.0f) / 255.0f / 2;
+            }
+        }
+        expectedMean.insert(expectedMean.end(), mean, mean + 3);
+    }
+
+    auto converter = YUVPlaneConverter::create(
+        deviceWrapper(), mGraphicsQueue, mPipelineCache.handle(),
+        loadShader(YUVPlaneConverter::shaderPath(YUVPlaneConverter::Output::RGBA), VK_SHADER_STAGE_COMPUTE_BIT),
+        YUVPlaneConverter::Output::RGBA, width, height);
+    if (converter == nullptr)
+    {
+        LOGCATE("Long exposure benchmark: Failed to create the %ux%u converter", width, height);
+        return;
+    }
+
+    UploadManager *uploadManager = deviceWrapper()->getUploadManager();
+    for (Precision precision : {Precision::HALF, Precision::FLOAT})
+    {
+        auto accumulator = FrameAccumulator::create(
+            deviceWrapper(), mGraphicsQueue, mPipelineCache.handle(),
+            loadShader(FrameAccumulator::shaderPath(precision), VK_SHADER_STAGE_COMPUTE_BIT), precision, width,
+            height);
+        if (accumulator == nullptr)
+        {
+            continue;
+        }
+
+        std::string timings;
+        float       meanError = 0.0f;
+        for (Mode mode : {Mode::MEAN, Mode::LIGHTEN, Mode::DECAY})
+        {
+            accumulator->reset(mode, 0.1f);
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (uint32_t i = 0; i < frameCount; i++)
+            {
+                converter->convert(frames[i % 2]);
+                accumulator->accumulate(*converter->rgbaImage());
+                // One batch per frame like the frame loop, the staging ring blocks when the GPU is behind
+                uploadManager->flush();
+            }
+            uploadManager->wait(accumulator->lastToken());
+            const double seconds =
+                std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+            char timing[64];
+            snprintf(timing, sizeof(timing), "%s%s %.1f frames/s", timings.empty() ? "" : ", ",
+                     modeNames[static_cast<int>(mode)], frameCount / seconds);
+            timings += timing;
+
+            if (mode != Mode::MEAN)
+            {
+                continue;
+            }
+            std::vector<uint8_t> texels(width * height * accumulator->texelSize());
+            accumulator->requestReadback();
+            if (!accumulator->readback(texels.data()))
+            {
+                continue;
+            }
+            for (uint32_t i = 0; i < expectedMean.size(); i++)
+            {
+                const uint32_t texel = i / 3 * pixelStep * 4 + i % 3;
+                const float    value =
+                    precision == Precision::HALF
+                        ? glm::unpackHalf1x16(reinterpret_cast<const uint16_t *>(texels.data())[texel])
+                        : reinterpret_cast<const float *>(texels.data())[texel];
+                meanError = std::max(meanError, std::abs(value - expectedMean[i]));
+            }
+        }
+
+        // The RGBA8 conversion may round the other way than the CPU, a float mean stays within a step
+        const bool withinTolerance = precision == Precision::HALF || meanError <= 1.0f / 255.0f;
+        LOGCATI("Long exposure %ux%u %s, %u frames: %s; mean max error %.5f%s", width, height,
+                precisionNames[static_cast<int>(precision)], frameCount, timings.c_str(), meanError,
+                withinTolerance ? "" : " (FAILED)");
+    }
+}
+
+Sample_13_LongExposure::~Sample_13_LongExposure()
+{
+    // The frames in flight sample the accumulators
+    vkDeviceWaitIdle(device());
+}
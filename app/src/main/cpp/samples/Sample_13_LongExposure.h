@@ -0,0 +1,104 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GAINVULKANSAMPLE_SAMPLE_13_LONGEXPOSURE_H
+#define GAINVULKANSAMPLE_SAMPLE_13_LONGEXPOSURE_H
+
+#include "VulkanInitializers.hpp"
+#include <VulkanContextBase.h>
+#include <VulkanFrameAccumulator.h>
+#include <VulkanImageWrapper.h>
+#include <VulkanYUVPlaneConverter.h>
+#include <array>
+#include <atomic>
+#include <mutex>
+
+class Sample_13_LongExposure : public VulkanContextBase
+{
+  private:
+    // Uploads the camera planes and converts them to RGBA on the GPU
+    std::unique_ptr<YUVPlaneConverter> mYUVConverter;
+    // Integrates the converted frames, drawn from the result of the last frame
+    std::unique_ptr<FrameAccumulator> mAccumulator;
+
+    std::array<YUVSinglePassImage, 3> mYUVImages;
+
+    // Set i samples FrameAccumulator::image(i)
+    VkDescriptorSet mDescriptorSets[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    // Set drawn by the next frames, -1 until the first camera frame has been accumulated
+    std::atomic<int32_t> mDisplayedSet{-1};
+
+    // Set from the UI thread, applied before the next camera frame
+    std::mutex              mModeMutex;
+    bool                    mResetRequested = false;
+    FrameAccumulator::Mode  mRequestedMode  = FrameAccumulator::Mode::MEAN;
+    float                   mRequestedDecay = 0.1f;
+
+    void updateUniformBuffers();
+
+    void setupDescriptorSetLayout();
+
+    void setupDescriptorPool();
+
+    void updateTexture();
+
+    // Record the draw of descriptorSet into the command buffer of swap chain image index, only the
+    // clear if it is VK_NULL_HANDLE
+    void recordCommandBuffer(uint32_t index, VkDescriptorSet descriptorSet);
+
+  public:
+    Sample_13_LongExposure() :
+        VulkanContextBase("shaders/shader_13_long_exposure.vert.spv",
+                          "shaders/shader_13_long_exposure.frag.spv")
+    {}
+
+    virtual void prepare(JNIEnv *env) override;
+
+    virtual void preparePipelines() override;
+
+    virtual void setupDescriptorSet();
+
+    virtual void buildCommandBuffers() override;
+
+    virtual void prepareUniformBuffers();
+
+    virtual void draw();
+
+    // Feed synthetic 1080p frames to each mode and precision, log the frames/s and check the means
+    // against the CPU
+    virtual void runBenchmarks() override;
+
+    void setYUVImage(uint8_t *yData, uint8_t *uData, uint8_t *vData, uint32_t w, uint32_t h,
+                     uint32_t yStride, uint32_t uStride, uint32_t vStride, uint32_t uPixelStride,
+                     uint32_t vPixelStride, uint32_t orientation);
+
+    // Restart the exposure with mode, decay is the weight of each frame in FrameAccumulator::Mode::DECAY
+    void setMode(FrameAccumulator::Mode mode, float decay);
+
+    void prepareYUVImage();
+
+    ~Sample_13_LongExposure();
+};
+
+#endif        // GAINVULKANSAMPLE_SAMPLE_13_LONGEXPOSURE_H
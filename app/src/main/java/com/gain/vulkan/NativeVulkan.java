@@ -25,6 +25,7 @@ package com.gain.vulkan;
 
 import android.content.res.AssetManager;
 import android.graphics.Bitmap;
+import android.hardware.HardwareBuffer;
 import android.os.Handler;
 import android.os.HandlerThread;
 import android.view.Surface;
@@ -35,6 +36,9 @@ import androidx.annotation.Nullable;
 import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.FutureTask;
 
 public class NativeVulkan implements VulkanSample {
     // Used to load the 'vulkan' library on application startup.
@@ -50,7 +54,7 @@ public class NativeVulkan implements VulkanSample {
     private boolean mDrawing = false;
 
     // Return a non-zero handle on success, and 0L if failed.
-    private native long nativeInit(AssetManager assetManager, int sampleType);
+    private native long nativeInit(AssetManager assetManager, int sampleType, boolean headless, String cacheDir);
 
     // Frees up any underlying native resources. After calling this method, the NativeVulkan
     // must not be used in any way.
@@ -64,6 +68,8 @@ public class NativeVulkan implements VulkanSample {
 
     private native void nativePrepareI420VkConversion(long handle, @NonNull byte[] imgData, int w, int h, int strideY, int strideU, int strideV);
 
+    private native void nativePrepareNV12VkConversion(long handle, @NonNull byte[] imgData, int w, int h, boolean crCb);
+
     private native void nativePrepareCameraYUV(long handle,
                                          @NonNull ByteBuffer yBuffer,
                                          @NonNull ByteBuffer uBuffer,
@@ -88,17 +94,29 @@ public class NativeVulkan implements VulkanSample {
                                                int vPixelstride,
                                                int orientation);
 
-    private native void nativePrepareCameraTexture(long handle);
+    private native void nativeSetHistogramChannel(long handle, int channel);
+
+    private native long nativeGetLatestHistogram(long handle, int[] bins);
+
+    private native void nativePrepareCameraTexture(long handle, HardwareBuffer hardwareBuffer, int orientation);
 
     private native void nativePrepareLUT(long handle, Bitmap lutBitmap);
 
-    private native void nativePrepareLUTs(long handle, Bitmap[] luts);
+    private native void nativePrepareLUTs(long handle, String[] lutPaths);
+
+    private native void nativeSetLUTChain(long handle, Bitmap[] lutBitmaps);
+
+    private native void nativeSetLUTIntensity(long handle, int step, float intensity);
+
+    private native boolean nativeApplyLUT(long handle, @NonNull ByteBuffer yBuffer, @NonNull ByteBuffer uBuffer, @NonNull ByteBuffer vBuffer, int w, int h, int strideY, int strideU, int strideV, int uPixelStride, int vPixelStride, boolean tetrahedral, @NonNull Bitmap dst);
 
     private native void nativeUpdateLUTs(long handle, int itemWidth, int startIndex, int drawCount, int offset);
 
     private native void nativeUpdateSelectedIndex(long handle, int selectedIndex);
 
-    private native void nativePrepareLongExposure(long handle, @NonNull ByteBuffer yBuffer, @NonNull ByteBuffer uBuffer, @NonNull ByteBuffer vBuffer, int w, int h, int strideY, int strideU, int strideV);
+    private native void nativePrepareLongExposure(long handle, @NonNull ByteBuffer yBuffer, @NonNull ByteBuffer uBuffer, @NonNull ByteBuffer vBuffer, int w, int h, int strideY, int strideU, int strideV, int uPixelStride, int vPixelStride, int orientation);
+
+    private native void nativeSetLongExposureMode(long handle, int mode, float decay);
 
     private native void nativePrepare3dModel(long handle, String filePath);
 
@@ -112,10 +130,20 @@ public class NativeVulkan implements VulkanSample {
 
     private native void native_setWindow(long handle, Surface surface, int width, int height);
 
+    private native void nativeSetHeadlessTarget(long handle, int width, int height);
+
+    private native boolean nativeReadbackFrame(long handle, @NonNull ByteBuffer dst);
+
     private native void nativeOnTouchActionMove(long handle, float deltaX, float deltaY);
 
+    private native void nativeSetFramesInFlight(long handle, int count);
+
+    private native String nativeCompareFramesInFlight(long handle, int frameCount);
+
+    private native void nativeRunBenchmarks(long handle);
+
     @Override
-    public void init(AssetManager assetManager, int sampleType) {
+    public void init(AssetManager assetManager, int sampleType, String cacheDir, boolean headless) {
         if (mRenderThread != null) {
             mRenderThread.quitSafely();
             mRenderThread = null;
@@ -126,7 +154,7 @@ public class NativeVulkan implements VulkanSample {
         mRenderThread.start();
         mRenderHandler = new Handler(mRenderThread.getLooper());
 
-        mVulkanHandle = nativeInit(assetManager, sampleType);
+        mVulkanHandle = nativeInit(assetManager, sampleType, headless, cacheDir);
     }
 
     @Override
@@ -150,6 +178,16 @@ public class NativeVulkan implements VulkanSample {
         native_setWindow(mVulkanHandle, surface, width, height);
     }
 
+    @Override
+    public void setHeadlessTarget(int width, int height) {
+        nativeSetHeadlessTarget(mVulkanHandle, width, height);
+    }
+
+    @Override
+    public boolean readbackFrame(@NonNull ByteBuffer dst) {
+        return nativeReadbackFrame(mVulkanHandle, dst);
+    }
+
     @Override
     public void prepare() {
         nativePrepare(mVulkanHandle);
@@ -170,6 +208,11 @@ public class NativeVulkan implements VulkanSample {
         nativePrepareI420VkConversion(mVulkanHandle, imgData, w, h, strideY, strideU, strideV);
     }
 
+    @Override
+    public void prepareNV12VkConversion(@NonNull byte[] imgData, int w, int h, boolean crCb) {
+        nativePrepareNV12VkConversion(mVulkanHandle, imgData, w, h, crCb);
+    }
+
     @Override
     public void prepareYUV(@NonNull ByteBuffer yBuffer,
                           @NonNull ByteBuffer uBuffer,
@@ -190,8 +233,18 @@ public class NativeVulkan implements VulkanSample {
     }
 
     @Override
-    public void prepareCameraTexture() {
-        nativePrepareCameraTexture(mVulkanHandle);
+    public void setHistogramChannel(int channel) {
+        nativeSetHistogramChannel(mVulkanHandle, channel);
+    }
+
+    @Override
+    public long getLatestHistogram(@NonNull int[] bins) {
+        return nativeGetLatestHistogram(mVulkanHandle, bins);
+    }
+
+    @Override
+    public void prepareCameraTexture(@NonNull HardwareBuffer hardwareBuffer, int orientation) {
+        nativePrepareCameraTexture(mVulkanHandle, hardwareBuffer, orientation);
     }
 
     @Override
@@ -200,8 +253,23 @@ public class NativeVulkan implements VulkanSample {
     }
 
     @Override
-    public void prepareLUTs(@NonNull Bitmap[] lutArray) {
-        nativePrepareLUTs(mVulkanHandle, lutArray);
+    public void setLUTChain(@NonNull Bitmap[] lutBitmaps) {
+        nativeSetLUTChain(mVulkanHandle, lutBitmaps);
+    }
+
+    @Override
+    public void setLUTIntensity(int step, float intensity) {
+        nativeSetLUTIntensity(mVulkanHandle, step, intensity);
+    }
+
+    @Override
+    public boolean applyLUT(@NonNull ByteBuffer yBuffer, @NonNull ByteBuffer uBuffer, @NonNull ByteBuffer vBuffer, int w, int h, int strideY, int strideU, int strideV, int uPixelstride, int vPixelstride, boolean tetrahedral, @NonNull Bitmap dst) {
+        return nativeApplyLUT(mVulkanHandle, yBuffer, uBuffer, vBuffer, w, h, strideY, strideU, strideV, uPixelstride, vPixelstride, tetrahedral, dst);
+    }
+
+    @Override
+    public void prepareLUTs(@NonNull String[] lutPaths) {
+        nativePrepareLUTs(mVulkanHandle, lutPaths);
     }
 
     @Override
@@ -215,8 +283,13 @@ public class NativeVulkan implements VulkanSample {
     }
 
     @Override
-    public void prepareLongExposure(@NonNull ByteBuffer yBuffer, @NonNull ByteBuffer uBuffer, @NonNull ByteBuffer vBuffer, int w, int h, int strideY, int strideU, int strideV) {
-        nativePrepareLongExposure(mVulkanHandle, yBuffer, uBuffer, vBuffer, w, h, strideY, strideU, strideV);
+    public void prepareLongExposure(@NonNull ByteBuffer yBuffer, @NonNull ByteBuffer uBuffer, @NonNull ByteBuffer vBuffer, int w, int h, int strideY, int strideU, int strideV, int uPixelstride, int vPixelstride, int orientation) {
+        nativePrepareLongExposure(mVulkanHandle, yBuffer, uBuffer, vBuffer, w, h, strideY, strideU, strideV, uPixelstride, vPixelstride, orientation);
+    }
+
+    @Override
+    public void setLongExposureMode(int mode, float decay) {
+        nativeSetLongExposureMode(mVulkanHandle, mode, decay);
     }
 
     @Override
@@ -263,4 +336,43 @@ public class NativeVulkan implements VulkanSample {
     public void onTouchActionMove(float deltaX, float deltaY) {
         nativeOnTouchActionMove(mVulkanHandle, deltaX, deltaY);
     }
+
+    @Override
+    public void setFramesInFlight(int count) {
+        mRenderHandler.post(() -> nativeSetFramesInFlight(mVulkanHandle, count));
+    }
+
+    @Override
+    public String compareFramesInFlight(int frameCount) {
+        return runBetweenFrames(() -> nativeCompareFramesInFlight(mVulkanHandle, frameCount));
+    }
+
+    @Override
+    public void runBenchmarks() {
+        runBetweenFrames(() -> {
+            nativeRunBenchmarks(mVulkanHandle);
+            return null;
+        });
+    }
+
+    // Run task on the render thread between two frames and wait for its result. A render loop is
+    // paused meanwhile.
+    private <T> T runBetweenFrames(@NonNull Callable<T> task) {
+        boolean looping = mDrawing;
+        if (looping) {
+            // The task is queued on the render thread behind the render loop, end the loop
+            nativeStopLoopRender(mVulkanHandle);
+        }
+
+        FutureTask<T> future = new FutureTask<>(task);
+        mRenderHandler.post(future);
+        if (looping) {
+            mRenderHandler.post(() -> nativeStartRender(mVulkanHandle, true));
+        }
+        try {
+            return future.get();
+        } catch (ExecutionException | InterruptedException e) {
+            throw new RuntimeException(e);
+        }
+    }
 }
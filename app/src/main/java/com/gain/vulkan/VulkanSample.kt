@@ -51,6 +51,14 @@ interface VulkanSample {
         strideV: Int
     )
 
+    // Packed NV12 (or NV21 if crCb) frame, sampled with its interleaved chroma as is
+    fun prepareNV12VkConversion(
+        imgData: ByteArray,
+        w: Int,
+        h: Int,
+        crCb: Boolean = false
+    )
+
     fun prepareYUV(
         yBuffer: ByteBuffer,
         uBuffer: ByteBuffer,
@@ -79,16 +87,48 @@ interface VulkanSample {
         orientation: Int = 0,
     )
 
-    fun prepareCameraTexture()
+    // 0 average of R, G and B, 1 red, 2 green, 3 blue, 4 luma
+    fun setHistogramChannel(channel: Int)
+
+    // Copy the newest histogram read back from the GPU, one or two frames old, to bins (256 entries).
+    // Returns its frame number, 0 if no histogram has been read back yet.
+    fun getLatestHistogram(bins: IntArray): Long
+
+    fun prepareCameraTexture(hardwareBuffer: HardwareBuffer, orientation: Int = 0)
 
     fun prepareLUT(lutBitmap: Bitmap)
 
-    fun prepareLUTs(lutArray: Array<Bitmap>)
+    // LUTs applied after the one of prepareLUT, the chain is baked into a single LUT
+    fun setLUTChain(lutBitmaps: Array<Bitmap>)
+
+    // Mix of a LUT of the chain with its input, from 0 to 1. Step 0 is the LUT of prepareLUT.
+    fun setLUTIntensity(step: Int, intensity: Float)
+
+    // Apply the LUT chain of prepareLUT and setLUTChain to a full resolution frame, offscreen, and write the result to
+    // an ARGB_8888 bitmap of the frame size. Blocks until the bitmap is written.
+    fun applyLUT(
+        yBuffer: ByteBuffer,
+        uBuffer: ByteBuffer,
+        vBuffer: ByteBuffer,
+        w: Int,
+        h: Int,
+        strideY: Int,
+        strideU: Int,
+        strideV: Int,
+        uPixelstride: Int,
+        vPixelstride: Int,
+        tetrahedral: Boolean,
+        dst: Bitmap,
+    ): Boolean
+
+    // Asset paths of the LUT images
+    fun prepareLUTs(lutPaths: Array<String>)
 
     fun updateLUTs(lutWidth:Int, startIndex:Int, drawCount:Int, offset:Int)
 
     fun updateSelectedIndex(selectedIndex:Int)
 
+    // Accumulate a camera frame into the long exposure shown on screen
     fun prepareLongExposure(
         yBuffer: ByteBuffer,
         uBuffer: ByteBuffer,
@@ -97,9 +137,16 @@ interface VulkanSample {
         h: Int,
         strideY: Int,
         strideU: Int,
-        strideV: Int
+        strideV: Int,
+        uPixelstride: Int,
+        vPixelstride: Int,
+        orientation: Int = 0,
     )
 
+    // Restart the long exposure. 0 mean of the frames, 1 lighten (per channel maximum), 2 exponential decay where
+    // each new frame weighs decay
+    fun setLongExposureMode(mode: Int, decay: Float = 0.1f)
+
     fun prepare3dModel(filePath: String)
 
     fun prepare3dModelWithAnim(filePath: String)
@@ -112,9 +159,31 @@ interface VulkanSample {
 
     fun setWindow(surface: Surface?, width: Int, height: Int)
 
+    // Render offscreen to a width x height RGBA_8888 target instead of a window, the sample must be
+    // initialized headless
+    fun setHeadlessTarget(width: Int, height: Int)
+
+    // Copy the last rendered frame of the headless target to a direct buffer of width * height * 4 bytes.
+    // Call it on the render thread after startRender(false) returned.
+    fun readbackFrame(dst: ByteBuffer): Boolean
+
     fun onTouchActionMove(deltaX:Float, deltaY:Float)
 
-    fun init(assetManager: AssetManager, sampleType: Int)
+    // Frames the CPU may record ahead of the GPU, applied on the render thread
+    fun setFramesInFlight(count: Int)
+
+    // Draw frameCount frames with 1, 2 and 3 frames in flight and return the frame times, one line per
+    // count. Blocks until done, the render loop is paused meanwhile. Call it off the main thread.
+    fun compareFramesInFlight(frameCount: Int): String
+
+    // Run the benchmarks of the sample and the CPU ones of the engine, the results are logged (adb
+    // logcat | grep Vulkan). Blocks until done, the render loop is paused meanwhile. Call it off the
+    // main thread.
+    fun runBenchmarks()
+
+    // cacheDir keeps the pipeline cache between launches, headless renders without a window, see
+    // setHeadlessTarget
+    fun init(assetManager: AssetManager, sampleType: Int, cacheDir: String, headless: Boolean = false)
 
     fun unInit()
 }
\ No newline at end of file
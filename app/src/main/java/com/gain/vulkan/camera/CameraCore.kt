@@ -98,7 +98,8 @@ class CameraCore constructor(private var mContext: Context) {
      * - Sets up the still image capture listeners
      */
     public suspend fun initializeCamera(display:Display, configPreview:(prevSize:Size)->Unit,
-    onImageAvailable:(imageReader:ImageReader)->Unit, previewSurface: Surface? = null) {
+    onImageAvailable:(imageReader:ImageReader)->Unit, previewSurface: Surface? = null,
+    hardwareBufferUsage: Long = 0) {
         withContext(Dispatchers.Main) {
             // Open the selected camera
             val context = mContext.applicationContext
@@ -117,10 +118,18 @@ class CameraCore constructor(private var mContext: Context) {
             Log.i("Vulkan", "previewSize:${previewSize.width}x${previewSize.height}")
             configPreview(previewSize)
 
-            imageReader = ImageReader.newInstance(
-                previewSize.width, previewSize.height, ImageFormat.YUV_420_888,
-                IMAGE_BUFFER_SIZE
-            )
+            imageReader = if (hardwareBufferUsage == 0L) {
+                ImageReader.newInstance(
+                    previewSize.width, previewSize.height, ImageFormat.YUV_420_888,
+                    IMAGE_BUFFER_SIZE
+                )
+            } else {
+                // The images are consumed through their HardwareBuffer, e.g. sampled by Vulkan
+                ImageReader.newInstance(
+                    previewSize.width, previewSize.height, ImageFormat.YUV_420_888,
+                    IMAGE_BUFFER_SIZE, hardwareBufferUsage
+                )
+            }
 
             imageReader.setOnImageAvailableListener(ImageReader.OnImageAvailableListener {
                 onImageAvailable(it)
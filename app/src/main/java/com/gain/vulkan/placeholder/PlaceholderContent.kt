@@ -44,9 +44,11 @@ object PlaceholderContent {
         addItem(PlaceholderItem( "Triangle+Cube", ChooseFragment.newInstance(ActionType.BASE_GRAPHICS.ordinal)))
         addItem(PlaceholderItem("Texture", ChooseFragment.newInstance(ActionType.TEXTURE.ordinal)))
         addItem(PlaceholderItem("Camera preview", CameraFragment.newInstance(SampleType.CAMERA_YUV.ordinal)))
+        addItem(PlaceholderItem("Camera preview (AHardwareBuffer)", CameraFragment.newInstance(SampleType.CAMERA_HARDWAREBUFFER.ordinal)))
         addItem(PlaceholderItem("Camera LUT", CameraFragment.newInstance(SampleType.LUT.ordinal)))
         addItem(PlaceholderItem("Multi LUT", CameraMultiLutFragment.newInstance(SampleType.MULTI_LUT.ordinal)))
         addItem(PlaceholderItem("histogram", CameraHistogramFragment.newInstance(SampleType.HISTOGRAM.ordinal)))
+        addItem(PlaceholderItem("Long exposure", CameraFragment.newInstance(SampleType.LONG_EXPOSURE.ordinal)))
         addItem(PlaceholderItem("glTF model", SampleFragment.newInstance(SampleType.LOAD_3D_MODEL.ordinal)))
         addItem(PlaceholderItem("glTF model with anim", SampleFragment.newInstance(SampleType.LOAD_3D_MODEL_WITH_ANIM.ordinal)))
         addItem(PlaceholderItem("glTF model PBR", SampleFragment.newInstance(SampleType.LOAD_3D_MODEL_PBR.ordinal)))
@@ -94,5 +96,6 @@ object PlaceholderContent {
         LOAD_3D_MODEL,
         LOAD_3D_MODEL_WITH_ANIM,
         LOAD_3D_MODEL_PBR,
+        LONG_EXPOSURE,
     }
 }
\ No newline at end of file
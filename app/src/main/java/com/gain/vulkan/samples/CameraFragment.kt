@@ -29,6 +29,7 @@ import android.annotation.SuppressLint
 import android.content.Context
 import android.content.pm.PackageManager
 import android.graphics.*
+import android.hardware.HardwareBuffer
 import android.hardware.camera2.*
 import android.media.Image
 import android.os.Bundle
@@ -70,6 +71,9 @@ class CameraFragment : Fragment() {
 
     private lateinit var mCameraCore: CameraCore
 
+    /** Images whose HardwareBuffer may still be sampled by the frames in flight */
+    private val mImagesInFlight = ArrayDeque<Image>()
+
     override fun onCreate(savedInstanceState: Bundle?) {
         super.onCreate(savedInstanceState)
         arguments?.let {
@@ -80,7 +84,11 @@ class CameraFragment : Fragment() {
         mCameraCore.init()
 
         vulkan = NativeVulkan()
-        vulkan.init(activity!!.assets, type!!)
+        vulkan.init(activity!!.assets, type!!, activity!!.cacheDir.absolutePath)
+
+        setHasOptionsMenu(type == PlaceholderContent.SampleType.CAMERA_YUV.ordinal ||
+                type == PlaceholderContent.SampleType.CAMERA_HARDWAREBUFFER.ordinal ||
+                type == PlaceholderContent.SampleType.LONG_EXPOSURE.ordinal)
 
         if (ContextCompat.checkSelfPermission(requireContext(), Manifest.permission.CAMERA)
             == PackageManager.PERMISSION_DENIED) {
@@ -106,6 +114,38 @@ class CameraFragment : Fragment() {
         }
     }
 
+    override fun onCreateOptionsMenu(menu: Menu, inflater: MenuInflater) {
+        if (type != PlaceholderContent.SampleType.LONG_EXPOSURE.ordinal) {
+            inflater.inflate(R.menu.menu_frames_in_flight, menu)
+        }
+        if (type == PlaceholderContent.SampleType.CAMERA_YUV.ordinal ||
+                type == PlaceholderContent.SampleType.LONG_EXPOSURE.ordinal) {
+            inflater.inflate(R.menu.menu_benchmarks, menu)
+        }
+    }
+
+    override fun onOptionsItemSelected(item: MenuItem): Boolean {
+        when (item.itemId) {
+            // On the image reader thread no camera frame is prepared while the comparison draws the
+            // last one again and again
+            R.id.compare_frames_in_flight -> mCameraCore.runInImageReaderThread {
+                val report = vulkan.compareFramesInFlight(COMPARE_FRAME_COUNT)
+                Log.i(TAG, report)
+                activity?.runOnUiThread {
+                    Toast.makeText(context, report, Toast.LENGTH_LONG).show()
+                }
+            }
+            R.id.run_benchmarks -> mCameraCore.runInImageReaderThread {
+                vulkan.runBenchmarks()
+                activity?.runOnUiThread {
+                    Toast.makeText(context, R.string.logcat_info, Toast.LENGTH_LONG).show()
+                }
+            }
+            else -> return super.onOptionsItemSelected(item)
+        }
+        return true
+    }
+
     override fun onCreateView(
             inflater: LayoutInflater,
             container: ViewGroup?,
@@ -157,6 +197,8 @@ class CameraFragment : Fragment() {
     }
 
     suspend fun initializeCamera() {
+        val hardwareBufferUsage =
+            if (type == PlaceholderContent.SampleType.CAMERA_HARDWAREBUFFER.ordinal) HardwareBuffer.USAGE_GPU_SAMPLED_IMAGE else 0L
         mCameraCore.initializeCamera(mPreviewView.display, {previewSize ->
             mPreviewView.setAspectRatio(previewSize)
         },  {imageReader ->
@@ -179,17 +221,49 @@ class CameraFragment : Fragment() {
                         mCameraCore.getOrientation()
                     )
                 }
+                PlaceholderContent.SampleType.LONG_EXPOSURE.ordinal->{
+                    vulkan.prepareLongExposure(yuvImage.planes[0].buffer,
+                        yuvImage.planes[1].buffer,
+                        yuvImage.planes[2].buffer,
+                        width,  height,
+                        yuvImage.planes[0].rowStride,
+                        yuvImage.planes[1].rowStride,
+                        yuvImage.planes[2].rowStride,
+                        yuvImage.planes[1].pixelStride,
+                        yuvImage.planes[2].pixelStride,
+                        mCameraCore.getOrientation()
+                    )
+                }
+                PlaceholderContent.SampleType.CAMERA_HARDWAREBUFFER.ordinal->{
+                    // The native side keeps its own reference to the buffer
+                    yuvImage.hardwareBuffer?.use {
+                        vulkan.prepareCameraTexture(it, mCameraCore.getOrientation())
+                    }
+                }
             }
 
             vulkan.startRender(false)
-            yuvImage.close()
-        })
+            if (type == PlaceholderContent.SampleType.CAMERA_HARDWAREBUFFER.ordinal) {
+                // The GPU samples the buffer directly, closing the image would let the camera
+                // write it again while the frames in flight still read it
+                mImagesInFlight.addLast(yuvImage)
+                if (mImagesInFlight.size > FRAMES_IN_FLIGHT) {
+                    mImagesInFlight.removeFirst().close()
+                }
+            } else {
+                yuvImage.close()
+            }
+        }, null, hardwareBufferUsage)
     }
 
     override fun onStop() {
         super.onStop()
         try {
             mCameraCore.close()
+            mCameraCore.runInImageReaderThread {
+                mImagesInFlight.forEach { it.close() }
+                mImagesInFlight.clear()
+            }
         } catch (exc: Throwable) {
             Log.e(TAG, "Error closing camera", exc)
         }
@@ -259,6 +333,12 @@ class CameraFragment : Fragment() {
     companion object {
         private val TAG = CameraFragment::class.java.simpleName
 
+        /** Frames drawn per frames in flight count by compareFramesInFlight */
+        private const val COMPARE_FRAME_COUNT: Int = 300
+
+        /** Frames the renderer keeps in flight, see VulkanContextBase::Settings::framesInFlight */
+        private const val FRAMES_IN_FLIGHT: Int = 2
+
         /** Helper data class used to hold capture metadata with their associated image */
         data class CombinedCaptureResult(
                 val image: Image,
@@ -80,7 +80,9 @@ class CameraHistogramFragment : Fragment() {
         mCameraCore.init()
 
         vulkan = NativeVulkan()
-        vulkan.init(activity!!.assets, type!!)
+        vulkan.init(activity!!.assets, type!!, activity!!.cacheDir.absolutePath)
+
+        setHasOptionsMenu(true)
 
         if (ContextCompat.checkSelfPermission(requireContext(), Manifest.permission.CAMERA)
             == PackageManager.PERMISSION_DENIED) {
@@ -145,6 +147,24 @@ class CameraHistogramFragment : Fragment() {
         )
     }
 
+    override fun onCreateOptionsMenu(menu: Menu, inflater: MenuInflater) {
+        inflater.inflate(R.menu.menu_benchmarks, menu)
+    }
+
+    override fun onOptionsItemSelected(item: MenuItem): Boolean {
+        if (item.itemId != R.id.run_benchmarks) {
+            return super.onOptionsItemSelected(item)
+        }
+        // On the image reader thread no camera frame is prepared while the benchmarks run
+        mCameraCore.runInImageReaderThread {
+            vulkan.runBenchmarks()
+            activity?.runOnUiThread {
+                Toast.makeText(context, R.string.logcat_info, Toast.LENGTH_LONG).show()
+            }
+        }
+        return true
+    }
+
     override fun onCreateView(
             inflater: LayoutInflater,
             container: ViewGroup?,
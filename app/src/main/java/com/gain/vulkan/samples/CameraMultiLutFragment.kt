@@ -108,7 +108,7 @@ class CameraMultiLutFragment : Fragment() {
         mCameraCore.init()
 
         vulkan = NativeVulkan()
-        vulkan.init(activity!!.assets, type!!)
+        vulkan.init(activity!!.assets, type!!, activity!!.cacheDir.absolutePath)
 
         if (ContextCompat.checkSelfPermission(requireContext(), Manifest.permission.CAMERA)
             == PackageManager.PERMISSION_DENIED) {
@@ -248,12 +248,10 @@ class CameraMultiLutFragment : Fragment() {
             ) {
                 vulkan.setWindow(Surface(surface), width, height)
                 lifecycleScope.launch {
-                    var lutArray = arrayListOf<Bitmap>()
-                    for (i in 1..9) {
-                        lutArray.add(loadBitmapFromAssets("lut/lut_0$i.png"))
-                    }
+                    // Decoded natively once they scroll into view
+                    val lutPaths = Array(9) { i -> "lut/lut_0${i + 1}.png" }
 
-                    vulkan.prepareLUTs(lutArray.toTypedArray())
+                    vulkan.prepareLUTs(lutPaths)
 
                     if (ContextCompat.checkSelfPermission(requireContext(), Manifest.permission.CAMERA)
                         == PackageManager.PERMISSION_GRANTED) {
@@ -296,19 +294,6 @@ class CameraMultiLutFragment : Fragment() {
         mCameraCore.unInit()
     }
 
-    suspend fun loadBitmapFromAssets(filePath:String) :Bitmap {
-        return withContext(Dispatchers.IO) {
-            var inputStream = resources.assets.open(filePath)
-            val bitmap: Bitmap?
-
-            inputStream.use {
-                bitmap = BitmapFactory.decodeStream(it)
-            }
-
-            bitmap!!
-        }
-    }
-
     suspend fun saveImage(imageBitmap: Bitmap, file: File) {
         withContext(Dispatchers.IO) {
             var output: FileOutputStream? = null
@@ -33,6 +33,7 @@ import android.os.Handler
 import android.os.HandlerThread
 import android.view.*
 import android.widget.ProgressBar
+import android.widget.Toast
 import androidx.fragment.app.Fragment
 import androidx.lifecycle.lifecycleScope
 import com.gain.vulkan.NativeVulkan
@@ -60,7 +61,33 @@ class SampleFragment : Fragment() {
         }
 
         vulkan  = NativeVulkan()
-        vulkan.init(context!!.assets, type!!)
+        vulkan.init(context!!.assets, type!!, context!!.cacheDir.absolutePath)
+
+        setHasOptionsMenu(type == PlaceholderContent.SampleType.LOAD_3D_MODEL_PBR.ordinal)
+    }
+
+    override fun onCreateOptionsMenu(menu: Menu, inflater: MenuInflater) {
+        inflater.inflate(R.menu.menu_frames_in_flight, menu)
+        inflater.inflate(R.menu.menu_benchmarks, menu)
+    }
+
+    override fun onOptionsItemSelected(item: MenuItem): Boolean {
+        when (item.itemId) {
+            R.id.compare_frames_in_flight -> lifecycleScope.launch(Dispatchers.IO) {
+                val report = vulkan.compareFramesInFlight(COMPARE_FRAME_COUNT)
+                withContext(Dispatchers.Main) {
+                    Toast.makeText(context, report, Toast.LENGTH_LONG).show()
+                }
+            }
+            R.id.run_benchmarks -> lifecycleScope.launch(Dispatchers.IO) {
+                vulkan.runBenchmarks()
+                withContext(Dispatchers.Main) {
+                    Toast.makeText(context, R.string.logcat_info, Toast.LENGTH_LONG).show()
+                }
+            }
+            else -> return super.onOptionsItemSelected(item)
+        }
+        return true
     }
 
     override fun onDestroy() {
@@ -233,6 +260,8 @@ class SampleFragment : Fragment() {
     }
 
     companion object {
+        /** Frames drawn per frames in flight count by compareFramesInFlight */
+        private const val COMPARE_FRAME_COUNT: Int = 300
 
         @JvmStatic
         fun newInstance(type: Int) =
@@ -0,0 +1,47 @@
+// Body of accumulate.comp (RGBA16F accumulator) and accumulate_float.comp (RGBA32F), see
+// FrameAccumulator. They define ACCUMULATOR_FORMAT, the format qualifier of the accumulators.
+//
+// One invocation per pixel integrates the new frame into the previous accumulator and writes the
+// other one of the pair, so the result of the previous frames stays readable while it runs.
+
+layout (local_size_x_id = 0, local_size_y_id = 1) in;
+
+// Same as FrameAccumulator::Mode
+#define MODE_MEAN    0
+#define MODE_LIGHTEN 1
+#define MODE_DECAY   2
+
+// RGB of the new frame, see YUVPlaneConverter::Output::RGBA
+layout (binding = 0, rgba8) uniform readonly image2D frameImage;
+layout (binding = 1, ACCUMULATOR_FORMAT) uniform readonly image2D previousImage;
+layout (binding = 2, ACCUMULATOR_FORMAT) uniform writeonly image2D accumulatorImage;
+
+layout(push_constant) uniform PushConsts {
+    int mode;
+    // Frames accumulated before this one, 0 restarts the accumulation
+    int frameIndex;
+    // Weight of the new frame in MODE_DECAY
+    float decay;
+} accumulation;
+
+void main() {
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(accumulatorImage);
+    if (coord.x >= size.x || coord.y >= size.y) {
+        return;
+    }
+
+    vec3 rgb = clamp(imageLoad(frameImage, coord).rgb, 0.0, 1.0);
+    if (accumulation.frameIndex > 0) {
+        vec3 previous = imageLoad(previousImage, coord).rgb;
+        if (accumulation.mode == MODE_MEAN) {
+            // Running mean, the sum of the frames would overflow the half floats
+            rgb = previous + (rgb - previous) / float(accumulation.frameIndex + 1);
+        } else if (accumulation.mode == MODE_LIGHTEN) {
+            rgb = max(previous, rgb);
+        } else {
+            rgb = mix(previous, rgb, accumulation.decay);
+        }
+    }
+    imageStore(accumulatorImage, coord, vec4(rgb, 1.0));
+}
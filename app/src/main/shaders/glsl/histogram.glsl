@@ -0,0 +1,127 @@
+// Body of histogram.comp, histogram_subgroup.comp and histogram_global.comp, see
+// HistogramCalculator. They differ in how a pixel is counted:
+//   GLOBAL_ATOMICS:  one atomic on the global bins per pixel, the first version of the sample. Hot
+//                    bins (flat areas, clipped highlights) serialize all invocations of the GPU.
+//   default:         the workgroup counts in shared memory, then adds each non-empty bin to the
+//                    global bins with one atomic.
+//   SUBGROUP_BALLOT: as the default, the lanes of a subgroup hitting the same bin first agree on
+//                    it and add their count with one shared memory atomic.
+
+layout (local_size_x_id = 0, local_size_y_id = 1) in;
+
+#define BIN_COUNT 256
+
+layout (binding = 0, r8) uniform readonly image2D inYImage;
+layout (binding = 1, r8) uniform readonly image2D inUImage;
+layout (binding = 2, r8) uniform readonly image2D inVImage;
+
+// Cleared before the dispatch
+layout (binding = 3) buffer OutBuffer {
+    uint colorCount[BIN_COUNT];
+} histogramBuffer;
+
+layout(push_constant) uniform PushConsts {
+    int uPixelStride;
+    int vPixelStride;
+    // histogram::Channel
+    int channel;
+} params;
+
+#define CHANNEL_RED 1
+#define CHANNEL_GREEN 2
+#define CHANNEL_BLUE 3
+#define CHANNEL_LUMA 4
+
+// U and V of the chroma sample at coord, centered on 0
+vec2 chromaAt(ivec2 coord) {
+    if (params.channel == CHANNEL_LUMA) {
+        return vec2(0.0);
+    }
+    float u = imageLoad(inUImage, ivec2(coord.x * params.uPixelStride, coord.y)).r;
+    float v = imageLoad(inVImage, ivec2(coord.x * params.vPixelStride, coord.y)).r;
+    return vec2(u, v) - 0.5;
+}
+
+// Same math as histogram::binOf
+uint binOf(float y, vec2 uv) {
+    if (params.channel == CHANNEL_LUMA) {
+        return uint(round(y * 255.0));
+    }
+    float r = y + 1.403 * uv.y;
+    float g = y - 0.344 * uv.x - 0.714 * uv.y;
+    float b = y + 1.770 * uv.x;
+
+    float value;
+    switch (params.channel) {
+        case CHANNEL_RED: value = r; break;
+        case CHANNEL_GREEN: value = g; break;
+        case CHANNEL_BLUE: value = b; break;
+        default: value = (r + g + b) / 3.0; break;
+    }
+    return uint(clamp(value, 0.0, 1.0) * 255.0);
+}
+
+#ifdef GLOBAL_ATOMICS
+
+void main() {
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(coord, imageSize(inYImage)))) {
+        return;
+    }
+    uint bin = binOf(imageLoad(inYImage, coord).r, chromaAt(coord / 2));
+    atomicAdd(histogramBuffer.colorCount[bin], 1u);
+}
+
+#else
+
+shared uint localBins[BIN_COUNT];
+
+void countPixel(uint bin) {
+#ifdef SUBGROUP_BALLOT
+    // One iteration per distinct bin of the subgroup, few where the bins are hot
+    for (;;) {
+        uint firstBin = subgroupBroadcastFirst(bin);
+        uvec4 sameBin = subgroupBallot(bin == firstBin);
+        if (bin == firstBin) {
+            if (subgroupElect()) {
+                atomicAdd(localBins[bin], subgroupBallotBitCount(sameBin));
+            }
+            break;
+        }
+    }
+#else
+    atomicAdd(localBins[bin], 1u);
+#endif
+}
+
+void main() {
+    uint invocations = gl_WorkGroupSize.x * gl_WorkGroupSize.y;
+    for (uint i = gl_LocalInvocationIndex; i < BIN_COUNT; i += invocations) {
+        localBins[i] = 0u;
+    }
+    barrier();
+
+    // A 2x2 block per invocation, its pixels share one chroma sample
+    ivec2 block = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(inYImage);
+    if (all(lessThan(block * 2, size))) {
+        vec2 uv = chromaAt(block);
+        for (int i = 0; i < 4; i++) {
+            ivec2 coord = block * 2 + ivec2(i & 1, i >> 1);
+            if (all(lessThan(coord, size))) {
+                countPixel(binOf(imageLoad(inYImage, coord).r, uv));
+            }
+        }
+    }
+    memoryBarrierShared();
+    barrier();
+
+    for (uint i = gl_LocalInvocationIndex; i < BIN_COUNT; i += invocations) {
+        uint count = localBins[i];
+        if (count != 0u) {
+            atomicAdd(histogramBuffer.colorCount[i], count);
+        }
+    }
+}
+
+#endif
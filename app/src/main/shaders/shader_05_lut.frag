@@ -21,5 +21,8 @@ void main() {
    // 远远低于人眼能感知的一千多万种，这时候我们是能看到有明显的"色彩断层"问题的。所以为了提高精度，
    // sampler的采样方式我们设置为linear，这样经过差值后256*256*256种颜色的图经过LUT映射后依然
    // 是256*256*256的颜色精度，这样就不会有"色彩断层"问题了。
-   outColor = texture(lutImg, vec3(r, g, b), 0.0);
+   // The texels of the baked LUT (LutChain) sit on the grid of the colors, 0 and 1 are the
+   // centers of the first and the last texel
+   float size = float(textureSize(lutImg, 0).x);
+   outColor = texture(lutImg, (vec3(r, g, b) * (size - 1.0) + 0.5) / size, 0.0);
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 450
+layout (binding = 1) uniform sampler2D yuvImgs[3];
+// The LUTs stacked along z, slot n spans the depths [n * size, (n + 1) * size)
+layout (binding = 2) uniform sampler3D lutAtlas;
+layout (location = 0) in vec2 texturePos;
+layout (location = 1) flat in uint lutSlot;
+layout (location = 0) out vec4 outColor;
+void main() {
+   float y, u, v, r, g, b;
+   y = texture(yuvImgs[0], texturePos, 0.0).r;
+   u = texture(yuvImgs[1], texturePos, 0.0).r;
+   v = texture(yuvImgs[2], texturePos, 0.0).r;
+   u = u - 0.5;
+   v = v - 0.5;
+   r = y + 1.403 * v;
+   g = y - 0.344 * u - 0.714 * v;
+   b = y + 1.770 * u;
+
+   // Keep z on the texel centers of the slot, as CLAMP_TO_EDGE does on a single LUT, so that the
+   // neighbour slots never bleed in
+   ivec3 atlasSize = textureSize(lutAtlas, 0);
+   float lutSize = float(atlasSize.x);
+   float z = clamp(b * lutSize, 0.5, lutSize - 0.5) + float(lutSlot) * lutSize;
+   outColor = texture(lutAtlas, vec3(r, g, z / float(atlasSize.z)), 0.0);
+}
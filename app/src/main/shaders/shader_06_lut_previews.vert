@@ -0,0 +1,41 @@
+#version 450
+
+layout (location = 0) in vec4 inPos;
+layout (location = 1) in vec2 inUVPos;
+// Slot of the LUT bank holding the LUT of this preview, -1 past the last LUT
+layout (location = 2) in int inSlot;
+
+layout (binding = 0) uniform UBO
+{
+    mat4 projectionMatrix;
+    mat4 modelMatrix;
+    mat4 viewMatrix;
+} ubo;
+
+layout (push_constant) uniform PushContant{
+    float LUT_ITEM_WIDTH;
+    float WINDOW_WIDTH;
+} lutContant;
+
+layout (location = 0) out vec2 texturePos;
+layout (location = 1) flat out uint lutSlot;
+
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+
+// One instance per visible preview
+void main()
+{
+    if (inSlot < 0) {
+        // Past the end of the strip, the degenerate triangles are culled
+        gl_Position = vec4(0.0);
+        return;
+    }
+    texturePos = inUVPos;
+    lutSlot = uint(inSlot);
+    float x_offset = (float(gl_InstanceIndex) * lutContant.LUT_ITEM_WIDTH) * 2.0f /lutContant.WINDOW_WIDTH;
+    vec4 pos = ubo.projectionMatrix * ubo.viewMatrix * ubo.modelMatrix * inPos;
+    gl_Position = vec4(pos.x + x_offset, pos.yzw);
+}
@@ -1,18 +1,46 @@
 #version 450
 
 layout (binding = 0) readonly buffer InBuffer {
-  int colorCount[256];
+  uint colorCount[256];
 } histogramBuffer;
 
+// histogram::Statistics of the same bins, written by histogram_stats.comp
+layout (binding = 1) readonly buffer Statistics {
+  uint pixelCount;
+  uint minimum;
+  uint maximum;
+  float mean;
+  float meteredLuminance;
+  float exposure;
+  float exposureScale;
+  uint percentiles[5];
+} statistics;
+
 layout (location = 0) out vec4 outFragColor;
 layout (location = 0) in vec2 texturePos;
 
 void main()
 {
   int index = int(255 * texturePos.x);
-  int colorCount = histogramBuffer.colorCount[index];
+  uint colorCount = histogramBuffer.colorCount[index];
+
+  // Markers at the median, the mean, and the 1st and 99th percentiles
+  if (statistics.pixelCount > 0u) {
+    if (index == int(statistics.percentiles[2])) {
+      outFragColor = vec4(1.0, 0.8, 0.0, 0.8);
+      return;
+    }
+    if (index == int(statistics.mean + 0.5)) {
+      outFragColor = vec4(1.0, 0.3, 0.3, 0.8);
+      return;
+    }
+    if (index == int(statistics.percentiles[0]) || index == int(statistics.percentiles[4])) {
+      outFragColor = vec4(0.5, 0.5, 0.5, 0.6);
+      return;
+    }
+  }
 
-  int maxHeight = 0;
+  uint maxHeight = 0u;
   for (uint i = 0; i < 256; i++)
   {
     maxHeight = max(histogramBuffer.colorCount[i], maxHeight);
@@ -23,4 +51,4 @@ void main()
   } else {
     discard;
   }
-}
\ No newline at end of file
+}
@@ -1,7 +1,8 @@
 #version 450
 
 layout (location = 0) in vec3 inPos;
-layout (location = 1) in vec3 inNormal;
+// Octahedral normal of vkglTF::VertexLayout::compact
+layout (location = 1) in vec2 inNormal;
 layout (location = 2) in vec2 inUV;
 
 layout (set = 0, binding = 0) uniform UBOScene
@@ -25,15 +26,24 @@ layout (location = 2) out vec2 outUV;
 layout (location = 3) out vec3 outViewVec;
 layout (location = 4) out vec3 outLightVec;
 
+vec3 octDecode(vec2 p)
+{
+	vec3 n = vec3(p, 1.0 - abs(p.x) - abs(p.y));
+	// The lower half is folded over the upper one
+	float t = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+	return normalize(n);
+}
+
 void main()
 {
-	outNormal = inNormal;
+	vec3 normal = octDecode(inNormal);
 	outColor = vec3(1.0, 1.0, 1.0);
 	outUV = inUV;
 
 	gl_Position = uboScene.projection * uboScene.view * node.matrix * vec4(inPos.xyz, 1.0);
 
-	outNormal = normalize(transpose(inverse(mat3(uboScene.view * node.matrix))) * inNormal);
+	outNormal = normalize(transpose(inverse(mat3(uboScene.view * node.matrix))) * normal);
 
 	vec4 pos = uboScene.view * vec4(inPos, 1.0);
 	vec3 lPos = mat3(uboScene.view) * uboScene.lightPos.xyz;
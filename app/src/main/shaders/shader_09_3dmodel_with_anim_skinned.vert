@@ -0,0 +1,41 @@
+#version 450
+
+layout (location = 0) in vec3 inPos;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) in vec2 inUV;
+layout (location = 3) in vec2 inUV1; // We don't use it
+
+layout (set = 0, binding = 0) uniform UBOScene
+{
+	mat4 projection;
+	mat4 view;
+	vec4 lightPos;
+} uboScene;
+
+// The joint matrices following it in the buffer are not used
+layout (set = 2, binding = 0) uniform UBONode {
+	mat4 matrix;
+} node;
+
+layout (location = 0) out vec3 outNormal;
+layout (location = 1) out vec3 outColor;
+layout (location = 2) out vec2 outUV;
+layout (location = 3) out vec3 outViewVec;
+layout (location = 4) out vec3 outLightVec;
+
+void main()
+{
+	// Skinned already by gltf_skinning.comp, only the mesh matrix is left
+	vec4 pos = uboScene.projection * uboScene.view * node.matrix * vec4(inPos, 1.0);
+	outNormal = normalize(transpose(inverse(mat3(uboScene.view * node.matrix))) * inNormal);
+
+	pos.y = -pos.y;
+	gl_Position = pos;
+
+	outColor = vec3(1.0, 1.0, 1.0);
+	outUV = inUV;
+
+	vec3 lPos = mat3(uboScene.view) * uboScene.lightPos.xyz;
+	outLightVec = lPos - pos.xyz;
+	outViewVec = -pos.xyz;
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#version 450
+// The YCbCr conversion of the camera buffer is done by the immutable sampler
+layout (binding = 1) uniform sampler2D cameraImg;
+layout (location = 0) in vec2 texturePos;
+layout (location = 0) out vec4 outColor;
+void main() {
+   outColor = texture(cameraImg, texturePos);
+}
\ No newline at end of file
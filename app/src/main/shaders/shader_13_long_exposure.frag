@@ -0,0 +1,8 @@
+#version 450
+// Result of FrameAccumulator, RGB in [0, 1]
+layout (binding = 1) uniform sampler2D accumulatorImg;
+layout (location = 0) in vec2 texturePos;
+layout (location = 0) out vec4 outColor;
+void main() {
+   outColor = vec4(texture(accumulatorImg, texturePos, 0.0).rgb, 1.0);
+}
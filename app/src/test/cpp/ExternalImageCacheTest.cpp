@@ -0,0 +1,240 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <ExternalImageCache.h>
+#include <memory>
+#include <vector>
+
+#include "TestUtil.h"
+
+using namespace vks;
+
+namespace
+{
+// Host memory stand-in of an external buffer, lets the cache be exercised without a device
+struct HostBuffer
+{
+    uint64_t             id     = 0;
+    uint32_t             width  = 0;
+    uint32_t             height = 0;
+    uint32_t             format = 0;
+    std::vector<uint8_t> pixels;
+};
+
+// "Imports" a host buffer by aliasing its memory, like a real import no pixel is copied
+struct HostImage
+{
+    ExternalBufferDesc desc;
+    const uint8_t *    pixels = nullptr;
+};
+
+class HostImageImporter : public ExternalImageImporter<HostBuffer, HostImage>
+{
+  public:
+    bool describe(HostBuffer *buffer, ExternalBufferDesc *desc) override
+    {
+        desc->id     = buffer->id;
+        desc->width  = buffer->width;
+        desc->height = buffer->height;
+        desc->format = buffer->format;
+        desc->usage  = 0;
+        return true;
+    }
+
+    std::shared_ptr<HostImage> import(HostBuffer *buffer, const ExternalBufferDesc &desc) override
+    {
+        if (buffer->pixels.empty())
+            return nullptr;
+        importCount++;
+        auto image    = std::make_shared<HostImage>();
+        image->desc   = desc;
+        image->pixels = buffer->pixels.data();
+        return image;
+    }
+
+    uint32_t importCount = 0;
+};
+
+HostBuffer makeBuffer(uint64_t id, uint32_t width = 64, uint32_t height = 48)
+{
+    HostBuffer buffer;
+    buffer.id     = id;
+    buffer.width  = width;
+    buffer.height = height;
+    buffer.format = 1;
+    buffer.pixels.resize(width * height * 4, static_cast<uint8_t>(id));
+    return buffer;
+}
+
+void testMissThenHit()
+{
+    HostImageImporter                          importer;
+    ExternalImageCache<HostBuffer, HostImage> cache(&importer, 4);
+    HostBuffer                                 buffer = makeBuffer(1);
+
+    auto first = cache.acquire(&buffer);
+    CHECK(first != nullptr);
+    CHECK_EQ(first->pixels, buffer.pixels.data());
+    CHECK_EQ(importer.importCount, 1u);
+    CHECK_EQ(cache.stats().imports, 1u);
+    CHECK_EQ(cache.stats().hits, 0u);
+
+    auto second = cache.acquire(&buffer);
+    CHECK_EQ(second, first);
+    CHECK_EQ(importer.importCount, 1u);
+    CHECK_EQ(cache.stats().hits, 1u);
+    CHECK_EQ(cache.size(), 1u);
+}
+
+// A producer cycling through its buffers only imports during the first round
+void testProducerRing()
+{
+    HostImageImporter                          importer;
+    ExternalImageCache<HostBuffer, HostImage> cache(&importer, 4);
+    std::vector<HostBuffer>                    buffers;
+    for (uint64_t id = 1; id <= 4; id++)
+    {
+        buffers.push_back(makeBuffer(id));
+    }
+
+    for (int frame = 0; frame < 40; frame++)
+    {
+        CHECK(cache.acquire(&buffers[frame % buffers.size()]) != nullptr);
+    }
+    CHECK_EQ(importer.importCount, 4u);
+    CHECK_EQ(cache.stats().hits, 36u);
+    CHECK_EQ(cache.stats().evictions, 0u);
+}
+
+void testLruEviction()
+{
+    HostImageImporter                          importer;
+    ExternalImageCache<HostBuffer, HostImage> cache(&importer, 2);
+    HostBuffer                                 a = makeBuffer(1);
+    HostBuffer                                 b = makeBuffer(2);
+    HostBuffer                                 c = makeBuffer(3);
+
+    std::weak_ptr<HostImage> imageA = cache.acquire(&a);
+    std::weak_ptr<HostImage> imageB = cache.acquire(&b);
+    // a becomes the most recently used, b the least
+    cache.acquire(&a);
+    cache.acquire(&c);
+    CHECK_EQ(cache.size(), 2u);
+    CHECK_EQ(cache.stats().evictions, 1u);
+    // The cache held the only reference to the evicted image
+    CHECK(imageB.expired());
+    CHECK(!imageA.expired());
+
+    // a is still cached, b is imported again
+    cache.acquire(&a);
+    CHECK_EQ(importer.importCount, 3u);
+    cache.acquire(&b);
+    CHECK_EQ(importer.importCount, 4u);
+    CHECK_EQ(cache.stats().evictions, 2u);
+}
+
+// A user keeps its image alive after the cache evicted it, e.g. while the GPU still reads it
+void testEvictedImageStaysWithUser()
+{
+    HostImageImporter                          importer;
+    ExternalImageCache<HostBuffer, HostImage> cache(&importer, 1);
+    HostBuffer                                 a = makeBuffer(1);
+    HostBuffer                                 b = makeBuffer(2);
+
+    std::shared_ptr<HostImage> inUse = cache.acquire(&a);
+    cache.acquire(&b);
+    CHECK_EQ(cache.stats().evictions, 1u);
+    CHECK(inUse != nullptr);
+    CHECK_EQ(inUse->pixels, a.pixels.data());
+}
+
+// The producer released a buffer and allocated a new one that got the same id, with a different
+// size. The stale import must not be handed out for it.
+void testIdReusedAfterRelease()
+{
+    HostImageImporter                          importer;
+    ExternalImageCache<HostBuffer, HostImage> cache(&importer, 4);
+
+    auto original = std::make_unique<HostBuffer>(makeBuffer(7, 64, 48));
+    auto stale    = cache.acquire(original.get());
+    original.reset();
+
+    HostBuffer reused = makeBuffer(7, 128, 96);
+    auto       image  = cache.acquire(&reused);
+    CHECK(image != nullptr);
+    CHECK(image != stale);
+    CHECK_EQ(image->desc.width, 128u);
+    CHECK_EQ(image->pixels, reused.pixels.data());
+    CHECK_EQ(importer.importCount, 2u);
+    CHECK_EQ(cache.stats().evictions, 1u);
+    CHECK_EQ(cache.stats().hits, 0u);
+    CHECK_EQ(cache.size(), 1u);
+
+    // From then on the new buffer hits
+    CHECK_EQ(cache.acquire(&reused), image);
+    CHECK_EQ(cache.stats().hits, 1u);
+}
+
+void testFailures()
+{
+    HostImageImporter                          importer;
+    ExternalImageCache<HostBuffer, HostImage> cache(&importer, 2);
+    HostBuffer                                 empty;
+    empty.id = 5;
+
+    CHECK(cache.acquire(nullptr) == nullptr);
+    CHECK(cache.acquire(&empty) == nullptr);
+    CHECK_EQ(cache.stats().failures, 2u);
+    CHECK_EQ(cache.size(), 0u);
+}
+
+void testClear()
+{
+    HostImageImporter                          importer;
+    ExternalImageCache<HostBuffer, HostImage> cache(&importer, 4);
+    HostBuffer                                 a = makeBuffer(1);
+    HostBuffer                                 b = makeBuffer(2);
+
+    cache.acquire(&a);
+    cache.acquire(&b);
+    cache.clear();
+    CHECK_EQ(cache.size(), 0u);
+    CHECK_EQ(cache.stats().evictions, 2u);
+    cache.acquire(&a);
+    CHECK_EQ(importer.importCount, 3u);
+}
+}        // namespace
+
+int main()
+{
+    testMissThenHit();
+    testProducerRing();
+    testLruEviction();
+    testEvictedImageStaysWithUser();
+    testIdReusedAfterRelease();
+    testFailures();
+    testClear();
+    return test::result();
+}
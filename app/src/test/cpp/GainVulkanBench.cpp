@@ -0,0 +1,179 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <AssetUtil.h>
+#include <Sample.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Host benchmark driver, renders the samples headless:
+//   GainVulkanBench <compiled assets dir> <source assets dir> frames-in-flight [frames per run]
+//   GainVulkanBench <compiled assets dir> <source assets dir> benchmarks
+// The PBR model and environment map are not in the repository, copy them to the source assets
+// (models/DamagedHelmet, environments/papermill.ktx) to include the PBR sample.
+namespace
+{
+constexpr uint32_t kWidth  = 1280;
+constexpr uint32_t kHeight = 720;
+
+using FramePacing = VulkanContextBase::FramePacing;
+
+// Synthetic I420 camera frame: a diagonal luma gradient on a constant chroma
+struct YUVFrame
+{
+    uint32_t             width, height;
+    std::vector<uint8_t> y, u, v;
+
+    YUVFrame(uint32_t w, uint32_t h) :
+        width(w), height(h), y(w * h), u(w * h / 4, 96), v(w * h / 4, 160)
+    {
+        for (uint32_t row = 0; row < h; row++)
+        {
+            for (uint32_t col = 0; col < w; col++)
+            {
+                y[row * w + col] = static_cast<uint8_t>((row + col) & 0xff);
+            }
+        }
+    }
+};
+
+std::unique_ptr<Sample> createSample(const std::shared_ptr<AssetLoader> &assets, uint32_t type)
+{
+    auto sample = std::make_unique<Sample>(type);
+    sample->initialize(false, assets, true);
+    sample->setHeadlessTarget(kWidth, kHeight);
+    return sample;
+}
+
+const char *kPBRModel = "models/DamagedHelmet/DamagedHelmet.gltf";
+
+bool hasPBRAssets(const AssetLoader &assets)
+{
+    if (!assets.exists(kPBRModel) || !assets.exists("environments/papermill.ktx"))
+    {
+        fprintf(stderr, "%s or environments/papermill.ktx not found, skipping the PBR sample\n", kPBRModel);
+        return false;
+    }
+    return true;
+}
+
+// The camera sample on a 1080p frame
+std::vector<FramePacing> compareCameraYUV(const std::shared_ptr<AssetLoader> &assets, uint32_t frameCount)
+{
+    YUVFrame frame(1920, 1080);
+    auto     sample = createSample(assets, SampleType::CAMERA_YUV);
+    sample->prepareYUV(nullptr, frame.y.data(), frame.u.data(), frame.v.data(), frame.width, frame.height,
+                       frame.width, frame.width / 2, frame.width / 2);
+    return sample->compareFramesInFlight(frameCount);
+}
+
+std::vector<FramePacing> comparePBR(const std::shared_ptr<AssetLoader> &assets, uint32_t frameCount)
+{
+    if (!hasPBRAssets(*assets))
+    {
+        return {};
+    }
+
+    auto sample = createSample(assets, SampleType::LOAD_3D_MODEL_PBR);
+    sample->prepare3dModelPBR(nullptr, kPBRModel);
+    return sample->compareFramesInFlight(frameCount);
+}
+
+void printFramePacing(const std::vector<FramePacing> &camera, const std::vector<FramePacing> &pbr)
+{
+    printf("frames in flight | camera ms/frame | camera cpu ms | PBR ms/frame | PBR cpu ms\n");
+    for (size_t i = 0; i < std::max(camera.size(), pbr.size()); i++)
+    {
+        const FramePacing *c = i < camera.size() ? &camera[i] : nullptr;
+        const FramePacing *p = i < pbr.size() ? &pbr[i] : nullptr;
+        printf("%16u | %15.2f | %13.2f | %12.2f | %10.2f\n",
+               c != nullptr ? c->framesInFlight : p->framesInFlight,
+               c != nullptr ? c->frameMs : 0.0,
+               c != nullptr ? c->cpuMs : 0.0,
+               p != nullptr ? p->frameMs : 0.0,
+               p != nullptr ? p->cpuMs : 0.0);
+    }
+}
+
+// The benchmarks of the samples that have some, see VulkanContextBase::runBenchmarks, and the CPU
+// benchmarks of the engine
+void runBenchmarks(const std::shared_ptr<AssetLoader> &assets)
+{
+    YUVFrame frame(1920, 1080);
+    auto     histogram = createSample(assets, SampleType::HISTOGRAM);
+    histogram->prepareHistogram(nullptr, frame.y.data(), frame.u.data(), frame.v.data(), frame.width,
+                                frame.height, frame.width, frame.width / 2, frame.width / 2, 1, 1);
+    histogram->runBenchmarks();
+
+    auto exposure = createSample(assets, SampleType::LONG_EXPOSURE);
+    exposure->prepareLongExposure(nullptr, frame.y.data(), frame.u.data(), frame.v.data(), frame.width,
+                                  frame.height, frame.width, frame.width / 2, frame.width / 2, 1, 1);
+    exposure->runBenchmarks();
+
+    if (hasPBRAssets(*assets))
+    {
+        auto pbr = createSample(assets, SampleType::LOAD_3D_MODEL_PBR);
+        pbr->prepare3dModelPBR(nullptr, kPBRModel);
+        pbr->runBenchmarks();
+    }
+
+    exposure->runEngineBenchmarks();
+}
+}        // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        fprintf(stderr,
+                "Usage: %s <compiled assets dir> <source assets dir> frames-in-flight [frames per run]\n"
+                "       %s <compiled assets dir> <source assets dir> benchmarks\n",
+                argv[0], argv[0]);
+        return 1;
+    }
+    const auto assets = AssetLoader::create({argv[1], argv[2]});
+
+    if (strcmp(argv[3], "frames-in-flight") == 0)
+    {
+        const uint32_t frameCount = argc > 4 ? static_cast<uint32_t>(atoi(argv[4])) : 300;
+        const auto     camera     = compareCameraYUV(assets, frameCount);
+        const auto     pbr        = comparePBR(assets, frameCount);
+        printFramePacing(camera, pbr);
+    }
+    else if (strcmp(argv[3], "benchmarks") == 0)
+    {
+        runBenchmarks(assets);
+    }
+    else
+    {
+        fprintf(stderr, "Unknown mode %s\n", argv[3]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 by Gain
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <AssetUtil.h>
+#include <Sample.h>
+#include <cstdlib>
+#include <vector>
+
+#include "TestUtil.h"
+
+namespace
+{
+constexpr uint32_t kWidth  = 256;
+constexpr uint32_t kHeight = 256;
+
+const uint8_t *pixel(const std::vector<uint8_t> &frame, uint32_t x, uint32_t y)
+{
+    return frame.data() + (static_cast<size_t>(y) * kWidth + x) * 4;
+}
+
+// RGBA8 pixel within tolerance of the expected value, the rasterizers may round differently
+bool near(const uint8_t *rgba, int r, int g, int b, int a, int tolerance = 3)
+{
+    return abs(rgba[0] - r) <= tolerance && abs(rgba[1] - g) <= tolerance && abs(rgba[2] - b) <= tolerance &&
+           abs(rgba[3] - a) <= tolerance;
+}
+
+// The first sample: one triangle with a black, a red and a green vertex on a (0, 0, 0.2) clear color
+void testTriangle(const std::shared_ptr<AssetLoader> &assets)
+{
+    Sample sample(SampleType::TRIANGLE);
+    sample.initialize(false, assets, true);
+    sample.setHeadlessTarget(kWidth, kHeight);
+    sample.prepare(nullptr);
+    sample.render(false);
+
+    std::vector<uint8_t> frame(kWidth * kHeight * 4);
+    CHECK(!sample.readbackFrame(frame.data(), frame.size() - 1));
+    CHECK(sample.readbackFrame(frame.data(), frame.size()));
+
+    // The center is a quarter red, a quarter green and half black
+    const uint8_t *center = pixel(frame, kWidth / 2, kHeight / 2);
+    CHECK(near(center, 64, 64, 0, 255));
+    // Outside of the triangle, away from the UI overlay drawn at the top left
+    const uint8_t *corner = pixel(frame, kWidth - 1, kHeight - 1);
+    CHECK(near(corner, 0, 0, 51, 255));
+    if (test::failures() != 0)
+    {
+        fprintf(stderr, "center %d %d %d %d, corner %d %d %d %d\n", center[0], center[1], center[2], center[3],
+                corner[0], corner[1], corner[2], corner[3]);
+    }
+}
+}        // namespace
+
+// HeadlessRenderTest <compiled assets dir> <source assets dir>
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s <compiled assets dir> <source assets dir>\n", argv[0]);
+        return 1;
+    }
+    const auto assets = AssetLoader::create({argv[1], argv[2]});
+
+    testTriangle(assets);
+    return test::result();
+}